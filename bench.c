@@ -0,0 +1,1030 @@
+#define _GNU_SOURCE // eventfd, O_CLOEXEC
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/eventfd.h>
+#include <locale.h>
+
+#include "dircache.h"
+#include "textfile.h"
+#include "filter.h"
+#include "sortview.h"
+#include "copy.h"
+#include "treecopy.h"
+#include "dusize.h"
+#include "layout.h"
+#include "textsearch.h"
+#include "proclist.h"
+#include "sessions.h"
+#include "finder.h"
+#include "dirlru.h"
+#include "hash.h"
+#include "dupfind.h"
+#include "treeindex.h"
+
+// 화면 없이 목록, 파일 보기, 복사 경로를 측정하는 벤치마크 (make bench)
+// 환경 변수
+//   BENCH_DIR   - 측정용 파일을 만들 디렉토리 (기본 /tmp/guiShell-bench, 다음 실행에서 재사용)
+//   BENCH_SCALE - quick (기본, 1k/100k 목록, 256MB 텍스트) 또는 full (1M 목록, 2GB 텍스트 추가)
+
+#define BENCH_VISIBLE_ROWS 25  // 목록/보기 화면 한 페이지의 줄 수 (100x30 터미널 기준)
+#define BENCH_COLS 100         // 화면 폭
+
+typedef struct {
+    int full;
+    int list_sizes[3];     // 목록 디렉토리 항목 수 (0 이면 없음)
+    long long text_bytes;  // 텍스트 파일 크기
+    int tree_dirs;         // 작은 파일 트리의 디렉토리 수
+    int tree_files;        // 디렉토리당 파일 수
+} bench_scale;
+
+static char bench_dir[MAX_DIR_LENGTH] = "/tmp/guiShell-bench";
+static int ready_fd = -1; // stat 결과 도착 알림
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static uint64_t rng_state = 0x2545F4914F6CDD1DULL;
+
+static uint64_t rng_next(void) { // xorshift64
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+// 측정값 모음 (ms)
+typedef struct {
+    double *v;
+    int n;
+    int capacity;
+    double total;
+} samples;
+
+static void sample_add(samples *s, double ms) {
+    if (s->n == s->capacity) {
+        int new_capacity = s->capacity ? s->capacity * 2 : 256;
+        double *p = realloc(s->v, new_capacity * sizeof(double));
+        if (!p) {
+            return;
+        }
+        s->v = p;
+        s->capacity = new_capacity;
+    }
+    s->v[s->n++] = ms;
+    s->total += ms;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return x < y ? -1 : x > y;
+}
+
+static double percentile(const samples *s, double p) {
+    int i = (int)(p * (s->n - 1) + 0.5);
+    return s->v[i];
+}
+
+// 백분위 지연 시간과 처리량 한 줄 출력. units 는 전체 측정 동안 처리한 양 (0 이면 처리량 생략)
+static void report(const char *name, samples *s, double units, const char *unit_name) {
+    if (s->n == 0) {
+        printf("%-34s (no samples)\n", name);
+        return;
+    }
+    qsort(s->v, s->n, sizeof(double), compare_double);
+    printf("%-34s n=%-6d p50 %9.3f  p90 %9.3f  p99 %9.3f  max %9.3f ms", name, s->n,
+           percentile(s, 0.50), percentile(s, 0.90), percentile(s, 0.99), s->v[s->n - 1]);
+    if (units > 0 && s->total > 0) {
+        printf("  %10.1f %s/s", units / (s->total / 1e3), unit_name);
+    }
+    printf("\n");
+    free(s->v);
+    memset(s, 0, sizeof(*s));
+}
+
+// ---------------------------------------------------------------- 측정용 파일
+
+static const char *words[] = {
+    "report", "photo", "backup", "draft", "invoice", "notes", "build", "release",
+    "video", "music", "shell", "kernel", "config", "readme", "test", "data",
+};
+
+static int make_dirs(const char *path) {
+    if (mkdir(path, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "bench: mkdir %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+// 완료 표시 파일이 있으면 이전 실행에서 만든 것을 그대로 쓴다
+static int fixture_ready(const char *path) {
+    char marker[MAX_DIR_LENGTH + 16];
+    snprintf(marker, sizeof(marker), "%s.done", path);
+    return access(marker, F_OK) == 0;
+}
+
+static void fixture_done(const char *path) {
+    char marker[MAX_DIR_LENGTH + 16];
+    snprintf(marker, sizeof(marker), "%s.done", path);
+    int fd = open(marker, O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+// 빈 파일 count 개와 하위 디렉토리 몇 개로 된 목록
+static int make_listing(const char *path, int count) {
+    if (fixture_ready(path)) {
+        return 0;
+    }
+    if (make_dirs(path) < 0) {
+        return -1;
+    }
+    int dirfd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirfd < 0) {
+        return -1;
+    }
+    double start = now_ms();
+    for (int i = 0; i < count; i++) {
+        char name[64];
+        const char *a = words[rng_next() % 16], *b = words[rng_next() % 16];
+        if (i % 100 == 0) {
+            snprintf(name, sizeof(name), "%s_dir%d", a, i);
+            if (mkdirat(dirfd, name, 0755) != 0 && errno != EEXIST) {
+                break;
+            }
+            continue;
+        }
+        snprintf(name, sizeof(name), "%s-%s_%d.%s", a, b, i, (i & 1) ? "txt" : "jpg");
+        int fd = openat(dirfd, name, O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            fprintf(stderr, "bench: create %s/%s: %s\n", path, name, strerror(errno));
+            close(dirfd);
+            return -1;
+        }
+        if (i % 7 == 0) { // 크기 정렬이 의미 있도록 일부는 내용을 채운다 (희소)
+            if (ftruncate(fd, (off_t)(rng_next() % (1 << 20))) != 0) {
+                close(fd);
+                close(dirfd);
+                return -1;
+            }
+        }
+        close(fd);
+    }
+    close(dirfd);
+    fixture_done(path);
+    printf("  created %s (%d entries, %.1f s)\n", path, count, (now_ms() - start) / 1e3);
+    return 0;
+}
+
+// 길이가 제각각인 줄로 된 텍스트 파일
+static int make_text(const char *path, long long bytes) {
+    if (fixture_ready(path)) {
+        return 0;
+    }
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "bench: create %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    double start = now_ms();
+    size_t buf_size = 1 << 20;
+    char *buf = malloc(buf_size + 256);
+    long long written = 0;
+    long long line = 0;
+    while (buf && written < bytes) {
+        size_t used = 0;
+        while (used < buf_size) {
+            int len = snprintf(buf + used, 64, "%lld ", ++line);
+            used += len;
+            int words_in_line = rng_next() % 24; // 빈 줄도 섞는다
+            for (int w = 0; w < words_in_line; w++) {
+                const char *word = words[rng_next() % 16];
+                size_t wl = strlen(word);
+                memcpy(buf + used, word, wl);
+                used += wl;
+                buf[used++] = ' ';
+            }
+            buf[used++] = '\n';
+        }
+        if (write(fd, buf, used) != (ssize_t)used) {
+            free(buf);
+            close(fd);
+            return -1;
+        }
+        written += used;
+    }
+    free(buf);
+    close(fd);
+    fixture_done(path);
+    printf("  created %s (%lld MB, %.1f s)\n", path, written >> 20, (now_ms() - start) / 1e3);
+    return 0;
+}
+
+// 작은 파일 (1 - 16KB) 로 된 디렉토리 트리
+static int make_tree(const char *path, int dirs, int files) {
+    if (fixture_ready(path)) {
+        return 0;
+    }
+    if (make_dirs(path) < 0) {
+        return -1;
+    }
+    char data[16 * 1024];
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = 'a' + (rng_next() % 26);
+    }
+    for (int d = 0; d < dirs; d++) {
+        char dir[MAX_DIR_LENGTH + 64];
+        // 두 단계 깊이로 나눈다
+        snprintf(dir, sizeof(dir), "%s/group%d", path, d % 8);
+        if (make_dirs(dir) < 0) {
+            return -1;
+        }
+        snprintf(dir, sizeof(dir), "%s/group%d/dir%d", path, d % 8, d);
+        if (make_dirs(dir) < 0) {
+            return -1;
+        }
+        for (int f = 0; f < files; f++) {
+            char file[MAX_DIR_LENGTH + 128];
+            snprintf(file, sizeof(file), "%s/file%d.dat", dir, f);
+            int fd = open(file, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (fd < 0) {
+                return -1;
+            }
+            size_t len = 1024 + rng_next() % (sizeof(data) - 1024);
+            ssize_t n = write(fd, data, len);
+            close(fd);
+            if (n != (ssize_t)len) {
+                return -1;
+            }
+        }
+    }
+    fixture_done(path);
+    printf("  created %s (%d files)\n", path, dirs * files);
+    return 0;
+}
+
+// ---------------------------------------------------------------- 목록
+
+static void bench_ready(void) { // metafetch 스레드에서 호출
+    uint64_t one = 1;
+    ssize_t n = write(ready_fd, &one, sizeof(one));
+    (void)n;
+}
+
+// 모든 항목의 stat 을 요청하고 다 도착할 때까지 기다린다
+static void fetch_all(dir_cache *dc) {
+    dircache_fetch(dc, 0, dc->count);
+    int cursor = 0;
+    while (1) {
+        dircache_refresh(dc);
+        while (cursor < dc->count && dc->state[cursor] != STAT_PENDING) {
+            cursor++;
+        }
+        if (cursor >= dc->count) {
+            break;
+        }
+        uint64_t value;
+        ssize_t n = read(ready_fd, &value, sizeof(value)); // 다음 결과까지 대기
+        (void)n;
+    }
+}
+
+static const char *bench_name_at(const void *ctx, int idx) {
+    return dircache_name((const dir_cache *)ctx, idx);
+}
+
+// 보이는 줄을 그리는 것과 같은 일 (stat 요청, 줄 문자열 만들기) - 화면 출력만 빠짐
+static void render_rows(dir_cache *dc, const int *order, int count, int start) {
+    char row[512];
+    for (int i = start; i < count && i < start + BENCH_VISIBLE_ROWS; i++) {
+        dircache_fetch(dc, order[i], 1);
+    }
+    dircache_refresh(dc);
+    for (int i = start; i < count && i < start + BENCH_VISIBLE_ROWS; i++) {
+        struct stat st_buf;
+        const struct stat *st = dircache_peek_stat(dc, order[i], &st_buf) == 0 ? &st_buf : NULL;
+        if (st) {
+            char mod_time[20];
+            strftime(mod_time, sizeof(mod_time), "%Y-%m-%d %H:%M", localtime(&st->st_mtime));
+            snprintf(row, sizeof(row), "%-30s %-10s %-10ld %-20s", dircache_name(dc, order[i]),
+                     S_ISDIR(st->st_mode) ? "DIR" : "FILE", (long)st->st_size, mod_time);
+        } else {
+            snprintf(row, sizeof(row), "%-30s %-10s %-10s %-20s", dircache_name(dc, order[i]), "...", "...", "...");
+        }
+    }
+}
+
+// 디렉토리 사이를 오갈 때 - 처음 들어가기 (미리 읽기 포함) 와 최근 목록 캐시로 다시 들어가기
+static void bench_navigation(const char *a, const char *b) {
+    samples s = {0};
+    int result;
+    dirlru_init(bench_ready);
+    dirlru_open(a, &result);
+
+    // 선택만 해 두고 사용자가 고민하는 동안 미리 읽은 목록으로 들어가기
+    dirlru_prefetch(b);
+    usleep((DIRLRU_PREFETCH_DELAY_MS + 500) * 1000); // 미리 읽기가 끝날 만큼
+    double t = now_ms();
+    dir_cache *dc = dirlru_open(b, &result);
+    for (int i = 0; dc && i < BENCH_VISIBLE_ROWS && i < dc->count; i++) {
+        dircache_stat(dc, i, NULL);
+    }
+    sample_add(&s, now_ms() - t);
+    report("enter prefetched dir", &s, 0, NULL);
+
+    for (int r = 0; r < 50; r++) {
+        t = now_ms();
+        dc = dirlru_open(r % 2 ? b : a, &result);
+        for (int i = 0; dc && i < BENCH_VISIBLE_ROWS && i < dc->count; i++) {
+            dircache_stat(dc, i, NULL);
+        }
+        sample_add(&s, now_ms() - t);
+    }
+    report("revisit cached dir", &s, 0, NULL);
+}
+
+static void bench_listing(const char *path, int entries) {
+    char label[64];
+    samples s = {0};
+    int rounds = entries >= 1000000 ? 3 : entries >= 100000 ? 5 : 50;
+
+    // 디렉토리를 처음 열 때 (목록 + 첫 페이지)
+    for (int r = 0; r < rounds; r++) {
+        dir_cache dc;
+        dircache_init(&dc);
+        dc.on_ready = bench_ready;
+        double t = now_ms();
+        dircache_open(&dc, path);
+        dircache_fetch(&dc, 0, BENCH_VISIBLE_ROWS);
+        for (int i = 0; i < BENCH_VISIBLE_ROWS && i < dc.count; i++) {
+            dircache_stat(&dc, i, NULL); // 첫 페이지가 채워질 때까지
+        }
+        sample_add(&s, now_ms() - t);
+        dircache_free(&dc);
+    }
+    snprintf(label, sizeof(label), "list open %dk", entries / 1000);
+    report(label, &s, (double)entries * rounds, "entries");
+
+    dir_cache dc;
+    dircache_init(&dc);
+    dc.on_ready = bench_ready;
+    dircache_open(&dc, path);
+
+    // 모든 항목의 stat (크기/시각 정렬에 필요)
+    double t = now_ms();
+    fetch_all(&dc);
+    sample_add(&s, now_ms() - t);
+    snprintf(label, sizeof(label), "list stat-all %dk", entries / 1000);
+    report(label, &s, (double)dc.count, "entries");
+
+    // 정렬 기준 변경
+    sort_view sv;
+    sortview_init(&sv);
+    for (int r = 0; r < 3; r++) {
+        for (int mode = 0; mode < SORT_MODE_COUNT; mode++) {
+            sv.mode = mode;
+            t = now_ms();
+            sortview_update(&sv, &dc);
+            sample_add(&s, now_ms() - t);
+        }
+    }
+    snprintf(label, sizeof(label), "sort switch %dk", entries / 1000);
+    report(label, &s, 0, NULL);
+
+    // 한 줄씩, 한 페이지씩 스크롤
+    sv.mode = SORT_NAME;
+    const int *order = sortview_update(&sv, &dc);
+    int steps = dc.count < 20000 ? dc.count : 20000;
+    for (int i = 0; order && i < steps; i++) {
+        t = now_ms();
+        order = sortview_update(&sv, &dc);
+        render_rows(&dc, order, dc.count, i);
+        sample_add(&s, now_ms() - t);
+    }
+    snprintf(label, sizeof(label), "scroll line %dk", entries / 1000);
+    report(label, &s, 0, NULL);
+    for (int i = 0; order && i < dc.count && s.n < 5000; i += BENCH_VISIBLE_ROWS) {
+        t = now_ms();
+        order = sortview_update(&sv, &dc);
+        render_rows(&dc, order, dc.count, i);
+        sample_add(&s, now_ms() - t);
+    }
+    snprintf(label, sizeof(label), "scroll page %dk", entries / 1000);
+    report(label, &s, 0, NULL);
+
+    // 필터 - 한 글자씩 입력하고 지우기
+    static const char *queries[] = { "report", "phdr", "shell-kernel", "_9", "xyz" };
+    name_filter f;
+    filter_init(&f);
+    unsigned long generation = dc.generation;
+    for (int r = 0; r < 3; r++) {
+        generation++; // 매 라운드 목록이 새로 바뀐 것처럼 처음부터
+        for (size_t q = 0; q < sizeof(queries) / sizeof(queries[0]); q++) {
+            char query[FILTER_MAX_QUERY];
+            size_t len = strlen(queries[q]);
+            for (size_t k = 1; k <= len; k++) {
+                memcpy(query, queries[q], k);
+                query[k] = '\0';
+                t = now_ms();
+                filter_apply(&f, query, bench_name_at, &dc, dc.count, generation);
+                sample_add(&s, now_ms() - t);
+            }
+            for (size_t k = len - 1; k > 0; k--) { // 지우기 - 보관해 둔 앞 단계 결과
+                query[k] = '\0';
+                t = now_ms();
+                filter_apply(&f, query, bench_name_at, &dc, dc.count, generation);
+                sample_add(&s, now_ms() - t);
+            }
+        }
+    }
+    snprintf(label, sizeof(label), "filter keystroke %dk", entries / 1000);
+    report(label, &s, 0, NULL);
+
+    filter_free(&f);
+    sortview_free(&sv);
+    dircache_free(&dc);
+}
+
+// ---------------------------------------------------------------- 파일 보기
+
+// 한글, 탭, 제어 문자가 섞인 긴 줄을 줄바꿈 모드로 한 페이지 배치
+static void bench_layout(void) {
+    samples s = {0};
+    static const char *pieces[] = {"디렉토리 ", "\tcolumn ", "plain ascii words here ", "파일 목록 ", "\x01", "é "};
+    size_t len = 0, cap = 1 << 20;
+    char *line = malloc(cap);
+    if (!line) {
+        return;
+    }
+    while (1) {
+        const char *piece = pieces[rng_next() % 6];
+        size_t n = strlen(piece);
+        if (len + n >= cap) {
+            break;
+        }
+        memcpy(line + len, piece, n);
+        len += n;
+    }
+    char text[4096];
+    size_t pos = 0;
+    for (int i = 0; i < 20000; i++) {
+        double t = now_ms();
+        for (int k = 0; k < BENCH_VISIBLE_ROWS; k++) {
+            if (pos >= len) {
+                pos = 0;
+            }
+            pos += layout_line(text, sizeof(text), line + pos, len - pos, 0, BENCH_COLS, 0);
+        }
+        sample_add(&s, now_ms() - t);
+    }
+    report("view layout wrapped page", &s, 0, NULL);
+    free(line);
+}
+
+static void bench_viewer(const char *path) {
+    samples s = {0};
+    text_file tf;
+    char text[4096];
+
+    double t = now_ms();
+    if (textfile_open(&tf, path, NULL) < 0) {
+        fprintf(stderr, "bench: cannot open %s\n", path);
+        return;
+    }
+    // 첫 페이지
+    size_t off = 0;
+    for (int i = 0; i < BENCH_VISIBLE_ROWS; i++) {
+        textfile_line_end(&tf, off);
+        off = textfile_next_line(&tf, off);
+    }
+    sample_add(&s, now_ms() - t);
+    report("view open + first page", &s, 0, NULL);
+
+    // 백그라운드 라인 인덱스가 끝날 때까지
+    int done = 0;
+    size_t lines = 0;
+    while (!done) {
+        lines = textfile_indexed_lines(&tf, &done);
+        if (!done) {
+            usleep(1000);
+        }
+    }
+    sample_add(&s, now_ms() - t);
+    report("view line index", &s, (double)tf.size / (1 << 20), "MB");
+
+    // 페이지 단위로 앞뒤 이동
+    off = 0;
+    for (int i = 0; i < 20000; i++) {
+        t = now_ms();
+        for (int k = 0; k < BENCH_VISIBLE_ROWS; k++) {
+            off = textfile_next_line(&tf, off);
+        }
+        size_t row = off;
+        for (int k = 0; k < BENCH_VISIBLE_ROWS; k++) {
+            size_t end = textfile_line_end(&tf, row);
+            layout_line(text, sizeof(text), tf.data + row, end - row, 0, BENCH_COLS, 0);
+            row = textfile_next_line(&tf, row);
+        }
+        sample_add(&s, now_ms() - t);
+    }
+    report("view page down", &s, 0, NULL);
+    for (int i = 0; i < 20000; i++) {
+        t = now_ms();
+        for (int k = 0; k < BENCH_VISIBLE_ROWS; k++) {
+            off = textfile_prev_line(&tf, off);
+        }
+        sample_add(&s, now_ms() - t);
+    }
+    report("view page up", &s, 0, NULL);
+
+    // 임의의 줄 번호로 이동
+    for (int i = 0; lines > 0 && i < 5000; i++) {
+        size_t line = rng_next() % lines;
+        t = now_ms();
+        if (textfile_line_offset(&tf, line, &off) == 0) {
+            size_t row = off;
+            for (int k = 0; k < BENCH_VISIBLE_ROWS; k++) {
+                textfile_line_end(&tf, row);
+                row = textfile_next_line(&tf, row);
+            }
+        }
+        sample_add(&s, now_ms() - t);
+    }
+    report("view goto line", &s, 0, NULL);
+
+    // 파일 전체 검색 (백그라운드 인덱스가 끝날 때까지)
+    static const struct {
+        const char *label;
+        const char *pattern;
+        int regex;
+    } searches[] = {
+        {"view search literal", "needle-not-present", 0},
+        {"view search common word", "kernel", 0},
+        {"view search regex", "^[0-9]+7 shell", 1},
+    };
+    for (int i = 0; i < 3; i++) {
+        text_search ts;
+        int search_done = 0;
+        t = now_ms();
+        if (textsearch_start(&ts, tf.data, tf.size, searches[i].pattern, searches[i].regex, NULL) != 0) {
+            continue;
+        }
+        while (!search_done) {
+            textsearch_progress(&ts, &search_done, NULL);
+            if (!search_done) {
+                usleep(1000);
+            }
+        }
+        sample_add(&s, now_ms() - t);
+        char label[64];
+        snprintf(label, sizeof(label), "%s (%zu)", searches[i].label, textsearch_progress(&ts, NULL, NULL));
+        report(label, &s, (double)tf.size / (1 << 20), "MB");
+        textsearch_stop(&ts);
+    }
+
+    textfile_close(&tf);
+}
+
+// ---------------------------------------------------------------- 붙여넣기
+
+// 파일 전체의 해시 (복사 결과 확인용)
+static int hash_file(const char *path, hash128 *out) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    static char buf[1 << 20];
+    hash_state hs;
+    hash_init(&hs);
+    ssize_t n;
+    while ((n = read(fd, buf, sizeof(buf))) > 0) {
+        hash_update(&hs, buf, n);
+    }
+    close(fd);
+    *out = hash_final(&hs);
+    return n < 0 ? -1 : 0;
+}
+
+typedef struct {
+    copy_stats cs;
+    volatile int finished; // 복사가 (절반 전에 실패하거나 끝나서) 돌아옴
+} cancel_target;
+
+// 복사가 절반쯤 진행되면 취소하는 스레드 (중단 후 이어 복사 확인)
+static void *cancel_half(void *arg) {
+    cancel_target *target = arg;
+    copy_stats *cs = &target->cs;
+    while (!target->finished &&
+           (__atomic_load_n(&cs->bytes_done, __ATOMIC_RELAXED) < cs->bytes_total / 2 || cs->bytes_total == 0)) {
+        usleep(200);
+    }
+    cs->cancel = 1;
+    return NULL;
+}
+
+// 큰 파일 복사를 중간에 취소한 뒤 다시 복사 - 체크포인트에서 이어서, 해시가 원본과 같은지 확인
+static void bench_resume(const char *text_path) {
+    samples s = {0};
+    char dest[MAX_DIR_LENGTH + 32];
+    snprintf(dest, sizeof(dest), "%s/resume-file", bench_dir);
+    hash128 want;
+    if (hash_file(text_path, &want) != 0) {
+        return;
+    }
+
+    long long resumed = 0;
+    int bad = 0;
+    for (int r = 0; r < 3; r++) {
+        cancel_target target;
+        memset(&target, 0, sizeof(target));
+        pthread_t tid;
+        pthread_create(&tid, NULL, cancel_half, &target);
+        int rc = copy_file_fast(text_path, dest, &target.cs);
+        target.finished = 1;
+        pthread_join(tid, NULL);
+        if (rc == 0 || target.cs.error != ECANCELED) {
+            fprintf(stderr, "bench: copy was not cancelled (%s)\n", copy_method_name(target.cs.method));
+            unlink(dest);
+            return;
+        }
+
+        copy_stats cs;
+        memset(&cs, 0, sizeof(cs));
+        double t = now_ms();
+        rc = copy_file_fast(text_path, dest, &cs);
+        sample_add(&s, now_ms() - t);
+        resumed += cs.bytes_total - cs.resumed_from;
+        hash128 got;
+        if (rc != 0 || hash_file(dest, &got) != 0 || !hash_equal(got, want) ||
+            (cs.has_digest && !hash_equal(cs.digest, want))) {
+            bad++;
+        }
+        if (r == 0) {
+            // 복사본을 다시 복사하면 복사본에 남긴 해시와 비교한다
+            char again[sizeof(dest) + 8];
+            snprintf(again, sizeof(again), "%s-again", dest);
+            copy_stats check;
+            memset(&check, 0, sizeof(check));
+            int verified = copy_file_fast(dest, again, &check) == 0 && check.verified;
+            unlink(again);
+            printf("  resumed from %lld of %lld bytes, digest %s, copy of the copy %s\n", cs.resumed_from,
+                   cs.bytes_total, cs.has_digest ? "computed" : "none", verified ? "verified" : "not verified");
+        }
+        unlink(dest);
+    }
+    if (bad) {
+        fprintf(stderr, "bench: resumed copy differs from source (%d of 3)\n", bad);
+    }
+    report("paste resume after cancel", &s, (double)resumed / (1 << 20), "MB");
+}
+
+static void bench_paste(const char *text_path, const char *tree_path) {
+    samples s = {0};
+    char dest[MAX_DIR_LENGTH + 32];
+
+    snprintf(dest, sizeof(dest), "%s/paste-file", bench_dir);
+    for (int r = 0; r < 3; r++) {
+        copy_stats cs;
+        memset(&cs, 0, sizeof(cs));
+        double t = now_ms();
+        int rc = copy_file_fast(text_path, dest, &cs);
+        double elapsed = now_ms() - t;
+        if (rc == 0) {
+            sample_add(&s, elapsed);
+        } else {
+            fprintf(stderr, "bench: copy failed: %s\n", strerror(cs.error));
+        }
+        if (r == 0) {
+            printf("  copy method: %s\n", copy_method_name(cs.method));
+        }
+        unlink(dest);
+    }
+    struct stat st;
+    double mb = stat(text_path, &st) == 0 ? (double)st.st_size / (1 << 20) : 0;
+    report("paste large file", &s, mb * s.n, "MB");
+    bench_resume(text_path);
+
+    snprintf(dest, sizeof(dest), "%s/paste-tree", bench_dir);
+    long long files = 0;
+    for (int r = 0; r < 3; r++) {
+        tree_copy_stats ts;
+        memset(&ts, 0, sizeof(ts));
+        remove_tree(dest);
+        double t = now_ms();
+        copy_tree(tree_path, dest, &ts);
+        sample_add(&s, now_ms() - t);
+        files += ts.files_done;
+        if (ts.errors) {
+            fprintf(stderr, "bench: tree copy errors: %d (%s)\n", ts.errors, ts.error_path);
+        }
+    }
+    remove_tree(dest);
+    report("paste small-file tree", &s, (double)files, "files");
+
+    // 같은 트리의 전체 크기 계산 (du)
+    double t = now_ms();
+    if (du_start(tree_path) == 0) {
+        long long scanned;
+        while (du_running(&scanned)) {
+            usleep(200);
+        }
+        sample_add(&s, now_ms() - t);
+        du_stop();
+    }
+    report("du small-file tree", &s, 0, NULL);
+}
+
+// 작은 파일 트리의 재귀 검색 - 이름만 보는 검색 (stat 없음) 과 크기 조건 검색 (항목마다 stat)
+static void bench_find(const char *tree_path) {
+    static const char *queries[] = {"*7.dat", "size>100"};
+    for (int q = 0; q < 2; q++) {
+        samples s = {0};
+        long long total = 0;
+        for (int i = 0; i < 5; i++) {
+            char error[128];
+            double t = now_ms();
+            if (find_start(tree_path, queries[q], error, sizeof(error)) != 0) {
+                break;
+            }
+            while (find_running(NULL)) {
+                usleep(200);
+            }
+            sample_add(&s, now_ms() - t);
+            find_count(&total);
+        }
+        find_stop();
+        char label[64];
+        snprintf(label, sizeof(label), "find %s (%lld found)", queries[q], total);
+        report(label, &s, 0, NULL);
+    }
+}
+
+// 중복 찾기용 디렉토리 - 서로 다른 파일 groups 개와 그 복사본, 그리고 앞/뒤 블록은 같고 가운데만 다른
+// (부분 해시는 같지만 전체 해시는 다른) 같은 크기의 파일들
+static int make_dup_tree(const char *path, int groups, int size) {
+    if (fixture_ready(path)) {
+        return 0;
+    }
+    char orig[MAX_DIR_LENGTH + 64], copies[MAX_DIR_LENGTH + 64], near[MAX_DIR_LENGTH + 64];
+    snprintf(orig, sizeof(orig), "%s/orig", path);
+    snprintf(copies, sizeof(copies), "%s/copies", path);
+    snprintf(near, sizeof(near), "%s/near", path);
+    if (make_dirs(path) < 0 || make_dirs(orig) < 0 || make_dirs(copies) < 0 || make_dirs(near) < 0) {
+        return -1;
+    }
+    char *data = malloc(size);
+    if (!data) {
+        return -1;
+    }
+    int rc = 0;
+    for (int g = 0; g < groups && rc == 0; g++) {
+        for (int i = 0; i < size; i++) {
+            data[i] = (char)rng_next();
+        }
+        const char *dirs[3] = { orig, copies, near };
+        for (int k = 0; k < 3 && rc == 0; k++) {
+            char file[MAX_DIR_LENGTH + 128];
+            snprintf(file, sizeof(file), "%s/file%d.bin", dirs[k], g);
+            if (k == 2) {
+                data[size / 2] ^= 0x5A; // 가운데 한 바이트만 다름
+            }
+            int fd = open(file, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (fd < 0 || write(fd, data, size) != size) {
+                rc = -1;
+            }
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+    }
+    free(data);
+    if (rc == 0) {
+        fixture_done(path);
+        printf("  created %s (%d files)\n", path, groups * 3);
+    }
+    return rc;
+}
+
+// 색인 - 처음 검색 (순회하면서 색인을 채움), 색인으로 답하는 검색, 저장하고 다시 연 뒤 (다음 실행) 의 검색,
+// 디렉토리 하나가 바뀐 뒤의 검색 (바뀐 곳까지만 다시 읽는다)
+// 크기나 시각 조건은 색인으로 답하지 않으므로 이름으로 찾는다
+static void bench_index(const char *tree_path) {
+    char file[MAX_DIR_LENGTH + 32];
+    snprintf(file, sizeof(file), "%s/index.bin", bench_dir);
+    unlink(file);
+    tindex_open(file);
+
+    static const char *labels[] = {"find *7.dat (walk, fills index)", "find *7.dat (index)",
+                                   "find *7.dat (index, reopened)", "find *7.dat (index, one dir changed)"};
+    char changed[MAX_DIR_LENGTH + 64];
+    snprintf(changed, sizeof(changed), "%s/group3/dir3/bench-touch", tree_path);
+    samples s = {0};
+    for (int phase = 0; phase < 4; phase++) {
+        if (phase == 2) {
+            double t = now_ms();
+            tindex_save();
+            sample_add(&s, now_ms() - t);
+            report("index save", &s, 0, NULL);
+            tindex_close();
+            t = now_ms();
+            tindex_open(file);
+            sample_add(&s, now_ms() - t);
+            report("index open (mmap)", &s, 0, NULL);
+        }
+        long long total = 0;
+        for (int i = 0; i < (phase == 0 ? 1 : 5); i++) {
+            char error[128];
+            if (phase == 3) { // 디렉토리 mtime 을 바꾼다
+                close(open(changed, O_WRONLY | O_CREAT | O_CLOEXEC, 0644));
+                unlink(changed);
+            }
+            double t = now_ms();
+            if (find_start(tree_path, "*7.dat", error, sizeof(error)) != 0) {
+                break;
+            }
+            while (find_running(NULL)) {
+                usleep(200);
+            }
+            sample_add(&s, now_ms() - t);
+            find_count(&total);
+        }
+        find_stop();
+        char label[80];
+        snprintf(label, sizeof(label), "%s (%lld)", labels[phase], total);
+        report(label, &s, 0, NULL);
+    }
+
+    // du 가 이전 실행의 합계를 쓰기 전에 하는 확인 (하위 디렉토리마다 lstat)
+    struct stat st;
+    if (stat(tree_path, &st) == 0) {
+        for (int i = 0; i < 20; i++) {
+            double t = now_ms();
+            if (tindex_scan_tree(tree_path, st.st_dev, st.st_ino, &st.st_mtim, NULL, NULL) != 0) {
+                break;
+            }
+            sample_add(&s, now_ms() - t);
+        }
+        report("index validate tree", &s, 0, NULL);
+    }
+    tindex_close();
+    unlink(file);
+}
+
+// 중복 찾기 - 해시 자체의 속도 (메모리 안의 버퍼) 와 픽스처 전체 검색
+static void bench_dup(const char *dup_path) {
+    samples s = {0};
+    size_t len = 64 << 20;
+    char *buf = malloc(len);
+    if (buf) {
+        memset(buf, 0x3C, len);
+        volatile uint64_t sink = 0;
+        for (int i = 0; i < 10; i++) {
+            double t = now_ms();
+            sink += hash_buffer(buf, len).lo;
+            sample_add(&s, now_ms() - t);
+        }
+        (void)sink;
+        free(buf);
+        report("hash 64MB buffer", &s, 64.0 * s.n, "MB");
+    }
+
+    dup_progress p = {0};
+    double mb = 0;
+    for (int i = 0; i < 5; i++) {
+        double t = now_ms();
+        if (dup_start(dup_path) != 0) {
+            break;
+        }
+        do {
+            usleep(200);
+            dup_get_progress(&p);
+        } while (p.state < DUP_DONE);
+        sample_add(&s, now_ms() - t);
+        mb += (double)p.bytes_read / (1 << 20);
+    }
+    dup_stop();
+    char label[64];
+    snprintf(label, sizeof(label), "dup scan (%lld groups)", p.groups);
+    report(label, &s, mb, "MB");
+}
+
+// ---------------------------------------------------------------- 프로세스/세션
+
+// 프로세스 화면 한 번 갱신 (/proc 읽기 + 정렬) 과 이전 방식인 ps 실행 비교
+static void bench_monitor(void) {
+    samples s = {0};
+    proc_table pt;
+    if (proctable_init(&pt) == 0) {
+        int *order = NULL;
+        for (int i = 0; i < 200; i++) {
+            double t = now_ms();
+            int count = proctable_refresh(&pt);
+            int *p = realloc(order, (count > 0 ? count : 1) * sizeof(int));
+            if (!p) {
+                break;
+            }
+            order = p;
+            proctable_view(&pt, "", PROC_SORT_CPU, order);
+            sample_add(&s, now_ms() - t);
+        }
+        char label[64];
+        snprintf(label, sizeof(label), "proc refresh + sort (%d procs)", pt.count);
+        report(label, &s, 0, NULL);
+        free(order);
+        proctable_free(&pt);
+    }
+
+    for (int i = 0; i < 20; i++) {
+        double t = now_ms();
+        FILE *fp = popen("ps -e -o pid,user,stat,pcpu,rss,nlwp,comm 2>/dev/null", "r");
+        if (!fp) {
+            break;
+        }
+        char buf[4096];
+        while (fread(buf, 1, sizeof(buf), fp) > 0) {
+        }
+        pclose(fp);
+        sample_add(&s, now_ms() - t);
+    }
+    report("ps fork + exec (before)", &s, 0, NULL);
+
+    session_info sessions[256];
+    for (int i = 0; i < 1000; i++) {
+        double t = now_ms();
+        sessions_read(NULL, sessions, 256);
+        sample_add(&s, now_ms() - t);
+    }
+    report("sessions read utmp", &s, 0, NULL);
+}
+
+int main(void) {
+    setlocale(LC_CTYPE, ""); // 문자 폭 계산 (guiShell 과 같게)
+    const char *env = getenv("BENCH_DIR");
+    if (env && env[0]) {
+        snprintf(bench_dir, sizeof(bench_dir), "%s", env);
+    }
+    bench_scale scale = { 0, { 1000, 100000, 0 }, 256LL << 20, 64, 32 };
+    env = getenv("BENCH_SCALE");
+    if (env && strcmp(env, "full") == 0) {
+        scale.full = 1;
+        scale.list_sizes[2] = 1000000;
+        scale.text_bytes = 2LL << 30;
+        scale.tree_dirs = 256;
+        scale.tree_files = 80;
+    }
+
+    ready_fd = eventfd(0, EFD_CLOEXEC);
+    if (ready_fd < 0 || make_dirs(bench_dir) < 0) {
+        return 1;
+    }
+
+    printf("guiShell bench (%s) in %s\n", scale.full ? "full" : "quick", bench_dir);
+    char path[3][MAX_DIR_LENGTH + 32];
+    for (int i = 0; i < 3 && scale.list_sizes[i]; i++) {
+        snprintf(path[i], sizeof(path[i]), "%s/list-%d", bench_dir, scale.list_sizes[i]);
+        if (make_listing(path[i], scale.list_sizes[i]) < 0) {
+            return 1;
+        }
+    }
+    char text_path[MAX_DIR_LENGTH + 32];
+    snprintf(text_path, sizeof(text_path), "%s/text-%lldM.txt", bench_dir, scale.text_bytes >> 20);
+    char tree_path[MAX_DIR_LENGTH + 32];
+    snprintf(tree_path, sizeof(tree_path), "%s/tree-%d", bench_dir, scale.tree_dirs * scale.tree_files);
+    char dup_path[MAX_DIR_LENGTH + 32];
+    snprintf(dup_path, sizeof(dup_path), "%s/dups-%d", bench_dir, scale.full ? 512 : 64);
+    if (make_text(text_path, scale.text_bytes) < 0 || make_tree(tree_path, scale.tree_dirs, scale.tree_files) < 0 ||
+        make_dup_tree(dup_path, scale.full ? 512 : 64, 1 << 20) < 0) {
+        return 1;
+    }
+
+    printf("\n[listing]\n");
+    for (int i = 0; i < 3 && scale.list_sizes[i]; i++) {
+        bench_listing(path[i], scale.list_sizes[i]);
+    }
+    bench_navigation(path[0], path[1]);
+    printf("\n[viewer]\n");
+    bench_viewer(text_path);
+    bench_layout();
+    printf("\n[paste]\n");
+    bench_paste(text_path, tree_path);
+    bench_find(tree_path);
+    bench_index(tree_path);
+    bench_dup(dup_path);
+    printf("\n[monitor]\n");
+    bench_monitor();
+
+    close(ready_fd);
+    return 0;
+}
@@ -0,0 +1,655 @@
+#define _GNU_SOURCE // copy_file_range, SEEK_DATA
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <limits.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/xattr.h>
+#include <linux/fs.h>
+
+#include "copy.h"
+#include "perf.h"
+#include "project_macro.h"
+
+#define COPY_CHUNK (8 * 1024 * 1024)  // 커널 복사 한 번에 넘기는 크기 (취소 확인 간격)
+#define COPY_BUFFER (1024 * 1024)     // 버퍼 복사에 쓰는 버퍼 크기
+#define COPY_VERIFY_TAIL (64 * 1024)  // 이어 복사하기 전에 원본과 비교하는 임시 파일의 끝부분
+#define COPY_CHECKPOINT_VERSION 1
+
+// 체크포인트 파일 (.이름.gspart.ckpt) - 임시 파일의 [0, offset) 이 디스크에 있고 내용의 해시가 hs 임
+// 원본이 같은 파일이고 바뀌지 않았을 때만 쓴다. hash_state 를 그대로 저장하므로 구조체 크기도 확인한다
+typedef struct {
+    char magic[8];        // "GSCKPT"
+    uint32_t version;
+    uint32_t state_size;  // sizeof(hash_state)
+    uint64_t src_dev;
+    uint64_t src_ino;
+    int64_t src_size;
+    int64_t src_mtime_sec;
+    int64_t src_mtime_nsec;
+    int64_t offset;
+    hash_state hs;
+} copy_checkpoint;
+
+const char *copy_method_name(int method) {
+    switch (method) {
+        case COPY_METHOD_REFLINK: return "reflink";
+        case COPY_METHOD_COPY_FILE_RANGE: return "copy_file_range";
+        case COPY_METHOD_SENDFILE: return "sendfile";
+        case COPY_METHOD_BUFFER: return "buffer";
+        case COPY_METHOD_HASHED: return "hashed";
+        default: return "none";
+    }
+}
+
+void format_size(char *buf, size_t buf_size, double bytes) {
+    const char *units = "BKMGTP";
+    int unit = 0;
+    while (bytes >= 1024 && units[unit + 1]) {
+        bytes /= 1024;
+        unit++;
+    }
+    if (unit == 0) {
+        snprintf(buf, buf_size, "%.0f%c", bytes, units[unit]);
+    } else {
+        snprintf(buf, buf_size, "%.1f%c", bytes, units[unit]);
+    }
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// 다음 방식으로 넘어가도 되는 오류인지 (지원하지 않는 경우)
+static int is_unsupported(int err) {
+    return err == EXDEV || err == ENOSYS || err == EOPNOTSUPP || err == EINVAL ||
+           err == ENOTTY || err == EBADF || err == EPERM;
+}
+
+static void add_progress(copy_stats *stats, long long n) {
+    perf_count(PERF_C_COPY_BYTES, n);
+    __atomic_add_fetch(&stats->bytes_done, n, __ATOMIC_RELAXED);
+    if (stats->shared_done) {
+        __atomic_add_fetch(stats->shared_done, n, __ATOMIC_RELAXED);
+    }
+}
+
+static int is_cancelled(const copy_stats *stats) {
+    return stats->cancel || (stats->shared_cancel && *stats->shared_cancel);
+}
+
+// 버퍼로 [off, off+len) 구간 복사, 짧은 쓰기도 끝까지 처리
+static int copy_range_buffer(int src, int dst, off_t off, off_t len, copy_stats *stats) {
+    char *buffer = malloc(COPY_BUFFER);
+    if (!buffer) {
+        return -1;
+    }
+    while (len > 0 && !is_cancelled(stats)) {
+        ssize_t n = pread(src, buffer, len < COPY_BUFFER ? len : COPY_BUFFER, off);
+        perf_count(PERF_C_COPY_CALL, 1);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            free(buffer);
+            return -1;
+        }
+        if (n == 0) {
+            break; // 복사 도중 파일이 줄어든 경우
+        }
+        for (ssize_t written = 0; written < n; ) {
+            ssize_t w = pwrite(dst, buffer + written, n - written, off + written);
+            perf_count(PERF_C_COPY_CALL, 1);
+            if (w < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                free(buffer);
+                return -1;
+            }
+            written += w;
+        }
+        off += n;
+        len -= n;
+        add_progress(stats, n);
+    }
+    free(buffer);
+    return 0;
+}
+
+// 데이터 구간 하나를 가능한 가장 싼 방식으로 복사
+static int copy_range(int src, int dst, off_t off, off_t len, copy_stats *stats) {
+    if (stats->method <= COPY_METHOD_COPY_FILE_RANGE) {
+        off_t in = off, out = off;
+        while (len > 0 && !is_cancelled(stats)) {
+            ssize_t n = copy_file_range(src, &in, dst, &out, len < COPY_CHUNK ? len : COPY_CHUNK, 0);
+            perf_count(PERF_C_COPY_CALL, 1);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                if (n == 0 && in == off) {
+                    break; // /proc 등 copy_file_range 가 0 을 돌려주는 파일 - 다음 방식으로
+                }
+                if (n == 0) {
+                    return 0; // 파일 끝
+                }
+                if (!is_unsupported(errno)) {
+                    return -1;
+                }
+                break;
+            }
+            stats->method = COPY_METHOD_COPY_FILE_RANGE;
+            len -= n;
+            add_progress(stats, n);
+        }
+        if (len == 0 || is_cancelled(stats)) {
+            return 0;
+        }
+        off = in; // 지원되지 않는 경우 남은 부분부터 다음 방식으로
+        stats->method = COPY_METHOD_SENDFILE;
+    }
+
+    if (stats->method == COPY_METHOD_SENDFILE) {
+        if (lseek(dst, off, SEEK_SET) < 0) {
+            return -1;
+        }
+        off_t in = off;
+        while (len > 0 && !is_cancelled(stats)) {
+            ssize_t n = sendfile(dst, src, &in, len < COPY_CHUNK ? len : COPY_CHUNK);
+            perf_count(PERF_C_COPY_CALL, 1);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                if (n == 0 && in > off) {
+                    return 0;
+                }
+                if (n < 0 && !is_unsupported(errno)) {
+                    return -1;
+                }
+                break;
+            }
+            len -= n;
+            add_progress(stats, n);
+        }
+        if (len == 0 || is_cancelled(stats)) {
+            return 0;
+        }
+        off = in;
+        stats->method = COPY_METHOD_BUFFER;
+    }
+
+    return copy_range_buffer(src, dst, off, len, stats);
+}
+
+// 희소 파일의 데이터 구간만 골라서 복사
+static int copy_data_segments(int src, int dst, off_t size, copy_stats *stats) {
+    off_t off = 0;
+    while (off < size && !is_cancelled(stats)) {
+        off_t data = lseek(src, off, SEEK_DATA);
+        if (data < 0) {
+            if (errno == ENXIO) {
+                break; // 남은 부분은 모두 빈 영역
+            }
+            return copy_range(src, dst, off, size - off, stats); // SEEK_DATA 미지원
+        }
+        off_t hole = lseek(src, data, SEEK_HOLE);
+        if (hole < 0 || hole > size) {
+            hole = size;
+        }
+        // 건너뛴 빈 영역도 진행률에는 포함
+        add_progress(stats, data - off);
+        if (copy_range(src, dst, data, hole - data, stats) < 0) {
+            return -1;
+        }
+        off = hole;
+    }
+    if (off < size) {
+        add_progress(stats, size - off);
+    }
+    return 0;
+}
+
+// [off, off+len) 을 짧은 쓰기까지 끝까지 쓴다
+static int write_all(int fd, const char *buf, size_t len, off_t off) {
+    while (len > 0) {
+        ssize_t w = pwrite(fd, buf, len, off);
+        perf_count(PERF_C_COPY_CALL, 1);
+        if (w < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        buf += w;
+        len -= w;
+        off += w;
+    }
+    return 0;
+}
+
+static int read_all(int fd, char *buf, size_t len, off_t off) {
+    while (len > 0) {
+        ssize_t n = pread(fd, buf, len, off);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return -1;
+        }
+        buf += n;
+        len -= n;
+        off += n;
+    }
+    return 0;
+}
+
+// destination 과 같은 디렉토리의 임시 파일 경로 (.이름.gspart)
+// 이름이 길면 이름의 해시를 쓴다 (체크포인트 접미사까지 NAME_MAX 안에 들어가도록)
+static int make_temp_path(const char *destination, char *buf, size_t size) {
+    const char *slash = strrchr(destination, '/');
+    const char *name = slash ? slash + 1 : destination;
+    int dir_len = slash ? (int)(slash - destination + 1) : 0;
+    int n;
+    if (strlen(name) > NAME_MAX - 32) {
+        hash128 h = hash_buffer(name, strlen(name));
+        n = snprintf(buf, size, "%.*s.%016llx%s", dir_len, destination, (unsigned long long)h.lo, COPY_TEMP_SUFFIX);
+    } else {
+        n = snprintf(buf, size, "%.*s.%s%s", dir_len, destination, name, COPY_TEMP_SUFFIX);
+    }
+    return n < 0 || (size_t)n >= size ? -1 : 0;
+}
+
+static void checkpoint_init(copy_checkpoint *cp, const struct stat *src_stat) {
+    memset(cp, 0, sizeof(*cp));
+    memcpy(cp->magic, "GSCKPT", 6);
+    cp->version = COPY_CHECKPOINT_VERSION;
+    cp->state_size = sizeof(hash_state);
+    cp->src_dev = src_stat->st_dev;
+    cp->src_ino = src_stat->st_ino;
+    cp->src_size = src_stat->st_size;
+    cp->src_mtime_sec = src_stat->st_mtim.tv_sec;
+    cp->src_mtime_nsec = src_stat->st_mtim.tv_nsec;
+    hash_init(&cp->hs);
+}
+
+// 같은 원본의 체크포인트가 있으면 읽는다. return 0 - 이어 복사할 수 있음
+static int checkpoint_load(const char *path, const struct stat *src_stat, copy_checkpoint *cp) {
+    copy_checkpoint want;
+    checkpoint_init(&want, src_stat);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    int ok = read_all(fd, (char *)cp, sizeof(*cp), 0) == 0;
+    close(fd);
+    // 해시 상태 앞까지 (식별 정보) 가 같아야 한다
+    if (!ok || memcmp(cp, &want, offsetof(copy_checkpoint, offset)) != 0 ||
+        cp->offset <= 0 || cp->offset > cp->src_size) {
+        return -1;
+    }
+    return 0;
+}
+
+// 임시 파일의 [0, offset) 을 디스크에 내린 뒤 체크포인트를 쓴다 (임시 파일에 쓰고 rename)
+// 다 쓴 부분은 페이지 캐시에서 내보낸다 (수십 GB 파일이 캐시를 밀어내지 않도록)
+static int checkpoint_save(const char *path, int src, int dst, copy_checkpoint *cp, off_t offset) {
+    int saved_errno = errno;
+    int result = -1;
+    if (fdatasync(dst) == 0) {
+        char tmp[MAX_DIR_LENGTH + 16];
+        snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+        int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+        if (fd >= 0) {
+            cp->offset = offset;
+            result = write_all(fd, (const char *)cp, sizeof(*cp), 0);
+            if (close(fd) != 0 || result != 0 || rename(tmp, path) != 0) {
+                unlink(tmp);
+                result = -1;
+            }
+        }
+        posix_fadvise(src, 0, offset, POSIX_FADV_DONTNEED);
+        posix_fadvise(dst, 0, offset, POSIX_FADV_DONTNEED);
+    }
+    errno = saved_errno;
+    return result;
+}
+
+// 이어 복사하기 전에 임시 파일의 체크포인트 바로 앞부분이 원본과 같은지 확인
+static int tail_matches(int src, int dst, off_t offset) {
+    off_t len = offset < COPY_VERIFY_TAIL ? offset : COPY_VERIFY_TAIL;
+    char *buf = malloc(2 * len);
+    if (!buf) {
+        return 0;
+    }
+    int same = read_all(src, buf, len, offset - len) == 0 && read_all(dst, buf + len, len, offset - len) == 0 &&
+               memcmp(buf, buf + len, len) == 0;
+    free(buf);
+    return same;
+}
+
+// 큰 파일 복사 - cp->offset 부터 버퍼로 읽어 해시하면서 쓰고, COPY_CHECKPOINT_INTERVAL 마다 체크포인트를 남긴다
+// 희소 파일의 빈 영역은 쓰지 않고 0 으로 해시한다. 실패하거나 취소되면 마지막으로 쓴 위치를 체크포인트로 남긴다
+static int copy_hashed(int src, int dst, off_t size, copy_checkpoint *cp, const char *cp_path,
+                       copy_stats *stats) {
+    char *buffer = malloc(COPY_BUFFER);
+    char *zeros = calloc(1, COPY_BUFFER);
+    if (!buffer || !zeros) {
+        free(buffer);
+        free(zeros);
+        return -1;
+    }
+    posix_fadvise(src, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    off_t pos = cp->offset;
+    off_t saved = pos;      // 마지막 체크포인트
+    off_t data = -1, hole = -1; // 지금 데이터 구간 [data, hole)
+    int result = 0;
+    while (pos < size && !is_cancelled(stats)) {
+        if (pos >= hole) {
+            data = lseek(src, pos, SEEK_DATA);
+            if (data < 0) {
+                data = errno == ENXIO ? size : pos; // ENXIO - 남은 부분은 모두 빈 영역, 그 밖에는 SEEK_DATA 미지원
+            }
+            hole = data < size ? lseek(src, data, SEEK_HOLE) : size;
+            if (hole < 0 || hole > size) {
+                hole = size;
+            }
+        }
+
+        if (pos < data) { // 빈 영역
+            size_t len = data - pos < COPY_BUFFER ? data - pos : COPY_BUFFER;
+            hash_update(&cp->hs, zeros, len);
+            pos += len;
+            add_progress(stats, len);
+        } else {
+            size_t want = hole - pos < COPY_BUFFER ? hole - pos : COPY_BUFFER;
+            ssize_t n = pread(src, buffer, want, pos);
+            perf_count(PERF_C_COPY_CALL, 1);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0) {
+                result = -1;
+                break;
+            }
+            if (n == 0) {
+                break; // 복사 도중 파일이 줄어든 경우 (끝에서 원본 확인으로 실패)
+            }
+            if (write_all(dst, buffer, n, pos) != 0) {
+                result = -1;
+                break;
+            }
+            hash_update(&cp->hs, buffer, n);
+            pos += n;
+            add_progress(stats, n);
+        }
+
+        if (pos < size && pos - saved >= COPY_CHECKPOINT_INTERVAL && checkpoint_save(cp_path, src, dst, cp, pos) == 0) {
+            saved = pos;
+        }
+    }
+    if ((result != 0 || is_cancelled(stats)) && pos > saved) {
+        checkpoint_save(cp_path, src, dst, cp, pos);
+    }
+    cp->offset = pos;
+    free(buffer);
+    free(zeros);
+    return result;
+}
+
+// 파일에 남긴 해시 (COPY_DIGEST_XATTR) 를 읽는다. 기록할 때와 크기, mtime 이 같아야 유효
+static int digest_load(int fd, const struct stat *st, hash128 *out) {
+    char value[96];
+    ssize_t n = fgetxattr(fd, COPY_DIGEST_XATTR, value, sizeof(value) - 1);
+    if (n <= 0) {
+        return -1;
+    }
+    value[n] = '\0';
+    unsigned long long hi, lo;
+    long long size, sec;
+    long nsec;
+    if (sscanf(value, "%16llx%16llx %lld %lld.%ld", &hi, &lo, &size, &sec, &nsec) != 5 ||
+        size != st->st_size || sec != st->st_mtim.tv_sec || nsec != st->st_mtim.tv_nsec) {
+        return -1;
+    }
+    out->hi = hi;
+    out->lo = lo;
+    return 0;
+}
+
+// 복사한 파일에 해시를 남긴다. mtime 은 원본 것을 그대로 쓰므로 원본의 크기, mtime 으로 기록
+// user xattr 를 지원하지 않는 파일시스템이면 남기지 않는다
+static void digest_store(int fd, const struct stat *st, hash128 digest) {
+    char value[96];
+    int n = snprintf(value, sizeof(value), "%016llx%016llx %lld %lld.%09ld", (unsigned long long)digest.hi,
+                     (unsigned long long)digest.lo, (long long)st->st_size, (long long)st->st_mtim.tv_sec,
+                     st->st_mtim.tv_nsec);
+    fsetxattr(fd, COPY_DIGEST_XATTR, value, n, 0);
+}
+
+// rename 으로 바뀐 디렉토리 항목을 디스크에 내린다
+static int sync_parent(const char *path) {
+    const char *slash = strrchr(path, '/');
+    char dir[MAX_DIR_LENGTH];
+    if (!slash) {
+        strcpy(dir, ".");
+    } else if (slash == path) {
+        strcpy(dir, "/");
+    } else if ((size_t)(slash - path) < sizeof(dir)) {
+        memcpy(dir, path, slash - path);
+        dir[slash - path] = '\0';
+    } else {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    int fd = open(dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    int result = fsync(fd);
+    int saved_errno = errno;
+    close(fd);
+    errno = saved_errno;
+    return result;
+}
+
+static int has_suffix(const char *name, const char *suffix) {
+    size_t len = strlen(name), suffix_len = strlen(suffix);
+    return len > suffix_len && strcmp(name + len - suffix_len, suffix) == 0;
+}
+
+int copy_is_partial(const char *name) {
+    return name[0] == '.' && (has_suffix(name, COPY_TEMP_SUFFIX) || has_suffix(name, COPY_TEMP_SUFFIX COPY_CHECKPOINT_SUFFIX));
+}
+
+int copy_remove_partial(const char *path) {
+    char temp[MAX_DIR_LENGTH], cp_path[MAX_DIR_LENGTH];
+    size_t len = strlen(path);
+    if (has_suffix(path, COPY_CHECKPOINT_SUFFIX)) {
+        len -= strlen(COPY_CHECKPOINT_SUFFIX);
+    }
+    if (len >= sizeof(temp) || len + sizeof(COPY_CHECKPOINT_SUFFIX) > sizeof(cp_path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    memcpy(temp, path, len);
+    temp[len] = '\0';
+    memcpy(cp_path, path, len);
+    memcpy(cp_path + len, COPY_CHECKPOINT_SUFFIX, sizeof(COPY_CHECKPOINT_SUFFIX));
+    int result = unlink(temp) == 0 || errno == ENOENT ? 0 : -1;
+    if (unlink(cp_path) != 0 && errno != ENOENT) {
+        result = -1;
+    }
+    return result;
+}
+
+int copy_file_fast(const char *source, const char *destination, copy_stats *stats) {
+    stats->bytes_done = 0;
+    stats->method = COPY_METHOD_NONE;
+    stats->error = 0;
+    stats->resumed_from = 0;
+    stats->has_digest = 0;
+    stats->verified = 0;
+    stats->partial_kept = 0;
+    stats->temp_path[0] = '\0';
+    double start = now_seconds();
+    uint64_t perf_start = perf_begin();
+
+    char temp[MAX_DIR_LENGTH], cp_path[MAX_DIR_LENGTH];
+    if (make_temp_path(destination, temp, sizeof(temp)) != 0 ||
+        snprintf(cp_path, sizeof(cp_path), "%s%s", temp, COPY_CHECKPOINT_SUFFIX) >= (int)sizeof(cp_path)) {
+        stats->error = ENAMETOOLONG;
+        return -1;
+    }
+
+    int src = open(source, O_RDONLY | O_CLOEXEC);
+    if (src < 0) {
+        stats->error = errno;
+        return -1;
+    }
+    struct stat src_stat;
+    if (fstat(src, &src_stat) != 0) {
+        stats->error = errno;
+        close(src);
+        return -1;
+    }
+    stats->bytes_total = src_stat.st_size;
+
+    // 큰 파일은 같은 원본의 체크포인트가 있으면 그 위치부터 잇는다
+    int large = src_stat.st_size >= COPY_CHECKPOINT_MIN;
+    // 작은 파일은 호출한 쪽이 여러 개를 모아서 한 번에 디스크에 내린다
+    int defer = stats->defer_commit && !large;
+    hash128 known = {0, 0};
+    int has_known = large && digest_load(src, &src_stat, &known) == 0;
+    copy_checkpoint cp;
+    checkpoint_init(&cp, &src_stat);
+    int dst = -1;
+    if (large && checkpoint_load(cp_path, &src_stat, &cp) == 0) {
+        dst = open(temp, O_RDWR | O_CLOEXEC);
+        if (dst >= 0 && tail_matches(src, dst, cp.offset) && ftruncate(dst, cp.offset) == 0) {
+            stats->resumed_from = cp.offset;
+            add_progress(stats, cp.offset);
+        } else {
+            if (dst >= 0) {
+                close(dst);
+                dst = -1;
+            }
+            checkpoint_init(&cp, &src_stat);
+        }
+    }
+    if (dst < 0) {
+        unlink(cp_path); // 다른 원본이거나 임시 파일과 맞지 않는 체크포인트
+        dst = open(temp, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    }
+    if (dst < 0) {
+        stats->error = errno;
+        close(src);
+        return -1;
+    }
+
+    int result = 0;
+    if (cp.offset == 0 && ioctl(dst, FICLONE, src) == 0) {
+        stats->method = COPY_METHOD_REFLINK;
+        add_progress(stats, src_stat.st_size);
+    } else if (large) {
+        stats->method = COPY_METHOD_HASHED;
+        result = copy_hashed(src, dst, src_stat.st_size, &cp, cp_path, stats);
+        if (result == 0 && !is_cancelled(stats)) {
+            stats->digest = hash_final(&cp.hs);
+            stats->has_digest = 1;
+        }
+    } else {
+        stats->method = COPY_METHOD_COPY_FILE_RANGE;
+        result = copy_data_segments(src, dst, src_stat.st_size, stats);
+    }
+    // 끝부분 빈 영역까지 크기를 맞춘다
+    if (result == 0 && stats->method != COPY_METHOD_REFLINK && !is_cancelled(stats) &&
+        ftruncate(dst, src_stat.st_size) != 0) {
+        result = -1;
+    }
+
+    if (result == 0 && is_cancelled(stats)) {
+        errno = ECANCELED;
+        result = -1;
+    }
+    // 복사하는 동안 원본이 바뀌었으면 섞인 내용이므로 버린다
+    struct stat end_stat;
+    int changed = 0;
+    if (result == 0 && fstat(src, &end_stat) == 0 &&
+        (end_stat.st_size != src_stat.st_size || end_stat.st_mtim.tv_sec != src_stat.st_mtim.tv_sec ||
+         end_stat.st_mtim.tv_nsec != src_stat.st_mtim.tv_nsec)) {
+        errno = EAGAIN;
+        result = -1;
+        changed = 1;
+    }
+    // 원본이 바뀌지 않았는데 예전에 남긴 해시와 다르면 읽은 내용을 믿을 수 없다
+    if (result == 0 && has_known && stats->has_digest) {
+        if (hash_equal(known, stats->digest)) {
+            stats->verified = 1;
+        } else {
+            errno = EIO;
+            result = -1;
+            changed = 1;
+        }
+    }
+    if (result == 0) {
+        struct timespec times[2] = { src_stat.st_atim, src_stat.st_mtim };
+        fchmod(dst, src_stat.st_mode & 07777); // umask 영향 제거
+        futimens(dst, times);
+        if (stats->has_digest) {
+            digest_store(dst, &src_stat, stats->digest);
+        }
+        // 디스크에 내린 뒤에 이름을 바꿔야 중간에 죽어도 destination 이 반쯤 쓴 파일이 되지 않는다
+        if (!defer && fdatasync(dst) != 0) {
+            result = -1;
+        }
+    }
+    if (result != 0) {
+        stats->error = errno;
+    }
+
+    if (close(dst) != 0 && result == 0) {
+        stats->error = errno;
+        result = -1;
+    }
+    close(src);
+    int renamed = 0;
+    if (result == 0 && defer) {
+        strcpy(stats->temp_path, temp); // 같은 크기의 배열
+    } else if (result == 0 && rename(temp, destination) != 0) {
+        stats->error = errno;
+        result = -1;
+    } else if (result == 0) {
+        renamed = 1;
+        if (sync_parent(destination) != 0) {
+            stats->error = errno; // 이름은 바뀌었지만 디스크에 남았는지 알 수 없다
+            result = -1;
+        }
+    }
+    if (result == 0 || renamed) {
+        unlink(cp_path);
+    } else if (!large || changed || access(cp_path, F_OK) != 0) {
+        // 이어 복사할 수 없는 임시 파일은 남기지 않는다
+        unlink(temp);
+        unlink(cp_path);
+    } else {
+        stats->partial_kept = 1;
+    }
+
+    perf_end(PERF_COPY, perf_start);
+    stats->seconds = now_seconds() - start;
+    stats->bytes_per_sec = stats->seconds > 0 ? stats->bytes_done / stats->seconds : 0;
+    return result;
+}
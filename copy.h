@@ -0,0 +1,61 @@
+#ifndef __COPY__
+#define __COPY__
+
+#include "hash.h"
+#include "project_macro.h"
+
+// 실제로 사용된 복사 방식 (가장 싼 방식부터 시도)
+#define COPY_METHOD_NONE 0
+#define COPY_METHOD_REFLINK 1         // FICLONE - 데이터 블록 공유, 복사 없음
+#define COPY_METHOD_COPY_FILE_RANGE 2 // 커널 안에서 복사
+#define COPY_METHOD_SENDFILE 3        // 커널 안에서 복사 (구형 커널/파일시스템)
+#define COPY_METHOD_BUFFER 4          // 큰 버퍼로 read/write
+#define COPY_METHOD_HASHED 5          // 버퍼로 읽으며 해시, 체크포인트 (큰 파일)
+
+#define COPY_TEMP_SUFFIX ".gspart"          // 복사 중인 임시 파일 (.이름.gspart, 같은 디렉토리)
+#define COPY_CHECKPOINT_SUFFIX ".ckpt"      // 이어 복사할 위치 (.이름.gspart.ckpt)
+#define COPY_CHECKPOINT_MIN (64LL << 20)    // 이 크기 이상의 파일은 해시하며 복사하고 체크포인트를 남긴다
+#define COPY_CHECKPOINT_INTERVAL (256LL << 20) // 체크포인트 간격
+#define COPY_DIGEST_XATTR "user.guishell.digest" // 복사한 파일에 남기는 해시 ("해시 크기 mtime", 크기와 mtime 이 같을 때만 유효)
+
+// 복사 진행 상황과 결과
+// bytes_done 은 복사 스레드가 갱신하고 다른 스레드에서 읽을 수 있다
+typedef struct {
+    long long bytes_total;
+    volatile long long bytes_done;
+    volatile int cancel;  // 1 로 설정하면 다음 청크에서 중단
+    volatile long long *shared_done; // 있으면 여러 파일을 합친 진행량도 함께 갱신
+    volatile int *shared_cancel;     // 있으면 이 값도 취소 여부로 확인
+    int method;
+    int error;            // 실패 시 errno
+    double seconds;
+    double bytes_per_sec;
+    long long resumed_from; // 이전 체크포인트에서 이어 복사한 경우 그 위치
+    int has_digest;       // 1 - digest 가 있음 (COPY_METHOD_HASHED 로 복사한 경우)
+    hash128 digest;       // 복사한 내용 전체의 해시 (같은 읽기에서 계산)
+    int verified;         // 1 - 원본에 남아 있던 해시 (COPY_DIGEST_XATTR) 와 digest 가 같음
+    int partial_kept;     // 1 - 실패/취소 후 이어 복사할 임시 파일과 체크포인트를 남김
+    int defer_commit;     // 1 - 작은 파일은 디스크에 내리지 않고 rename 도 하지 않는다 (temp_path 를 호출한 쪽이 마무리)
+    char temp_path[MAX_DIR_LENGTH]; // defer_commit 으로 남긴 임시 파일, 없으면 빈 문자열
+} copy_stats;
+
+// source 를 destination 으로 복사한다. 권한, 시간 정보, 희소 파일의 빈 영역을 유지
+// 임시 파일에 모두 쓰고 fdatasync 한 뒤 rename 하고 디렉토리도 fsync 하므로 destination 에 반쯤 쓴 내용이 보이지 않는다
+// 큰 파일은 중단되면 (실패, 취소) 임시 파일과 체크포인트를 남기고, 같은 복사를 다시 하면 그 위치부터 잇는다
+// 큰 파일의 해시는 destination 의 COPY_DIGEST_XATTR 에 남기고, 원본에 유효한 해시가 있으면 비교한다 (다르면 EIO)
+// 복사 도중 원본이 바뀌면 실패한다 (EAGAIN)
+// return 0 - 성공, -1 - 실패 (stats->error 에 원인), rename 뒤 디렉토리 fsync 실패가 아니면 destination 은 바뀌지 않는다
+int copy_file_fast(const char *source, const char *destination, copy_stats *stats);
+
+// name 이 중단된 복사가 남긴 임시 파일 (.이름.gspart) 이나 그 체크포인트인지
+int copy_is_partial(const char *name);
+
+// 중단된 복사의 임시 파일과 체크포인트를 함께 지운다 (path 는 둘 중 어느 쪽이든)
+int copy_remove_partial(const char *path);
+
+const char *copy_method_name(int method);
+
+// 사람이 읽기 쉬운 크기 문자열 (예: "12.3M")
+void format_size(char *buf, size_t buf_size, double bytes);
+
+#endif
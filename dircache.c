@@ -0,0 +1,529 @@
+#define _GNU_SOURCE // qsort_r
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+#include <sys/syscall.h>
+
+#include "dircache.h"
+#include "perf.h"
+
+#define DIRCACHE_EVENTS (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | \
+                         IN_ATTRIB | IN_MODIFY | IN_CLOSE_WRITE | \
+                         IN_DELETE_SELF | IN_MOVE_SELF)
+
+#define DIRCACHE_DENTS_BUFFER (256 * 1024) // getdents64 한 번에 읽는 크기
+
+static int dircache_apply_results(dir_cache *dc);
+
+// 세대 번호는 모든 목록 캐시가 함께 쓰는 카운터에서 받는다
+// (목록을 여러 개 번갈아 보여줄 때 필터/정렬 결과가 다른 목록의 것과 섞이지 않도록)
+static unsigned long generation_counter = 0;
+
+static unsigned long next_generation(void) {
+    return __atomic_add_fetch(&generation_counter, 1, __ATOMIC_RELAXED);
+}
+
+// getdents64 가 돌려주는 항목
+struct linux_dirent64 {
+    ino_t d_ino;
+    off_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+void dircache_init(dir_cache *dc) {
+    memset(dc, 0, sizeof(*dc));
+    dc->watch_fd = -1;
+    dc->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+}
+
+void dircache_free(dir_cache *dc) {
+    if (dc->inotify_fd >= 0) {
+        close(dc->inotify_fd); // 감시도 함께 해제됨
+    }
+    metafetch_close(dc->meta);
+    free(dc->names);
+    free(dc->name_off);
+    free(dc->state);
+    free(dc->type);
+    free(dc->mode);
+    free(dc->size);
+    free(dc->mtime_sec);
+    free(dc->mtime_nsec);
+    free(dc->ino);
+    free(dc->dev);
+    free(dc->blocks);
+    memset(dc, 0, sizeof(*dc));
+    dc->inotify_fd = -1;
+    dc->watch_fd = -1;
+}
+
+// 이름순 위치 검색, 없으면 삽입될 위치를 -(pos+1) 로 반환
+static int dircache_search(const dir_cache *dc, const char *name) {
+    int lo = 0, hi = dc->count - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        int cmp = strcmp(dircache_name(dc, mid), name);
+        if (cmp == 0) {
+            return mid;
+        } else if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return -(lo + 1);
+}
+
+int dircache_find(const dir_cache *dc, const char *name) {
+    int pos = dircache_search(dc, name);
+    return pos >= 0 ? pos : -1;
+}
+
+// 필드 배열 하나를 늘린다
+static int grow_array(void **array, size_t element, int capacity) {
+    void *p = realloc(*array, capacity * element);
+    if (!p) {
+        return -1;
+    }
+    *array = p;
+    return 0;
+}
+
+static int dircache_reserve(dir_cache *dc, int need) {
+    if (need <= dc->capacity) {
+        return 0;
+    }
+    int new_capacity = dc->capacity ? dc->capacity : 64;
+    while (new_capacity < need) {
+        new_capacity *= 2;
+    }
+    // 일부만 늘어난 경우에도 capacity 를 올리지 않으므로 다음 호출에서 다시 시도한다
+    if (grow_array((void **)&dc->name_off, sizeof(uint32_t), new_capacity) < 0 ||
+        grow_array((void **)&dc->state, 1, new_capacity) < 0 ||
+        grow_array((void **)&dc->type, 1, new_capacity) < 0 ||
+        grow_array((void **)&dc->mode, sizeof(uint32_t), new_capacity) < 0 ||
+        grow_array((void **)&dc->size, sizeof(int64_t), new_capacity) < 0 ||
+        grow_array((void **)&dc->mtime_sec, sizeof(int64_t), new_capacity) < 0 ||
+        grow_array((void **)&dc->mtime_nsec, sizeof(uint32_t), new_capacity) < 0 ||
+        grow_array((void **)&dc->ino, sizeof(uint64_t), new_capacity) < 0 ||
+        grow_array((void **)&dc->dev, sizeof(uint64_t), new_capacity) < 0 ||
+        grow_array((void **)&dc->blocks, sizeof(int64_t), new_capacity) < 0) {
+        return -1;
+    }
+    dc->capacity = new_capacity;
+    return 0;
+}
+
+// 이름을 아레나 끝에 붙인다. return 아레나 위치, 메모리 부족이면 -1
+static long dircache_add_name(dir_cache *dc, const char *name, size_t len) {
+    if (dc->names_used + len + 1 > dc->names_capacity) {
+        size_t new_capacity = dc->names_capacity ? dc->names_capacity : 64 * 1024;
+        while (dc->names_used + len + 1 > new_capacity) {
+            new_capacity *= 2;
+        }
+        if (new_capacity > UINT32_MAX) {
+            return -1;
+        }
+        char *p = realloc(dc->names, new_capacity);
+        if (!p) {
+            return -1;
+        }
+        dc->names = p;
+        dc->names_capacity = new_capacity;
+    }
+    size_t off = dc->names_used;
+    memcpy(dc->names + off, name, len + 1);
+    dc->names_used += len + 1;
+    return (long)off;
+}
+
+// 지워진 이름이 아레나의 절반을 넘으면 살아 있는 이름만 앞으로 모은다
+static void dircache_compact_names(dir_cache *dc) {
+    if (dc->names_garbage < 64 * 1024 || dc->names_garbage * 2 < dc->names_used) {
+        return;
+    }
+    char *packed = malloc(dc->names_used - dc->names_garbage);
+    if (!packed) {
+        return;
+    }
+    size_t used = 0;
+    for (int i = 0; i < dc->count; i++) {
+        const char *name = dircache_name(dc, i);
+        size_t len = strlen(name) + 1;
+        memcpy(packed + used, name, len);
+        dc->name_off[i] = (uint32_t)used;
+        used += len;
+    }
+    free(dc->names);
+    dc->names = packed;
+    dc->names_used = used;
+    dc->names_capacity = used;
+    dc->names_garbage = 0;
+}
+
+// [from, count) 항목을 shift 칸 옮긴다 (1 - 삽입 자리 만들기, -1 - 삭제)
+static void dircache_shift(dir_cache *dc, int from, int shift) {
+    int n = dc->count - from;
+    int to = from + shift;
+    memmove(dc->name_off + to, dc->name_off + from, n * sizeof(uint32_t));
+    memmove(dc->state + to, dc->state + from, n);
+    memmove(dc->type + to, dc->type + from, n);
+    memmove(dc->mode + to, dc->mode + from, n * sizeof(uint32_t));
+    memmove(dc->size + to, dc->size + from, n * sizeof(int64_t));
+    memmove(dc->mtime_sec + to, dc->mtime_sec + from, n * sizeof(int64_t));
+    memmove(dc->mtime_nsec + to, dc->mtime_nsec + from, n * sizeof(uint32_t));
+    memmove(dc->ino + to, dc->ino + from, n * sizeof(uint64_t));
+    memmove(dc->dev + to, dc->dev + from, n * sizeof(uint64_t));
+    memmove(dc->blocks + to, dc->blocks + from, n * sizeof(int64_t));
+}
+
+static void dircache_insert(dir_cache *dc, const char *name, unsigned char type) {
+    int pos = dircache_search(dc, name);
+    if (pos >= 0) { // 이미 있으면 stat 만 무효화
+        dc->state[pos] = STAT_NONE;
+        dc->type[pos] = type;
+        dc->stat_generation = next_generation();
+        return;
+    }
+    long off;
+    if (dircache_reserve(dc, dc->count + 1) < 0 || (off = dircache_add_name(dc, name, strlen(name))) < 0) {
+        dc->valid = 0; // 메모리 부족 - 다음 번에 전체 재스캔
+        return;
+    }
+    pos = -pos - 1;
+    dircache_shift(dc, pos, 1);
+    dc->name_off[pos] = (uint32_t)off;
+    dc->state[pos] = STAT_NONE;
+    dc->type[pos] = type;
+    dc->count++;
+    dc->generation = next_generation();
+}
+
+static void dircache_remove(dir_cache *dc, const char *name) {
+    int pos = dircache_search(dc, name);
+    if (pos < 0) {
+        return;
+    }
+    dc->names_garbage += strlen(dircache_name(dc, pos)) + 1;
+    dircache_shift(dc, pos + 1, -1);
+    dc->count--;
+    dc->generation = next_generation();
+    dircache_compact_names(dc);
+}
+
+static void dircache_invalidate(dir_cache *dc, const char *name) {
+    int pos = dircache_search(dc, name);
+    if (pos >= 0) {
+        dc->state[pos] = STAT_NONE;
+        dc->stat_generation = next_generation();
+    }
+}
+
+// 이름순 정렬용 - 아레나 위치(상위 비트)와 d_type(하위 8비트)을 묶은 값
+static int compare_packed_name(const void *a, const void *b, void *arena) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return strcmp((const char *)arena + (x >> 8), (const char *)arena + (y >> 8));
+}
+
+// getdents64 로 디렉토리를 큰 단위로 읽어 아레나와 필드 배열을 채운다
+// return 항목 수, 읽기 실패면 -1
+static int dircache_read_entries(dir_cache *dc, int dirfd) {
+    char *buf = malloc(DIRCACHE_DENTS_BUFFER);
+    uint64_t *packed = NULL;
+    int packed_capacity = 0;
+    int n = 0;
+    if (!buf) {
+        return -1;
+    }
+    dc->names_used = 0;
+    dc->names_garbage = 0;
+    while (1) {
+        long len = syscall(SYS_getdents64, dirfd, buf, DIRCACHE_DENTS_BUFFER);
+        if (len < 0) {
+            free(buf);
+            free(packed);
+            return -1;
+        }
+        if (len == 0) {
+            break;
+        }
+        for (long pos = 0; pos < len; ) {
+            struct linux_dirent64 *d = (struct linux_dirent64 *)(buf + pos);
+            pos += d->d_reclen;
+            if (n == packed_capacity) {
+                int new_capacity = packed_capacity ? packed_capacity * 2 : 1024;
+                uint64_t *p = realloc(packed, new_capacity * sizeof(uint64_t));
+                if (!p) {
+                    free(buf);
+                    free(packed);
+                    return -1;
+                }
+                packed = p;
+                packed_capacity = new_capacity;
+            }
+            long off = dircache_add_name(dc, d->d_name, strlen(d->d_name));
+            if (off < 0) {
+                free(buf);
+                free(packed);
+                return -1;
+            }
+            packed[n++] = ((uint64_t)off << 8) | d->d_type;
+        }
+    }
+    free(buf);
+    perf_count(PERF_C_DIRENT, n);
+
+    qsort_r(packed, n, sizeof(uint64_t), compare_packed_name, dc->names);
+    if (dircache_reserve(dc, n) < 0) {
+        free(packed);
+        return -1;
+    }
+    for (int i = 0; i < n; i++) {
+        dc->name_off[i] = (uint32_t)(packed[i] >> 8);
+        dc->type[i] = (unsigned char)packed[i];
+    }
+    memset(dc->state, STAT_NONE, n);
+    free(packed);
+    return n;
+}
+
+// 디렉토리 전체를 다시 읽는다
+static int dircache_rescan(dir_cache *dc) {
+    // 이전 요청의 결과는 버리고 디렉토리를 새로 연다
+    metafetch_close(dc->meta);
+    dc->meta = NULL;
+    int dirfd = open(dc->path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    int file_count = -1;
+    if (dirfd >= 0) {
+        file_count = dircache_read_entries(dc, dirfd);
+        dc->meta = metafetch_open(dirfd, dc->on_ready);
+        if (!dc->meta) {
+            close(dirfd);
+        }
+    }
+
+    dc->generation = next_generation();
+    if (file_count < 0) {
+        dc->count = 0;
+        dc->valid = 0;
+        return -1;
+    }
+    dc->count = file_count;
+
+    struct stat dir_stat;
+    if (stat(dc->path, &dir_stat) == 0) {
+        dc->dir_mtime = dir_stat.st_mtim;
+    }
+    dc->last_check = time(NULL);
+    dc->valid = 1;
+    return 0;
+}
+
+int dircache_open(dir_cache *dc, const char *path) {
+    if (dc->valid && strcmp(dc->path, path) == 0) {
+        dircache_refresh(dc);
+        return dc->valid ? 0 : -1;
+    }
+
+    // 다른 디렉토리로 이동 - 이전 감시 해제 후 새로 읽기
+    if (dc->watch_fd >= 0) {
+        inotify_rm_watch(dc->inotify_fd, dc->watch_fd);
+        dc->watch_fd = -1;
+    }
+    strncpy(dc->path, path, sizeof(dc->path) - 1);
+    dc->path[sizeof(dc->path) - 1] = '\0';
+
+    // 스캔 전에 감시를 걸어야 스캔 도중의 변경을 놓치지 않는다
+    if (dc->inotify_fd >= 0) {
+        dc->watch_fd = inotify_add_watch(dc->inotify_fd, dc->path, DIRCACHE_EVENTS | IN_ONLYDIR);
+    }
+    return dircache_rescan(dc);
+}
+
+int dircache_refresh(dir_cache *dc) {
+    if (!dc->valid) {
+        return dc->path[0] && dircache_rescan(dc) == 0;
+    }
+    int fetched = dircache_apply_results(dc);
+
+    if (dc->watch_fd < 0) {
+        // inotify 를 쓸 수 없는 경우 1초에 한 번 디렉토리 mtime 으로 변경 확인
+        time_t now = time(NULL);
+        if (now == dc->last_check) {
+            return fetched;
+        }
+        dc->last_check = now;
+        struct stat dir_stat;
+        if (stat(dc->path, &dir_stat) != 0) {
+            dc->valid = 0;
+            dc->count = 0;
+            dc->generation = next_generation();
+            return 1;
+        }
+        if (dir_stat.st_mtim.tv_sec == dc->dir_mtime.tv_sec &&
+            dir_stat.st_mtim.tv_nsec == dc->dir_mtime.tv_nsec) {
+            return fetched;
+        }
+        dircache_rescan(dc);
+        return 1;
+    }
+
+    char buf[16 * 1024] __attribute__((aligned(__alignof__(struct inotify_event))));
+    int changed = fetched;
+    int need_rescan = 0;
+
+    while (1) {
+        ssize_t len = read(dc->inotify_fd, buf, sizeof(buf));
+        if (len <= 0) {
+            break; // EAGAIN - 더 이상 이벤트 없음
+        }
+        for (char *p = buf; p < buf + len; ) {
+            struct inotify_event *ev = (struct inotify_event *)p;
+            p += sizeof(struct inotify_event) + ev->len;
+
+            if (ev->mask & IN_Q_OVERFLOW) { // 이벤트 유실 - 전체 재스캔
+                need_rescan = 1;
+                continue;
+            }
+            if (ev->wd != dc->watch_fd) {
+                continue; // 이전 디렉토리의 남은 이벤트
+            }
+            if (ev->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+                need_rescan = 1;
+                continue;
+            }
+            if (ev->len == 0) {
+                continue;
+            }
+
+            if (ev->mask & (IN_CREATE | IN_MOVED_TO)) {
+                dircache_insert(dc, ev->name, (ev->mask & IN_ISDIR) ? DT_DIR : DT_UNKNOWN);
+            } else if (ev->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                dircache_remove(dc, ev->name);
+            } else {
+                dircache_invalidate(dc, ev->name);
+            }
+            dircache_invalidate(dc, "."); // 디렉토리 자신의 mtime 도 바뀜
+            changed = 1;
+        }
+    }
+
+    if (need_rescan) {
+        if (dc->watch_fd >= 0) {
+            inotify_rm_watch(dc->inotify_fd, dc->watch_fd);
+        }
+        dc->watch_fd = inotify_add_watch(dc->inotify_fd, dc->path, DIRCACHE_EVENTS | IN_ONLYDIR);
+        dircache_rescan(dc);
+        changed = 1;
+    }
+    return changed;
+}
+
+// 결과 하나를 필드 배열에 기록
+static void dircache_set_stat(dir_cache *dc, int idx, const struct stat *st, int ok) {
+    dc->state[idx] = ok ? STAT_OK : STAT_FAILED;
+    if (ok) {
+        dc->mode[idx] = st->st_mode;
+        dc->size[idx] = st->st_size;
+        dc->mtime_sec[idx] = st->st_mtim.tv_sec;
+        dc->mtime_nsec[idx] = st->st_mtim.tv_nsec;
+        dc->ino[idx] = st->st_ino;
+        dc->dev[idx] = st->st_dev;
+        dc->blocks[idx] = st->st_blocks;
+    }
+}
+
+// 백그라운드 stat 결과를 목록에 반영
+static int dircache_apply_results(dir_cache *dc) {
+    if (!dc->meta) {
+        return 0;
+    }
+    meta_result *results;
+    int lost;
+    int n = metafetch_collect(dc->meta, &results, &lost);
+    for (int i = 0; i < n; i++) {
+        int pos = dircache_search(dc, results[i].name);
+        if (pos >= 0 && dc->state[pos] == STAT_PENDING) {
+            dircache_set_stat(dc, pos, &results[i].st, results[i].ok);
+        }
+    }
+    free(results);
+    if (lost) {
+        // 결과를 잃은 항목은 계속 기다리게 된다 - 다음 dircache_fetch 가 다시 요청하도록 되돌린다
+        for (int i = 0; i < dc->count; i++) {
+            if (dc->state[i] == STAT_PENDING) {
+                dc->state[i] = STAT_NONE;
+            }
+        }
+    }
+    if (n > 0 || lost) {
+        dc->stat_generation = next_generation();
+    }
+    return n > 0 || lost;
+}
+
+int dircache_stat(dir_cache *dc, int idx, struct stat *st) {
+    if (idx < 0 || idx >= dc->count) {
+        return -1;
+    }
+    if (dc->state[idx] != STAT_OK && dc->state[idx] != STAT_FAILED) {
+        struct stat fresh;
+        int ok;
+        if (dc->meta) {
+            ok = metafetch_stat_now(metafetch_dirfd(dc->meta), dircache_name(dc, idx), &fresh) == 0;
+        } else {
+            char filepath[MAX_DIR_LENGTH + MAX_FILENAME_LENGTH];
+            int len = snprintf(filepath, sizeof(filepath), "%s/%s", dc->path, dircache_name(dc, idx));
+            ok = len >= 0 && (size_t)len < sizeof(filepath) && stat(filepath, &fresh) == 0;
+            perf_count(PERF_C_STAT, 1);
+        }
+        dircache_set_stat(dc, idx, &fresh, ok);
+        dc->stat_generation = next_generation();
+    }
+    return dircache_peek_stat(dc, idx, st);
+}
+
+void dircache_fetch(dir_cache *dc, int first, int count) {
+    for (int i = first; i < first + count && i < dc->count; i++) {
+        if (dc->state[i] != STAT_NONE) {
+            continue;
+        }
+        if (dc->meta && metafetch_request(dc->meta, dircache_name(dc, i)) == 0) {
+            dc->state[i] = STAT_PENDING;
+        } else {
+            dircache_stat(dc, i, NULL); // 요청할 수 없으면 직접 읽는다
+        }
+    }
+}
+
+int dircache_peek_stat(const dir_cache *dc, int idx, struct stat *st) {
+    if (idx < 0 || idx >= dc->count || dc->state[idx] != STAT_OK) {
+        return -1;
+    }
+    if (st) {
+        memset(st, 0, sizeof(*st));
+        st->st_mode = dc->mode[idx];
+        st->st_size = dc->size[idx];
+        st->st_mtim.tv_sec = dc->mtime_sec[idx];
+        st->st_mtim.tv_nsec = dc->mtime_nsec[idx];
+        st->st_ino = dc->ino[idx];
+        st->st_dev = dc->dev[idx];
+        st->st_blocks = dc->blocks[idx];
+    }
+    return 0;
+}
+
+int dircache_is_dir(const dir_cache *dc, int idx) {
+    if (dc->state[idx] == STAT_OK) {
+        return S_ISDIR(dc->mode[idx]);
+    }
+    return dc->type[idx] == DT_DIR;
+}
@@ -0,0 +1,87 @@
+#ifndef __DIRCACHE__
+#define __DIRCACHE__
+
+#include <stdint.h>
+#include <time.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "project_macro.h"
+#include "metafetch.h"
+
+// 항목의 stat 정보 상태
+#define STAT_NONE 0     // 아직 읽지 않음 (또는 변경되어 다시 읽어야 함)
+#define STAT_PENDING 1  // 백그라운드에서 읽는 중
+#define STAT_OK 2
+#define STAT_FAILED 3   // stat 실패 (삭제된 파일 등)
+
+// 디렉토리 하나의 목록 캐시
+// 항목과 stat 정보를 프레임 사이에 유지하고 inotify 이벤트로 증분 갱신한다
+// 항목은 구조체 배열 대신 필드별 배열로 두고, 이름은 하나의 아레나에 이어 붙인다
+// (항목당 할당 없음, 다시 읽을 때도 버퍼를 재사용)
+typedef struct {
+    char path[MAX_DIR_LENGTH];
+    int count;            // 항목 수 (이름순 정렬 상태 유지)
+    int capacity;
+
+    char *names;          // 이름 아레나 - NUL 로 끝나는 이름을 이어 붙인다
+    size_t names_used;
+    size_t names_capacity;
+    size_t names_garbage; // 지워진 항목이 남긴 바이트 (많아지면 압축)
+    uint32_t *name_off;   // name_off[i] - i 번째 항목 이름의 아레나 위치
+
+    unsigned char *state; // stat 정보 상태 (STAT_*)
+    unsigned char *type;  // 디렉토리 항목의 d_type (DT_UNKNOWN 이면 stat 으로 판단)
+    uint32_t *mode;       // 아래는 state 가 STAT_OK 일 때만 의미 있음
+    int64_t *size;
+    int64_t *mtime_sec;
+    uint32_t *mtime_nsec;
+    uint64_t *ino;
+    uint64_t *dev;
+    int64_t *blocks;
+
+    int valid;            // 1 - 목록이 path 의 내용과 일치
+    unsigned long generation; // 항목이 추가/삭제될 때마다 바뀜 (모든 목록 캐시에서 겹치지 않는 값)
+    unsigned long stat_generation; // stat 정보가 바뀔 때마다 바뀜 (위와 같음)
+    int inotify_fd;       // -1 이면 inotify 사용 불가
+    int watch_fd;         // -1 이면 감시 중이 아님 (NFS 등)
+    time_t last_check;    // 감시가 없을 때 마지막으로 mtime 을 확인한 시각
+    struct timespec dir_mtime;
+    meta_target *meta;    // 디렉토리를 열어 둔 메타데이터 요청 대상
+    void (*on_ready)(void); // 백그라운드 stat 결과 도착 알림 (NULL 가능)
+} dir_cache;
+
+// idx 번째 항목의 이름 (다음 목록 변경 전까지 유효)
+static inline const char *dircache_name(const dir_cache *dc, int idx) {
+    return dc->names + dc->name_off[idx];
+}
+
+void dircache_init(dir_cache *dc);
+void dircache_free(dir_cache *dc);
+
+// path 의 목록을 준비한다. 이미 캐시된 디렉토리면 변경 이벤트만 반영
+// return 0 - 성공, -1 - 디렉토리 읽기 실패
+int dircache_open(dir_cache *dc, const char *path);
+
+// 대기 중인 변경 이벤트를 목록에 반영한다 (블록하지 않음)
+// return 1 - 목록이 바뀜, 0 - 변경 없음
+int dircache_refresh(dir_cache *dc);
+
+// idx 번째 항목의 stat 정보를 st 에 채운다. 아직 없으면 이때 한 번만 읽는다 (동기)
+// st 에는 모드, 크기, 수정 시각, inode, 장치, 블록 수만 채워진다
+// return 0 - 성공, -1 - stat 실패
+int dircache_stat(dir_cache *dc, int idx, struct stat *st);
+
+// [first, first+count) 항목 중 stat 정보가 없는 것들을 백그라운드로 요청한다
+void dircache_fetch(dir_cache *dc, int first, int count);
+
+// 준비된 stat 정보만 st 에 채운다 (블록하지 않음). return 0 - 있음, -1 - 아직 없거나 실패
+int dircache_peek_stat(const dir_cache *dc, int idx, struct stat *st);
+
+// 이름으로 항목 위치 검색, 없으면 -1
+int dircache_find(const dir_cache *dc, const char *name);
+
+// idx 번째 항목이 디렉토리인지 (stat 정보가 없으면 d_type 으로 판단)
+int dircache_is_dir(const dir_cache *dc, int idx);
+
+#endif
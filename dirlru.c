@@ -0,0 +1,230 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "dirlru.h"
+
+typedef struct {
+    dir_cache *dc;                    // NULL 이면 빈 자리
+    unsigned long last_used;          // 0 - 미리 읽기만 하고 아직 들어가지 않음 (먼저 버린다)
+    char cursor[MAX_FILENAME_LENGTH]; // 마지막으로 선택한 항목, 빈 문자열이면 없음
+    int cursor_row;
+} dirlru_slot;
+
+static dirlru_slot slots[DIRLRU_SLOTS];
+static dirlru_slot *current = NULL; // 마지막으로 연 목록 (화면에 보이는 중이라 버리지 않는다)
+static unsigned long use_tick = 0;
+static void (*ready_callback)(void) = NULL;
+
+// 미리 읽기 스레드와 주고받는 상태
+static pthread_mutex_t prefetch_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t prefetch_cond = PTHREAD_COND_INITIALIZER;
+static char want_path[MAX_DIR_LENGTH];    // 다음에 읽을 경로, 빈 문자열이면 없음
+static char loading_path[MAX_DIR_LENGTH]; // 읽는 중인 경로
+static dir_cache *ready = NULL;           // 다 읽었지만 아직 UI 스레드가 가져가지 않은 목록
+static int prefetch_started = 0;
+
+static void release_cache(dir_cache *dc) {
+    if (dc) {
+        dircache_free(dc);
+        free(dc);
+    }
+}
+
+static dir_cache *new_cache(void) {
+    dir_cache *dc = malloc(sizeof(dir_cache));
+    if (dc) {
+        dircache_init(dc);
+        dc->on_ready = ready_callback;
+    }
+    return dc;
+}
+
+static dirlru_slot *find_slot(const char *path) {
+    for (int i = 0; i < DIRLRU_SLOTS; i++) {
+        if (slots[i].dc && strcmp(slots[i].dc->path, path) == 0) {
+            return &slots[i];
+        }
+    }
+    return NULL;
+}
+
+// 빈 자리, 없으면 가장 오래 쓰지 않은 자리를 비워서 (현재 목록 제외)
+static dirlru_slot *take_slot(void) {
+    dirlru_slot *victim = NULL;
+    for (int i = 0; i < DIRLRU_SLOTS; i++) {
+        if (!slots[i].dc) {
+            return &slots[i];
+        }
+        if (&slots[i] != current && (!victim || slots[i].last_used < victim->last_used)) {
+            victim = &slots[i];
+        }
+    }
+    release_cache(victim->dc);
+    memset(victim, 0, sizeof(*victim));
+    return victim;
+}
+
+// 항목 수 합계가 상한을 넘으면 오래된 목록부터 버린다
+static void trim_to_budget(void) {
+    while (1) {
+        long long total = 0;
+        dirlru_slot *victim = NULL;
+        for (int i = 0; i < DIRLRU_SLOTS; i++) {
+            if (!slots[i].dc) {
+                continue;
+            }
+            total += slots[i].dc->count;
+            if (&slots[i] != current && (!victim || slots[i].last_used < victim->last_used)) {
+                victim = &slots[i];
+            }
+        }
+        if (total <= DIRLRU_MAX_ENTRIES || !victim) {
+            return;
+        }
+        release_cache(victim->dc);
+        memset(victim, 0, sizeof(*victim));
+    }
+}
+
+// 미리 읽은 목록을 캐시에 넣는다 (UI 스레드)
+static void adopt_ready(void) {
+    pthread_mutex_lock(&prefetch_lock);
+    dir_cache *dc = ready;
+    ready = NULL;
+    pthread_mutex_unlock(&prefetch_lock);
+    if (!dc) {
+        return;
+    }
+    if (find_slot(dc->path)) { // 그 사이 직접 읽음
+        release_cache(dc);
+        return;
+    }
+    dirlru_slot *slot = take_slot();
+    slot->dc = dc;
+    slot->last_used = 0;
+    trim_to_budget();
+}
+
+static void *prefetch_thread(void *arg) {
+    (void)arg;
+    char path[MAX_DIR_LENGTH];
+    pthread_mutex_lock(&prefetch_lock);
+    while (1) {
+        while (!want_path[0]) {
+            pthread_cond_wait(&prefetch_cond, &prefetch_lock);
+        }
+        // 선택이 잠시 머무를 때만 읽는다 - 목록을 빠르게 훑고 지나가는 동안에는 읽지 않음
+        snprintf(path, sizeof(path), "%s", want_path);
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += DIRLRU_PREFETCH_DELAY_MS * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        int rc = 0;
+        while (rc != ETIMEDOUT && strcmp(want_path, path) == 0) {
+            rc = pthread_cond_timedwait(&prefetch_cond, &prefetch_lock, &deadline);
+        }
+        if (strcmp(want_path, path) != 0) {
+            continue; // 선택이 바뀜
+        }
+        want_path[0] = '\0';
+        snprintf(loading_path, sizeof(loading_path), "%s", path);
+        pthread_mutex_unlock(&prefetch_lock);
+
+        // 목록과 첫 화면 항목의 stat 까지 읽어 둔다
+        dir_cache *dc = new_cache();
+        if (dc && dircache_open(dc, path) == 0) {
+            for (int i = 0; i < dc->count && i < DIRLRU_PREFETCH_STATS; i++) {
+                dircache_stat(dc, i, NULL);
+            }
+        } else {
+            release_cache(dc);
+            dc = NULL;
+        }
+
+        pthread_mutex_lock(&prefetch_lock);
+        loading_path[0] = '\0';
+        if (dc) {
+            release_cache(ready); // 가져가지 않은 이전 결과는 버린다
+            ready = dc;
+        }
+    }
+    return NULL;
+}
+
+void dirlru_init(void (*on_ready)(void)) {
+    ready_callback = on_ready;
+    pthread_t thread;
+    if (!prefetch_started && pthread_create(&thread, NULL, prefetch_thread, NULL) == 0) {
+        pthread_detach(thread);
+        prefetch_started = 1;
+    }
+}
+
+dir_cache *dirlru_open(const char *path, int *result) {
+    adopt_ready();
+    dirlru_slot *slot = find_slot(path);
+    if (!slot) {
+        // 미리 읽는 중이어도 기다리지 않고 여기서 읽는다 - 미리 읽기는 앞쪽 항목의 stat 까지 하므로
+        // 느린 파일 시스템에서는 목록만 읽는 것보다 훨씬 늦게 끝날 수 있다 (늦게 온 결과는 adopt_ready 가 버린다)
+        pthread_mutex_lock(&prefetch_lock);
+        if (strcmp(want_path, path) == 0) {
+            want_path[0] = '\0';
+        }
+        pthread_mutex_unlock(&prefetch_lock);
+    }
+    if (!slot) {
+        dir_cache *dc = new_cache();
+        if (!dc) {
+            return NULL;
+        }
+        slot = take_slot();
+        slot->dc = dc;
+    }
+    slot->last_used = ++use_tick;
+    current = slot;
+    *result = dircache_open(slot->dc, path);
+    trim_to_budget();
+    return slot->dc;
+}
+
+void dirlru_prefetch(const char *path) {
+    if (!prefetch_started) {
+        return;
+    }
+    adopt_ready();
+    if (find_slot(path)) {
+        return;
+    }
+    pthread_mutex_lock(&prefetch_lock);
+    if (strcmp(loading_path, path) != 0 && (!ready || strcmp(ready->path, path) != 0) &&
+        strcmp(want_path, path) != 0) {
+        snprintf(want_path, sizeof(want_path), "%s", path);
+        pthread_cond_broadcast(&prefetch_cond);
+    }
+    pthread_mutex_unlock(&prefetch_lock);
+}
+
+void dirlru_set_cursor(const char *path, const char *name, int row) {
+    dirlru_slot *slot = find_slot(path);
+    if (slot) {
+        snprintf(slot->cursor, sizeof(slot->cursor), "%s", name);
+        slot->cursor_row = row;
+    }
+}
+
+int dirlru_get_cursor(const char *path, char *name, size_t name_size, int *row) {
+    dirlru_slot *slot = find_slot(path);
+    if (!slot || !slot->cursor[0]) {
+        return -1;
+    }
+    snprintf(name, name_size, "%s", slot->cursor);
+    *row = slot->cursor_row;
+    return 0;
+}
@@ -0,0 +1,33 @@
+#ifndef __DIRLRU__
+#define __DIRLRU__
+
+#include "dircache.h"
+
+#define DIRLRU_SLOTS 16                      // 기억하는 디렉토리 목록 수
+#define DIRLRU_MAX_ENTRIES (2 * 1024 * 1024) // 기억하는 목록의 항목 수 합계 상한
+#define DIRLRU_PREFETCH_DELAY_MS 100         // 선택이 이만큼 머무르면 미리 읽기 시작
+#define DIRLRU_PREFETCH_STATS 64             // 미리 읽을 때 stat 까지 해 두는 앞쪽 항목 수
+
+// 최근에 본 디렉토리 목록 캐시 (LRU) 와 선택된 하위 디렉토리 미리 읽기
+// 목록마다 dir_cache 를 그대로 유지하므로 (inotify 감시 포함) 다시 들어가면
+// 쌓인 변경 이벤트만 반영하고 바로 보여준다. 목록마다 마지막 선택 위치도 기억한다
+// 미리 읽기 스레드는 자기 dir_cache 에 목록을 읽고 나서 UI 스레드에 넘긴다
+// (dir_cache 는 한 번에 한 스레드만 다룬다)
+
+// on_ready - 목록의 백그라운드 stat 결과 도착 알림 (UI 스레드 전용, 처음 한 번)
+void dirlru_init(void (*on_ready)(void));
+
+// path 의 목록. 캐시에 있으면 변경 이벤트만 반영하고, 없으면 (미리 읽는 중이어도) 바로 읽는다
+// result 에 dircache_open 의 결과 (0 - 성공, -1 - 읽기 실패). 메모리 부족이면 NULL (UI 스레드 전용)
+dir_cache *dirlru_open(const char *path, int *result);
+
+// path 를 백그라운드로 미리 읽는다. 캐시에 있거나 이미 읽는 중이면 무시, 새 요청이 이전 요청을 대신한다
+void dirlru_prefetch(const char *path);
+
+// path 목록의 선택 위치를 기억한다 (name - 선택한 항목, row - 화면 안에서의 줄)
+void dirlru_set_cursor(const char *path, const char *name, int row);
+
+// 기억한 선택 위치. return 0 - 있음, -1 - 없음
+int dirlru_get_cursor(const char *path, char *name, size_t name_size, int *row);
+
+#endif
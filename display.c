@@ -1,164 +1,1649 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 #include <time.h>
+#include <unistd.h>
 #include <dirent.h>
+#include <signal.h>
 #include <sys/stat.h>
-#include <locale.h>
-#include <wchar.h>
 #include <ncurses.h>
 
 #include "project_macro.h"
+#include "dircache.h"
+#include "textfile.h"
+#include "uichannel.h"
+#include "jobs.h"
+#include "copy.h"
+#include "screen.h"
+#include "filter.h"
+#include "sortview.h"
+#include "dusize.h"
+#include "perf.h"
+#include "layout.h"
+#include "textsearch.h"
+#include "proclist.h"
+#include "sessions.h"
+#include "finder.h"
+#include "dirlru.h"
+#include "dupfind.h"
 
 // 문자열을 지정된 길이로 자르고 출력하는 함수
-// 한글과 영문이 같은 넓이를 차지하도록 조정하여 max_width 길이의 문자열을 출력
+// 로케일은 main 에서 한 번 설정하고, 배치한 줄은 addstr 한 번으로 출력한다
 void print_trimmed(const char *str, int max_width) {
-    setlocale(LC_ALL, "");
-    int width = 0;
-    const char *ptr = str;
-
-    while (*ptr && width < max_width) {
-        wchar_t wc;
-        int char_len = mbtowc(&wc, ptr, MB_CUR_MAX);
-        if (char_len <= 0) {
-            break;
-        }
+    char buf[4096];
+    layout_trimmed(buf, sizeof(buf), str, max_width);
+    addstr(buf);
+}
 
-        int char_width = wcwidth(wc);
-        if (char_width < 0) {
-            char_width = 0;
-        }
+int is_marked(const char *file_path); // execute.c에 있는 함수
+int mark_count(void);
+void toggle_mark(const char *file_path);
+void set_clipboard_cut(const char *file_path);
 
-        if (width + char_width > max_width) {
-            break;
-        }
+// 현재 디렉토리 목록 캐시 - 프레임마다 scandir 하지 않도록 유지
+// 최근에 본 목록은 dirlru 가 보관하고, 이것은 그중 지금 보이는 목록
+static dir_cache *folder_cache = NULL;
+static int folder_cache_ready = 0;
 
-        addnstr(ptr, char_len);
-        width += char_width;
-        ptr += char_len;
+// 현재 디렉토리 변경 감시용 fd, 감시할 수 없으면 -1 (주기적으로 folder_refresh 필요)
+int folder_watch_fd(void) {
+    if (!folder_cache || folder_cache->watch_fd < 0) {
+        return -1;
     }
+    return folder_cache->inotify_fd;
+}
+
+// 쌓인 변경 이벤트를 목록에 반영, 바뀌었으면 1
+int folder_refresh(void) {
+    return folder_cache && dircache_refresh(folder_cache);
+}
+
+// 목록 필터 - 검색어가 있으면 일치한 항목만 점수 순으로 보여준다
+static name_filter folder_filter;
+static char folder_filter_query[FILTER_MAX_QUERY] = "";
+
+void folder_filter_set(const char *query) {
+    strncpy(folder_filter_query, query, sizeof(folder_filter_query) - 1);
+    folder_filter_query[sizeof(folder_filter_query) - 1] = '\0';
+}
 
-    for (int i = width; i < max_width; i++) {
-        addch(' ');
+// 목록 정렬 기준 - 's' 로 기준 변경, 'd' 로 디렉토리 먼저 켜고 끄기
+static sort_view folder_sort;
+
+void folder_sort_cycle(void) {
+    folder_sort.mode = (folder_sort.mode + 1) % SORT_MODE_COUNT;
+}
+
+void folder_sort_toggle_dirs_first(void) {
+    folder_sort.dirs_first = !folder_sort.dirs_first;
+}
+
+// 'u' 로 켜고 끄는 디렉토리 전체 크기 표시 - 켜져 있으면 현재 디렉토리를 백그라운드로 순회
+#define DU_RETRY_MS 2000 // 순회를 시작할 수 없었던 디렉토리를 다시 시도하는 간격
+static int folder_du_enabled = 0;
+static char folder_du_failed[MAX_DIR_LENGTH]; // 마지막으로 순회를 시작하지 못한 디렉토리
+static uint64_t folder_du_failed_at = 0;
+
+void folder_du_toggle(void) {
+    folder_du_enabled = !folder_du_enabled;
+    if (!folder_du_enabled) {
+        du_stop();
     }
 }
 
-int sort_by_name(const struct dirent **a, const struct dirent **b) {
-    return strcmp((*a)->d_name, (*b)->d_name);
+static const char *folder_name_at(const void *ctx, int idx) {
+    return dircache_name((const dir_cache *)ctx, idx);
+}
+
+// 화면에 보일 항목 목록을 정한다. 필터가 있으면 점수 순, 없으면 정렬 기준 순
+// items 가 NULL 이면 전체 목록 순서 그대로
+static int folder_view(const int **items) {
+    *items = NULL;
+    if (folder_filter_query[0]) {
+        int n = filter_apply(&folder_filter, folder_filter_query, folder_name_at, folder_cache,
+                             folder_cache->count, folder_cache->generation);
+        if (n >= 0) {
+            *items = filter_results(&folder_filter, &n);
+            return n;
+        }
+    }
+    *items = sortview_update(&folder_sort, folder_cache);
+    if (folder_sort.missing_stats > 0) { // 크기/시각 정렬 - 모든 항목의 stat 을 요청
+        dircache_fetch(folder_cache, 0, folder_cache->count);
+    }
+    return folder_cache->count;
 }
 
 // 디렉토리의 파일 정보를 출력하는 함수
-int display_folder(const char *directory, const int print_start_idx, const int highlighted_idx, char *selected_filename, size_t filename_size) {
-    struct dirent **filelist = NULL;
-    int file_count = scandir(directory, &filelist, NULL, sort_by_name);
+// directory 의 목록을 현재 목록으로 연다. return 0 - 성공, -1 - 읽기 실패
+static int folder_open(const char *directory) {
+    if (!folder_cache_ready) {
+        dirlru_init(ui_post_redraw); // stat 결과가 오면 화면 갱신
+        filter_init(&folder_filter);
+        sortview_init(&folder_sort);
+        folder_cache_ready = 1;
+    }
+    int result = -1;
+    folder_cache = dirlru_open(directory, &result);
+    return folder_cache ? result : -1;
+}
 
-    if (file_count < 0) {
-        mvprintw(1, 0, "Error reading directory: %s", directory);
-        return 0;
+// directory 목록에서 name 이 보이는 위치 (현재 필터와 정렬 순서), 없으면 -1
+int folder_locate(const char *directory, const char *name) {
+    if (folder_open(directory) < 0) {
+        return -1;
+    }
+    int idx = dircache_find(folder_cache, name);
+    if (idx < 0) {
+        return -1;
+    }
+    const int *items;
+    int count = folder_view(&items);
+    if (!items) {
+        return idx;
+    }
+    for (int i = 0; i < count; i++) {
+        if (items[i] == idx) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// 떠나는 디렉토리의 선택 위치를 기억한다 (row - 선택한 항목의 목록 안 줄)
+void folder_remember(const char *directory, const char *name, int row) {
+    dirlru_set_cursor(directory, name, row);
+}
+
+// 들어온 디렉토리에서 처음 선택할 위치 - 기억해 둔 항목, 없으면 from (올라오기 전의 하위 디렉토리 이름, NULL 가능)
+// rows 는 목록에 보이는 줄 수
+void folder_restore(const char *directory, const char *from, int rows, int *highlighted, int *start) {
+    char name[MAX_FILENAME_LENGTH];
+    int row = 0;
+    int idx = -1;
+    if (dirlru_get_cursor(directory, name, sizeof(name), &row) == 0) {
+        idx = folder_locate(directory, name);
+    }
+    if (idx < 0 && from) {
+        idx = folder_locate(directory, from);
+        row = rows / 2;
+    }
+    if (idx < 0) {
+        *highlighted = 0;
+        *start = 0;
+        return;
+    }
+    if (row >= rows) {
+        row = rows - 1;
+    }
+    if (row < 0) {
+        row = 0;
+    }
+    *highlighted = idx;
+    *start = idx > row ? idx - row : 0;
+}
+
+// 선택된 하위 디렉토리 (또는 ..) 를 미리 읽어 둔다 - 경로는 execute_command 가 만드는 것과 같게
+static void folder_prefetch(const char *directory, int idx) {
+    const char *name = dircache_name(folder_cache, idx);
+    if (!dircache_is_dir(folder_cache, idx) || strcmp(name, ".") == 0) {
+        return;
+    }
+    char path[MAX_DIR_LENGTH];
+    if (strcmp(name, "..") == 0) {
+        snprintf(path, sizeof(path), "%s", directory);
+        char *last_slash = strrchr(path, '/');
+        if (!last_slash) {
+            snprintf(path, sizeof(path), "/");
+        } else if (last_slash == path) {
+            path[1] = '\0'; // "/usr" 의 상위는 "/"
+        } else {
+            *last_slash = '\0';
+        }
+    } else if (snprintf(path, sizeof(path), "%s%s%s", directory, strcmp(directory, "/") == 0 ? "" : "/", name) >=
+               (int)sizeof(path)) {
+        return;
     }
+    dirlru_prefetch(path);
+}
 
-    // ncurses 색상 초기화
-    start_color();
-    init_pair(1, COLOR_YELLOW, COLOR_BLACK); // 노란색 글자, 검은색 배경
+int display_folder(const char *directory, const int print_start_idx, const int highlighted_idx, char *selected_filename, size_t filename_size) {
+    screen_begin();
+    uint64_t perf_start = perf_begin();
+    int opened = folder_open(directory);
+    perf_end(PERF_LIST, perf_start);
+    if (opened < 0) {
+        screen_put(1, A_NORMAL, "Error reading directory: %s", directory);
+        return 0;
+    }
 
     int screen_height;
     int screen_width;
     getmaxyx(stdscr, screen_height, screen_width);
 
-    mvprintw(0, 0, "===========================================");
-    mvprintw(1, 0, "current directory :  %s", directory); 
-    mvprintw(2, 0, "-------------------------------------------");
-    mvprintw(3, 0, "%-30s %-10s %-10s %-20s", "Filename", "Kind", "Size", "Modified");
-    mvprintw(4, 0, "-------------------------------------------");
+    screen_put(0, A_NORMAL, "===========================================");
+    long long du_scanned = 0;
+    if (folder_du_enabled && (!du_path() || strcmp(du_path(), directory) != 0) &&
+        (strcmp(folder_du_failed, directory) != 0 || perf_now() - folder_du_failed_at >= DU_RETRY_MS * 1000000ULL)) {
+        if (du_start(directory) != 0) { // 디렉토리가 바뀌면 이전 순회는 취소
+            snprintf(folder_du_failed, sizeof(folder_du_failed), "%s", directory);
+            folder_du_failed_at = perf_now();
+        } else {
+            folder_du_failed[0] = '\0';
+        }
+    }
+    if (folder_du_enabled && du_running(&du_scanned)) {
+        screen_put(1, A_NORMAL, "current directory :  %s  [du: %lld dirs scanned]", directory, du_scanned);
+    } else {
+        screen_put(1, A_NORMAL, "current directory :  %s", directory);
+    }
+    const int *view_items;
+    perf_start = perf_begin();
+    int file_count = folder_view(&view_items);
+    perf_end(PERF_ORDER, perf_start);
+
+    if (folder_filter_query[0]) {
+        screen_put(2, A_NORMAL, "-- filter: %s (%d / %d) --", folder_filter_query, file_count, folder_cache->count);
+    } else {
+        screen_put(2, A_NORMAL, "-------------------------------------------");
+    }
+    screen_put(3, A_NORMAL, "%-30s %-10s %-10s %-20s [sort: %s%s]", "Filename", "Kind", "Size", "Modified",
+               sort_mode_name(folder_sort.mode), folder_sort.dirs_first ? ", dirs first" : "");
+    screen_put(4, A_NORMAL, "-------------------------------------------");
 
     int print_start_screenY = RESERVED_LINE_UPPER;
     int print_end_screenY = screen_height - RESERVED_LINE_LOWER - 1;
     int current_screenY = print_start_screenY;
 
-    for (int file_idx = print_start_idx; file_idx < file_count && current_screenY <= print_end_screenY; file_idx++, current_screenY++) {
-        struct stat file_stat;
-        char filepath[1024];
-        snprintf(filepath, sizeof(filepath), "%s/%s", directory, filelist[file_idx]->d_name);
+    if (file_count == 0) { // 필터에 일치하는 항목 없음
+        selected_filename[0] = '\0';
+    }
+
+    // 화면에 보일 항목의 stat 을 한꺼번에 백그라운드로 요청하고, 도착한 것부터 채운다
+    perf_start = perf_begin();
+    if (view_items) {
+        for (int i = print_start_idx; i < file_count && i <= print_start_idx + print_end_screenY - print_start_screenY; i++) {
+            dircache_fetch(folder_cache, view_items[i], 1);
+        }
+    } else {
+        dircache_fetch(folder_cache, print_start_idx, print_end_screenY - print_start_screenY + 1);
+    }
+    perf_end(PERF_STAT, perf_start);
+
+    perf_start = perf_begin();
 
-        if (stat(filepath, &file_stat) == 0) {
-            char *kind = (S_ISDIR(file_stat.st_mode)) ? "DIR" : "FILE";
+    for (int view_idx = print_start_idx; view_idx < file_count && current_screenY <= print_end_screenY; view_idx++, current_screenY++) {
+        int file_idx = view_items ? view_items[view_idx] : view_idx;
+        struct stat st_buf;
+        const struct stat *st = dircache_peek_stat(folder_cache, file_idx, &st_buf) == 0 ? &st_buf : NULL;
+        int stat_state = folder_cache->state[file_idx];
+        const char *name = dircache_name(folder_cache, file_idx);
+        attr_t attr = A_NORMAL;
 
-            char mod_time[20];
-            strftime(mod_time, sizeof(mod_time), "%Y-%m-%d %H:%M", localtime(&file_stat.st_mtime));
+        if (view_idx == highlighted_idx) {
+            attr |= A_REVERSE;
+            strncpy(selected_filename, name, filename_size - 1);
+            selected_filename[filename_size - 1] = '\0';
+        }
 
-            if (file_idx == highlighted_idx) {
-                attron(A_REVERSE);
-                strncpy(selected_filename, filelist[file_idx]->d_name, filename_size - 1);
-                selected_filename[filename_size - 1] = '\0';
-            }
+        if (st != NULL && S_ISDIR(st->st_mode)) { // 디렉토리인 경우 색상 설정
+            attr |= COLOR_PAIR(1);
+        }
+
+        char name_field[MAX_FILENAME_LENGTH * 2];
+        int marked = 0;
+        if (mark_count() > 0) { // 선택 표시된 파일은 앞에 '*'
+            char filepath[1024];
+            snprintf(filepath, sizeof(filepath), "%s%s%s", directory, strcmp(directory, "/") == 0 ? "" : "/", name);
+            marked = is_marked(filepath);
+        }
+        layout_trimmed(name_field, sizeof(name_field), name, marked ? 29 : 30);
 
-            if (S_ISDIR(file_stat.st_mode)) { // 디렉토리인 경우 색상 설정
-                attron(COLOR_PAIR(1));
+        if (st != NULL) {
+            // 중단된 붙여넣기가 남긴 임시 파일은 PART (선택하면 지울 수 있다)
+            char *kind = (S_ISDIR(st->st_mode)) ? "DIR" : copy_is_partial(name) ? "PART" : "FILE";
+
+            char mod_time[20];
+            strftime(mod_time, sizeof(mod_time), "%Y-%m-%d %H:%M", localtime(&st->st_mtime));
+            du_total total;
+            int du_state = (folder_du_enabled && S_ISDIR(st->st_mode)) ? du_lookup(st, &total) : DU_NONE;
+            if (du_state != DU_NONE) { // 하위 트리 전체 크기, 순회 중이면 '+'
+                char size_field[16];
+                format_size(size_field, sizeof(size_field) - 1, (double)total.bytes);
+                if (du_state == DU_PARTIAL) {
+                    strcat(size_field, "+");
+                }
+                screen_put(current_screenY, attr, "%s%s%-10s %-10s %-20s %lld files", marked ? "*" : "", name_field, kind,
+                           size_field, mod_time, total.files);
+            } else {
+                screen_put(current_screenY, attr, "%s%s%-10s %-10ld %-20s", marked ? "*" : "", name_field, kind, st->st_size, mod_time);
             }
+        } else if (stat_state == STAT_FAILED) {
+            screen_put(current_screenY, attr, "%s%s%-10s %-10s %-20s", marked ? "*" : "", name_field, "?", "?", "?");
+        } else { // 아직 도착하지 않음
+            screen_put(current_screenY, attr, "%s%s%-10s %-10s %-20s", marked ? "*" : "", name_field, "...", "...", "...");
+        }
+    }
+
+    perf_end(PERF_FORMAT, perf_start);
+
+    if (highlighted_idx < file_count) {
+        folder_prefetch(directory, view_items ? view_items[highlighted_idx] : highlighted_idx);
+    }
+
+    if (perf_overlay_visible()) { // 선택된 줄을 가리지 않는 쪽 절반에 성능 오버레이
+        int rows = perf_overlay_rows();
+        int highlighted_screenY = print_start_screenY + highlighted_idx - print_start_idx;
+        int overlay_y = highlighted_screenY > (print_start_screenY + print_end_screenY) / 2
+                        ? print_start_screenY : print_end_screenY - rows + 1;
+        if (overlay_y < print_start_screenY) {
+            overlay_y = print_start_screenY;
+        }
+        for (int i = 0; i < rows && overlay_y + i <= print_end_screenY; i++) {
+            char line[256];
+            perf_overlay_line(i, line, sizeof(line));
+            screen_put(overlay_y + i, A_BOLD, "%s", line);
+        }
+    }
+
+    char jobs_line[256];
+    if (jobs_summary(jobs_line, sizeof(jobs_line)) > 0) { // 실행 중인 작업 요약
+        screen_put(screen_height - 4, A_NORMAL, "-- %s --", jobs_line);
+    } else {
+        screen_put(screen_height - 4, A_NORMAL, "-------------------------------------------");
+    }
+    if (mark_count() > 0) {
+        screen_put(screen_height - 3, A_NORMAL, "Processes(p)  Sessions(w)  Command(!)  Mark(m)  Jobs(j)  Perf(o)  Dups(D)  [%d marked]", mark_count());
+    } else {
+        screen_put(screen_height - 3, A_NORMAL, "Processes(p)  Sessions(w)  Command(!)  Mark(m)  Jobs(j)  Perf(o)  Dups(D)");
+    }
+    screen_put(screen_height - 2, A_NORMAL, "Quit(q)  Copy(c)  Cut(x)  Paste(v)  Execute(Space Bar)  Filter(/)  Find(f)  Sort(s/d)  Du(u)");
+    screen_put(screen_height - 1, A_NORMAL, "===========================================");
+
+    return file_count;
+}
+
+extern volatile sig_atomic_t idle_timeout; // main.c
+
+// 키 하나를 읽는다. 어느 화면에서든 키를 받으면 입력 없음 타이머를 다시 걸고, 그 사이 울린 타이머는 무시한다
+int read_key(void) {
+    int ch = getch();
+    if (ch != ERR) {
+        alarm(IDLE_TIMEOUT_SECONDS);
+        idle_timeout = 0;
+    }
+    return ch;
+}
+
+// 화면 맨 아래 줄에서 문자열을 입력받는 함수
+// return 0 - 입력 있음, -1 - 빈 입력
+int prompt_input(const char *label, char *buf, size_t buf_size) {
+    mvprintw(LINES - 1, 0, "%s", label);
+    clrtoeol();
+    refresh();
+    echo();
+    int old_cursor = curs_set(1);
+    getnstr(buf, buf_size - 1);
+    alarm(IDLE_TIMEOUT_SECONDS); // 입력 중에도 사용 중
+    idle_timeout = 0;
+    if (old_cursor != ERR) {
+        curs_set(old_cursor);
+    }
+    noecho();
+    return buf[0] ? 0 : -1;
+}
+
+// 줄 번호 입력을 받는 함수, 취소하면 -1
+static long prompt_line_number(void) {
+    char input[32] = "";
+    prompt_input("Go to line: ", input, sizeof(input));
+    char *end;
+    long line = strtol(input, &end, 10);
+    if (end == input || line < 1) {
+        return -1;
+    }
+    return line;
+}
 
-            move(current_screenY, 0);
-            print_trimmed(filelist[file_idx]->d_name, 30);
-            mvprintw(current_screenY, 30, "%-10s %-10ld %-20s", kind, file_stat.st_size, mod_time);
+#define VIEW_HSCROLL_STEP 8 // 좌우 스크롤 단위 (칸)
+#define WRAP_BYTES_PER_COL 16 // 줄바꿈 모드에서 화면 줄 하나를 찾을 때 먼저 보는 바이트 (칸당, 결합 문자 등)
+#define WRAP_MARK_ROWS 64     // 긴 줄의 화면 줄 시작을 기억하는 간격
 
-            if (S_ISDIR(file_stat.st_mode)) { // 색상 해제
-                attroff(COLOR_PAIR(1));
+// 줄바꿈 모드의 화면 줄 하나 - 줄 끝까지 찾지 않고 화면 폭에 필요한 만큼만 본다 (줄바꿈 없는 큰 파일)
+// *end 에 배치할 때 넘길 끝 (개행, 파일 끝 또는 그 앞의 충분히 먼 위치), return 이 화면 줄의 바이트 수
+// off + return < *end 이면 줄이 다음 화면 줄로 이어진다
+static size_t wrap_row(const text_file *tf, size_t off, int width, size_t *end) {
+    size_t window = (size_t)width * WRAP_BYTES_PER_COL + TEXTSEARCH_MAX_PATTERN;
+    while (1) {
+        size_t limit = tf->size - off > window ? off + window : tf->size;
+        const char *nl = memchr(tf->data + off, '\n', limit - off);
+        *end = nl ? (size_t)(nl - tf->data) : limit;
+        size_t used = layout_line(NULL, 0, tf->data + off, *end - off, 0, width, 0);
+        // 창 끝에서 잘린 문자나 검색 일치가 결과에 영향을 주지 않을 만큼 남았으면 된다
+        if (nl || limit == tf->size || off + used + TEXTSEARCH_MAX_PATTERN <= *end) {
+            return used;
+        }
+        window *= 2;
+    }
+}
+
+// 줄바꿈 모드에서 off (화면 줄의 시작) 다음 화면 줄의 시작, 마지막이면 off 그대로
+static size_t wrap_next(const text_file *tf, size_t off, int width) {
+    size_t end;
+    size_t used = wrap_row(tf, off, width, &end);
+    if (off + used < end) {
+        return off + used;
+    }
+    return end + 1 < tf->size ? end + 1 : off;
+}
+
+// 마지막으로 위로 스크롤한 줄의 화면 줄 시작 - WRAP_MARK_ROWS 줄마다 기억해서
+// 같은 줄에서 다시 위로 가면 줄의 처음부터 나누지 않고 가까운 위치부터 잇는다
+static struct {
+    const char *data;   // 캐시한 파일 (다시 매핑되면 버린다)
+    size_t size;
+    int width;
+    size_t *marks;      // marks[i] - i * WRAP_MARK_ROWS 번째 화면 줄의 시작, marks[0] 은 줄의 시작
+    size_t count;
+    size_t cap;
+    size_t line_end;    // 줄의 끝 (개행 또는 파일 끝), 모르면 (size_t)-1
+} wrap_cache;
+
+static void wrap_cache_reset(const text_file *tf, int width, size_t line) {
+    wrap_cache.data = tf->data;
+    wrap_cache.size = tf->size;
+    wrap_cache.width = width;
+    wrap_cache.count = 0;
+    wrap_cache.line_end = (size_t)-1;
+    if (wrap_cache.cap == 0) {
+        wrap_cache.marks = malloc(64 * sizeof(size_t));
+        wrap_cache.cap = wrap_cache.marks ? 64 : 0;
+    }
+    if (wrap_cache.cap) {
+        wrap_cache.marks[wrap_cache.count++] = line;
+    }
+}
+
+// 줄바꿈 모드에서 off 바로 앞 화면 줄의 시작
+static size_t wrap_prev(const text_file *tf, size_t off, int width) {
+    if (off == 0) {
+        return 0;
+    }
+    // 파일이 다시 매핑되거나 줄어들었으면 (follow) 기억한 위치는 쓸 수 없다
+    if (wrap_cache.data != tf->data || tf->size < wrap_cache.size || wrap_cache.width != width) {
+        wrap_cache_reset(tf, width, textfile_prev_line(tf, off));
+    }
+    wrap_cache.size = tf->size;
+    // off 가 기억한 줄 안인지 - 마지막 기억 위치와 off 사이에 개행이 없어야 한다
+    // (off 가 줄의 시작이면 그 앞 줄의 마지막 화면 줄을 찾는다)
+    size_t last = wrap_cache.count ? wrap_cache.marks[wrap_cache.count - 1] : (size_t)-1;
+    if (wrap_cache.count == 0 || off <= wrap_cache.marks[0] ||
+        (wrap_cache.line_end != (size_t)-1 ? off > wrap_cache.line_end + 1 :
+         memchr(tf->data + last, '\n', off - 1 > last ? off - 1 - last : 0) != NULL)) {
+        wrap_cache_reset(tf, width, textfile_prev_line(tf, off));
+        if (wrap_cache.count == 0) { // 메모리 부족 - 줄의 처음부터 나눈다
+            size_t seg = textfile_prev_line(tf, off);
+            for (size_t next; seg < off && (next = wrap_next(tf, seg, width)) < off && next != seg; seg = next) {
             }
+            return seg;
+        }
+    }
 
-            if (file_idx == highlighted_idx) {
-                attroff(A_REVERSE);
+    // off 앞까지 화면 줄을 나누면서 WRAP_MARK_ROWS 줄마다 기억한다
+    size_t *marks = wrap_cache.marks;
+    while (wrap_cache.line_end == (size_t)-1 && marks[wrap_cache.count - 1] < off) {
+        size_t seg = marks[wrap_cache.count - 1];
+        int rows = 0;
+        for (; rows < WRAP_MARK_ROWS && seg < off; rows++) {
+            size_t end;
+            size_t used = wrap_row(tf, seg, width, &end);
+            if (seg + used >= end || used == 0) {
+                wrap_cache.line_end = end;
+                break;
+            }
+            seg += used;
+        }
+        if (wrap_cache.line_end != (size_t)-1 || rows < WRAP_MARK_ROWS) {
+            break;
+        }
+        if (wrap_cache.count == wrap_cache.cap) {
+            size_t *grown = realloc(marks, wrap_cache.cap * 2 * sizeof(size_t));
+            if (!grown) {
+                break;
             }
+            marks = wrap_cache.marks = grown;
+            wrap_cache.cap *= 2;
         }
+        marks[wrap_cache.count++] = seg;
     }
 
-    mvprintw(screen_height - 4, 0, "-------------------------------------------");
-    mvprintw(screen_height - 3, 0, "Execute ps(p)  Execute who(w)");
-    mvprintw(screen_height - 2, 0, "Quit(q)  Copy(c)  Cut(x)  Paste(v)  Execute(Space Bar)");
-    mvprintw(screen_height - 1, 0, "===========================================");
+    // off 보다 앞인 마지막 기억 위치부터 나눈다 (많아야 WRAP_MARK_ROWS 줄)
+    size_t lo = 0, hi = wrap_cache.count;
+    while (hi - lo > 1) {
+        size_t mid = (lo + hi) / 2;
+        if (marks[mid] < off) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    size_t seg = marks[lo];
+    while (seg < off) {
+        size_t next = wrap_next(tf, seg, width);
+        if (next >= off || next == seg) {
+            break;
+        }
+        seg = next;
+    }
+    return seg;
+}
 
-    for (int i = 0; i < file_count; ++i) {
-        free(filelist[i]);
+// 마지막 화면의 첫 줄 - 파일 끝에서 거꾸로 한 화면만큼 (인덱스 없이도 바로 계산)
+static size_t last_page_top(const text_file *tf, int page, int wrap) {
+    size_t top = tf->size;
+    for (int i = 0; i < page; i++) {
+        top = wrap ? wrap_prev(tf, top, COLS) : textfile_prev_line(tf, top);
     }
-    free(filelist);
+    return top;
+}
 
-    return file_count;
+// 같은 검색어로 data 를 처음부터 다시 검색한다 (검색 중이 아니면 아무것도 안 함)
+static int restart_search(text_search *ts, const char *data, size_t size, int regex) {
+    if (ts->pattern_len == 0) {
+        return 0;
+    }
+    char pattern[TEXTSEARCH_MAX_PATTERN];
+    snprintf(pattern, sizeof(pattern), "%s", ts->pattern);
+    textsearch_stop(ts);
+    return textsearch_start(ts, data, size, pattern, regex, ui_post_redraw);
+}
+
+// off 가 속한 줄의 시작
+static size_t line_start(const text_file *tf, size_t off) {
+    if (off == 0 || tf->data[off - 1] == '\n') {
+        return off;
+    }
+    return textfile_prev_line(tf, off);
+}
+
+// top 부터 page 줄을 보여줄 때 화면에 나오는 마지막 바이트의 다음 위치
+static size_t page_end(const text_file *tf, size_t top, int page, int wrap) {
+    size_t off = top;
+    for (int y = 0; y < page; y++) {
+        size_t next = wrap ? wrap_next(tf, off, COLS) : textfile_next_line(tf, off);
+        if (next == off) {
+            return tf->size;
+        }
+        off = next;
+    }
+    return off;
+}
+
+// 화면 줄 y 에 나온 [off, off+used) 안의 검색 일치를 반전해서 표시한다
+// skip 은 왼쪽으로 넘긴 칸 수, current 는 지금 선택된 일치
+static void highlight_matches(text_search *ts, const text_file *tf, int y, size_t off, size_t used, size_t line_end,
+                              int skip, size_t current) {
+    size_t offs[64], lens[64];
+    size_t end = off + used;
+    if (!ts->regex) { // 화면 오른쪽 끝에 걸친 일치도 찾는다
+        end = line_end - end > ts->pattern_len ? end + ts->pattern_len - 1 : line_end;
+    }
+    int n = textsearch_range(ts, off, end, offs, lens, 64);
+    for (int i = 0; i < n; i++) {
+        int c0 = layout_width(tf->data + off, offs[i] - off) - skip;
+        int c1 = layout_width(tf->data + off, offs[i] + lens[i] - off) - skip;
+        if (c0 < 0) {
+            c0 = 0;
+        }
+        if (c1 > COLS) {
+            c1 = COLS;
+        }
+        if (c1 > c0) {
+            mvchgat(y, c0, c1 - c0, offs[i] == current ? A_REVERSE | A_BOLD | A_UNDERLINE : A_REVERSE, 0, NULL);
+        }
+    }
 }
 
 // 파일 내용을 출력하는 함수
+// 파일을 mmap 하고 백그라운드 라인 인덱스로 임의 위치에 바로 이동한다
+// 줄마다 layout_line 으로 화면 폭만큼만 배치해서 addstr 한 번으로 출력한다
 void display_file(const char *file_path) {
-    FILE *file = fopen(file_path, "r");
-    if (!file) {
+    text_file tf;
+    if (textfile_open(&tf, file_path, ui_post_redraw) != 0) {
         mvprintw(1, 0, "Error opening file: %s", file_path);
         return;
     }
 
-    int y_offset = 0; // 파일 출력 시작 위치
-    char line[1024];
+    size_t top = 0;       // 화면 첫 줄의 파일 오프셋 (줄바꿈 모드에서는 줄 중간일 수 있음)
+    long pending_line = -1; // 인덱싱이 끝나기를 기다리는 이동 요청 (0부터)
+    int wrap = 0;         // 긴 줄을 여러 화면 줄로 나눠서 보여줄지
+    int follow = 0;       // 따라가기 (F) - 파일 끝에 추가되는 내용을 반영
+    int follow_tail = 0;  // 따라가기 중 화면을 파일 끝에 붙여 둘지 (위로 스크롤하면 멈춤)
+    int follow_check = 0; // 감시 이벤트가 와서 파일 상태를 확인해야 함
+    int hscroll = 0;      // 줄바꿈하지 않을 때 왼쪽으로 넘긴 칸 수
+    char row[4096];
+
+    // 검색 (/, ?) - 일치 위치 인덱스는 백그라운드에서 만든다
+    text_search search;
+    memset(&search, 0, sizeof(search));
+    int search_regex = 0;       // 다음 검색을 정규식으로
+    int search_backward = 0;    // 마지막 검색 방향
+    int search_pending = 0;     // 인덱스가 search_from 근처까지 만들어지기를 기다리는 이동
+    int pending_backward = 0;
+    size_t search_from = 0;
+    size_t current_match = SIZE_MAX;
+    char search_message[TEXTSEARCH_MAX_PATTERN + 64] = ""; // "Pattern not found: " + 검색어
 
     while (1) {
+        int page = LINES - RESERVED_LINE_LOWER;
+        int index_done;
+        size_t total_lines = textfile_indexed_lines(&tf, &index_done);
+
+        // 따라가는 파일이 바뀌었으면 추가된 부분만 반영하고 (잘렸거나 회전했으면 다시 열고) 끝으로
+        if (follow_check) {
+            follow_check = 0;
+            int change = textfile_follow_poll(&tf);
+            if (change != TEXTFILE_SAME) {
+                textsearch_pause(&search); // 검색 스레드가 옛 매핑을 읽지 않게
+                if (change == TEXTFILE_GROWN && textfile_grow(&tf) == 0) {
+                    textsearch_resume(&search, tf.data, tf.size);
+                } else {
+                    if (textfile_reopen(&tf) != 0) {
+                        textsearch_stop(&search);
+                        ui_post_status("Cannot reopen %s", file_path);
+                        return;
+                    }
+                    restart_search(&search, tf.data, tf.size, search.regex);
+                    top = 0;
+                    current_match = SIZE_MAX;
+                    pending_line = -1;
+                    snprintf(search_message, sizeof(search_message), "file truncated or replaced - reopened");
+                }
+                total_lines = textfile_indexed_lines(&tf, &index_done);
+                if (follow_tail) {
+                    top = last_page_top(&tf, page, wrap);
+                }
+            }
+        }
+
+        if (pending_line >= 0 && textfile_line_offset(&tf, pending_line, &top) == 0) {
+            pending_line = -1;
+        }
+
+        if (search_pending) {
+            size_t match;
+            int wrapped = 0;
+            int found = textsearch_find(&search, search_from, pending_backward, &match);
+            if (found < 0) { // 끝까지 없으면 반대쪽 끝에서 다시
+                wrapped = 1;
+                found = textsearch_find(&search, pending_backward ? tf.size : 0, pending_backward, &match);
+            }
+            if (found == 0) {
+                search_pending = 0;
+                current_match = match;
+                if (match < top || match >= page_end(&tf, top, page, wrap)) {
+                    top = line_start(&tf, match);
+                }
+                snprintf(search_message, sizeof(search_message), "%s",
+                         wrapped ? (pending_backward ? "search hit TOP, continuing at BOTTOM" : "search hit BOTTOM, continuing at TOP") : "");
+            } else if (found < 0) {
+                search_pending = 0;
+                snprintf(search_message, sizeof(search_message), "Pattern not found: %s", search.pattern);
+            }
+        }
+
+        uint64_t perf_frame = perf_begin();
         clear();
-        int y = 0;
-        fseek(file, 0, SEEK_SET);
-        for (int i = 0; i < y_offset; i++) {
-            if (!fgets(line, sizeof(line), file)) {
+        size_t off = top;
+        for (int y = 0; y < page && off < tf.size; y++) {
+            size_t end;
+            if (wrap) { // 긴 줄도 화면 폭만큼만 본다
+                wrap_row(&tf, off, COLS, &end);
+            } else {
+                end = textfile_line_end(&tf, off);
+            }
+            size_t used = layout_line(row, sizeof(row), tf.data + off, end - off, wrap ? 0 : hscroll, COLS, 0);
+            mvaddstr(y, 0, row);
+            if (search.pattern_len > 0) {
+                highlight_matches(&search, &tf, y, off, used, end, wrap ? 0 : hscroll, current_match);
+            }
+            if (wrap && off + used < end) { // 같은 줄의 나머지는 다음 화면 줄에
+                off += used;
+                continue;
+            }
+            if (end + 1 >= tf.size) {
                 break;
             }
+            off = end + 1;
         }
 
-        while (fgets(line, sizeof(line), file) != NULL && y < LINES - RESERVED_LINE_LOWER) {
-            mvprintw(y++, 0, "%s", line);
+        long line_no = textfile_line_number(&tf, top);
+        if (line_no >= 0) {
+            mvprintw(LINES - 2, 0, "Line %ld / %zu%s", line_no + 1, total_lines, index_done ? "" : "+ (indexing...)");
+        } else {
+            mvprintw(LINES - 2, 0, "Line ? / %zu+ (indexing...)", total_lines);
         }
-
-        mvprintw(LINES - 1, 0, "Use UP/DOWN to scroll, Q to quit");
+        if (wrap) {
+            printw("  [wrap]");
+        } else if (hscroll > 0) {
+            printw("  [col %d]", hscroll + 1);
+        }
+        if (follow) {
+            printw(follow_tail ? "  [follow]" : "  [follow paused]");
+        }
+        if (pending_line >= 0) {
+            printw("  waiting for line %ld", pending_line + 1);
+        }
+        if (search.pattern_len > 0) {
+            int search_done;
+            size_t scanned;
+            size_t matches = textsearch_progress(&search, &search_done, &scanned);
+            printw("  %c%s: %zu match%s", search_backward ? '?' : '/', search.pattern, matches, matches == 1 ? "" : "es");
+            if (!search_done) {
+                printw(" (searching %d%%)", tf.size ? (int)(scanned * 100 / tf.size) : 100);
+            } else if (current_match != SIZE_MAX && matches > 0) {
+                printw(" [%zu/%zu]", textsearch_rank(&search, current_match) + 1, matches);
+            }
+            if (search.stored < matches) {
+                printw(" (n/N limited to first %d)", TEXTSEARCH_MAX_MATCHES);
+            }
+        } else if (search_regex) {
+            printw("  [regex]");
+        }
+        if (search_pending) {
+            printw("  searching...");
+        } else if (search_message[0]) {
+            printw("  %s", search_message);
+        }
+        mvprintw(LINES - 1, 0, "Scroll arrows/PgUp/PgDn/Home/End, W wrap, :(line), /? search, n/N next, R regex, F follow, Q quit");
+        uint64_t perf_output = perf_begin();
         refresh(); // 화면 갱신
+        perf_end(PERF_OUTPUT, perf_output);
+        perf_end(PERF_VIEW, perf_frame);
+
+        // 키 입력이 없으면 키 입력, 인덱싱/검색 진행 알림, 따라가는 파일의 변경을 기다린다
+        // 파일이 그대로면 깨어나지 않는다
+        nodelay(stdscr, TRUE);
+        int ch = read_key();
+        nodelay(stdscr, FALSE);
+        if (ch == ERR) {
+            int follow_fd = textfile_follow_fd(&tf);
+            int events = ui_wait_events(&follow_fd, follow_fd >= 0 ? 1 : 0, -1);
+            ui_channel_drain();
+            if (events & UI_EVENT_EXTRA(0)) {
+                follow_check = 1;
+            }
+            continue;
+        }
+
+        switch (ch) {
+            case 'q':
+                textsearch_stop(&search); // 검색 스레드가 mmap 영역을 읽고 있으므로 먼저 멈춘다
+                textfile_close(&tf);
+                return;
+            case KEY_UP:
+                top = wrap ? wrap_prev(&tf, top, COLS) : textfile_prev_line(&tf, top);
+                follow_tail = 0;
+                break;
+            case KEY_DOWN:
+                top = wrap ? wrap_next(&tf, top, COLS) : textfile_next_line(&tf, top);
+                break;
+            case KEY_PPAGE:
+                for (int i = 0; i < page - 1; i++) {
+                    top = wrap ? wrap_prev(&tf, top, COLS) : textfile_prev_line(&tf, top);
+                }
+                follow_tail = 0;
+                break;
+            case KEY_NPAGE:
+                for (int i = 0; i < page - 1; i++) {
+                    top = wrap ? wrap_next(&tf, top, COLS) : textfile_next_line(&tf, top);
+                }
+                break;
+            case KEY_HOME:
+                top = 0;
+                hscroll = 0;
+                pending_line = -1;
+                follow_tail = 0;
+                break;
+            case KEY_END:
+                top = last_page_top(&tf, page, wrap);
+                pending_line = -1;
+                follow_tail = follow;
+                break;
+            case 'F': // 따라가기 - 켜면 파일 끝으로, 멈춰 있으면 다시 끝에 붙이고, 따라가는 중이면 끈다
+                if (follow && !follow_tail) {
+                    follow_tail = 1;
+                } else if (follow) {
+                    textfile_follow(&tf, 0);
+                    follow = follow_tail = 0;
+                    break;
+                } else if (textfile_follow(&tf, 1) != 0) {
+                    snprintf(search_message, sizeof(search_message), "cannot watch this file");
+                    break;
+                } else {
+                    follow = follow_tail = follow_check = 1; // 켜기 전에 바뀐 내용도 반영
+                }
+                top = last_page_top(&tf, page, wrap);
+                pending_line = -1;
+                break;
+            case KEY_LEFT:
+                hscroll = hscroll > VIEW_HSCROLL_STEP ? hscroll - VIEW_HSCROLL_STEP : 0;
+                break;
+            case KEY_RIGHT:
+                if (!wrap) {
+                    hscroll += VIEW_HSCROLL_STEP;
+                }
+                break;
+            case 'w':
+                wrap = !wrap;
+                hscroll = 0;
+                if (!wrap && top > 0 && tf.data[top - 1] != '\n') { // 줄 중간이면 그 줄의 시작으로
+                    top = textfile_prev_line(&tf, top);
+                }
+                break;
+            case ':': {
+                long line = prompt_line_number();
+                if (line > 0) {
+                    pending_line = line - 1;
+                    follow_tail = 0;
+                }
+                break;
+            }
+            case '/':
+            case '?': {
+                char pattern[TEXTSEARCH_MAX_PATTERN] = "";
+                const char *label = ch == '/' ? (search_regex ? "Search regex: " : "Search: ")
+                                              : (search_regex ? "Search regex backward: " : "Search backward: ");
+                if (prompt_input(label, pattern, sizeof(pattern)) != 0) {
+                    break;
+                }
+                textsearch_stop(&search);
+                current_match = SIZE_MAX;
+                search_pending = 0;
+                search_message[0] = '\0';
+                if (textsearch_start(&search, tf.data, tf.size, pattern, search_regex, ui_post_redraw) != 0) {
+                    snprintf(search_message, sizeof(search_message), "Bad pattern: %s", search.error);
+                    break;
+                }
+                search_backward = pending_backward = ch == '?';
+                search_from = top;
+                search_pending = 1;
+                follow_tail = 0;
+                break;
+            }
+            case 'n':
+            case 'N':
+                if (search.pattern_len == 0) {
+                    break;
+                }
+                search_message[0] = '\0';
+                pending_backward = ch == 'n' ? search_backward : !search_backward; // N 은 한 번만 반대 방향
+                if (current_match != SIZE_MAX) {
+                    search_from = pending_backward ? current_match : current_match + 1;
+                } else {
+                    search_from = top;
+                }
+                search_pending = 1;
+                follow_tail = 0;
+                break;
+            case 'r': // 문자열/정규식 전환, 검색 중이면 같은 검색어로 다시
+                search_regex = !search_regex;
+                if (search.pattern_len > 0) {
+                    current_match = SIZE_MAX;
+                    if (restart_search(&search, tf.data, tf.size, search_regex) != 0) {
+                        snprintf(search_message, sizeof(search_message), "Bad pattern: %s", search.error);
+                        search_pending = 0;
+                    } else {
+                        pending_backward = search_backward;
+                        search_from = top;
+                        search_pending = 1;
+                    }
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+// 백그라운드 작업 목록과 진행 상황을 보여주는 화면
+// 작업이 실행 중이면 jobs.c 의 진행 알림으로 계속 갱신된다
+void display_jobs(void) {
+    job_info jobs[64];
+    int selected = 0;
 
-        int ch = getch();
-        if (ch == 'q') {
-            fclose(file);
-            return;
-        } else if (ch == KEY_UP && y_offset > 0) {
-            y_offset--;
-        } else if (ch == KEY_DOWN) {
-            y_offset++;
+    while (1) {
+        int count = jobs_snapshot(jobs, 64);
+        if (selected >= count) {
+            selected = count > 0 ? count - 1 : 0;
+        }
+
+        clear();
+        mvprintw(0, 0, "===========================================");
+        mvprintw(1, 0, "Background jobs");
+        mvprintw(2, 0, "-------------------------------------------");
+
+        int y = 3;
+        for (int i = 0; i < count && y + 1 < LINES - 3; i++, y += 2) {
+            job_info *job = &jobs[i];
+            double ratio = job->bytes_total > 0 ? (double)job->bytes_done / job->bytes_total : 0;
+            if (job->state == JOB_DONE) {
+                ratio = 1;
+            }
+
+            char done_str[16], total_str[16], rate_str[16], eta_str[16];
+            format_size(done_str, sizeof(done_str), job->bytes_done);
+            format_size(total_str, sizeof(total_str), job->bytes_total);
+            format_size(rate_str, sizeof(rate_str), job->bytes_per_sec);
+            format_eta(eta_str, sizeof(eta_str), job->eta_seconds);
+
+            if (i == selected) {
+                attron(A_REVERSE);
+            }
+            mvprintw(y, 0, "#%-3d %-9s %-4s %d item(s): %s -> %s", job->id, job_state_name(job->state),
+                     job->action == CLIPBOARD_CUT ? "move" : "copy", job->item_count,
+                     job->first_source, job->destination_dir);
+            clrtoeol();
+            if (i == selected) {
+                attroff(A_REVERSE);
+            }
+
+            // 진행 막대
+            int bar_width = 30;
+            int filled = (int)(ratio * bar_width);
+            mvprintw(y + 1, 5, "[");
+            for (int b = 0; b < bar_width; b++) {
+                addch(b < filled ? '#' : '.');
+            }
+            printw("] %3d%%  %s/%s  %lld/%lld files  %s/s  ETA %s", (int)(ratio * 100), done_str, total_str,
+                   job->files_done, job->files_total, rate_str, eta_str);
+            if (job->errors) {
+                printw("  %d errors", job->errors);
+            }
+        }
+        if (count == 0) {
+            mvprintw(3, 0, "No jobs.");
+        }
+
+        char summary[256];
+        if (jobs_summary(summary, sizeof(summary)) > 0) {
+            mvprintw(LINES - 3, 0, "%s", summary);
+        }
+        mvprintw(LINES - 2, 0, "UP/DOWN select  Cancel(k)  Clear finished(C)  Back(q)");
+        if (ui_status()[0]) {
+            mvprintw(LINES - 1, 0, "%s", ui_status());
+        }
+        refresh();
+
+        nodelay(stdscr, TRUE);
+        int ch = read_key();
+        nodelay(stdscr, FALSE);
+        if (ch == ERR) {
+            ui_wait_events(NULL, 0, -1);
+            ui_channel_drain();
+            continue;
+        }
+
+        switch (ch) {
+            case 'q':
+            case 'j':
+                return;
+            case KEY_UP:
+                if (selected > 0) {
+                    selected--;
+                }
+                break;
+            case KEY_DOWN:
+                if (selected < count - 1) {
+                    selected++;
+                }
+                break;
+            case 'k':
+                if (count > 0) {
+                    jobs_cancel(jobs[selected].id);
+                }
+                break;
+            case 'C':
+                jobs_clear_finished();
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+// 프로세스/세션 화면의 갱신 간격 (-i 옵션, 화면에서 +/-)
+#define MONITOR_INTERVAL_MIN 250
+#define MONITOR_INTERVAL_MAX 10000
+static int monitor_interval_ms = 1000;
+static const char *session_source = NULL; // -u 옵션, NULL 이면 시스템 utmp
+
+void monitor_set_interval(int ms) {
+    if (ms < MONITOR_INTERVAL_MIN) {
+        ms = MONITOR_INTERVAL_MIN;
+    }
+    monitor_interval_ms = ms > MONITOR_INTERVAL_MAX ? MONITOR_INTERVAL_MAX : ms;
+}
+
+void sessions_set_source(const char *path) {
+    session_source = path;
+}
+
+// 갱신 간격 조절 키 처리. return 1 - 처리함
+static int monitor_interval_key(int ch) {
+    if (ch == '+') {
+        monitor_set_interval(monitor_interval_ms * 2);
+        return 1;
+    }
+    if (ch == '-') {
+        monitor_set_interval(monitor_interval_ms / 2);
+        return 1;
+    }
+    return 0;
+}
+
+// 선택 줄 이동 (UP/DOWN/PgUp/PgDn/Home/End). return 1 - 처리함
+static int list_move_key(int ch, int *selected, int count, int page) {
+    switch (ch) {
+        case KEY_UP:
+            *selected -= 1;
+            break;
+        case KEY_DOWN:
+            *selected += 1;
+            break;
+        case KEY_PPAGE:
+            *selected -= page;
+            break;
+        case KEY_NPAGE:
+            *selected += page;
+            break;
+        case KEY_HOME:
+            *selected = 0;
+            break;
+        case KEY_END:
+            *selected = count - 1;
+            break;
+        default:
+            return 0;
+    }
+    if (*selected >= count) {
+        *selected = count - 1;
+    }
+    if (*selected < 0) {
+        *selected = 0;
+    }
+    return 1;
+}
+
+// 프로세스 목록 화면 - ps 를 실행하지 않고 /proc 를 직접 읽어 주기적으로 갱신한다
+// CPU 사용률은 갱신 사이의 tick 차이로 계산한다
+void display_processes(void) {
+    proc_table pt;
+    if (proctable_init(&pt) != 0) {
+        ui_post_status("Cannot open /proc");
+        return;
+    }
+    int *order = NULL;
+    int order_capacity = 0;
+    int sort_key = PROC_SORT_CPU;
+    char filter[64] = "";
+    int selected = 0, start = 0;
+    uint64_t next_refresh = 0;
+    double refresh_ms = 0;
+    int samples = 0;
+
+    while (1) {
+        uint64_t now = perf_now();
+        if (now >= next_refresh) {
+            uint64_t begin = now;
+            proctable_refresh(&pt);
+            now = perf_now();
+            refresh_ms = (now - begin) / 1e6;
+            // 첫 갱신에는 CPU 사용률이 없으므로 두 번째는 빨리
+            next_refresh = now + (uint64_t)(samples++ == 0 ? MONITOR_INTERVAL_MIN : monitor_interval_ms) * 1000000ULL;
+            if (pt.count > order_capacity) {
+                int *p = realloc(order, pt.count * sizeof(int));
+                if (!p) {
+                    break;
+                }
+                order = p;
+                order_capacity = pt.count;
+            }
+        }
+        int shown = proctable_view(&pt, filter, sort_key, order);
+        int page = LINES - 7;
+        if (selected >= shown) {
+            selected = shown > 0 ? shown - 1 : 0;
+        }
+        if (selected < start) {
+            start = selected;
+        } else if (selected >= start + page) {
+            start = selected - page + 1;
+        }
+
+        clear();
+        mvprintw(0, 0, "===========================================");
+        mvprintw(1, 0, "Processes: %d shown / %d  sort: %s  every %.2gs  (read in %.1f ms)", shown, pt.count,
+                 proctable_sort_name(sort_key), monitor_interval_ms / 1000.0, refresh_ms);
+        if (filter[0]) {
+            printw("  filter: %s", filter);
+        }
+        mvprintw(2, 0, "%7s %-10s %s %6s %5s %8s %4s  %s", "PID", "USER", "S", "CPU%", "MEM%", "RSS", "THR", "COMMAND");
+        for (int i = start; i < shown && i - start < page; i++) {
+            const proc_info *p = &pt.procs[order[i]];
+            char rss[16];
+            format_size(rss, sizeof(rss), (double)p->rss);
+            if (i == selected) {
+                attron(A_REVERSE);
+            }
+            mvprintw(3 + i - start, 0, "%7d %-10.10s %c %6.1f %5.1f %8s %4d  %s", p->pid, p->user, p->state, p->cpu,
+                     pt.mem_total ? p->rss * 100.0 / pt.mem_total : 0, rss, p->threads, p->comm);
+            clrtoeol();
+            if (i == selected) {
+                attroff(A_REVERSE);
+            }
+        }
+        mvprintw(LINES - 3, 0, "Filter: text, user:NAME, cpu>N, rss>N[K|M|G]");
+        mvprintw(LINES - 2, 0, "UP/DOWN select  Sort(s)  Filter(/)  Interval(+/-)  Back(q)");
+        if (ui_status()[0]) {
+            mvprintw(LINES - 1, 0, "%s", ui_status());
+        }
+        refresh();
+
+        nodelay(stdscr, TRUE);
+        int ch = read_key();
+        nodelay(stdscr, FALSE);
+        if (ch == ERR) {
+            now = perf_now();
+            int timeout = next_refresh > now ? (int)((next_refresh - now) / 1000000) + 1 : 0;
+            ui_wait_events(NULL, 0, timeout);
+            ui_channel_drain();
+            continue;
+        }
+
+        if (list_move_key(ch, &selected, shown, page)) {
+            continue;
+        }
+        if (monitor_interval_key(ch)) {
+            next_refresh = perf_now() + (uint64_t)monitor_interval_ms * 1000000ULL;
+            continue;
+        }
+        if (ch == 'q' || ch == 'p') {
+            break;
+        } else if (ch == 's') {
+            sort_key = (sort_key + 1) % PROC_SORT_COUNT;
+        } else if (ch == '/') {
+            char input[sizeof(filter)] = "";
+            prompt_input("Filter (empty to clear): ", input, sizeof(input));
+            snprintf(filter, sizeof(filter), "%s", input);
+            selected = start = 0;
+        }
+    }
+    free(order);
+    proctable_free(&pt);
+}
+
+// 로그인 세션 화면 - who 를 실행하지 않고 utmp 를 직접 읽는다
+void display_sessions(void) {
+    session_info sessions[256];
+    char filter[SESSION_USER_LENGTH] = "";
+    int selected = 0;
+    uint64_t next_refresh = 0;
+    int count = 0;
+
+    while (1) {
+        uint64_t now = perf_now();
+        if (now >= next_refresh) {
+            count = sessions_read(session_source, sessions, 256);
+            next_refresh = now + (uint64_t)monitor_interval_ms * 1000000ULL;
+        }
+
+        clear();
+        mvprintw(0, 0, "===========================================");
+        mvprintw(1, 0, "Sessions (%s)  every %.2gs", session_source ? session_source : "utmp", monitor_interval_ms / 1000.0);
+        if (filter[0]) {
+            printw("  user: %s", filter);
+        }
+        mvprintw(2, 0, "%-12s %-10s %-16s %6s %7s  %s", "USER", "LINE", "LOGIN", "IDLE", "PID", "FROM");
+        int shown = 0;
+        if (count < 0) {
+            mvprintw(3, 0, "Cannot read %s", session_source ? session_source : "utmp");
+        }
+        for (int i = 0; i < count && shown < LINES - 7; i++) {
+            const session_info *s = &sessions[i];
+            if (filter[0] && strcmp(s->user, filter) != 0) {
+                continue;
+            }
+            char login[20] = "?", idle[24] = "?", pid[16] = "";
+            if (s->login) {
+                strftime(login, sizeof(login), "%Y-%m-%d %H:%M", localtime(&s->login));
+            }
+            if (s->idle >= 0) {
+                if (s->idle < 60) {
+                    snprintf(idle, sizeof(idle), ".");
+                } else if (s->idle >= 24 * 3600) { // w 처럼 하루가 넘으면 일 단위
+                    snprintf(idle, sizeof(idle), "%ldday", s->idle / (24 * 3600));
+                } else {
+                    snprintf(idle, sizeof(idle), "%ld:%02ld", s->idle / 3600, s->idle / 60 % 60);
+                }
+            }
+            if (s->pid) {
+                snprintf(pid, sizeof(pid), "%d", s->pid);
+            }
+            if (shown == selected) {
+                attron(A_REVERSE);
+            }
+            mvprintw(3 + shown, 0, "%-12s %-10s %-16s %6s %7s  %s", s->user, s->line, login, idle, pid, s->host);
+            clrtoeol();
+            if (shown == selected) {
+                attroff(A_REVERSE);
+            }
+            shown++;
+        }
+        if (count == 0) {
+            mvprintw(3, 0, "No sessions.");
+        }
+        mvprintw(LINES - 2, 0, "UP/DOWN select  Filter user(/)  Interval(+/-)  Back(q)");
+        refresh();
+
+        nodelay(stdscr, TRUE);
+        int ch = read_key();
+        nodelay(stdscr, FALSE);
+        if (ch == ERR) {
+            now = perf_now();
+            int timeout = next_refresh > now ? (int)((next_refresh - now) / 1000000) + 1 : 0;
+            ui_wait_events(NULL, 0, timeout);
+            ui_channel_drain();
+            continue;
+        }
+
+        if (list_move_key(ch, &selected, shown, LINES - 7) || monitor_interval_key(ch)) {
+            continue;
+        }
+        if (ch == 'q' || ch == 'w') {
+            break;
+        } else if (ch == '/') {
+            char input[sizeof(filter)] = "";
+            prompt_input("User (empty for all): ", input, sizeof(input));
+            snprintf(filter, sizeof(filter), "%s", input);
+            selected = 0;
+        }
+    }
+}
+
+// 재귀 검색 화면 - 결과는 화면을 나갔다 와도 남아 있어서 'f' 로 다시 돌아올 수 있다
+static char find_query_text[FIND_MAX_QUERY] = "";
+static int find_selected = 0;
+static uint64_t find_started = 0;   // 검색 시작 시각 (ns)
+static uint64_t find_finished = 0;  // 순회가 끝난 시각, 0 이면 아직
+static int find_stopped = 0;        // 'c' 로 중간에 멈춤
+
+// 새 검색어를 입력받아 검색을 시작한다. return 0 - 시작함, -1 - 취소 또는 오류
+static int find_prompt(const char *root) {
+    char input[FIND_MAX_QUERY] = "";
+    if (prompt_input("Find (name glob, size>N, mtime<Nd, type:f/d/l): ", input, sizeof(input)) != 0) {
+        return -1;
+    }
+    char error[128];
+    if (find_start(root, input, error, sizeof(error)) != 0) {
+        ui_post_status("Find: %s", error);
+        return -1;
+    }
+    snprintf(find_query_text, sizeof(find_query_text), "%s", input);
+    find_selected = 0;
+    find_started = perf_now();
+    find_finished = 0;
+    find_stopped = 0;
+    return 0;
+}
+
+// return 1 - target 에 선택한 결과의 전체 경로 (목록 화면에서 그 항목으로 이동), 0 - 그냥 돌아감
+int display_find(const char *root, char *target, size_t target_size) {
+    // root 가 이전 검색의 루트이거나 그 아래면 (결과로 이동했다가 돌아온 경우) 이전 결과를 그대로 보여준다
+    const char *prev = find_root();
+    size_t prev_len = prev ? strlen(prev) : 0;
+    int inside = prev && strncmp(root, prev, prev_len) == 0 &&
+                 (root[prev_len] == '\0' || root[prev_len] == '/' || prev[prev_len - 1] == '/');
+    if (!inside && find_prompt(root) != 0) {
+        return 0;
+    }
+    int start = 0;
+    find_result r;
+
+    while (1) {
+        const char *base = find_root();
+        if (!base) { // 새 검색을 시작하지 못해서 이전 결과도 없다
+            return 0;
+        }
+        long long scanned = 0, total = 0;
+        int running = find_running(&scanned);
+        if (!running && !find_finished) {
+            find_finished = perf_now();
+        }
+        int count = find_count(&total);
+        int page = LINES - 7;
+        if (find_selected >= count) {
+            find_selected = count > 0 ? count - 1 : 0;
+        }
+        if (find_selected < start) {
+            start = find_selected;
+        } else if (find_selected >= start + page) {
+            start = find_selected - page + 1;
+        }
+
+        clear();
+        mvprintw(0, 0, "===========================================");
+        uint64_t end = find_finished ? find_finished : perf_now();
+        mvprintw(1, 0, "Find in %s: %s  -  %lld found, %lld dirs, %.1fs %s", base, find_query_text, total,
+                 scanned, (end - find_started) / 1e9, running ? "[searching]" : find_stopped ? "[stopped]" : "[done]");
+        if (total > count) {
+            printw(" (first %d listed)", count);
+        }
+        mvprintw(2, 0, "%10s %-16s  %s", "Size", "Modified", "Path");
+        for (int i = start; i < count && i - start < page; i++) {
+            if (find_get(i, &r) != 0) {
+                break;
+            }
+            char size[16] = "?", when[20] = "?", path[1024];
+            if (S_ISDIR(r.mode)) {
+                snprintf(size, sizeof(size), "DIR");
+            } else if (r.size >= 0) {
+                format_size(size, sizeof(size), (double)r.size);
+            }
+            if (r.mtime) {
+                strftime(when, sizeof(when), "%Y-%m-%d %H:%M", localtime(&r.mtime));
+            }
+            layout_trimmed(path, sizeof(path), r.path, COLS > 30 ? COLS - 29 : 1);
+            attr_t attr = S_ISDIR(r.mode) ? COLOR_PAIR(1) : A_NORMAL;
+            if (i == find_selected) {
+                attr |= A_REVERSE;
+            }
+            attron(attr);
+            mvprintw(3 + i - start, 0, "%10s %-16s  %s", size, when, path);
+            clrtoeol();
+            attroff(attr);
+        }
+        if (count == 0) {
+            mvprintw(3, 0, running ? "Searching..." : "No matches.");
+        }
+        mvprintw(LINES - 2, 0, "UP/DOWN select  Go to(Enter)  View(Space)  New search(/)  Stop(c)  Back(q)");
+        if (ui_status()[0]) {
+            mvprintw(LINES - 1, 0, "%s", ui_status());
+        }
+        refresh();
+
+        nodelay(stdscr, TRUE);
+        int ch = read_key();
+        nodelay(stdscr, FALSE);
+        if (ch == ERR) {
+            ui_wait_events(NULL, 0, running ? 500 : -1); // 결과가 없는 동안에도 진행 상황 갱신
+            ui_channel_drain();
+            continue;
+        }
+
+        if (list_move_key(ch, &find_selected, count, page)) {
+            continue;
+        }
+        if (ch == 'q' || ch == 'f') {
+            return 0;
+        } else if (ch == 'c' && running) {
+            find_cancel();
+            find_stopped = 1;
+        } else if (ch == '/') { // 지금 디렉토리에서 새로 검색
+            find_prompt(root);
+            start = 0;
+        } else if ((ch == '\n' || ch == KEY_ENTER || ch == ' ') && find_get(find_selected, &r) == 0) {
+            const char *sep = base[0] && base[strlen(base) - 1] == '/' ? "" : "/";
+            if (snprintf(target, target_size, "%s%s%s", base, sep, r.path) >= (int)target_size) {
+                ui_post_status("Path too long: %.200s...", r.path);
+                continue;
+            }
+            if (ch == ' ' && S_ISREG(r.mode)) {
+                display_file(target);
+                continue;
+            }
+            return 1;
+        }
+    }
+}
+
+// 중복 파일 화면 - 결과는 화면을 나갔다 와도 남아 있어서 'D' 로 다시 돌아올 수 있다
+static int dup_selected = 0;
+static uint64_t dup_started = 0;   // 검색 시작 시각 (ns)
+static uint64_t dup_finished = 0;  // 끝난 시각, 0 이면 아직
+
+static void dup_begin(const char *root) {
+    if (dup_start(root) != 0) {
+        ui_post_status("Duplicates: cannot open %s", root);
+        return;
+    }
+    dup_selected = 0;
+    dup_started = perf_now();
+    dup_finished = 0;
+}
+
+// 묶음마다 가장 오래된 하나만 남기고 선택 표시한다
+static void dup_mark_all(dup_group *groups, int group_count, dup_file *files) {
+    for (int g = 0; g < group_count; g++) {
+        int kept = 0;
+        for (int i = groups[g].first; i < groups[g].first + groups[g].count; i++) {
+            if (files[i].removed) {
+                continue;
+            }
+            if (!kept) {
+                kept = 1;
+                if (is_marked(files[i].path)) {
+                    toggle_mark(files[i].path);
+                }
+            } else if (!is_marked(files[i].path)) {
+                toggle_mark(files[i].path);
+            }
+        }
+    }
+}
+
+// 선택 표시한 중복 파일을 지운다. 묶음의 모든 파일이 선택되었으면 그 묶음은 건너뛴다
+// 지우기 직전에 남는 사본 하나와 바이트 단위로 비교해서, 어느 쪽이든 바뀌었거나 내용이 다르면 지우지 않는다
+static void dup_delete_marked(dup_group *groups, int group_count, dup_file *files) {
+    int deleted = 0, skipped = 0, failed = 0;
+    long long freed = 0;
+    for (int g = 0; g < group_count; g++) {
+        int first = groups[g].first, end = first + groups[g].count;
+        int keep = 0;
+        for (int i = first; i < end; i++) {
+            keep += !files[i].removed && !is_marked(files[i].path);
+        }
+        for (int i = first; i < end; i++) {
+            if (files[i].removed || !is_marked(files[i].path)) {
+                continue;
+            }
+            if (!keep) { // 하나는 남긴다
+                skipped++;
+                continue;
+            }
+            int verified = 0;
+            for (int k = first; k < end && !verified; k++) {
+                if (k != i && !files[k].removed && !is_marked(files[k].path)) {
+                    verified = dup_same_content(&files[i], &files[k]);
+                }
+            }
+            if (!verified) {
+                skipped++;
+                continue;
+            }
+            if (unlink(files[i].path) != 0) {
+                failed++;
+                continue;
+            }
+            toggle_mark(files[i].path);
+            files[i].removed = 1;
+            freed += files[i].size;
+            deleted++;
+        }
+    }
+    char size[16];
+    format_size(size, sizeof(size), (double)freed);
+    ui_post_status("Deleted %d file(s), %s freed%s%s", deleted, size, skipped ? " (some skipped: changed or last copy)" : "",
+                   failed ? " (some failed)" : "");
+}
+
+void display_duplicates(const char *root) {
+    // root 가 이전 검색의 루트와 같으면 이전 결과를 그대로 보여준다
+    const char *prev = dup_root();
+    if (!prev || strcmp(prev, root) != 0) {
+        dup_begin(root);
+    }
+    int start = 0;
+    int *rows = NULL; // 화면의 줄 - 0 이상은 파일 번호, 음수는 -(묶음 번호 + 1)
+    int row_capacity = 0;
+
+    while (1) {
+        dup_progress p;
+        dup_get_progress(&p);
+        int running = p.state < DUP_DONE && dup_root();
+        if (!running && !dup_finished) {
+            dup_finished = perf_now();
+        }
+        dup_group *groups = NULL;
+        dup_file *files = NULL;
+        int group_count = dup_results(&groups, &files);
+
+        // 묶음 머리줄과 파일 줄
+        int row_count = 0;
+        long long marked_bytes = 0;
+        int marked = 0;
+        if (group_count > 0 && row_capacity < group_count + groups[group_count - 1].first + groups[group_count - 1].count) {
+            row_capacity = group_count + groups[group_count - 1].first + groups[group_count - 1].count;
+            int *r = realloc(rows, row_capacity * sizeof(int));
+            if (!r) {
+                break;
+            }
+            rows = r;
+        }
+        for (int g = 0; g < group_count; g++) {
+            rows[row_count++] = -(g + 1);
+            for (int i = groups[g].first; i < groups[g].first + groups[g].count; i++) {
+                rows[row_count++] = i;
+                if (!files[i].removed && is_marked(files[i].path)) {
+                    marked++;
+                    marked_bytes += files[i].size;
+                }
+            }
+        }
+
+        int page = LINES - 8;
+        if (dup_selected >= row_count) {
+            dup_selected = row_count > 0 ? row_count - 1 : 0;
+        }
+        if (dup_selected < start) {
+            start = dup_selected;
+        } else if (dup_selected >= start + page) {
+            start = dup_selected - page + 1;
+        }
+
+        clear();
+        mvprintw(0, 0, "===========================================");
+        uint64_t end = dup_finished ? dup_finished : perf_now();
+        char read_size[16], reclaim[16], marked_size[16];
+        format_size(read_size, sizeof(read_size), (double)p.bytes_read);
+        format_size(reclaim, sizeof(reclaim), (double)p.reclaimable);
+        format_size(marked_size, sizeof(marked_size), (double)marked_bytes);
+        mvprintw(1, 0, "Duplicates in %s  -  %lld files, %s read, %.1fs ", dup_root() ? dup_root() : root, p.files, read_size,
+                 (end - dup_started) / 1e9);
+        switch (p.state) {
+            case DUP_SCANNING: printw("[scanning]"); break;
+            case DUP_PARTIAL: printw("[partial hash %lld/%lld]", p.hashed, p.candidates); break;
+            case DUP_FULL: printw("[full hash %lld/%lld]", p.hashed, p.candidates); break;
+            case DUP_DONE: printw("[done]"); break;
+            default: printw("[stopped]"); break;
+        }
+        if (p.state == DUP_DONE) {
+            mvprintw(2, 0, "%lld groups, %s reclaimable, %d marked (%s)", p.groups, reclaim, marked, marked_size);
+        }
+        if (p.errors) {
+            printw(", %d unreadable", p.errors);
+        }
+        for (int i = start; i < row_count && i - start < page; i++) {
+            char size[16], when[20], path[1024];
+            attr_t attr = i == dup_selected ? A_REVERSE : A_NORMAL;
+            attron(attr);
+            if (rows[i] < 0) {
+                dup_group *g = &groups[-rows[i] - 1];
+                format_size(size, sizeof(size), (double)g->size);
+                format_size(reclaim, sizeof(reclaim), (double)g->size * (g->count - 1));
+                mvprintw(3 + i - start, 0, "-- %d copies of %s, %s reclaimable", g->count, size, reclaim);
+            } else {
+                dup_file *f = &files[rows[i]];
+                strftime(when, sizeof(when), "%Y-%m-%d %H:%M", localtime(&f->mtime));
+                layout_trimmed(path, sizeof(path), f->path, COLS > 24 ? COLS - 23 : 1);
+                mvprintw(3 + i - start, 0, "  %c %-16s  %s", f->removed ? '-' : is_marked(f->path) ? '*' : ' ', when, path);
+            }
+            clrtoeol();
+            attroff(attr);
+        }
+        if (row_count == 0) {
+            mvprintw(3, 0, running ? "Searching..." : p.state == DUP_DONE ? "No duplicates." : "Stopped.");
+        }
+        mvprintw(LINES - 3, 0, "Mark(m/Space)  Mark all but oldest(a)  Unmark(u)  Cut marked(x)  Delete marked(d)");
+        mvprintw(LINES - 2, 0, "UP/DOWN select  View(Enter)  Rescan(r)  Stop(c)  Back(q)");
+        if (ui_status()[0]) {
+            mvprintw(LINES - 1, 0, "%s", ui_status());
+        }
+        refresh();
+
+        nodelay(stdscr, TRUE);
+        int ch = read_key();
+        nodelay(stdscr, FALSE);
+        if (ch == ERR) {
+            ui_wait_events(NULL, 0, running ? 500 : -1); // 진행 상황 갱신
+            ui_channel_drain();
+            continue;
+        }
+
+        if (list_move_key(ch, &dup_selected, row_count, page)) {
+            continue;
+        }
+        dup_file *current = row_count > 0 && rows[dup_selected] >= 0 ? &files[rows[dup_selected]] : NULL;
+        if (ch == 'q' || ch == 'D') {
+            break;
+        } else if (ch == 'c' && running) {
+            dup_cancel();
+        } else if (ch == 'r') {
+            dup_begin(root);
+            start = 0;
+        } else if ((ch == 'm' || ch == ' ') && current && !current->removed) {
+            toggle_mark(current->path);
+            if (dup_selected < row_count - 1) {
+                dup_selected++;
+            }
+        } else if (ch == 'a' && group_count > 0) {
+            dup_mark_all(groups, group_count, files);
+        } else if (ch == 'u') {
+            for (int i = 0; i < row_count; i++) {
+                if (rows[i] >= 0 && is_marked(files[rows[i]].path)) {
+                    toggle_mark(files[rows[i]].path);
+                }
+            }
+        } else if (ch == 'x' && marked > 0) {
+            // 다른 화면에서 표시한 파일도 함께 클립보드로 간다 (목록 화면과 같은 동작)
+            for (int i = 0; i < row_count; i++) {
+                if (rows[i] >= 0 && !files[rows[i]].removed && is_marked(files[rows[i]].path)) {
+                    files[rows[i]].removed = 1;
+                }
+            }
+            set_clipboard_cut(NULL);
+        } else if (ch == 'd' && marked > 0) {
+            char answer[8] = "";
+            char label[96];
+            snprintf(label, sizeof(label), "Delete %d marked file(s), %s? (y/N): ", marked, marked_size);
+            prompt_input(label, answer, sizeof(answer));
+            if (answer[0] == 'y' || answer[0] == 'Y') {
+                dup_delete_marked(groups, group_count, files);
+            }
+        } else if ((ch == '\n' || ch == KEY_ENTER) && current) {
+            display_file(current->path);
         }
     }
+    free(rows);
 }
@@ -0,0 +1,642 @@
+#define _GNU_SOURCE // O_NOATIME
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#include "dupfind.h"
+#include "walker.h"
+#include "uichannel.h"
+
+#define DUP_BLOCK_SIZE (1024 * 1024) // 경로 문자열 블록 크기
+#define DUP_REDRAW_INTERVAL_MS 100
+
+// 순회에서 찾은 일반 파일 하나
+typedef struct {
+    const char *path;
+    long long size;
+    dev_t dev;
+    ino_t ino;
+    time_t mtime;
+    hash128 hash;     // 지금 단계까지의 해시 (부분 또는 전체)
+    int complete;     // 1 - hash 가 파일 전체의 해시 (작은 파일은 부분 단계에서 끝남)
+    int failed;       // 읽기 실패 - 후보에서 뺀다
+} dup_entry;
+
+// 경로 문자열 블록. 옮기지 않으므로 dup_entry/dup_file 의 포인터가 계속 유효하다
+typedef struct dup_block {
+    struct dup_block *next;
+    size_t used;
+    char data[];
+} dup_block;
+
+static pthread_mutex_t dup_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t scan_cond = PTHREAD_COND_INITIALIZER;
+static walker *scan_walker = NULL;   // dup_lock - 순회가 끝나면 작업 스레드가 해제
+static int scan_finished = 0;        // dup_lock
+static volatile int cancelled = 0;
+static pthread_t worker;
+static int worker_started = 0;
+static char root_path[4096];
+static int has_root = 0;
+static dup_progress progress;        // 개수는 __atomic, state 는 dup_lock
+
+static dup_entry *entries = NULL;    // 순회 중에는 dup_lock
+static int entry_count = 0;
+static int entry_capacity = 0;
+static dup_block *blocks = NULL;
+
+static dup_file *result_files = NULL;
+static dup_group *result_groups = NULL;
+static int result_group_count = 0;
+
+static long long dup_last_redraw_ms = 0;
+
+static long long now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000LL + ts.tv_nsec / 1000000;
+}
+
+// 너무 자주 화면을 다시 그리지 않도록 간격을 둔다 (작업 스레드에서 호출)
+static void dup_post_redraw(int force) {
+    long long now = now_ms();
+    long long last = __atomic_load_n(&dup_last_redraw_ms, __ATOMIC_RELAXED);
+    if (!force && now - last < DUP_REDRAW_INTERVAL_MS) {
+        return;
+    }
+    if (__atomic_compare_exchange_n(&dup_last_redraw_ms, &last, now, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED) || force) {
+        ui_post_redraw();
+    }
+}
+
+static void set_state(int state) {
+    pthread_mutex_lock(&dup_lock);
+    progress.state = state;
+    pthread_mutex_unlock(&dup_lock);
+    dup_post_redraw(1);
+}
+
+// 경로를 블록에 복사한다 (호출 전에 dup_lock). return NULL - 메모리 부족
+static const char *store_path(const char *path, size_t len) {
+    if (!blocks || blocks->used + len + 1 > DUP_BLOCK_SIZE) {
+        dup_block *b = malloc(sizeof(dup_block) + DUP_BLOCK_SIZE);
+        if (!b) {
+            return NULL;
+        }
+        b->next = blocks;
+        b->used = 0;
+        blocks = b;
+    }
+    char *p = blocks->data + blocks->used;
+    memcpy(p, path, len + 1);
+    blocks->used += len + 1;
+    return p;
+}
+
+static void dup_visit(walker *w, walk_node *parent, const char *name, const struct stat *st, void *ctx) {
+    (void)w;
+    (void)ctx;
+    if (!S_ISREG(st->st_mode) || st->st_size == 0) { // 빈 파일은 모두 같으므로 지워도 얻는 공간이 없다
+        return;
+    }
+    char path[4096];
+    if (walk_node_path(parent, path, sizeof(path)) < 0) {
+        return;
+    }
+    char joined[4096];
+    size_t path_len = strlen(path);
+    int len = snprintf(joined, sizeof(joined), "%s%s%s", path, path_len && path[path_len - 1] == '/' ? "" : "/", name);
+    if (len < 0 || len >= (int)sizeof(joined)) {
+        return;
+    }
+
+    pthread_mutex_lock(&dup_lock);
+    if (entry_count == entry_capacity) {
+        int new_capacity = entry_capacity ? entry_capacity * 2 : 4096;
+        dup_entry *p = realloc(entries, new_capacity * sizeof(dup_entry));
+        if (p) {
+            entries = p;
+            entry_capacity = new_capacity;
+        }
+    }
+    const char *stored = entry_count < entry_capacity ? store_path(joined, len) : NULL;
+    if (stored) {
+        dup_entry *e = &entries[entry_count++];
+        memset(e, 0, sizeof(*e));
+        e->path = stored;
+        e->size = st->st_size;
+        e->dev = st->st_dev;
+        e->ino = st->st_ino;
+        e->mtime = st->st_mtime;
+        progress.files++;
+    }
+    pthread_mutex_unlock(&dup_lock);
+    dup_post_redraw(0);
+}
+
+static void dup_leave(walker *w, walk_node *node, void *ctx) {
+    (void)w;
+    (void)ctx;
+    if (node->depth == 0) { // 순회 끝
+        pthread_mutex_lock(&dup_lock);
+        scan_finished = 1;
+        pthread_cond_broadcast(&scan_cond);
+        pthread_mutex_unlock(&dup_lock);
+    }
+}
+
+static const walk_ops dup_ops = { NULL, dup_visit, dup_leave, 0 };
+
+// ---- 해시 ----
+
+// fd 의 [offset, offset+len) 을 hs 에 더한다
+// 순차 읽기 힌트를 주고, 다음 청크는 미리 읽기를 요청하고, 읽은 청크는 페이지 캐시에서 내보낸다
+// (수백 GB 를 읽는 동안 다른 프로그램의 캐시를 밀어내지 않도록)
+// return 0 - 성공, -1 - 읽기 실패 또는 취소
+static int hash_range(int fd, off_t offset, long long len, hash_state *hs, char *buf) {
+    while (len > 0) {
+        if (cancelled) {
+            return -1;
+        }
+        size_t want = len < DUP_READ_CHUNK ? (size_t)len : DUP_READ_CHUNK;
+        if (len > DUP_READ_CHUNK) {
+            posix_fadvise(fd, offset + DUP_READ_CHUNK, DUP_READ_CHUNK, POSIX_FADV_WILLNEED);
+        }
+        ssize_t n = pread(fd, buf, want, offset);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) { // 그 사이 파일이 줄어듦
+            return -1;
+        }
+        hash_update(hs, buf, n);
+        posix_fadvise(fd, offset, n, POSIX_FADV_DONTNEED);
+        __atomic_add_fetch(&progress.bytes_read, n, __ATOMIC_RELAXED);
+        offset += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static int open_noatime(const char *path, int flags) {
+    int fd = open(path, O_RDONLY | O_NOATIME | O_CLOEXEC | flags);
+    if (fd < 0 && errno == EPERM) { // O_NOATIME 은 소유자만 쓸 수 있다
+        fd = open(path, O_RDONLY | O_CLOEXEC | flags);
+    }
+    return fd;
+}
+
+// full 이 0 이면 앞/뒤 블록만 (둘을 합한 것보다 작은 파일은 전체를 읽고 complete 로 표시)
+static void hash_entry(dup_entry *e, int full, char *buf) {
+    int fd = open_noatime(e->path, 0);
+    if (fd < 0) {
+        e->failed = 1;
+        return;
+    }
+    hash_state hs;
+    hash_init(&hs);
+    int rc;
+    if (full || e->size <= 2 * DUP_PARTIAL_BLOCK) {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        rc = hash_range(fd, 0, e->size, &hs, buf);
+        e->complete = 1;
+    } else {
+        rc = hash_range(fd, 0, DUP_PARTIAL_BLOCK, &hs, buf);
+        if (rc == 0) {
+            rc = hash_range(fd, e->size - DUP_PARTIAL_BLOCK, DUP_PARTIAL_BLOCK, &hs, buf);
+        }
+    }
+    close(fd);
+    if (rc < 0) {
+        e->failed = 1;
+        return;
+    }
+    e->hash = hash_final(&hs);
+}
+
+typedef struct {
+    dup_entry **work;
+    int count;
+    int next;   // __atomic
+    int full;
+} hash_job;
+
+static void *hash_thread(void *arg) {
+    hash_job *job = arg;
+    char *buf = malloc(DUP_READ_CHUNK);
+    if (!buf) {
+        return NULL;
+    }
+    while (!cancelled) {
+        int idx = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED);
+        if (idx >= job->count) {
+            break;
+        }
+        dup_entry *e = job->work[idx];
+        hash_entry(e, job->full, buf);
+        if (e->failed && !cancelled) {
+            __atomic_add_fetch(&progress.errors, 1, __ATOMIC_RELAXED);
+        }
+        __atomic_add_fetch(&progress.hashed, 1, __ATOMIC_RELAXED);
+        dup_post_redraw(0);
+    }
+    free(buf);
+    return NULL;
+}
+
+// 디스크 위치에 가깝도록 inode 순으로 읽는다
+static int compare_inode(const void *a, const void *b) {
+    const dup_entry *x = *(dup_entry *const *)a, *y = *(dup_entry *const *)b;
+    if (x->dev != y->dev) {
+        return x->dev < y->dev ? -1 : 1;
+    }
+    return x->ino < y->ino ? -1 : x->ino > y->ino;
+}
+
+// work 의 파일들을 스레드 풀에서 해시한다 (작업 스레드)
+static void hash_all(dup_entry **work, int count, int full) {
+    __atomic_store_n(&progress.candidates, count, __ATOMIC_RELAXED);
+    __atomic_store_n(&progress.hashed, 0, __ATOMIC_RELAXED);
+    if (count == 0) {
+        return;
+    }
+    dup_entry **order = malloc(count * sizeof(dup_entry *));
+    if (!order) {
+        cancelled = 1;
+        return;
+    }
+    memcpy(order, work, count * sizeof(dup_entry *));
+    qsort(order, count, sizeof(dup_entry *), compare_inode);
+
+    hash_job job = { order, count, 0, full };
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int thread_count = cpus > 0 ? (int)cpus * 2 : DUP_MIN_THREADS;
+    if (thread_count < DUP_MIN_THREADS) {
+        thread_count = DUP_MIN_THREADS;
+    }
+    if (thread_count > DUP_MAX_THREADS) {
+        thread_count = DUP_MAX_THREADS;
+    }
+    if (thread_count > count) {
+        thread_count = count;
+    }
+    pthread_t threads[DUP_MAX_THREADS];
+    int started = 0;
+    for (int i = 0; i < thread_count; i++) {
+        if (pthread_create(&threads[started], NULL, hash_thread, &job) == 0) {
+            started++;
+        }
+    }
+    if (started == 0) {
+        hash_thread(&job);
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(order);
+}
+
+// ---- 묶기 ----
+
+static int compare_size_inode(const void *a, const void *b) {
+    const dup_entry *x = *(dup_entry *const *)a, *y = *(dup_entry *const *)b;
+    if (x->size != y->size) {
+        return x->size < y->size ? -1 : 1;
+    }
+    return compare_inode(a, b);
+}
+
+static int compare_size_hash(const void *a, const void *b) {
+    const dup_entry *x = *(dup_entry *const *)a, *y = *(dup_entry *const *)b;
+    if (x->size != y->size) {
+        return x->size < y->size ? -1 : 1;
+    }
+    if (x->hash.hi != y->hash.hi) {
+        return x->hash.hi < y->hash.hi ? -1 : 1;
+    }
+    if (x->hash.lo != y->hash.lo) {
+        return x->hash.lo < y->hash.lo ? -1 : 1;
+    }
+    return x->mtime < y->mtime ? -1 : x->mtime > y->mtime; // 묶음 안에서는 오래된 순
+}
+
+static int same_group(const dup_entry *a, const dup_entry *b, int by_hash) {
+    return a->size == b->size && (!by_hash || hash_equal(a->hash, b->hash));
+}
+
+// 정렬된 list 에서 같은 묶음이 둘 이상인 것만 남긴다 (읽기 실패는 뺀다). return 남은 수
+static int keep_collisions(dup_entry **list, int count, int by_hash) {
+    int kept = 0;
+    for (int i = 0; i < count;) {
+        int j = i + 1;
+        while (j < count && same_group(list[i], list[j], by_hash)) {
+            j++;
+        }
+        int ok = 0;
+        for (int k = i; k < j; k++) {
+            ok += !list[k]->failed;
+        }
+        if (ok >= 2) {
+            for (int k = i; k < j; k++) {
+                if (!list[k]->failed) {
+                    list[kept++] = list[k];
+                }
+            }
+        }
+        i = j;
+    }
+    return kept;
+}
+
+typedef struct {
+    long long reclaim;
+    int first;
+    int count;
+} group_span;
+
+static int compare_reclaim(const void *a, const void *b) {
+    const group_span *x = a, *y = b;
+    if (x->reclaim != y->reclaim) {
+        return x->reclaim > y->reclaim ? -1 : 1;
+    }
+    return x->first - y->first;
+}
+
+// 해시가 끝난 후보로 결과를 만든다 (list 는 크기/해시/시각 순)
+static void build_results(dup_entry **list, int count) {
+    int group_count = 0;
+    for (int i = 0; i < count;) {
+        int j = i + 1;
+        while (j < count && same_group(list[i], list[j], 1)) {
+            j++;
+        }
+        group_count++;
+        i = j;
+    }
+    group_span *spans = malloc((group_count ? group_count : 1) * sizeof(group_span));
+    dup_file *files = malloc((count ? count : 1) * sizeof(dup_file));
+    dup_group *groups = malloc((group_count ? group_count : 1) * sizeof(dup_group));
+    if (!spans || !files || !groups) {
+        free(spans);
+        free(files);
+        free(groups);
+        return;
+    }
+    long long reclaimable = 0;
+    int g = 0;
+    for (int i = 0; i < count;) {
+        int j = i + 1;
+        while (j < count && same_group(list[i], list[j], 1)) {
+            j++;
+        }
+        spans[g].first = i;
+        spans[g].count = j - i;
+        spans[g].reclaim = (long long)(j - i - 1) * list[i]->size;
+        reclaimable += spans[g].reclaim;
+        g++;
+        i = j;
+    }
+    qsort(spans, group_count, sizeof(group_span), compare_reclaim);
+
+    int pos = 0;
+    for (g = 0; g < group_count; g++) {
+        groups[g].first = pos;
+        groups[g].count = spans[g].count;
+        groups[g].size = list[spans[g].first]->size;
+        for (int k = 0; k < spans[g].count; k++) {
+            dup_entry *e = list[spans[g].first + k];
+            dup_file *f = &files[pos++];
+            f->path = e->path;
+            f->size = e->size;
+            f->mtime = e->mtime;
+            f->group = g;
+            f->removed = 0;
+        }
+    }
+    free(spans);
+
+    pthread_mutex_lock(&dup_lock);
+    result_files = files;
+    result_groups = groups;
+    result_group_count = group_count;
+    progress.groups = group_count;
+    progress.reclaimable = reclaimable;
+    pthread_mutex_unlock(&dup_lock);
+}
+
+static void *dup_thread(void *arg) {
+    (void)arg;
+    // 순회가 끝나기를 기다린다 (leave 가 불리지 않는 경우에 대비해 가끔 직접 확인)
+    pthread_mutex_lock(&dup_lock);
+    while (!scan_finished && !cancelled && !walker_done(scan_walker)) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += 100 * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&scan_cond, &dup_lock, &deadline);
+    }
+    walker *w = scan_walker;
+    scan_walker = NULL;
+    pthread_mutex_unlock(&dup_lock);
+    walker_free(w);
+
+    // 1. 크기가 같은 파일 (같은 inode 는 하나만 - 하드 링크는 지워도 공간이 생기지 않는다)
+    dup_entry **list = malloc((entry_count ? entry_count : 1) * sizeof(dup_entry *));
+    if (!list || cancelled) {
+        free(list);
+        set_state(DUP_CANCELLED);
+        return NULL;
+    }
+    int count = 0;
+    for (int i = 0; i < entry_count; i++) {
+        list[count++] = &entries[i];
+    }
+    qsort(list, count, sizeof(dup_entry *), compare_size_inode);
+    int unique = 0;
+    for (int i = 0; i < count; i++) {
+        if (unique > 0 && list[unique - 1]->dev == list[i]->dev && list[unique - 1]->ino == list[i]->ino) {
+            continue;
+        }
+        list[unique++] = list[i];
+    }
+    count = keep_collisions(list, unique, 0);
+
+    // 2. 앞/뒤 블록 해시
+    set_state(DUP_PARTIAL);
+    hash_all(list, count, 0);
+    if (!cancelled) {
+        qsort(list, count, sizeof(dup_entry *), compare_size_hash);
+        count = keep_collisions(list, count, 1);
+    }
+
+    // 3. 아직 같은 후보 중 전체를 읽지 않은 파일만 전체 해시
+    if (!cancelled) {
+        set_state(DUP_FULL);
+        int pending = 0;
+        dup_entry **work = malloc((count ? count : 1) * sizeof(dup_entry *));
+        if (work) {
+            for (int i = 0; i < count; i++) {
+                if (!list[i]->complete) {
+                    work[pending++] = list[i];
+                }
+            }
+            hash_all(work, pending, 1);
+            free(work);
+        } else {
+            cancelled = 1;
+        }
+    }
+    if (!cancelled) {
+        qsort(list, count, sizeof(dup_entry *), compare_size_hash);
+        count = keep_collisions(list, count, 1);
+        build_results(list, count);
+    }
+    free(list);
+    set_state(cancelled ? DUP_CANCELLED : DUP_DONE);
+    return NULL;
+}
+
+static void clear_results(void) {
+    free(entries);
+    entries = NULL;
+    entry_count = entry_capacity = 0;
+    while (blocks) {
+        dup_block *b = blocks;
+        blocks = b->next;
+        free(b);
+    }
+    free(result_files);
+    free(result_groups);
+    result_files = NULL;
+    result_groups = NULL;
+    result_group_count = 0;
+    memset(&progress, 0, sizeof(progress));
+}
+
+int dup_start(const char *root) {
+    dup_stop();
+    snprintf(root_path, sizeof(root_path), "%s", root);
+    cancelled = 0;
+    scan_finished = 0;
+    progress.state = DUP_SCANNING;
+    walker *w = walker_start(root_path, &dup_ops, NULL, 0, 1);
+    if (!w) {
+        return -1;
+    }
+    pthread_mutex_lock(&dup_lock);
+    scan_walker = w;
+    pthread_mutex_unlock(&dup_lock);
+    if (pthread_create(&worker, NULL, dup_thread, NULL) != 0) {
+        walker_free(w);
+        scan_walker = NULL;
+        return -1;
+    }
+    worker_started = 1;
+    has_root = 1;
+    return 0;
+}
+
+void dup_cancel(void) {
+    if (!worker_started) {
+        return;
+    }
+    pthread_mutex_lock(&dup_lock);
+    cancelled = 1;
+    if (scan_walker) {
+        walker_cancel(scan_walker);
+    }
+    pthread_cond_broadcast(&scan_cond);
+    pthread_mutex_unlock(&dup_lock);
+    pthread_join(worker, NULL); // 해시 중인 파일은 청크 단위로 멈춘다
+    worker_started = 0;
+}
+
+void dup_stop(void) {
+    dup_cancel();
+    clear_results();
+    has_root = 0;
+}
+
+void dup_get_progress(dup_progress *p) {
+    pthread_mutex_lock(&dup_lock);
+    p->state = progress.state;
+    p->files = progress.files;
+    p->groups = progress.groups;
+    p->reclaimable = progress.reclaimable;
+    pthread_mutex_unlock(&dup_lock);
+    p->candidates = __atomic_load_n(&progress.candidates, __ATOMIC_RELAXED);
+    p->hashed = __atomic_load_n(&progress.hashed, __ATOMIC_RELAXED);
+    p->bytes_read = __atomic_load_n(&progress.bytes_read, __ATOMIC_RELAXED);
+    p->errors = __atomic_load_n(&progress.errors, __ATOMIC_RELAXED);
+}
+
+const char *dup_root(void) {
+    return has_root ? root_path : NULL;
+}
+
+int dup_results(dup_group **groups, dup_file **files) {
+    pthread_mutex_lock(&dup_lock);
+    int done = progress.state == DUP_DONE;
+    pthread_mutex_unlock(&dup_lock);
+    if (!done || !result_files) {
+        return 0;
+    }
+    *groups = result_groups;
+    *files = result_files;
+    return result_group_count;
+}
+
+// ---- 지우기 전 확인 ----
+
+// 열린 fd 가 결과에 기록된 그대로의 일반 파일인지
+static int unchanged(int fd, const dup_file *f, struct stat *st) {
+    return fstat(fd, st) == 0 && S_ISREG(st->st_mode) && st->st_size == f->size && st->st_mtime == f->mtime;
+}
+
+int dup_same_content(const dup_file *a, const dup_file *b) {
+    int same = 0;
+    char *buf_a = NULL, *buf_b = NULL;
+    int fd_a = open_noatime(a->path, O_NOFOLLOW);
+    int fd_b = open_noatime(b->path, O_NOFOLLOW);
+    struct stat st_a, st_b;
+    if (fd_a < 0 || fd_b < 0 || !unchanged(fd_a, a, &st_a) || !unchanged(fd_b, b, &st_b) ||
+        (st_a.st_dev == st_b.st_dev && st_a.st_ino == st_b.st_ino)) { // 같은 inode 면 지우는 순간 마지막 사본
+        goto out;
+    }
+    buf_a = malloc(DUP_READ_CHUNK);
+    buf_b = malloc(DUP_READ_CHUNK);
+    if (!buf_a || !buf_b) {
+        goto out;
+    }
+    posix_fadvise(fd_a, 0, 0, POSIX_FADV_SEQUENTIAL);
+    posix_fadvise(fd_b, 0, 0, POSIX_FADV_SEQUENTIAL);
+    off_t offset = 0;
+    while (offset < a->size) {
+        size_t want = a->size - offset < DUP_READ_CHUNK ? (size_t)(a->size - offset) : DUP_READ_CHUNK;
+        ssize_t n_a = pread(fd_a, buf_a, want, offset);
+        ssize_t n_b = pread(fd_b, buf_b, want, offset);
+        if (n_a <= 0 || n_a != n_b || memcmp(buf_a, buf_b, n_a) != 0) {
+            goto out;
+        }
+        offset += n_a;
+    }
+    same = 1;
+out:
+    free(buf_a);
+    free(buf_b);
+    if (fd_a >= 0) {
+        close(fd_a);
+    }
+    if (fd_b >= 0) {
+        close(fd_b);
+    }
+    return same;
+}
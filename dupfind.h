@@ -0,0 +1,77 @@
+#ifndef __DUPFIND__
+#define __DUPFIND__
+
+#include <time.h>
+#include <sys/types.h>
+
+#include "hash.h"
+
+#define DUP_PARTIAL_BLOCK (64 * 1024)  // 부분 해시에 쓰는 앞/뒤 블록 크기
+#define DUP_READ_CHUNK (1024 * 1024)   // 전체 해시의 read 단위
+#define DUP_MIN_THREADS 2              // 해시 스레드 수 - 코어 수의 두 배를 이 범위로
+#define DUP_MAX_THREADS 8
+
+// 진행 단계
+#define DUP_SCANNING 0  // 트리 순회 - 크기 수집
+#define DUP_PARTIAL 1   // 같은 크기 후보의 앞/뒤 블록 해시
+#define DUP_FULL 2      // 여전히 같은 후보의 전체 해시
+#define DUP_DONE 3
+#define DUP_CANCELLED 4
+
+// 중복 파일 찾기
+// 크기가 같은 파일만 남기고 (같은 inode 인 하드 링크는 하나로), 앞/뒤 블록의 해시가 같은 것만 남긴 뒤
+// 남은 후보만 전체 내용을 해시한다. 해시는 스레드 풀에서 inode 순으로 읽는다
+// (순차 읽기 힌트와 다음 청크 미리 읽기, 읽은 청크는 페이지 캐시에서 내보냄)
+
+typedef struct {
+    int state;
+    long long files;         // 순회에서 찾은 일반 파일 수
+    long long candidates;    // 지금 단계에서 해시할 파일 수
+    long long hashed;        // 지금 단계에서 해시를 끝낸 파일 수
+    long long bytes_read;    // 해시하느라 읽은 바이트 (모든 단계)
+    long long groups;        // 중복 묶음 수 (끝난 뒤)
+    long long reclaimable;   // 묶음마다 하나만 남길 때 지울 수 있는 바이트 (끝난 뒤)
+    int errors;              // 읽을 수 없었던 파일 수
+} dup_progress;
+
+// 결과 파일 하나 (묶음 순, 묶음 안에서는 수정 시각이 오래된 순)
+typedef struct {
+    const char *path;        // 전체 경로
+    long long size;
+    time_t mtime;
+    int group;
+    int removed;             // 화면에서 지우거나 옮긴 파일 (UI 스레드가 표시)
+} dup_file;
+
+// 중복 묶음 (지울 수 있는 바이트가 큰 순)
+typedef struct {
+    int first;               // dup_file 배열 안의 시작 위치
+    int count;
+    long long size;          // 파일 하나의 크기
+} dup_group;
+
+// root 아래의 중복 파일 찾기를 시작한다. 이전 검색과 결과는 버린다 (UI 스레드 전용)
+// return 0 - 성공, -1 - root 를 열 수 없음
+int dup_start(const char *root);
+
+// 검색을 멈추고 결과를 버린다 (UI 스레드 전용)
+void dup_stop(void);
+
+// 검색을 멈춘다. 결과는 만들지 않는다 (UI 스레드 전용)
+void dup_cancel(void);
+
+void dup_get_progress(dup_progress *p);
+
+// 검색 중인 루트, 없으면 NULL
+const char *dup_root(void);
+
+// DUP_DONE 이후의 결과. 다음 dup_start/dup_stop 까지 유효 (UI 스레드 전용)
+// return 묶음 수
+int dup_results(dup_group **groups, dup_file **files);
+
+// a, b 가 지금도 결과에 기록된 크기와 수정 시각 그대로인 서로 다른 일반 파일이고 내용이 바이트 단위로 같은지
+// (해시는 후보를 고르는 데만 쓰고, 지우기 전에는 남길 사본과 직접 비교한다)
+// return 1 - 같음, 0 - 다르거나 확인할 수 없음
+int dup_same_content(const dup_file *a, const dup_file *b);
+
+#endif
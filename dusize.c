@@ -0,0 +1,447 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#include "dusize.h"
+#include "walker.h"
+#include "treeindex.h"
+#include "uichannel.h"
+
+#define DU_CACHE_BUCKETS 4096    // 2 의 거듭제곱
+#define DU_LIVE_BUCKETS 1024
+#define DU_REDRAW_INTERVAL_MS 200
+#define DU_CACHE_TTL_MS 30000    // 이보다 오래된 합계는 다시 센다 (파일 내용만 바뀌면 디렉토리 mtime 이 그대로)
+
+// 끝난 하위 트리의 합계 - 하위 트리의 모든 디렉토리의 mtime 이 같고 오래되지 않았으면 다시 순회하지 않는다
+typedef struct du_cache_entry {
+    dev_t dev;
+    ino_t ino;
+    struct timespec mtime;
+    du_total total;             // 디렉토리 자신은 제외한 내용의 합계
+    int has_total;              // 0 - 목록만 읽고 합계는 아직 (순회 중이거나 취소됨)
+    long long counted_ms;       // 합계를 센 시각 (from_index 이면 이번 실행에서 색인의 합계를 처음 쓴 시각)
+    int from_index;             // 1 - 합계가 이전 실행의 색인에서 옴 (하위 디렉토리 목록이 없다)
+    unsigned int recount;       // recount == du_generation 이면 이번 순회에서 색인의 합계가 오래되어 다시 센다 (하위 트리도)
+    char *subdirs;              // 같은 파일 시스템의 하위 디렉토리 이름 ('\0' 으로 구분, 빈 문자열로 끝), NULL - 없음
+    unsigned int checked;       // checked == du_generation 이면 이번 순회에서 확인한 결과가 valid
+    int valid;
+    struct du_cache_entry *next;
+} du_cache_entry;
+
+// 작업 스레드가 지금 읽고 있는 디렉토리의 하위 디렉토리 이름 (listed 에서 캐시로 넘긴다)
+typedef struct {
+    const walk_node *node;
+    char *buf;
+    size_t len;
+    size_t cap;
+    int failed;                 // 메모리 부족 - 이 디렉토리는 캐시하지 않는다
+} du_subdir_list;
+
+// 순회 중인 현재 디렉토리와 그 바로 밑 디렉토리의 노드 - 목록 화면에서 찾는다
+typedef struct du_live_entry {
+    walk_node *node;
+    struct du_live_entry *next;
+} du_live_entry;
+
+static pthread_mutex_t du_lock = PTHREAD_MUTEX_INITIALIZER;
+static du_cache_entry *du_cache[DU_CACHE_BUCKETS];
+static du_live_entry *du_live[DU_LIVE_BUCKETS];
+static walker *du_walker = NULL;
+static char du_current[4096];
+static long long du_last_redraw_ms = 0;
+static unsigned int du_generation = 0; // du_start 마다 증가 - 취소된 이전 순회의 작업 스레드를 구분
+static __thread du_subdir_list du_subdirs;
+
+static unsigned int du_hash(dev_t dev, ino_t ino) {
+    unsigned long long h = (unsigned long long)ino * 0x9E3779B97F4A7C15ULL ^ (unsigned long long)dev;
+    return (unsigned int)(h >> 32);
+}
+
+static long long now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000LL + ts.tv_nsec / 1000000;
+}
+
+// 너무 자주 화면을 다시 그리지 않도록 간격을 둔다 (작업 스레드에서 호출)
+static void du_post_redraw(int force) {
+    long long now = now_ms();
+    long long last = __atomic_load_n(&du_last_redraw_ms, __ATOMIC_RELAXED);
+    if (!force && now - last < DU_REDRAW_INTERVAL_MS) {
+        return;
+    }
+    if (__atomic_compare_exchange_n(&du_last_redraw_ms, &last, now, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED) || force) {
+        ui_post_redraw();
+    }
+}
+
+// 호출 전에 du_lock
+static du_cache_entry *cache_find(dev_t dev, ino_t ino) {
+    for (du_cache_entry *e = du_cache[du_hash(dev, ino) & (DU_CACHE_BUCKETS - 1)]; e; e = e->next) {
+        if (e->dev == dev && e->ino == ino) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static int same_time(const struct timespec *a, const struct timespec *b) {
+    return a->tv_sec == b->tv_sec && a->tv_nsec == b->tv_nsec;
+}
+
+// 호출 전에 du_lock
+static du_cache_entry *cache_get(dev_t dev, ino_t ino) {
+    du_cache_entry *e = cache_find(dev, ino);
+    if (!e && (e = calloc(1, sizeof(du_cache_entry)))) {
+        unsigned int b = du_hash(dev, ino) & (DU_CACHE_BUCKETS - 1);
+        e->dev = dev;
+        e->ino = ino;
+        e->next = du_cache[b];
+        du_cache[b] = e;
+    }
+    return e;
+}
+
+// 이전 순회가 취소된 뒤에 작업 스레드가 넣는 노드는 무시한다 (그 노드는 곧 해제됨)
+static void live_add(walk_node *node, unsigned int generation) {
+    du_live_entry *e = malloc(sizeof(du_live_entry));
+    if (!e) {
+        return;
+    }
+    e->node = node;
+    unsigned int b = du_hash(node->dev, node->ino) & (DU_LIVE_BUCKETS - 1);
+    pthread_mutex_lock(&du_lock);
+    if (generation != du_generation) {
+        pthread_mutex_unlock(&du_lock);
+        free(e);
+        return;
+    }
+    e->next = du_live[b];
+    du_live[b] = e;
+    pthread_mutex_unlock(&du_lock);
+}
+
+static void live_clear(void) {
+    pthread_mutex_lock(&du_lock);
+    for (int b = 0; b < DU_LIVE_BUCKETS; b++) {
+        while (du_live[b]) {
+            du_live_entry *e = du_live[b];
+            du_live[b] = e->next;
+            free(e);
+        }
+    }
+    pthread_mutex_unlock(&du_lock);
+}
+
+// 캐시된 합계를 쓸 수 있는지 - 하위 디렉토리를 모두 lstat 해서 캐시의 mtime 과 비교한다
+// path 는 (dev, ino) 디렉토리의 경로이고 len 뒤를 하위 경로로 덮어쓴다. mtime 이 NULL 이면 lstat 한다
+// 결과는 이번 순회 동안 디렉토리마다 기억하므로 (checked) 여러 깊이의 du_enter 가 같은 하위 트리를 다시 보지 않는다
+static int cache_valid(char *path, size_t len, size_t size, dev_t dev, ino_t ino, const struct timespec *mtime,
+                       unsigned int generation, long long now) {
+    struct stat st;
+    if (!mtime) {
+        if (lstat(path, &st) != 0 || !S_ISDIR(st.st_mode) || st.st_dev != dev || st.st_ino != ino) {
+            return 0;
+        }
+        mtime = &st.st_mtim;
+    }
+
+    pthread_mutex_lock(&du_lock);
+    du_cache_entry *e = cache_find(dev, ino);
+    if (e && e->checked == generation) {
+        int valid = e->valid;
+        pthread_mutex_unlock(&du_lock);
+        return valid;
+    }
+    char *subdirs = NULL;
+    size_t subdirs_len = 0;
+    // 색인에서 온 합계는 하위 디렉토리 목록이 없어 여기서 확인할 수 없다 (du_enter 가 색인으로 다시 확인)
+    int valid = e && e->has_total && !e->from_index && same_time(&e->mtime, mtime) &&
+                now - e->counted_ms < DU_CACHE_TTL_MS;
+    if (valid && e->subdirs) { // 다른 스레드가 목록을 바꿀 수 있으므로 복사해서 잠금 밖에서 본다
+        const char *p = e->subdirs;
+        while (*p) {
+            p += strlen(p) + 1;
+        }
+        subdirs_len = p - e->subdirs + 1;
+        subdirs = malloc(subdirs_len);
+        if (subdirs) {
+            memcpy(subdirs, e->subdirs, subdirs_len);
+        } else {
+            valid = 0;
+        }
+    }
+    pthread_mutex_unlock(&du_lock);
+
+    for (const char *name = subdirs; valid && *name; name += strlen(name) + 1) {
+        size_t name_len = strlen(name);
+        if (len + 1 + name_len >= size) {
+            valid = 0;
+            break;
+        }
+        path[len] = '/';
+        memcpy(path + len + 1, name, name_len + 1);
+        struct stat child;
+        if (lstat(path, &child) != 0 || !S_ISDIR(child.st_mode)) {
+            valid = 0;
+        } else if (child.st_dev == dev) { // 다른 파일 시스템은 세지 않았다
+            valid = cache_valid(path, len + 1 + name_len, size, child.st_dev, child.st_ino, &child.st_mtim,
+                                generation, now);
+        }
+    }
+    path[len] = '\0';
+    free(subdirs);
+
+    pthread_mutex_lock(&du_lock);
+    if ((e = cache_find(dev, ino))) {
+        e->checked = generation;
+        e->valid = valid;
+    }
+    pthread_mutex_unlock(&du_lock);
+    return valid;
+}
+
+// 하위 디렉토리에 들어가기 전 - 하위 트리가 그대로인 캐시된 합계가 있으면 그것을 쓰고 들어가지 않는다
+static int du_enter(walker *w, walk_node *node, void *ctx) {
+    (void)w;
+    unsigned int generation = (unsigned int)(uintptr_t)ctx;
+    du_total cached;
+    int hit = 0;
+    char path[4096];
+    long long now = now_ms();
+    pthread_mutex_lock(&du_lock);
+    du_cache_entry *e = cache_find(node->dev, node->ino);
+    // 이전 실행의 색인은 이번 실행에서 처음 쓴 뒤 DU_CACHE_TTL_MS 동안만 믿는다 (그 뒤에는 하위 트리까지 다시 센다)
+    // 이번 실행에서 센 적이 있으면 색인보다 캐시를 믿는다
+    int index_ok = !e || (e->from_index && now - e->counted_ms < DU_CACHE_TTL_MS);
+    if (e && e->from_index && !index_ok) {
+        e->recount = generation;
+    }
+    for (walk_node *p = node->parent; p && index_ok; p = p->parent) {
+        du_cache_entry *a = cache_find(p->dev, p->ino);
+        index_ok = !a || a->recount != generation;
+    }
+    int known = e && e->has_total && !e->from_index && same_time(&e->mtime, &node->mtime);
+    pthread_mutex_unlock(&du_lock);
+    if (known && walk_node_path(node, path, sizeof(path)) == 0 &&
+        cache_valid(path, strlen(path), sizeof(path), node->dev, node->ino, &node->mtime, generation, now)) {
+        pthread_mutex_lock(&du_lock);
+        if ((e = cache_find(node->dev, node->ino)) && e->has_total) {
+            cached = e->total;
+            hit = 1;
+        }
+        pthread_mutex_unlock(&du_lock);
+    }
+
+    // 이전 실행의 합계 - 하위 디렉토리가 모두 그대로인지 확인한 뒤에만 쓴다
+    tindex_total saved;
+    if (!hit && index_ok && tindex_get_total(node->dev, node->ino, &node->mtime, &saved) == 0 &&
+        walk_node_path(node, path, sizeof(path)) == 0 &&
+        tindex_scan_tree(path, node->dev, node->ino, &node->mtime, NULL, NULL) == 0) {
+        cached.bytes = saved.bytes;
+        cached.files = saved.files;
+        cached.dirs = saved.dirs;
+        hit = 1;
+        // 처음 쓴 시각을 남겨 TTL 이 지나면 다시 세도록 한다
+        pthread_mutex_lock(&du_lock);
+        if ((e = cache_get(node->dev, node->ino)) && !e->from_index) {
+            e->from_index = 1;
+            e->counted_ms = now;
+        }
+        if (e) {
+            e->mtime = node->mtime;
+            e->total = cached;
+            e->has_total = 1;
+            e->checked = 0;
+        }
+        pthread_mutex_unlock(&du_lock);
+    }
+
+    if (node->depth <= 1) {
+        live_add(node, generation);
+    }
+    if (hit) {
+        walk_add_totals(node, cached.bytes, cached.files, cached.dirs);
+        return 0;
+    }
+    return 1;
+}
+
+static void du_visit(walker *w, walk_node *parent, const char *name, const struct stat *st, void *ctx) {
+    (void)w;
+    (void)ctx;
+    int is_dir = S_ISDIR(st->st_mode);
+    walk_add_totals(parent, (long long)st->st_blocks * 512, is_dir ? 0 : 1, is_dir ? 1 : 0);
+    tindex_walk_visit(parent, name, st, 1);
+
+    // 캐시를 확인할 때 lstat 할 하위 디렉토리 이름
+    du_subdir_list *l = &du_subdirs;
+    if (l->node != parent) {
+        l->node = parent;
+        l->len = 0;
+        l->failed = 0;
+    }
+    if (is_dir && st->st_dev == parent->dev && !l->failed) {
+        size_t n = strlen(name) + 1;
+        if (l->len + n + 1 > l->cap) {
+            size_t cap = l->cap ? l->cap * 2 : 256;
+            while (cap < l->len + n + 1) {
+                cap *= 2;
+            }
+            char *buf = realloc(l->buf, cap);
+            if (!buf) {
+                l->failed = 1;
+                return;
+            }
+            l->buf = buf;
+            l->cap = cap;
+        }
+        memcpy(l->buf + l->len, name, n);
+        l->len += n;
+    }
+    du_post_redraw(0);
+}
+
+// 디렉토리 목록을 다 읽으면 하위 디렉토리 이름을 캐시에 넣는다 (합계는 du_leave 에서)
+static void du_listed(walker *w, walk_node *node, int complete, void *ctx) {
+    (void)w;
+    (void)ctx;
+    tindex_walk_listed(node, complete);
+
+    // visit 이 없었으면 (빈 디렉토리) 하위 디렉토리도 없다
+    du_subdir_list *l = &du_subdirs;
+    size_t n = l->node == node ? l->len : 0;
+    char *subdirs = NULL;
+    if (complete && !(l->node == node && l->failed) && (subdirs = malloc(n + 1))) {
+        if (n) {
+            memcpy(subdirs, l->buf, n);
+        }
+        subdirs[n] = '\0';
+    }
+    l->node = NULL;
+    l->len = 0;
+
+    pthread_mutex_lock(&du_lock);
+    du_cache_entry *e = cache_get(node->dev, node->ino);
+    if (e) {
+        free(e->subdirs);
+        e->subdirs = subdirs;
+        e->mtime = node->mtime;
+        e->has_total = 0; // du_leave 까지는 이전 합계를 쓰지 않는다
+        e->from_index = 0;
+        e->checked = 0;
+    } else {
+        free(subdirs);
+    }
+    pthread_mutex_unlock(&du_lock);
+}
+
+// 하위 트리가 끝나면 합계를 캐시에 넣는다
+static void du_leave(walker *w, walk_node *node, void *ctx) {
+    (void)w;
+    (void)ctx;
+    pthread_mutex_lock(&du_lock);
+    du_cache_entry *e = cache_find(node->dev, node->ino);
+    // 목록을 읽지 않고 캐시로 끝난 디렉토리는 이미 합계가 있다. 목록이 없으면 하위 트리를 확인할 수 없으므로 넣지 않는다
+    if (e && !e->has_total && same_time(&e->mtime, &node->mtime)) {
+        e->total.bytes = node->bytes;
+        e->total.files = node->files;
+        e->total.dirs = node->dirs;
+        e->has_total = 1;
+        e->counted_ms = now_ms();
+    }
+    pthread_mutex_unlock(&du_lock);
+    tindex_total total = { node->bytes, node->files, node->dirs };
+    tindex_put_total(node->dev, node->ino, &node->mtime, &total);
+
+    if (node->depth <= 1) { // 목록에 보이는 행이 끝남
+        du_post_redraw(node->depth == 0);
+    }
+}
+
+static const walk_ops du_ops = { du_enter, du_visit, du_leave, 0, du_listed };
+
+// 취소한 순회의 작업 스레드가 끝나기를 기다렸다가 해제하는 스레드 (UI 스레드가 기다리지 않도록)
+static void *du_reap_thread(void *arg) {
+    walker_free(arg);
+    return NULL;
+}
+
+int du_start(const char *path) {
+    du_stop();
+    pthread_mutex_lock(&du_lock);
+    unsigned int generation = ++du_generation;
+    pthread_mutex_unlock(&du_lock);
+    walker *w = walker_start(path, &du_ops, (void *)(uintptr_t)generation, 1, 1);
+    if (!w) {
+        return -1;
+    }
+    live_add(walker_root(w), generation);
+    du_walker = w;
+    snprintf(du_current, sizeof(du_current), "%s", path);
+    return 0;
+}
+
+void du_stop(void) {
+    if (du_walker) {
+        // 목록 화면이 해제될 노드를 보지 않도록 먼저 비우고, 이후에 작업 스레드가 넣는 노드는 live_add 가 버린다
+        pthread_mutex_lock(&du_lock);
+        du_generation++;
+        pthread_mutex_unlock(&du_lock);
+        live_clear();
+        walker_cancel(du_walker);
+        pthread_t tid;
+        if (pthread_create(&tid, NULL, du_reap_thread, du_walker) == 0) {
+            pthread_detach(tid);
+        } else {
+            walker_free(du_walker);
+        }
+        du_walker = NULL;
+    }
+    du_current[0] = '\0';
+}
+
+const char *du_path(void) {
+    return du_walker ? du_current : NULL;
+}
+
+int du_lookup(const struct stat *st, du_total *out) {
+    int state = DU_NONE;
+    pthread_mutex_lock(&du_lock);
+    for (du_live_entry *e = du_live[du_hash(st->st_dev, st->st_ino) & (DU_LIVE_BUCKETS - 1)]; e; e = e->next) {
+        walk_node *n = e->node;
+        if (n->dev == st->st_dev && n->ino == st->st_ino) {
+            state = __atomic_load_n(&n->complete, __ATOMIC_ACQUIRE) ? DU_DONE : DU_PARTIAL;
+            out->bytes = __atomic_load_n(&n->bytes, __ATOMIC_RELAXED); // 작업 스레드가 더하는 중
+            out->files = __atomic_load_n(&n->files, __ATOMIC_RELAXED);
+            out->dirs = __atomic_load_n(&n->dirs, __ATOMIC_RELAXED);
+            break;
+        }
+    }
+    if (state == DU_NONE) {
+        du_cache_entry *e = cache_find(st->st_dev, st->st_ino);
+        if (e && e->has_total && same_time(&e->mtime, &st->st_mtim)) { // 목록만 읽은 항목은 합계가 없다
+            *out = e->total;
+            state = DU_DONE;
+        }
+    }
+    pthread_mutex_unlock(&du_lock);
+
+    if (state != DU_NONE) { // du 처럼 디렉토리 자신도 포함
+        out->bytes += (long long)st->st_blocks * 512;
+    }
+    return state;
+}
+
+int du_running(long long *scanned) {
+    if (!du_walker) {
+        return 0;
+    }
+    *scanned = walker_scanned(du_walker);
+    return !walker_done(du_walker);
+}
@@ -0,0 +1,36 @@
+#ifndef __DUSIZE__
+#define __DUSIZE__
+
+#include <sys/stat.h>
+
+// 디렉토리의 하위 트리 전체 크기 (du 와 같이 실제 할당된 바이트)
+// 백그라운드에서 walker 로 현재 디렉토리를 순회하고, 끝난 하위 트리의 합계는
+// (dev, ino, mtime) 을 키로 캐시해 두었다가 다시 들어왔을 때 순회 없이 사용한다
+
+#define DU_NONE 0     // 정보 없음
+#define DU_PARTIAL 1  // 순회 중 - 지금까지 센 값
+#define DU_DONE 2     // 하위 트리 순회가 끝남
+
+typedef struct {
+    long long bytes;
+    long long files;
+    long long dirs;
+} du_total;
+
+// path 의 순회를 시작한다. 진행 중이던 이전 순회는 취소한다 (UI 스레드 전용)
+// return 0 - 성공, -1 - path 를 열 수 없음
+int du_start(const char *path);
+
+// 진행 중인 순회를 취소한다 (UI 스레드 전용)
+void du_stop(void);
+
+// 순회 중인 경로, 없으면 NULL
+const char *du_path(void);
+
+// st 로 주어진 디렉토리의 합계 (디렉토리 자신 포함). 순회 중인 값이 먼저, 없으면 캐시
+int du_lookup(const struct stat *st, du_total *out);
+
+// 1 - 순회 중, scanned 에 지금까지 읽은 디렉토리 수
+int du_running(long long *scanned);
+
+#endif
@@ -7,9 +7,17 @@
 #include <dirent.h>
 #include <sys/stat.h>
 #include <pthread.h>
-#include <sys/stat.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/wait.h>
 
 #include "project_macro.h"
+#include "jobs.h"
+#include "uichannel.h"
+#include "outbuf.h"
+#include "perf.h"
+#include "copy.h"
 
 void generate_unique_filename(char *destination, const char *base_path, const char *filename) {
     // 기본 파일 경로 생성
@@ -47,118 +55,245 @@ void generate_unique_filename(char *destination, const char *base_path, const ch
 }
 
 void display_file(const char *file_path); // display.c에 있는 함수
+void print_trimmed(const char *str, int max_width);
+int prompt_input(const char *label, char *buf, size_t buf_size);
+int read_key(void);
 
 // 클립보드 관련 변수 정의
-char clipboard_file[1024] = "";  // 클립보드에 저장된 파일의 전체 경로
-int clipboard_action = 0;         // 클립보드 작업 유형 (0: 없음, 1: 복사, 2: 잘라내기)
-
-// 복사 작업을 처리하는 스레드 함수
-void *copy_file_thread(void *args) {
-    char **paths = (char **)args;
-    char *source = paths[0];
-    char *destination = paths[1];
-
-    FILE *src = fopen(source, "rb");
-    if (!src) {
-        mvprintw(LINES - 1, 0, "Error: Cannot open source file %s.            ", source);
-        refresh();
-        free(paths);
-        return NULL;
+char **clipboard_files = NULL;  // 클립보드에 저장된 파일들의 전체 경로
+int clipboard_count = 0;
+int clipboard_action = 0;       // 클립보드 작업 유형 (0: 없음, 1: 복사, 2: 잘라내기)
+
+// 선택 표시(mark)된 파일들의 전체 경로, 이진 탐색을 위해 정렬 상태 유지
+static char **marked_files = NULL;
+static int marked_count = 0;
+static int marked_capacity = 0;
+
+static int find_mark(const char *path, int *insert_pos) {
+    int lo = 0, hi = marked_count - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        int cmp = strcmp(marked_files[mid], path);
+        if (cmp == 0) {
+            return mid;
+        } else if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    if (insert_pos) {
+        *insert_pos = lo;
     }
+    return -1;
+}
 
-    FILE *dest = fopen(destination, "wb");
-    if (!dest) {
-        mvprintw(LINES - 1, 0, "Error: Cannot create destination file %s.            ", destination);
-        refresh();
-        fclose(src);
-        free(paths);
-        return NULL;
+// 파일 선택 표시를 켜고 끄는 함수
+void toggle_mark(const char *file_path) {
+    int pos;
+    int idx = find_mark(file_path, &pos);
+    if (idx >= 0) {
+        free(marked_files[idx]);
+        memmove(&marked_files[idx], &marked_files[idx + 1], (marked_count - idx - 1) * sizeof(char *));
+        marked_count--;
+        return;
+    }
+    if (marked_count == marked_capacity) {
+        int new_capacity = marked_capacity ? marked_capacity * 2 : 16;
+        char **p = realloc(marked_files, new_capacity * sizeof(char *));
+        if (!p) {
+            return;
+        }
+        marked_files = p;
+        marked_capacity = new_capacity;
     }
+    memmove(&marked_files[pos + 1], &marked_files[pos], (marked_count - pos) * sizeof(char *));
+    marked_files[pos] = strdup(file_path);
+    marked_count++;
+}
 
-    char buffer[1024];
-    size_t bytes;
-    while ((bytes = fread(buffer, 1, sizeof(buffer), src)) > 0) {
-        fwrite(buffer, 1, bytes, dest);
+int is_marked(const char *file_path) {
+    return marked_count > 0 && find_mark(file_path, NULL) >= 0;
+}
+
+int mark_count(void) {
+    return marked_count;
+}
+
+static void clear_clipboard(void) {
+    for (int i = 0; i < clipboard_count; i++) {
+        free(clipboard_files[i]);
     }
+    free(clipboard_files);
+    clipboard_files = NULL;
+    clipboard_count = 0;
+    clipboard_action = CLIPBOARD_EMPTY;
+}
 
-    fclose(src);
-    fclose(dest);
-    mvprintw(LINES - 1, 0, "File copied successfully: %s            ", destination);
-    free(paths);
-    
-    return NULL;
+// 선택 표시된 파일들 (없으면 file_path 하나) 을 클립보드에 넣는 함수
+static void set_clipboard(const char *file_path, int action) {
+    clear_clipboard();
+    if (marked_count > 0) { // 선택 표시 목록을 그대로 넘긴다
+        clipboard_files = marked_files;
+        clipboard_count = marked_count;
+        marked_files = NULL;
+        marked_count = marked_capacity = 0;
+    } else {
+        clipboard_files = malloc(sizeof(char *));
+        if (!clipboard_files) {
+            return;
+        }
+        clipboard_files[0] = strdup(file_path);
+        clipboard_count = 1;
+    }
+    clipboard_action = action;
 }
 
-// 붙여넣기 작업 처리 함수
+// 붙여넣기 작업 처리 함수 - 클립보드 항목 전체를 백그라운드 작업 하나로 큐에 넣는다
 void paste_clipboard_file(const char *current_dir) {
-    if (clipboard_action == 0) {
-        mvprintw(LINES - 1, 0, "Clipboard is empty.                        ");
-        getch();
-        refresh();
+    if (clipboard_action == CLIPBOARD_EMPTY || clipboard_count == 0) {
+        ui_post_status("Clipboard is empty.");
         return;
     }
 
-    char destination[1024];
-    snprintf(destination, sizeof(destination), "%s/%s", current_dir, strrchr(clipboard_file, '/') + 1);
-    if (clipboard_action == 1) {  // 복사 작업
-        generate_unique_filename(destination, current_dir, strrchr(clipboard_file, '/') + 1);
-        char **paths = malloc(2 * sizeof(char *));
-        paths[0] = strdup(clipboard_file);
-        paths[1] = strdup(destination);
-
-        pthread_t tid;
-        pthread_create(&tid, NULL, copy_file_thread, paths);
-        pthread_detach(tid);
-        refresh();//작업이 끝나면 화면 refresh
-        getch();
-        clear();
-    } else if (clipboard_action == 2) {  // 잘라내기 작업
-        if (rename(clipboard_file, destination) == 0) {
-            mvprintw(LINES - 1, 0, "File moved successfully: %s           ", destination);
-            clipboard_file[0] = '\0';
-            clipboard_action = 0;  // 클립보드 초기화
-            refresh();
-            getch();
-            clear();
+    char **sources = calloc(clipboard_count, sizeof(char *));
+    char **destinations = calloc(clipboard_count, sizeof(char *));
+    if (!sources || !destinations) {
+        free(sources);
+        free(destinations);
+        ui_post_status("Error: Out of memory.");
+        return;
+    }
+    for (int i = 0; i < clipboard_count; i++) {
+        char destination[1024];
+        const char *name = strrchr(clipboard_files[i], '/') + 1;
+        if (clipboard_action == CLIPBOARD_COPY) {
+            generate_unique_filename(destination, current_dir, name);
         } else {
-            mvprintw(LINES - 1, 0, "Error: Unable to move file.            ");
-            refresh();
-            getch();
-            clear();
+            snprintf(destination, sizeof(destination), "%s/%s", current_dir, name);
         }
+        sources[i] = strdup(clipboard_files[i]);
+        destinations[i] = strdup(destination);
     }
 
-    refresh();
+    int id = jobs_submit(clipboard_action, sources, destinations, clipboard_count, current_dir);
+    if (id < 0) {
+        for (int i = 0; i < clipboard_count; i++) {
+            free(sources[i]);
+            free(destinations[i]);
+        }
+        free(sources);
+        free(destinations);
+        ui_post_status("Error: Unable to start background job.");
+        return;
+    }
+    ui_post_status("Job #%d queued: %s %d item(s)", id,
+                   clipboard_action == CLIPBOARD_CUT ? "move" : "copy", clipboard_count);
+    if (clipboard_action == CLIPBOARD_CUT) {
+        clear_clipboard();  // 잘라내기는 한 번만 붙여넣기
+    }
 }
 
 // 복사 작업 설정 함수
 void set_clipboard_copy(const char *file_path) {
-    strncpy(clipboard_file, file_path, sizeof(clipboard_file) - 1);
-    clipboard_action = 1;  // 복사 작업으로 설정
-    mvprintw(LINES - 1, 0, "File copied to clipboard: %s            ", clipboard_file);
-    getch();
-    refresh();
+    set_clipboard(file_path, CLIPBOARD_COPY);
+    if (clipboard_count == 1) {
+        ui_post_status("File copied to clipboard: %s", clipboard_files[0]);
+    } else {
+        ui_post_status("%d files copied to clipboard", clipboard_count);
+    }
 }
 
 // 잘라내기 작업 설정 함수
 void set_clipboard_cut(const char *file_path) {
-    strncpy(clipboard_file, file_path, sizeof(clipboard_file) - 1);
-    clipboard_action = 2;  // 잘라내기 작업으로 설정
-    mvprintw(LINES - 1, 0, "File cut to clipboard: %s            ", clipboard_file);
-    getch();
-    refresh();
+    set_clipboard(file_path, CLIPBOARD_CUT);
+    if (clipboard_count == 1) {
+        ui_post_status("File cut to clipboard: %s", clipboard_files[0]);
+    } else {
+        ui_post_status("%d files cut to clipboard", clipboard_count);
+    }
 }
 
 
+// 인자 문자열을 공백 기준으로 나눠 argv 를 만드는 함수 ('...' "..." 따옴표 지원)
+// 나눈 문자열은 storage 안에 저장된다. return 인자 개수
+static int split_args(const char *args, char *storage, size_t storage_size, char **argv, int max_args) {
+    int argc = 0;
+    size_t used = 0;
+    const char *p = args;
+
+    while (*p && argc < max_args) {
+        while (*p == ' ' || *p == '\t') {
+            p++;
+        }
+        if (!*p) {
+            break;
+        }
+        argv[argc++] = storage + used;
+        char quote = 0;
+        while (*p && (quote || (*p != ' ' && *p != '\t'))) {
+            if (!quote && (*p == '\'' || *p == '"')) {
+                quote = *p++;
+                continue;
+            }
+            if (quote && *p == quote) {
+                quote = 0;
+                p++;
+                continue;
+            }
+            if (used + 1 < storage_size) {
+                storage[used++] = *p;
+            }
+            p++;
+        }
+        if (used < storage_size) {
+            storage[used++] = '\0';
+        }
+    }
+    argv[argc] = NULL;
+    return argc;
+}
+
+#define EXEC_KILL_GRACE_MS 2000 // 종료 요청 (SIGTERM) 후 강제 종료 (SIGKILL) 까지 기다리는 시간
+
+// 명령의 프로세스 그룹 전체 (파이프라인의 손자 프로세스 포함) 를 끝낸다
+// SIGTERM 을 무시하면 EXEC_KILL_GRACE_MS 뒤에 SIGKILL. 자식을 거두기 전에 그룹에 보내야 pgid 가 재사용되지 않는다
+static void stop_command(pid_t pid) {
+    killpg(pid, SIGTERM);
+    for (int waited = 0; waited < EXEC_KILL_GRACE_MS; waited += 50) {
+        siginfo_t info;
+        memset(&info, 0, sizeof(info));
+        if (waitid(P_PID, pid, &info, WEXITED | WNOHANG | WNOWAIT) != 0 || info.si_pid == pid) {
+            break; // 자식은 끝남 (아직 거두지 않음)
+        }
+        usleep(50 * 1000);
+    }
+    killpg(pid, SIGKILL); // 남은 프로세스
+    waitpid(pid, NULL, 0);
+}
+
 // 명령 실행 결과를 ncurses 화면에 출력하는 함수
-void execute_command_in_ncurses(const char *command) {
+// 파이프를 블록하지 않고 읽어서 링 버퍼에 보관하므로 출력이 끝나지 않는 명령도 화면이 멈추지 않는다
+// args 는 공백으로 구분된 추가 인자 (NULL 가능), cwd 는 명령을 실행할 디렉토리 (NULL 이면 그대로)
+// 명령은 자기 프로세스 그룹에서 실행하므로 끝낼 때 그룹 전체에 시그널을 보낸다
+void execute_command_in_ncurses(const char *command, const char *args, const char *cwd) {
     int pipefd[2];
     pid_t pid;
 
+    char arg_storage[1024];
+    char *argv[64];
+    argv[0] = (char *)command;
+    int argc = 1;
+    if (args) {
+        argc += split_args(args, arg_storage, sizeof(arg_storage), argv + 1, 62);
+    } else {
+        argv[1] = NULL;
+    }
+
     if (pipe(pipefd) == -1) {
         mvprintw(LINES - 1, 0, "Error: Unable to create pipe.            ");
         refresh();
-        getch();
+        read_key();
         return;
     }
 
@@ -166,59 +301,200 @@ void execute_command_in_ncurses(const char *command) {
     if (pid == -1) {
         mvprintw(LINES - 1, 0, "Error: Unable to fork process.            ");
         refresh();
-        getch();
+        read_key();
+        close(pipefd[0]);
+        close(pipefd[1]);
         return;
     }
 
     if (pid == 0) { // 자식 프로세스
+        setpgid(0, 0); // 새 프로세스 그룹 - 파이프라인의 손자까지 한 번에 끝낼 수 있도록
         close(pipefd[0]); // 읽기 끝 닫기
         dup2(pipefd[1], STDOUT_FILENO); // 표준 출력을 파이프 쓰기로 연결
         dup2(pipefd[1], STDERR_FILENO); // 표준 오류도 파이프 쓰기로 연결
         close(pipefd[1]);
+        int devnull = open("/dev/null", O_RDONLY); // 터미널 입력은 UI 가 사용
+        if (devnull >= 0) {
+            dup2(devnull, STDIN_FILENO);
+            close(devnull);
+        }
 
-        execlp(command, command, NULL); // 명령 실행
-        perror("execlp");
+        if (cwd && chdir(cwd) != 0) { // UI 프로세스의 작업 디렉토리는 바꾸지 않는다
+            perror(cwd);
+            exit(EXIT_FAILURE);
+        }
+        execvp(command, argv); // 명령 실행
+        perror("execvp");
         exit(EXIT_FAILURE);
-    } else { // 부모 프로세스
-        close(pipefd[1]); // 쓰기 끝 닫기
+    }
 
-        char buffer[256];
-        int line = 0;
+    // 부모 프로세스
+    setpgid(pid, pid); // 자식이 setpgid 하기 전에 killpg 하는 경우를 막는다
+    close(pipefd[1]); // 쓰기 끝 닫기
+    int read_fd = pipefd[0];
+    fcntl(read_fd, F_SETFL, fcntl(read_fd, F_GETFL) | O_NONBLOCK);
+
+    out_buffer ob;
+    outbuf_init(&ob);
+    int top = 0;           // 화면 첫 줄의 출력 줄 번호
+    int follow = 1;        // 1 - 새 출력이 오면 맨 아래로 따라감
+    int exited = 0;
+    int exit_status = 0;
+    char search[128] = "";
+    char message[256] = "";
+    char title[256];
+    snprintf(title, sizeof(title), "Output of '%s%s%s' command:", command, args && args[0] ? " " : "", args ? args : "");
+
+    while (1) {
+        int page = LINES - 3;
+        int total = outbuf_line_count(&ob);
+        int max_top = total > page ? total - page : 0;
+        if (follow || top > max_top) {
+            top = max_top;
+        }
 
+        uint64_t perf_frame = perf_begin();
         clear();
-        mvprintw(0, 0, "Output of '%s' command:", command);
+        mvprintw(0, 0, "%s", title);
+        for (int y = 0; y < page && top + y < total; y++) {
+            const char *line = outbuf_line(&ob, top + y);
+            int hit = search[0] && strstr(line, search);
+            if (hit) {
+                attron(A_BOLD);
+            }
+            move(y + 1, 0);
+            print_trimmed(line, COLS);
+            if (hit) {
+                attroff(A_BOLD);
+            }
+        }
 
-        FILE *fp = fdopen(pipefd[0], "r");
-        if (!fp) {
-            mvprintw(LINES - 1, 0, "Error: Unable to open pipe.            ");
-            refresh();
-            getch();
-            return;
+        if (exited) {
+            mvprintw(LINES - 2, 0, "[exited with status %d]  lines %d-%d / %d", exit_status,
+                     total ? top + 1 : 0, top + page < total ? top + page : total, total);
+        } else {
+            mvprintw(LINES - 2, 0, "[running%s]  lines %d-%d / %d", follow ? ", following" : "",
+                     total ? top + 1 : 0, top + page < total ? top + page : total, total);
+        }
+        if (ob.dropped > 0) {
+            printw("  (%lld old lines dropped)", ob.dropped);
+        }
+        if (message[0]) {
+            printw("  %s", message);
+        }
+        mvprintw(LINES - 1, 0, "UP/DOWN PgUp/PgDn Home/End scroll  /(search) n/N(next/prev)  F(follow)  q(quit%s)",
+                 exited ? "" : ", kill");
+        uint64_t perf_output = perf_begin();
+        refresh();
+        perf_end(PERF_OUTPUT, perf_output);
+        perf_end(PERF_EXEC, perf_frame);
+
+        nodelay(stdscr, TRUE);
+        int ch = read_key();
+        nodelay(stdscr, FALSE);
+        if (ch == ERR) {
+            int events = ui_wait_events(&read_fd, 1, -1);
+            if (events & UI_EVENT_CHANNEL) {
+                ui_channel_drain();
+            }
+            if ((events & UI_EVENT_EXTRA(0)) && read_fd >= 0) {
+                // 준비된 만큼만 읽고 바로 화면으로 돌아간다
+                char buffer[64 * 1024];
+                long long dropped_before = ob.dropped;
+                for (int i = 0; i < 16; i++) {
+                    ssize_t n = read(read_fd, buffer, sizeof(buffer));
+                    perf_count(PERF_C_READ, 1);
+                    if (n > 0) {
+                        outbuf_append(&ob, buffer, n);
+                        continue;
+                    }
+                    if (n == 0 || (errno != EAGAIN && errno != EINTR)) { // EOF
+                        outbuf_flush(&ob);
+                        close(read_fd);
+                        read_fd = -1;
+                        int status;
+                        waitpid(pid, &status, 0);
+                        exit_status = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+                        exited = 1;
+                    }
+                    break;
+                }
+                // 오래된 줄이 버려진 만큼 화면 위치를 당겨서 보던 내용을 유지
+                if (!follow) {
+                    top -= (int)(ob.dropped - dropped_before);
+                    if (top < 0) {
+                        top = 0;
+                    }
+                }
+            }
+            continue;
         }
 
-        while (fgets(buffer, sizeof(buffer), fp)) {
-            buffer[strcspn(buffer, "\n")] = '\0'; // 개행 제거
-            mvprintw(++line, 0, "%s", buffer);
-            if (line >= LINES - RESERVED_LINE_LOWER) {
-                mvprintw(line, 0, "-- More -- Press SPACE to continue");
-                refresh();
-                while (getch() != ' ') {
-                    // SPACE 키 대기
+        message[0] = '\0';
+        switch (ch) {
+            case 'q':
+                if (!exited) { // 실행 중이면 종료시키고 기다린다
+                    mvprintw(LINES - 2, 0, "[stopping...]");
+                    clrtoeol();
+                    refresh();
+                    stop_command(pid);
+                }
+                if (read_fd >= 0) {
+                    close(read_fd);
                 }
+                outbuf_free(&ob);
                 clear();
-                line = 0;
+                refresh();
+                return;
+            case KEY_UP:
+                top = top > 0 ? top - 1 : 0;
+                follow = 0;
+                break;
+            case KEY_DOWN:
+                top++;
+                follow = top >= max_top;
+                break;
+            case KEY_PPAGE:
+                top = top > page ? top - page : 0;
+                follow = 0;
+                break;
+            case KEY_NPAGE:
+                top += page;
+                follow = top >= max_top;
+                break;
+            case KEY_HOME:
+                top = 0;
+                follow = 0;
+                break;
+            case KEY_END:
+            case 'F':
+                follow = 1;
+                break;
+            case '/':
+                if (prompt_input("Search: ", search, sizeof(search)) != 0) {
+                    search[0] = '\0';
+                    break;
+                }
+                /* fall through */
+            case 'n':
+            case 'N': {
+                if (!search[0]) {
+                    break;
+                }
+                int direction = ch == 'N' ? -1 : 1;
+                int from = ch == '/' ? top : top + direction;
+                int found = outbuf_find(&ob, from, search, direction);
+                if (found >= 0) {
+                    top = found;
+                    follow = 0;
+                } else {
+                    snprintf(message, sizeof(message), "Pattern not found: %s", search);
+                }
+                break;
             }
+            default:
+                break;
         }
-
-        fclose(fp); // 파일 포인터 닫기
-
-        mvprintw(LINES - 1, 0, "Press any key to return...");
-        refresh();
-        getch(); // 종료 대기
-
-        // 원래 ncurses 상태 복원
-        clear();
-        refresh();
     }
 }
 
@@ -228,15 +504,15 @@ void execute_command_in_ncurses(const char *command) {
 int execute_command(char *current_dir, const char *selected_filename) {
     char full_path[1024];
 
-    // (1) 예상 길이 확인
-    if (strlen(current_dir) + strlen(selected_filename) + 2 >= sizeof(full_path)) {
+    // 파일 전체 경로 생성, 잘리면 사용하지 않는다
+    // "/" 에서는 구분자를 더하지 않는다 ("//usr" 이면 ".." 으로 돌아올 때 위치와 디렉토리 캐시를 찾지 못한다)
+    int len = snprintf(full_path, sizeof(full_path), "%s%s%s", current_dir, strcmp(current_dir, "/") == 0 ? "" : "/",
+                       selected_filename);
+    if (len < 0 || (size_t)len >= sizeof(full_path)) {
         mvprintw(1, 0, "Path 가 너무 길어 사용 불가능합니다");
         return 0;
     }
 
-    // (2) snprintf로 파일 전체 경로 생성
-    snprintf(full_path, sizeof(full_path), "%s/%s", current_dir, selected_filename);
-
     struct stat file_stat;
     if (stat(full_path, &file_stat) == 0) {
         switch (file_stat.st_mode & S_IFMT) {
@@ -246,7 +522,9 @@ int execute_command(char *current_dir, const char *selected_filename) {
                 } else if (strcmp(selected_filename, "..") == 0) {
                     // 상위 디렉토리 이동
                     char *last_slash = strrchr(current_dir, '/');
-                    if (last_slash != NULL) {
+                    if (last_slash == current_dir) {
+                        current_dir[1] = '\0'; // "/usr" 의 상위는 "/"
+                    } else if (last_slash != NULL) {
                         *last_slash = '\0';
                     } else {
                         strncpy(current_dir, "/", MAX_DIR_LENGTH - 1);
@@ -259,19 +537,34 @@ int execute_command(char *current_dir, const char *selected_filename) {
                 }
                 return 99;
             case S_IFREG: // 일반 파일
+                if (copy_is_partial(selected_filename)) { // 중단된 붙여넣기의 임시 파일 - 지울지 묻는다
+                    clear();
+                    mvprintw(1, 0, "Selected = partial copy: %s", selected_filename);
+                    mvprintw(3, 0, "Left by an interrupted paste. Pasting the same file here again resumes it.");
+                    mvprintw(4, 0, "Delete it? (y/n)");
+                    if (read_key() == 'y') {
+                        if (copy_remove_partial(full_path) == 0) {
+                            ui_post_status("Deleted partial copy %s", selected_filename);
+                        } else {
+                            ui_post_status("Cannot delete %s: %s", selected_filename, strerror(errno));
+                        }
+                    }
+                    return 1;
+                }
                 if (file_stat.st_mode & S_IXUSR) {  // 실행파일  - 실행시키기
                     clear();
                     mvprintw(1, 0, "Selected = Executable file: %s", selected_filename);
-                    mvprintw(3, 0, "Press any key to execute the file...");
-                    getch();
-                    execute_command_in_ncurses(full_path);
+                    mvprintw(3, 0, "Enter arguments and press Enter to execute the file...");
+                    char args[512] = "";
+                    prompt_input("Arguments: ", args, sizeof(args));
+                    execute_command_in_ncurses(full_path, args, current_dir);
                     return 1;
                 } else {  // 일반 파일 , 볼수 있으면 cat 해서 보여주기
                     clear();
                     mvprintw(1, 0, "Selected = file: %s", selected_filename);
                     mvprintw(3, 0, "Press any key to view the file...");
                     char ch;
-                    while ((ch = getch()) != ' '); // space 키 입력 시 파일 보기
+                    while ((ch = read_key()) != ' '); // space 키 입력 시 파일 보기
                     display_file(full_path);
                     return 1;
                 }
@@ -279,20 +572,20 @@ int execute_command(char *current_dir, const char *selected_filename) {
                 clear();
                 mvprintw(1, 0, "Selected = symbolic link: %s", selected_filename);
                 mvprintw(3, 0, "Press any key to continue...");
-                getch();
+                read_key();
                 return 1;
             default:
                 clear();
                 mvprintw(1, 0, "Selected = Unknown file type: %s", selected_filename);
                 mvprintw(3, 0, "Press any key to continue...");
-                getch();
+                read_key();
                 return 1;
         }
     } else {
         clear();
         mvprintw(1, 0, "Error reading file information: %s", selected_filename);
         mvprintw(3, 0, "Press any key to continue...");
-        getch();
+        read_key();
     }
 
     return 0;
@@ -0,0 +1,428 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdint.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "filter.h"
+
+// 검색어를 글자 단위로 나눈 것 - 첫 바이트로 찾고 나머지 바이트(UTF-8)는 그대로 비교
+typedef struct {
+    unsigned char lower, upper;
+    const char *rest;
+    int rest_len;
+} query_unit;
+
+typedef struct {
+    query_unit units[FILTER_MAX_QUERY];
+    int count;
+    const char *text;
+    int len;
+} compiled_query;
+
+static void compile_query(compiled_query *q, const char *query, int len) {
+    q->count = 0;
+    q->text = query;
+    q->len = len;
+    for (int i = 0; i < len; ) {
+        unsigned char c = query[i];
+        int char_len = 1;
+        if (c >= 0xC0) { // UTF-8 선두 바이트 - 이어지는 바이트 수만큼 묶는다
+            char_len = c >= 0xF0 ? 4 : (c >= 0xE0 ? 3 : 2);
+            if (i + char_len > len) {
+                char_len = len - i; // 아직 입력 중인 글자
+            }
+        }
+        query_unit *u = &q->units[q->count++];
+        u->lower = tolower(c);
+        u->upper = toupper(c);
+        u->rest = query + i + 1;
+        u->rest_len = char_len - 1;
+        i += char_len;
+    }
+}
+
+// s 에서 lower/upper 중 하나와 같은 첫 바이트 위치, 문자열 끝까지 없으면 NULL
+static const char *find_byte(const char *s, unsigned char lower, unsigned char upper) {
+#ifdef __SSE2__
+    // 16바이트 정렬 단위로 읽는다 - 페이지 경계를 넘지 않으므로 문자열 끝 너머를 읽어도 안전
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i lo = _mm_set1_epi8((char)lower);
+    const __m128i up = _mm_set1_epi8((char)upper);
+    unsigned int misalign = (uintptr_t)s & 15;
+    const __m128i *p = (const __m128i *)(s - misalign);
+    unsigned int skip = misalign;
+    while (1) {
+        __m128i v = _mm_load_si128(p);
+        unsigned int hit = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, lo), _mm_cmpeq_epi8(v, up)));
+        unsigned int end = _mm_movemask_epi8(_mm_cmpeq_epi8(v, zero));
+        hit = (hit >> skip) << skip;
+        end = (end >> skip) << skip;
+        if (hit | end) {
+            // 끝(0) 보다 앞에 있는 일치만 유효
+            if (hit && (!end || __builtin_ctz(hit) < __builtin_ctz(end))) {
+                return (const char *)p + __builtin_ctz(hit);
+            }
+            return NULL;
+        }
+        p++;
+        skip = 0;
+    }
+#else
+    for (; *s; s++) {
+        unsigned char c = *s;
+        if (c == lower || c == upper) {
+            return s;
+        }
+    }
+    return NULL;
+#endif
+}
+
+// s 에서 글자 u 의 첫 위치, 없으면 NULL
+static const char *find_unit(const char *s, const query_unit *u) {
+    while (1) {
+        const char *p = find_byte(s, u->lower, u->upper);
+        if (!p || u->rest_len == 0 || memcmp(p + 1, u->rest, u->rest_len) == 0) {
+            return p; // memcmp 는 다른 바이트에서 멈추므로 문자열 끝을 넘지 않는다
+        }
+        s = p + 1;
+    }
+}
+
+// ASCII 만 대소문자 구분 없이 비교 (로케일 영향 없음)
+static int equal_ascii_ci(const char *a, const char *b, int len) {
+    for (int i = 0; i < len; i++) {
+        unsigned char x = a[i], y = b[i];
+        if (x != y) {
+            if ((x | 0x20) != (y | 0x20) || (x | 0x20) < 'a' || (x | 0x20) > 'z') {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+// 검색어가 이어진 채로 나타나는 첫 위치, 없으면 NULL
+static const char *find_substring(const char *name, const compiled_query *q) {
+    const char *p = name;
+    while ((p = find_unit(p, &q->units[0])) != NULL) {
+        if (equal_ascii_ci(p, q->text, q->len)) {
+            return p; // 다른 바이트(끝의 0 포함)에서 멈추므로 문자열 끝을 넘지 않는다
+        }
+        p++;
+    }
+    return NULL;
+}
+
+static int is_word_start(const char *name, const char *pos) {
+    if (pos == name) {
+        return 1;
+    }
+    char c = pos[-1];
+    return c == '.' || c == '_' || c == '-' || c == ' ';
+}
+
+// 검색어 전체로 처음부터 찾는다. return 1 - 일치
+static int match_full(const char *name, const compiled_query *q, filter_hit *h) {
+    // 부분 수열 검사 - 글자를 순서대로 찾으면서 끊긴 횟수를 센다
+    const char *pos = name;
+    const char *first = NULL;
+    int gaps = 0;
+    for (int i = 0; i < q->count; i++) {
+        const char *p = find_unit(pos, &q->units[i]);
+        if (!p) {
+            return 0;
+        }
+        if (i == 0) {
+            first = p;
+        } else if (p != pos) {
+            gaps++;
+        }
+        pos = p + 1 + q->units[i].rest_len;
+    }
+    const char *sub = gaps == 0 ? first : find_substring(name, q);
+    h->end = pos - name;
+    h->gaps = gaps;
+    h->sub = sub ? sub - name : -1;
+    return 1;
+}
+
+// 직전 단계의 상태에서 검색어 마지막 글자(ASCII 한 바이트)만 더 찾는다. return 1 - 일치
+static int match_next(const char *name, const compiled_query *q, filter_hit *h) {
+    const query_unit *u = &q->units[q->count - 1];
+    const char *p = find_byte(name + h->end, u->lower, u->upper);
+    if (!p) {
+        return 0;
+    }
+    if (p != name + h->end) {
+        h->gaps++;
+    }
+    h->end = p + 1 - name;
+
+    // 이어진 위치는 뒤로만 움직인다 - 직전 검색어가 없던 곳에는 새 검색어도 없다
+    if (h->sub >= 0) {
+        const char *sub = name + h->sub;
+        int last = q->len - 1;
+        if (!equal_ascii_ci(sub + last, q->text + last, 1)) {
+            sub = find_substring(sub + 1, q);
+            h->sub = sub ? sub - name : -1;
+        }
+    }
+    return 1;
+}
+
+static int hit_score(const char *name, int len, const filter_hit *h) {
+    int score;
+    if (h->sub == 0) {
+        score = 900;         // 앞부분 일치
+    } else if (h->sub > 0) {
+        score = is_word_start(name, name + h->sub) ? 800 : 700;
+    } else {
+        score = 500 - h->gaps * 20;
+        if (score < 200) {
+            score = 200;
+        }
+    }
+    score -= (len < 200 ? len : 200) / 2; // 짧은 이름 우선
+    return score;
+}
+
+int filter_score(const char *name, const char *query) {
+    compiled_query q;
+    int len = strlen(query);
+    if (len >= FILTER_MAX_QUERY) {
+        len = FILTER_MAX_QUERY - 1;
+    }
+    compile_query(&q, query, len);
+    filter_hit h;
+    if (len == 0 || !match_full(name, &q, &h)) {
+        return -1;
+    }
+    return hit_score(name, strlen(name), &h);
+}
+
+void filter_init(name_filter *f) {
+    memset(f, 0, sizeof(*f));
+}
+
+void filter_free(name_filter *f) {
+    for (int i = 0; i < FILTER_MAX_QUERY; i++) {
+        free(f->levels[i]);
+    }
+    free(f->scores);
+    free(f->ranked);
+    free(f->names);
+    free(f->offsets);
+    memset(f, 0, sizeof(*f));
+}
+
+// 목록이 바뀌었을 때 이름을 한 번 복사해 둔다
+static int build_names(name_filter *f, filter_name_fn name_at, const void *ctx, int count) {
+    int *offsets = realloc(f->offsets, (count > 0 ? count : 1) * sizeof(int));
+    if (!offsets) {
+        return -1;
+    }
+    f->offsets = offsets;
+    f->names_size = 0;
+    f->name_count = 0;
+    for (int i = 0; i < count; i++) {
+        const char *name = name_at(ctx, i);
+        size_t len = strlen(name) + 1;
+        if (f->names_size + len + 16 > f->names_capacity) { // 끝에 SIMD 로 읽을 여유 16바이트
+            size_t new_capacity = f->names_capacity ? f->names_capacity * 2 : 64 * 1024;
+            while (new_capacity < f->names_size + len + 16) {
+                new_capacity *= 2;
+            }
+            char *p = realloc(f->names, new_capacity);
+            if (!p) {
+                return -1;
+            }
+            f->names = p;
+            f->names_capacity = new_capacity;
+        }
+        memcpy(f->names + f->names_size, name, len);
+        offsets[i] = f->names_size;
+        f->names_size += len;
+    }
+    f->name_count = count;
+    return 0;
+}
+
+static int reserve_ranked(name_filter *f, int need) {
+    if (need <= f->ranked_capacity) {
+        return 0;
+    }
+    int *scores = realloc(f->scores, need * sizeof(int));
+    if (scores) {
+        f->scores = scores;
+    }
+    int *ranked = realloc(f->ranked, need * sizeof(int));
+    if (ranked) {
+        f->ranked = ranked;
+    }
+    if (!scores || !ranked) {
+        return -1;
+    }
+    f->ranked_capacity = need;
+    return 0;
+}
+
+// 첫 단계 전용 - 압축 사본 전체를 한 번에 훑어 바이트 하나가 나타나는 이름을 찾는다
+// 이름마다 따로 찾지 않고 일치와 문자열 끝(0)을 한 흐름으로 처리한다
+static int sweep_first(const name_filter *f, unsigned char lower, unsigned char upper, filter_hit *hits) {
+    int idx = 0;
+    int n = 0;
+    int matched = 0;
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i lo = _mm_set1_epi8((char)lower);
+    const __m128i up = _mm_set1_epi8((char)upper);
+    for (size_t off = 0; off < f->names_size; off += 16) {
+        // names 끝에는 16바이트 여유가 있다
+        __m128i v = _mm_loadu_si128((const __m128i *)(f->names + off));
+        unsigned int hit = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, lo), _mm_cmpeq_epi8(v, up)));
+        unsigned int end = _mm_movemask_epi8(_mm_cmpeq_epi8(v, zero));
+        if (f->names_size - off < 16) {
+            unsigned int valid = (1u << (f->names_size - off)) - 1;
+            hit &= valid;
+            end &= valid;
+        }
+        for (unsigned int all = hit | end; all; all &= all - 1) {
+            int bit = __builtin_ctz(all);
+            if (end & (1u << bit)) {
+                idx++;
+                matched = 0;
+            } else if (!matched) {
+                int pos = off + bit - f->offsets[idx];
+                filter_hit h = { idx, pos + 1, pos, 0 };
+                hits[n++] = h;
+                matched = 1;
+            }
+        }
+    }
+#else
+    for (size_t off = 0; off < f->names_size; off++) {
+        unsigned char c = f->names[off];
+        if (c == 0) {
+            idx++;
+            matched = 0;
+        } else if (!matched && (c == lower || c == upper)) {
+            int pos = off - f->offsets[idx];
+            filter_hit h = { idx, pos + 1, pos, 0 };
+            hits[n++] = h;
+            matched = 1;
+        }
+    }
+#endif
+    return n;
+}
+
+static int name_length(const name_filter *f, int idx) {
+    size_t next = idx + 1 < f->name_count ? (size_t)f->offsets[idx + 1] : f->names_size;
+    return next - f->offsets[idx] - 1;
+}
+
+// 점수별 계수 정렬 - 번호 순으로 들어온 항목을 점수 높은 순으로 (같은 점수는 번호 순 유지)
+static void rank_results(name_filter *f, const filter_hit *hits, int n) {
+    static int counts[FILTER_SCORE_MAX + 2];
+    memset(counts, 0, sizeof(counts));
+    for (int i = 0; i < n; i++) {
+        counts[FILTER_SCORE_MAX - f->scores[i] + 1]++;
+    }
+    for (int s = 1; s <= FILTER_SCORE_MAX + 1; s++) {
+        counts[s] += counts[s - 1];
+    }
+    for (int i = 0; i < n; i++) {
+        f->ranked[counts[FILTER_SCORE_MAX - f->scores[i]]++] = hits[i].idx;
+    }
+    f->ranked_count = n;
+}
+
+int filter_apply(name_filter *f, const char *query, filter_name_fn name_at, const void *ctx,
+                 int count, unsigned long generation) {
+    int len = strlen(query);
+    if (len >= FILTER_MAX_QUERY) {
+        len = FILTER_MAX_QUERY - 1;
+    }
+
+    // 앞부분이 같은 단계까지는 이전 결과를 그대로 쓴다
+    int keep = 0;
+    if (generation != f->generation || count != f->name_count || !f->names) {
+        f->depth = 0;
+        if (build_names(f, name_at, ctx, count) < 0) {
+            f->name_count = 0;
+            return -1;
+        }
+    } else {
+        while (keep < f->depth && keep < len && f->query[keep] == query[keep]) {
+            keep++;
+        }
+    }
+    f->depth = keep;
+    f->generation = generation;
+    memcpy(f->query, query, len);
+    f->query[len] = '\0';
+
+    if (len == 0) {
+        f->ranked_count = 0;
+        return 0;
+    }
+
+    // 새로 늘어난 단계마다 직전 단계의 결과 안에서만 찾는다
+    compiled_query q;
+    for (int level = keep; level < len; level++) {
+        const filter_hit *base = level > 0 ? f->levels[level - 1] : NULL;
+        int base_count = level > 0 ? f->level_count[level - 1] : count;
+        filter_hit *hits = realloc(f->levels[level], (base_count > 0 ? base_count : 1) * sizeof(filter_hit));
+        if (!hits) {
+            return -1;
+        }
+        f->levels[level] = hits;
+
+        compile_query(&q, query, level + 1);
+        // 늘어난 바이트가 ASCII 한 글자면 직전 상태에서 이어서 찾는다
+        const query_unit *last = &q.units[q.count - 1];
+        int incremental = level > 0 && last->rest == query + level + 1 && last->rest_len == 0 &&
+                          (unsigned char)query[level] < 0x80;
+
+        int n = 0;
+        if (level == 0) { // 한 바이트 - 목록 전체를 한 번에 훑는다
+            n = sweep_first(f, last->lower, last->upper, hits);
+        }
+        for (int i = 0; level > 0 && i < base_count; i++) {
+            filter_hit h;
+            if (base) {
+                h = base[i];
+            } else {
+                h.idx = i;
+            }
+            const char *name = f->names + f->offsets[h.idx];
+            if (incremental ? match_next(name, &q, &h) : match_full(name, &q, &h)) {
+                hits[n++] = h;
+            }
+        }
+        f->level_count[level] = n;
+        f->depth = level + 1;
+    }
+
+    // 마지막 단계의 점수를 매겨 정렬 (지우기로 단계를 다시 쓰는 경우도 같음)
+    const filter_hit *hits = f->levels[len - 1];
+    int n = f->level_count[len - 1];
+    if (reserve_ranked(f, n > 0 ? n : 1) < 0) {
+        return -1;
+    }
+    for (int i = 0; i < n; i++) {
+        f->scores[i] = hit_score(f->names + f->offsets[hits[i].idx], name_length(f, hits[i].idx), &hits[i]);
+    }
+    rank_results(f, hits, n);
+    return n;
+}
+
+const int *filter_results(const name_filter *f, int *count) {
+    *count = f->ranked_count;
+    return f->ranked;
+}
@@ -0,0 +1,55 @@
+#ifndef __FILTER__
+#define __FILTER__
+
+#define FILTER_MAX_QUERY 128   // 검색어 최대 바이트 수
+#define FILTER_SCORE_MAX 1023  // 점수 범위 0 - FILTER_SCORE_MAX
+
+// 일치한 항목 하나와 다음 글자를 이어서 찾기 위한 상태
+typedef struct {
+    int idx;   // 목록 번호
+    int end;   // 검색어 마지막 글자의 다음 위치 (이름 안의 오프셋)
+    int sub;   // 검색어가 이어진 채로 나타나는 첫 위치, 없으면 -1
+    int gaps;  // 부분 수열이 끊긴 횟수
+} filter_hit;
+
+// 이름 목록에 대한 점진적 퍼지 필터
+// 검색어가 한 글자씩 늘어날 때는 직전 결과 안에서만 다시 찾고,
+// 줄어들 때는 보관해 둔 앞 단계의 결과를 그대로 쓴다
+typedef struct {
+    char query[FILTER_MAX_QUERY];
+    int depth;                       // 계산해 둔 단계 수 (levels[i] = query 앞 i+1 바이트의 결과)
+    filter_hit *levels[FILTER_MAX_QUERY]; // 일치한 항목 (번호 순)
+    int level_count[FILTER_MAX_QUERY];
+    unsigned long generation;        // 결과를 계산한 목록의 세대
+
+    // 목록 이름의 압축 사본 - 항목 구조체를 건너뛰며 읽지 않고 연속된 메모리를 훑는다
+    char *names;
+    size_t names_size;
+    size_t names_capacity;
+    int *offsets;                    // offsets[idx] = names 안의 idx 번째 이름 위치
+    int name_count;
+
+    int *scores;                     // 마지막 단계 항목의 점수
+    int *ranked;                     // 마지막 단계 결과 (점수 높은 순, 같으면 번호 순)
+    int ranked_count;
+    int ranked_capacity;
+} name_filter;
+
+// idx 번째 이름을 돌려주는 함수
+typedef const char *(*filter_name_fn)(const void *ctx, int idx);
+
+void filter_init(name_filter *f);
+void filter_free(name_filter *f);
+
+// 목록 [0, count) 에 query 를 적용한다. generation 이 바뀌면 처음부터 다시 찾는다
+// return 일치한 항목 수, 메모리 부족이면 -1
+int filter_apply(name_filter *f, const char *query, filter_name_fn name_at, const void *ctx,
+                 int count, unsigned long generation);
+
+// 마지막 filter_apply 의 결과 (점수 높은 순)
+const int *filter_results(const name_filter *f, int *count);
+
+// name 이 query 와 일치하면 점수 (0 이상), 아니면 -1
+int filter_score(const char *name, const char *query);
+
+#endif
@@ -0,0 +1,459 @@
+#define _GNU_SOURCE // strcasestr, FNM_CASEFOLD
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fnmatch.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#include "finder.h"
+#include "walker.h"
+#include "treeindex.h"
+#include "uichannel.h"
+
+#define FIND_MAX_TERMS 8             // 이름 조건 최대 개수
+#define FIND_BLOCK_SIZE (1024 * 1024) // 경로 문자열 블록 크기
+#define FIND_REDRAW_INTERVAL_MS 100
+
+// 결과 하나 - 경로는 블록에 이어 붙인다 (결과마다 할당하지 않음)
+typedef struct {
+    const char *path;
+    mode_t mode;
+    long long size;
+    time_t mtime;
+} find_entry;
+
+// 경로 문자열 블록. 옮기지 않으므로 find_entry 의 포인터가 계속 유효하다
+typedef struct find_block {
+    struct find_block *next;
+    size_t used;
+    char data[];
+} find_block;
+
+typedef struct {
+    char names[FIND_MAX_TERMS][FIND_MAX_QUERY];
+    int glob[FIND_MAX_TERMS];  // 1 - fnmatch, 0 - 포함된 문자열
+    int name_count;
+    long long min_size;        // -1 이면 조건 없음
+    long long max_size;
+    time_t newer;              // 이 시각 이후 수정, 0 이면 조건 없음
+    time_t older;              // 이 시각 이전 수정
+    mode_t type;               // S_IFREG 등, 0 이면 아무 종류
+    int need_stat;             // 크기나 시각 조건이 있음
+} find_query;
+
+// 순회 하나가 보는 조건. 취소한 순회는 따로 정리되며 끝날 때까지 이것만 보므로 다음 검색과 섞이지 않는다
+typedef struct {
+    find_query query;
+    char root_path[4096];
+    size_t root_len;
+    unsigned int generation; // find_generation 과 다르면 결과를 버린다
+} find_search;
+
+static pthread_mutex_t find_lock = PTHREAD_MUTEX_INITIALIZER;
+static walker *find_walker = NULL;
+static find_query query;
+static char root_path[4096];
+static size_t root_len;
+static int has_results = 0;
+static long long scanned_final = 0; // 순회를 멈춘 뒤의 읽은 디렉토리 수
+static find_search *find_current = NULL; // find_walker 의 ctx
+static unsigned int find_generation = 0; // find_lock
+
+static find_entry *entries = NULL; // find_lock
+static int entry_count = 0;
+static int entry_capacity = 0;
+static long long match_total = 0;
+static find_block *blocks = NULL;
+
+static long long find_last_redraw_ms = 0;
+
+static long long now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000LL + ts.tv_nsec / 1000000;
+}
+
+// 너무 자주 화면을 다시 그리지 않도록 간격을 둔다 (작업 스레드에서 호출)
+static void find_post_redraw(int force) {
+    long long now = now_ms();
+    long long last = __atomic_load_n(&find_last_redraw_ms, __ATOMIC_RELAXED);
+    if (!force && now - last < FIND_REDRAW_INTERVAL_MS) {
+        return;
+    }
+    if (__atomic_compare_exchange_n(&find_last_redraw_ms, &last, now, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED) || force) {
+        ui_post_redraw();
+    }
+}
+
+// "10M" 같은 크기. return -1 - 형식 오류
+static long long parse_size(const char *s) {
+    char *end;
+    double v = strtod(s, &end);
+    if (end == s || v < 0) {
+        return -1;
+    }
+    switch (*end) {
+        case 'k': case 'K': v *= 1024; end++; break;
+        case 'm': case 'M': v *= 1024 * 1024; end++; break;
+        case 'g': case 'G': v *= 1024.0 * 1024 * 1024; end++; break;
+        default: break;
+    }
+    return *end == '\0' ? (long long)v : -1;
+}
+
+// "7d" 같은 기간 (초). return -1 - 형식 오류
+static long long parse_age(const char *s) {
+    char *end;
+    double v = strtod(s, &end);
+    if (end == s || v < 0) {
+        return -1;
+    }
+    switch (*end) {
+        case 's': end++; break;
+        case 'm': v *= 60; end++; break;
+        case 'h': v *= 3600; end++; break;
+        case 'd': case '\0': v *= 86400; end += *end ? 1 : 0; break;
+        default: return -1;
+    }
+    return *end == '\0' ? (long long)v : -1;
+}
+
+// return 0 - 성공, -1 - 형식 오류 (error 에 이유)
+static int parse_query(const char *text, find_query *q, char *error, size_t error_size) {
+    memset(q, 0, sizeof(*q));
+    q->min_size = q->max_size = -1;
+    time_t now = time(NULL);
+    char copy[FIND_MAX_QUERY];
+    snprintf(copy, sizeof(copy), "%s", text);
+
+    char *save = NULL;
+    for (char *tok = strtok_r(copy, " \t", &save); tok; tok = strtok_r(NULL, " \t", &save)) {
+        if (strncmp(tok, "size>", 5) == 0 || strncmp(tok, "size<", 5) == 0) {
+            long long v = parse_size(tok + 5);
+            if (v < 0) {
+                snprintf(error, error_size, "bad size: %s", tok);
+                return -1;
+            }
+            *(tok[4] == '>' ? &q->min_size : &q->max_size) = v;
+            q->need_stat = 1;
+        } else if (strncmp(tok, "mtime<", 6) == 0 || strncmp(tok, "mtime>", 6) == 0) {
+            long long age = parse_age(tok + 6);
+            if (age < 0) {
+                snprintf(error, error_size, "bad age: %s", tok);
+                return -1;
+            }
+            *(tok[5] == '<' ? &q->newer : &q->older) = now - (time_t)age;
+            q->need_stat = 1;
+        } else if (strncmp(tok, "type:", 5) == 0) {
+            switch (tok[5]) {
+                case 'f': q->type = S_IFREG; break;
+                case 'd': q->type = S_IFDIR; break;
+                case 'l': q->type = S_IFLNK; break;
+                default:
+                    snprintf(error, error_size, "bad type: %s (f, d or l)", tok);
+                    return -1;
+            }
+        } else if (q->name_count < FIND_MAX_TERMS) {
+            snprintf(q->names[q->name_count], FIND_MAX_QUERY, "%s", tok);
+            q->glob[q->name_count] = strpbrk(tok, "*?[") != NULL;
+            q->name_count++;
+        } else {
+            snprintf(error, error_size, "too many name patterns");
+            return -1;
+        }
+    }
+    if (q->name_count == 0 && !q->need_stat && !q->type) {
+        snprintf(error, error_size, "empty query");
+        return -1;
+    }
+    return 0;
+}
+
+static int query_match(const find_query *q, const char *name, const struct stat *st) {
+    if (q->type && (st->st_mode & S_IFMT) != q->type) {
+        return 0;
+    }
+    for (int i = 0; i < q->name_count; i++) {
+        if (q->glob[i] ? fnmatch(q->names[i], name, FNM_CASEFOLD) != 0 : !strcasestr(name, q->names[i])) {
+            return 0;
+        }
+    }
+    if (q->need_stat) {
+        if ((q->min_size >= 0 && st->st_size <= q->min_size) || (q->max_size >= 0 && st->st_size >= q->max_size)) {
+            return 0;
+        }
+        if ((q->newer && st->st_mtime < q->newer) || (q->older && st->st_mtime >= q->older)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// 경로를 블록에 복사한다 (호출 전에 find_lock). return NULL - 메모리 부족
+static const char *store_path(const char *path, size_t len) {
+    if (!blocks || blocks->used + len + 1 > FIND_BLOCK_SIZE) {
+        find_block *b = malloc(sizeof(find_block) + FIND_BLOCK_SIZE);
+        if (!b) {
+            return NULL;
+        }
+        b->next = blocks;
+        b->used = 0;
+        blocks = b;
+    }
+    char *p = blocks->data + blocks->used;
+    memcpy(p, path, len + 1);
+    blocks->used += len + 1;
+    return p;
+}
+
+// dir - 항목이 있는 디렉토리의 전체 경로, known - st 의 크기와 시각이 있음
+static void add_match(const find_search *search, const char *dir, const char *name, const struct stat *st, int known) {
+    const char *rel = dir + search->root_len;
+    while (*rel == '/') {
+        rel++;
+    }
+    char joined[4096];
+    int len = snprintf(joined, sizeof(joined), "%s%s%s", rel, *rel ? "/" : "", name);
+    if (len < 0 || len >= (int)sizeof(joined)) {
+        return;
+    }
+
+    pthread_mutex_lock(&find_lock);
+    if (search->generation != find_generation) { // 취소한 검색
+        pthread_mutex_unlock(&find_lock);
+        return;
+    }
+    match_total++;
+    if (entry_count < FIND_MAX_RESULTS) {
+        if (entry_count == entry_capacity) {
+            int new_capacity = entry_capacity ? entry_capacity * 2 : 1024;
+            find_entry *p = realloc(entries, new_capacity * sizeof(find_entry));
+            if (p) {
+                entries = p;
+                entry_capacity = new_capacity;
+            }
+        }
+        const char *stored = entry_count < entry_capacity ? store_path(joined, len) : NULL;
+        if (stored) {
+            find_entry *e = &entries[entry_count++];
+            e->path = stored;
+            e->mode = st->st_mode;
+            e->size = known ? (long long)st->st_size : -1;
+            e->mtime = known ? st->st_mtime : 0;
+        }
+    }
+    pthread_mutex_unlock(&find_lock);
+    find_post_redraw(0);
+}
+
+// 색인의 항목 - 이전에 읽은 목록이 그대로인 하위 트리는 다시 읽지 않는다
+static void find_index_visit(void *ctx, const char *dir, const char *name, const tindex_entry *e) {
+    const find_search *search = ctx;
+    struct stat st;
+    memset(&st, 0, sizeof(st));
+    st.st_mode = e->mode;
+    st.st_ino = e->ino;
+    st.st_size = e->size;
+    st.st_mtime = e->mtime_sec;
+    if (query_match(&search->query, name, &st)) {
+        // 하위 디렉토리의 시각은 tindex_scan_tree 가 lstat 으로 확인했다 - 파일은 순회할 때처럼 모르는 것으로
+        add_match(search, dir, name, &st, S_ISDIR(e->mode) && e->size >= 0);
+    }
+}
+
+// 하위 디렉토리에 들어가기 전 - 색인으로 답할 수 있으면 들어가지 않는다
+// 색인의 크기와 시각은 파일 내용이 바뀌어도 그대로이므로 (디렉토리 mtime 은 그대로) 그것이 필요한 검색은 순회한다
+static int find_enter(walker *w, walk_node *node, void *ctx) {
+    (void)w;
+    const find_search *search = ctx;
+    char path[4096];
+    if (!tindex_enabled() || search->query.need_stat || walk_node_path(node, path, sizeof(path)) < 0) {
+        return 1;
+    }
+    return tindex_scan_tree(path, node->dev, node->ino, &node->mtime, find_index_visit, ctx) != 0;
+}
+
+static void find_visit(walker *w, walk_node *parent, const char *name, const struct stat *st, void *ctx) {
+    (void)w;
+    const find_search *search = ctx;
+    int known = search->query.need_stat || S_ISDIR(st->st_mode); // 디렉토리는 항상 stat 한다
+    tindex_walk_visit(parent, name, st, known);
+    if (!query_match(&search->query, name, st)) {
+        return;
+    }
+    // 일치한 항목만 부모 포인터를 따라 경로를 만든다
+    char path[4096];
+    if (walk_node_path(parent, path, sizeof(path)) < 0) {
+        return;
+    }
+    add_match(search, path, name, st, known);
+}
+
+static void find_listed(walker *w, walk_node *node, int complete, void *ctx) {
+    (void)w;
+    (void)ctx;
+    tindex_walk_listed(node, complete);
+}
+
+static void find_leave(walker *w, walk_node *node, void *ctx) {
+    (void)w;
+    (void)ctx;
+    if (node->depth == 0) { // 순회 끝
+        find_post_redraw(1);
+    }
+}
+
+static walk_ops find_ops = { find_enter, find_visit, find_leave, 0, find_listed };
+
+static void clear_results(void) {
+    pthread_mutex_lock(&find_lock);
+    free(entries);
+    entries = NULL;
+    entry_count = entry_capacity = 0;
+    match_total = 0;
+    while (blocks) {
+        find_block *b = blocks;
+        blocks = b->next;
+        free(b);
+    }
+    pthread_mutex_unlock(&find_lock);
+}
+
+int find_start(const char *root, const char *text, char *error, size_t error_size) {
+    find_query parsed;
+    if (parse_query(text, &parsed, error, error_size) < 0) {
+        return -1; // 이전 결과는 그대로
+    }
+    find_stop();
+    query = parsed;
+    snprintf(root_path, sizeof(root_path), "%s", root);
+    root_len = strlen(root_path);
+    find_search *search = malloc(sizeof(find_search));
+    if (!search) {
+        snprintf(error, error_size, "out of memory");
+        return -1;
+    }
+    search->query = query;
+    memcpy(search->root_path, root_path, sizeof(root_path));
+    search->root_len = root_len;
+    pthread_mutex_lock(&find_lock);
+    search->generation = find_generation;
+    pthread_mutex_unlock(&find_lock);
+    find_ops.skip_file_stat = !query.need_stat;
+    find_walker = walker_start(root_path, &find_ops, search, 0, 1);
+    if (!find_walker) {
+        free(search);
+        snprintf(error, error_size, "cannot open %s", root);
+        return -1;
+    }
+    find_current = search;
+    has_results = 1;
+    return 0;
+}
+
+typedef struct {
+    walker *w;
+    find_search *search;
+} find_reap;
+
+static void *find_reap_thread(void *arg) {
+    find_reap *r = arg;
+    walker_free(r->w);
+    free(r->search);
+    free(r);
+    return NULL;
+}
+
+void find_cancel(void) {
+    if (find_walker) {
+        scanned_final = walker_scanned(find_walker);
+        // 작업 스레드는 응답 없는 파일 시스템에서 오래 멈춰 있을 수 있다 - 기다리지 않고 따로 정리한다
+        walker_cancel(find_walker);
+        pthread_mutex_lock(&find_lock);
+        find_generation++; // 멈추는 중에 찾은 항목은 버린다 - 결과는 여기서 그대로
+        pthread_mutex_unlock(&find_lock);
+        find_reap *r = malloc(sizeof(find_reap));
+        pthread_t tid;
+        if (r) {
+            r->w = find_walker;
+            r->search = find_current;
+        }
+        if (r && pthread_create(&tid, NULL, find_reap_thread, r) == 0) {
+            pthread_detach(tid);
+        } else {
+            free(r);
+            walker_free(find_walker);
+            free(find_current);
+        }
+        find_walker = NULL;
+        find_current = NULL;
+    }
+}
+
+void find_stop(void) {
+    find_cancel();
+    clear_results();
+    has_results = 0;
+    scanned_final = 0;
+}
+
+int find_running(long long *scanned) {
+    if (!find_walker) {
+        if (scanned) {
+            *scanned = scanned_final;
+        }
+        return 0;
+    }
+    if (scanned) {
+        *scanned = walker_scanned(find_walker);
+    }
+    return !walker_done(find_walker);
+}
+
+int find_count(long long *total) {
+    pthread_mutex_lock(&find_lock);
+    int count = entry_count;
+    if (total) {
+        *total = match_total;
+    }
+    pthread_mutex_unlock(&find_lock);
+    return count;
+}
+
+int find_get(int idx, find_result *out) {
+    pthread_mutex_lock(&find_lock);
+    if (idx < 0 || idx >= entry_count) {
+        pthread_mutex_unlock(&find_lock);
+        return -1;
+    }
+    find_entry e = entries[idx];
+    snprintf(out->path, sizeof(out->path), "%s", e.path);
+    pthread_mutex_unlock(&find_lock);
+
+    if (e.size < 0) { // 이름만 보고 찾은 항목 - 화면에 보일 때 stat
+        char full[8192];
+        struct stat st;
+        snprintf(full, sizeof(full), "%s/%s", root_path, out->path);
+        if (lstat(full, &st) == 0) {
+            e.mode = st.st_mode;
+            e.size = st.st_size;
+            e.mtime = st.st_mtime;
+            pthread_mutex_lock(&find_lock);
+            if (idx < entry_count) {
+                entries[idx].mode = e.mode;
+                entries[idx].size = e.size;
+                entries[idx].mtime = e.mtime;
+            }
+            pthread_mutex_unlock(&find_lock);
+        }
+    }
+    out->mode = e.mode;
+    out->size = e.size;
+    out->mtime = e.mtime;
+    return 0;
+}
+
+const char *find_root(void) {
+    return has_results ? root_path : NULL;
+}
@@ -0,0 +1,50 @@
+#ifndef __FINDER__
+#define __FINDER__
+
+#include <time.h>
+#include <sys/types.h>
+
+#define FIND_MAX_QUERY 256
+#define FIND_MAX_RESULTS (1024 * 1024) // 목록에 기록하는 최대 결과 수 (그 뒤로는 개수만 센다)
+
+// 현재 디렉토리 아래의 재귀 검색 (find)
+// walker 로 병렬 순회하며 조건에 맞는 항목을 찾는 즉시 결과 목록에 추가한다
+// 검색어는 공백으로 나눈 조건을 모두 만족하는 항목 (AND)
+//   이름      - 글롭 패턴 (*, ?, [..]), 글롭 문자가 없으면 이름에 포함된 문자열. 대소문자 무시
+//   size>N    - 크기 (K, M, G 단위 가능), size<N
+//   mtime<N   - N 안에 수정됨 (s, m, h, d 단위, 기본 d), mtime>N - N 보다 오래됨
+//   type:f    - 일반 파일, type:d 디렉토리, type:l 심볼릭 링크
+// 크기나 시각 조건이 없으면 디렉토리가 아닌 항목은 stat 하지 않는다 (이름과 d_type 만으로 판단)
+// 다른 파일 시스템으로는 넘어가지 않는다 (find -xdev)
+
+typedef struct {
+    char path[4096];      // 루트 기준 상대 경로
+    mode_t mode;          // 파일 종류와 권한 (stat 하지 않았으면 종류만)
+    long long size;       // 크기, 모르면 -1
+    time_t mtime;         // 수정 시각, 모르면 0
+} find_result;
+
+// root 아래에서 query 검색을 시작한다. 진행 중이던 이전 검색과 결과는 버린다 (UI 스레드 전용)
+// return 0 - 성공, -1 - 검색어 오류 또는 root 를 열 수 없음 (error 에 이유)
+int find_start(const char *root, const char *query, char *error, size_t error_size);
+
+// 순회를 멈춘다. 찾은 결과는 남는다 (UI 스레드 전용)
+void find_cancel(void);
+
+// 순회를 멈추고 결과를 버린다 (UI 스레드 전용)
+void find_stop(void);
+
+// 1 - 순회 중. scanned 는 지금까지 읽은 디렉토리 수 (NULL 가능)
+int find_running(long long *scanned);
+
+// 목록에 있는 결과 수. total 에는 찾은 전체 수 (FIND_MAX_RESULTS 를 넘으면 더 크다, NULL 가능)
+int find_count(long long *total);
+
+// idx 번째 결과를 out 에 복사한다. 크기와 시각을 모르면 이때 stat 한다
+// return 0 - 성공, -1 - 범위 밖
+int find_get(int idx, find_result *out);
+
+// 검색 중인 루트, 없으면 NULL
+const char *find_root(void);
+
+#endif
@@ -0,0 +1,163 @@
+#include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "hash.h"
+
+#define PRIME32_1 0x9E3779B1U
+#define PRIME32_2 0x85EBCA77U
+#define PRIME32_3 0xC2B2AE3DU
+#define PRIME64_1 0x9E3779B185EBCA87ULL
+#define PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define PRIME64_3 0x165667B19E3779F9ULL
+#define PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define PRIME64_5 0x27D4EB2F165667C5ULL
+
+#define STRIPES_PER_BLOCK 16 // 이 만큼 더할 때마다 누산기를 섞는다 (1KB)
+
+// 키 - 64바이트마다 한 칸씩 밀려서 쓰고, 끝의 8개는 섞을 때 쓴다 (splitmix64 로 만든 상수)
+static const uint64_t key[STRIPES_PER_BLOCK + 8] = {
+    0xE220A8397B1DCDAFULL, 0x6E789E6AA1B965F4ULL, 0x06C45D188009454FULL, 0xF88BB8A8724C81ECULL,
+    0x1B39896A51A8749BULL, 0x53CB9F0C747EA2EAULL, 0x2C829ABE1F4532E1ULL, 0xC584133AC916AB3CULL,
+    0x3EE5789041C98AC3ULL, 0xF3B8488C368CB0A6ULL, 0x657EECDD3CB13D09ULL, 0xC2D326E0055BDEF6ULL,
+    0x8621A03FE0BBDB7BULL, 0x8E1F7555983AA92FULL, 0xB54E0F1600CC4D19ULL, 0x84BB3F97971D80ABULL,
+    0x7D29825C75521255ULL, 0xC3CF17102B7F7F86ULL, 0x3466E9A083914F64ULL, 0xD81A8D2B5A4485ACULL,
+    0xDB01602B100B9ED7ULL, 0xA9038A921825F10DULL, 0xEDF5F1D90DCA2F6AULL, 0x54496AD67BD2634CULL,
+};
+
+static inline uint64_t read64(const unsigned char *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v)); // x86 은 리틀 엔디언
+    return v;
+}
+
+// 64바이트 하나를 누산기에 더한다
+// acc[i] += (d[i]^k[i]) 의 아래 32비트 * 위 32비트, acc[i^1] += d[i]
+static void accumulate(uint64_t *acc, const unsigned char *data, const uint64_t *k) {
+#ifdef __SSE2__
+    __m128i *a = (__m128i *)acc;
+    for (int i = 0; i < 4; i++) {
+        __m128i d = _mm_loadu_si128((const __m128i *)(data + 16 * i));
+        __m128i dk = _mm_xor_si128(d, _mm_loadu_si128((const __m128i *)(k + 2 * i)));
+        __m128i product = _mm_mul_epu32(dk, _mm_shuffle_epi32(dk, _MM_SHUFFLE(0, 3, 0, 1)));
+        __m128i swapped = _mm_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2));
+        __m128i v = _mm_loadu_si128(a + i);
+        _mm_storeu_si128(a + i, _mm_add_epi64(v, _mm_add_epi64(product, swapped)));
+    }
+#else
+    for (int i = 0; i < 8; i++) {
+        uint64_t d = read64(data + 8 * i);
+        uint64_t dk = d ^ k[i];
+        acc[i ^ 1] += d;
+        acc[i] += (dk & 0xFFFFFFFFULL) * (dk >> 32);
+    }
+#endif
+}
+
+// 블록마다 누산기의 위쪽 비트를 아래로 섞는다
+static void scramble(uint64_t *acc, const uint64_t *k) {
+#ifdef __SSE2__
+    __m128i *a = (__m128i *)acc;
+    const __m128i prime = _mm_set1_epi32((int)PRIME32_1);
+    for (int i = 0; i < 4; i++) {
+        __m128i v = _mm_loadu_si128(a + i);
+        v = _mm_xor_si128(v, _mm_srli_epi64(v, 47));
+        v = _mm_xor_si128(v, _mm_loadu_si128((const __m128i *)(k + 2 * i)));
+        // 64비트 * 32비트 = 아래 32비트 곱 + (위 32비트 곱 << 32)
+        __m128i lo = _mm_mul_epu32(v, prime);
+        __m128i hi = _mm_mul_epu32(_mm_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 1, 1)), prime);
+        _mm_storeu_si128(a + i, _mm_add_epi64(lo, _mm_slli_epi64(hi, 32)));
+    }
+#else
+    for (int i = 0; i < 8; i++) {
+        uint64_t v = acc[i];
+        v ^= v >> 47;
+        v ^= k[i];
+        acc[i] = v * PRIME32_1;
+    }
+#endif
+}
+
+static void add_stripe(hash_state *hs, const unsigned char *data) {
+    accumulate(hs->acc, data, key + hs->stripe);
+    if (++hs->stripe == STRIPES_PER_BLOCK) {
+        scramble(hs->acc, key + STRIPES_PER_BLOCK);
+        hs->stripe = 0;
+    }
+}
+
+void hash_init(hash_state *hs) {
+    static const uint64_t init[8] = {
+        PRIME32_3, PRIME64_1, PRIME64_2, PRIME64_3, PRIME64_4, PRIME32_2, PRIME64_5, PRIME32_1
+    };
+    memcpy(hs->acc, init, sizeof(init));
+    hs->buf_len = 0;
+    hs->stripe = 0;
+    hs->total = 0;
+}
+
+void hash_update(hash_state *hs, const void *data, size_t len) {
+    const unsigned char *p = data;
+    hs->total += len;
+    if (hs->buf_len > 0) {
+        size_t take = 64 - hs->buf_len < len ? 64 - hs->buf_len : len;
+        memcpy(hs->buf + hs->buf_len, p, take);
+        hs->buf_len += take;
+        p += take;
+        len -= take;
+        if (hs->buf_len < 64) {
+            return;
+        }
+        add_stripe(hs, hs->buf);
+        hs->buf_len = 0;
+    }
+    while (len >= 64) {
+        add_stripe(hs, p);
+        p += 64;
+        len -= 64;
+    }
+    memcpy(hs->buf, p, len);
+    hs->buf_len = len;
+}
+
+static uint64_t mul_fold(uint64_t a, uint64_t b) {
+    unsigned __int128 r = (unsigned __int128)a * b;
+    return (uint64_t)r ^ (uint64_t)(r >> 64);
+}
+
+static uint64_t avalanche(uint64_t h) {
+    h ^= h >> 37;
+    h *= 0x165667919E3779F9ULL;
+    return h ^ (h >> 32);
+}
+
+// 누산기 8개를 64비트 하나로 (k 는 서로 다른 키 위치)
+static uint64_t merge(const uint64_t *acc, const uint64_t *k, uint64_t start) {
+    uint64_t r = start;
+    for (int i = 0; i < 4; i++) {
+        r += mul_fold(acc[2 * i] ^ k[2 * i], acc[2 * i + 1] ^ k[2 * i + 1]);
+    }
+    return avalanche(r);
+}
+
+hash128 hash_final(const hash_state *hs) {
+    uint64_t acc[8];
+    memcpy(acc, hs->acc, sizeof(acc));
+    if (hs->buf_len > 0) { // 나머지는 0 으로 채워서 더한다 (길이를 따로 섞으므로 구분됨)
+        unsigned char last[64] = {0};
+        memcpy(last, hs->buf, hs->buf_len);
+        accumulate(acc, last, key + hs->stripe);
+    }
+    hash128 h;
+    h.lo = merge(acc, key + 3, hs->total * PRIME64_1);
+    h.hi = merge(acc, key + 11, ~(hs->total * PRIME64_2));
+    return h;
+}
+
+hash128 hash_buffer(const void *data, size_t len) {
+    hash_state hs;
+    hash_init(&hs);
+    hash_update(&hs, data, len);
+    return hash_final(&hs);
+}
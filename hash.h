@@ -0,0 +1,35 @@
+#ifndef __HASH__
+#define __HASH__
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 파일 내용 비교용 128비트 해시 (암호용 아님)
+// 64바이트 단위로 8개의 64비트 누산기에 더하는 구조라서 SSE2 로 두 개씩 한 번에 계산한다
+// (32x32->64 곱셈과 덧셈만 쓰므로 스칼라와 결과가 같다)
+
+typedef struct {
+    uint64_t lo;
+    uint64_t hi;
+} hash128;
+
+typedef struct {
+    uint64_t acc[8];
+    unsigned char buf[64];  // 64바이트가 되지 않은 나머지
+    size_t buf_len;
+    int stripe;             // 블록 안의 64바이트 순번 (키 위치)
+    uint64_t total;         // 지금까지 넣은 바이트 수
+} hash_state;
+
+void hash_init(hash_state *hs);
+void hash_update(hash_state *hs, const void *data, size_t len);
+hash128 hash_final(const hash_state *hs);
+
+// 한 번에 해시
+hash128 hash_buffer(const void *data, size_t len);
+
+static inline int hash_equal(hash128 a, hash128 b) {
+    return a.lo == b.lo && a.hi == b.hi;
+}
+
+#endif
@@ -0,0 +1,344 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+
+#include "jobs.h"
+#include "copy.h"
+#include "treecopy.h"
+#include "uichannel.h"
+
+// 작업 하나 = 클립보드 항목 묶음의 복사 또는 이동
+typedef struct job {
+    int id;
+    int action;
+    volatile int state;
+    int item_count;
+    char **sources;
+    char **destinations;
+    char destination_dir[MAX_DIR_LENGTH];
+    tree_copy_stats stats;
+    struct timespec started;
+    struct timespec finished;
+    struct job *next;
+} job;
+
+static pthread_mutex_t jobs_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t jobs_cond = PTHREAD_COND_INITIALIZER;   // 대기 작업이 생김
+static job *job_list = NULL;        // 모든 작업 (제출 순서)
+static job *job_list_tail = NULL;
+static int next_job_id = 1;
+static int running_count = 0;
+static int threads_started = 0;
+
+static double elapsed(const struct timespec *from, const struct timespec *to) {
+    return (to->tv_sec - from->tv_sec) + (to->tv_nsec - from->tv_nsec) / 1e9;
+}
+
+const char *job_state_name(int state) {
+    switch (state) {
+        case JOB_PENDING: return "queued";
+        case JOB_RUNNING: return "running";
+        case JOB_DONE: return "done";
+        case JOB_FAILED: return "failed";
+        case JOB_CANCELLED: return "cancelled";
+        default: return "?";
+    }
+}
+
+void format_eta(char *buf, size_t buf_size, double seconds) {
+    if (seconds < 0) {
+        snprintf(buf, buf_size, "-");
+        return;
+    }
+    long s = (long)(seconds + 0.5);
+    if (s >= 3600) {
+        snprintf(buf, buf_size, "%ld:%02ld:%02ld", s / 3600, (s / 60) % 60, s % 60);
+    } else {
+        snprintf(buf, buf_size, "%ld:%02ld", s / 60, s % 60);
+    }
+}
+
+static void free_job(job *j) {
+    for (int i = 0; i < j->item_count; i++) {
+        free(j->sources[i]);
+        free(j->destinations[i]);
+    }
+    free(j->sources);
+    free(j->destinations);
+    free(j);
+}
+
+// 작업 하나 실행 (작업 스레드)
+static void run_job(job *j) {
+    for (int i = 0; i < j->item_count && !j->stats.cancel; i++) {
+        if (j->action == CLIPBOARD_CUT) {
+            move_tree(j->sources[i], j->destinations[i], &j->stats);
+        } else {
+            copy_tree(j->sources[i], j->destinations[i], &j->stats);
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &j->finished);
+    double seconds = elapsed(&j->started, &j->finished);
+    const char *verb = j->action == CLIPBOARD_CUT ? "moved" : "copied";
+
+    // 상태를 바꾸면 jobs_clear_finished 가 지울 수 있으므로 메시지를 먼저 만든다
+    int state;
+    char message[UI_STATUS_LENGTH];
+    // 이어 복사하도록 남긴 임시 파일이 있으면 알린다 (목록에서 PART 로 보이고, 선택하면 지울 수 있다)
+    char kept[64] = "";
+    if (j->stats.partials_kept) {
+        snprintf(kept, sizeof(kept), ", %d partial cop%s kept for resume", j->stats.partials_kept,
+                 j->stats.partials_kept == 1 ? "y" : "ies");
+    }
+    if (j->stats.cancel) {
+        state = JOB_CANCELLED;
+        snprintf(message, sizeof(message), "Job #%d cancelled (%lld files %s%s)", j->id, j->stats.files_done, verb,
+                 kept);
+    } else if (j->stats.errors) {
+        state = JOB_FAILED;
+        snprintf(message, sizeof(message), "Job #%d failed (%d errors%s), %.256s: %s", j->id, j->stats.errors, kept,
+                 j->stats.error_path, strerror(j->stats.first_error));
+    } else {
+        state = JOB_DONE;
+        char speed[16], checked[64] = "";
+        format_size(speed, sizeof(speed), seconds > 0 ? j->stats.bytes_done / seconds : 0);
+        if (j->stats.files_checksummed) { // 큰 파일의 해시는 대상 파일의 xattr 에 남아 있다
+            snprintf(checked, sizeof(checked), ", %lld checksummed, %lld verified", j->stats.files_checksummed,
+                     j->stats.files_verified);
+        }
+        snprintf(message, sizeof(message), "Job #%d done: %lld files %s to %.256s (%s/s%s)", j->id,
+                 j->stats.files_done, verb, j->destination_dir, speed, checked);
+    }
+
+    pthread_mutex_lock(&jobs_lock);
+    j->state = state;
+    running_count--;
+    pthread_cond_broadcast(&jobs_cond); // jobs_shutdown 이 기다릴 수 있다
+    pthread_mutex_unlock(&jobs_lock);
+
+    ui_post_status("%s", message);
+}
+
+// 대기 중인 작업을 꺼내 실행하는 스레드 (JOBS_MAX_RUNNING 개)
+static void *runner_thread(void *arg) {
+    while (1) {
+        pthread_mutex_lock(&jobs_lock);
+        job *j = NULL;
+        while (1) {
+            for (j = job_list; j && j->state != JOB_PENDING; j = j->next) {
+            }
+            if (j) {
+                break;
+            }
+            pthread_cond_wait(&jobs_cond, &jobs_lock);
+        }
+        j->state = JOB_RUNNING;
+        running_count++;
+        clock_gettime(CLOCK_MONOTONIC, &j->started);
+        pthread_cond_broadcast(&jobs_cond); // 진행 스레드 깨우기
+        pthread_mutex_unlock(&jobs_lock);
+
+        run_job(j);
+    }
+    return NULL;
+}
+
+// 작업 실행 중에만 주기적으로 화면 갱신을 요청하는 스레드
+static void *progress_thread(void *arg) {
+    while (1) {
+        pthread_mutex_lock(&jobs_lock);
+        while (running_count == 0) {
+            pthread_cond_wait(&jobs_cond, &jobs_lock);
+        }
+        pthread_mutex_unlock(&jobs_lock);
+
+        ui_post_redraw();
+        usleep(JOBS_PROGRESS_MS * 1000);
+    }
+    return NULL;
+}
+
+static void start_threads(void) {
+    pthread_t tid;
+    for (int i = 0; i < JOBS_MAX_RUNNING; i++) {
+        if (pthread_create(&tid, NULL, runner_thread, NULL) == 0) {
+            pthread_detach(tid);
+            threads_started++;
+        }
+    }
+    if (pthread_create(&tid, NULL, progress_thread, NULL) == 0) {
+        pthread_detach(tid);
+    }
+}
+
+int jobs_submit(int action, char **sources, char **destinations, int count, const char *destination_dir) {
+    job *j = calloc(1, sizeof(job));
+    if (!j) {
+        return -1;
+    }
+    j->action = action;
+    j->state = JOB_PENDING;
+    j->item_count = count;
+    j->sources = sources;
+    j->destinations = destinations;
+    strncpy(j->destination_dir, destination_dir, sizeof(j->destination_dir) - 1);
+
+    pthread_mutex_lock(&jobs_lock);
+    if (!threads_started) {
+        start_threads();
+    }
+    if (!threads_started) {
+        pthread_mutex_unlock(&jobs_lock);
+        free(j); // 배열과 문자열은 호출한 쪽이 해제한다
+        return -1;
+    }
+    j->id = next_job_id++;
+    if (job_list_tail) {
+        job_list_tail->next = j;
+    } else {
+        job_list = j;
+    }
+    job_list_tail = j;
+    // 작업 스레드와 진행 스레드 모두 깨운다
+    pthread_cond_broadcast(&jobs_cond);
+    pthread_mutex_unlock(&jobs_lock);
+    return j->id;
+}
+
+void jobs_cancel(int id) {
+    pthread_mutex_lock(&jobs_lock);
+    for (job *j = job_list; j; j = j->next) {
+        if (j->id != id) {
+            continue;
+        }
+        if (j->state == JOB_PENDING) {
+            j->state = JOB_CANCELLED;
+        } else if (j->state == JOB_RUNNING) {
+            j->stats.cancel = 1;
+        }
+        break;
+    }
+    pthread_mutex_unlock(&jobs_lock);
+}
+
+void jobs_shutdown(void) {
+    pthread_mutex_lock(&jobs_lock);
+    for (job *j = job_list; j; j = j->next) {
+        if (j->state == JOB_PENDING) {
+            j->state = JOB_CANCELLED;
+        } else if (j->state == JOB_RUNNING) {
+            j->stats.cancel = 1;
+        }
+    }
+    while (running_count > 0) {
+        pthread_cond_wait(&jobs_cond, &jobs_lock);
+    }
+    pthread_mutex_unlock(&jobs_lock);
+}
+
+void jobs_clear_finished(void) {
+    pthread_mutex_lock(&jobs_lock);
+    job **pp = &job_list;
+    job_list_tail = NULL;
+    while (*pp) {
+        job *j = *pp;
+        if (j->state == JOB_DONE || j->state == JOB_FAILED || j->state == JOB_CANCELLED) {
+            *pp = j->next;
+            free_job(j);
+        } else {
+            job_list_tail = j;
+            pp = &j->next;
+        }
+    }
+    pthread_mutex_unlock(&jobs_lock);
+}
+
+static void fill_info(job *j, job_info *info, const struct timespec *now) {
+    memset(info, 0, sizeof(*info));
+    info->id = j->id;
+    info->action = j->action;
+    info->state = j->state;
+    info->item_count = j->item_count;
+    if (j->item_count > 0) {
+        strncpy(info->first_source, j->sources[0], sizeof(info->first_source) - 1);
+        info->first_source[sizeof(info->first_source) - 1] = '\0';
+    }
+    memcpy(info->destination_dir, j->destination_dir, sizeof(info->destination_dir)); // 같은 크기의 배열
+    info->files_done = j->stats.files_done;
+    info->files_total = j->stats.files_total;
+    info->bytes_done = j->stats.bytes_done;
+    info->bytes_total = j->stats.bytes_total;
+    info->errors = j->stats.errors;
+    info->eta_seconds = -1;
+
+    if (j->state == JOB_PENDING) {
+        return;
+    }
+    const struct timespec *end = j->state == JOB_RUNNING ? now : &j->finished;
+    double seconds = elapsed(&j->started, end);
+    if (seconds > 0) {
+        info->bytes_per_sec = info->bytes_done / seconds;
+    }
+    if (j->state == JOB_RUNNING && info->bytes_per_sec > 0 && info->bytes_total >= info->bytes_done) {
+        info->eta_seconds = (info->bytes_total - info->bytes_done) / info->bytes_per_sec;
+    }
+}
+
+int jobs_snapshot(job_info *out, int max) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    int n = 0;
+    pthread_mutex_lock(&jobs_lock);
+    for (job *j = job_list; j && n < max; j = j->next) {
+        fill_info(j, &out[n++], &now);
+    }
+    pthread_mutex_unlock(&jobs_lock);
+    return n;
+}
+
+int jobs_summary(char *buf, size_t buf_size) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    int running = 0, queued = 0;
+    long long done = 0, total = 0;
+    double rate = 0;
+
+    pthread_mutex_lock(&jobs_lock);
+    for (job *j = job_list; j; j = j->next) {
+        if (j->state != JOB_RUNNING && j->state != JOB_PENDING) {
+            continue;
+        }
+        job_info info;
+        fill_info(j, &info, &now);
+        if (j->state == JOB_RUNNING) {
+            running++;
+            rate += info.bytes_per_sec;
+        } else {
+            queued++;
+        }
+        done += info.bytes_done;
+        total += info.bytes_total;
+    }
+    pthread_mutex_unlock(&jobs_lock);
+
+    buf[0] = '\0';
+    if (running + queued == 0) {
+        return 0;
+    }
+
+    char done_str[16], total_str[16], rate_str[16], eta_str[16];
+    format_size(done_str, sizeof(done_str), done);
+    format_size(total_str, sizeof(total_str), total);
+    format_size(rate_str, sizeof(rate_str), rate);
+    format_eta(eta_str, sizeof(eta_str), rate > 0 && total >= done ? (total - done) / rate : -1);
+    snprintf(buf, buf_size, "Jobs: %d running, %d queued  %s/%s  %s/s  ETA %s",
+             running, queued, done_str, total_str, rate_str, eta_str);
+    return running + queued;
+}
@@ -0,0 +1,58 @@
+#ifndef __JOBS__
+#define __JOBS__
+
+#include <stddef.h>
+
+#include "project_macro.h"
+
+#define JOBS_MAX_RUNNING 2   // 동시에 실행하는 작업 수
+#define JOBS_PROGRESS_MS 250 // 작업 실행 중 화면 갱신 간격
+
+// 작업 상태
+#define JOB_PENDING 0
+#define JOB_RUNNING 1
+#define JOB_DONE 2
+#define JOB_FAILED 3
+#define JOB_CANCELLED 4
+
+// 화면 출력용 작업 정보 (작업 목록의 스냅샷)
+typedef struct {
+    int id;
+    int action;            // CLIPBOARD_COPY 또는 CLIPBOARD_CUT
+    int state;
+    int item_count;
+    char first_source[MAX_DIR_LENGTH];
+    char destination_dir[MAX_DIR_LENGTH];
+    long long files_done, files_total;
+    long long bytes_done, bytes_total;
+    int errors;
+    double bytes_per_sec;
+    double eta_seconds;    // 모르면 -1
+} job_info;
+
+// 복사/이동 작업 묶음을 큐에 넣는다. 성공하면 sources, destinations 와 각 문자열의 소유권을 넘겨받는다
+// return 작업 번호, 실패 시 -1 (이때는 호출한 쪽이 그대로 해제해야 한다)
+int jobs_submit(int action, char **sources, char **destinations, int count, const char *destination_dir);
+
+// 작업 취소 (대기 중이면 바로, 실행 중이면 다음 청크에서 중단)
+void jobs_cancel(int id);
+
+// 모든 작업을 취소하고 실행 중인 작업이 멈출 때까지 기다린다 (종료 전에 호출)
+// 큰 파일은 체크포인트를 남기므로 다음 실행에서 같은 복사를 하면 이어서 한다
+void jobs_shutdown(void);
+
+// 끝난 작업을 목록에서 지운다
+void jobs_clear_finished(void);
+
+// 작업 목록 스냅샷, return 채운 개수
+int jobs_snapshot(job_info *out, int max);
+
+// 실행 중/대기 중인 작업 전체의 한 줄 요약, return 활성 작업 수 (0 이면 buf 는 빈 문자열)
+int jobs_summary(char *buf, size_t buf_size);
+
+const char *job_state_name(int state);
+
+// 남은 시간 문자열 (예: "1:05:30", "-")
+void format_eta(char *buf, size_t buf_size, double seconds);
+
+#endif
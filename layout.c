@@ -0,0 +1,250 @@
+#include <string.h>
+#include <wchar.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "layout.h"
+
+// 표시 단위의 종류
+#define UNIT_TEXT 0  // 바이트를 그대로 출력
+#define UNIT_TAB 1   // 다음 탭 위치까지 공백
+#define UNIT_CTRL 2  // ^X
+#define UNIT_BAD 3   // 잘못된 UTF-8 또는 출력할 수 없는 문자 - '?'
+
+// 기본 다국어 평면 문자의 폭 캐시. 값은 폭+2 (wcwidth 가 -1 이면 1), 0 은 아직 모름
+// 로케일은 main 에서 한 번만 설정하므로 처음 계산한 값을 계속 쓴다
+static unsigned char width_cache[0x10000];
+
+static int char_width(unsigned int cp) {
+    if (cp < 0x10000) {
+        unsigned char w = width_cache[cp];
+        if (!w) {
+            w = (unsigned char)(wcwidth((wchar_t)cp) + 2);
+            width_cache[cp] = w;
+        }
+        return (int)w - 2;
+    }
+    return wcwidth((wchar_t)cp);
+}
+
+// UTF-8 문자 하나를 읽는다. return 바이트 수, 잘못된 시퀀스면 0
+static int decode_utf8(const unsigned char *s, size_t len, unsigned int *cp) {
+    unsigned char c = s[0];
+    int need;
+    unsigned int value;
+    if (c >= 0xC2 && c <= 0xDF) {
+        need = 1;
+        value = c & 0x1F;
+    } else if (c >= 0xE0 && c <= 0xEF) {
+        need = 2;
+        value = c & 0x0F;
+    } else if (c >= 0xF0 && c <= 0xF4) {
+        need = 3;
+        value = c & 0x07;
+    } else {
+        return 0;
+    }
+    if ((size_t)need >= len) {
+        return 0;
+    }
+    for (int i = 1; i <= need; i++) {
+        if ((s[i] & 0xC0) != 0x80) {
+            return 0;
+        }
+        value = (value << 6) | (s[i] & 0x3F);
+    }
+    // 너무 긴 표현, 서로게이트, 범위 밖
+    if ((need == 2 && value < 0x800) || (need == 3 && (value < 0x10000 || value > 0x10FFFF)) ||
+        (value >= 0xD800 && value <= 0xDFFF)) {
+        return 0;
+    }
+    *cp = value;
+    return need + 1;
+}
+
+// src[0, len) 앞부분의 출력 가능한 ASCII (0x20 - 0x7E) 바이트 수
+static size_t ascii_run(const unsigned char *src, size_t len) {
+    size_t i = 0;
+#ifdef __SSE2__
+    const __m128i below = _mm_set1_epi8(0x1F);
+    const __m128i del = _mm_set1_epi8(0x7F);
+    while (i + 16 <= len) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+        // 부호 있는 비교라서 0x80 이상은 음수 - 0x1F 보다 크지 않다
+        __m128i ok = _mm_andnot_si128(_mm_cmpeq_epi8(v, del), _mm_cmpgt_epi8(v, below));
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(ok);
+        if (mask != 0xFFFF) {
+            return i + __builtin_ctz(~mask);
+        }
+        i += 16;
+    }
+#endif
+    while (i < len && src[i] >= 0x20 && src[i] < 0x7F) {
+        i++;
+    }
+    return i;
+}
+
+// src 에서 시작하는 ASCII 가 아닌 표시 단위 하나 (col 은 탭 계산용 현재 열)
+static int next_unit(const unsigned char *src, size_t len, int col, size_t *bytes, int *width) {
+    unsigned char c = src[0];
+    if (c == '\t') {
+        *bytes = 1;
+        *width = LAYOUT_TAB_WIDTH - col % LAYOUT_TAB_WIDTH;
+        return UNIT_TAB;
+    }
+    if (c < 0x20 || c == 0x7F) {
+        *bytes = 1;
+        *width = 2;
+        return UNIT_CTRL;
+    }
+    unsigned int cp;
+    int n = decode_utf8(src, len, &cp);
+    if (n == 0) {
+        *bytes = 1;
+        *width = 1;
+        return UNIT_BAD;
+    }
+    *bytes = n;
+    int w = char_width(cp);
+    if (w < 0) { // C1 제어 문자 등
+        *width = 1;
+        return UNIT_BAD;
+    }
+    *width = w;
+    return UNIT_TEXT;
+}
+
+size_t layout_line(char *dst, size_t dst_size, const char *str, size_t len, int skip_cols, int max_width, int pad) {
+    const unsigned char *src = (const unsigned char *)str;
+    const int limit = skip_cols + max_width; // 보이는 열 [skip_cols, limit)
+    size_t used = 0;   // dst 에 쓴 바이트
+    size_t room = dst ? dst_size - 1 : (size_t)-1;
+    int col = 0;
+    int placed = 0;    // 보이는 영역에 놓은 단위가 있는지
+    size_t pos = 0;
+
+    while (pos < len && col < limit) {
+        // ASCII 는 한 칸씩이므로 남은 칸 수보다 더 볼 필요가 없다 (줄바꿈 없는 큰 파일에서도 화면 폭만큼만)
+        size_t run = ascii_run(src + pos, len - pos < (size_t)(limit - col) ? len - pos : (size_t)(limit - col));
+        if (run > 0) {
+            // ASCII 구간 중 보이는 부분만 한 번에 복사
+            size_t first = col < skip_cols ? (size_t)(skip_cols - col) : 0;
+            size_t last = run;
+            if ((size_t)(limit - col) < last) {
+                last = limit - col;
+            }
+            if (first < last) {
+                size_t n = last - first;
+                if (n > room - used) {
+                    n = room - used;
+                    last = first + n;
+                }
+                if (dst) {
+                    memcpy(dst + used, src + pos + first, n);
+                }
+                used += n;
+                placed = 1;
+            }
+            size_t take = last > first ? last : (first < run ? first : run);
+            col += (int)take;
+            pos += take;
+            if (take < run) {
+                break; // 오른쪽 끝 또는 dst 가 가득 참
+            }
+            continue;
+        }
+
+        size_t bytes;
+        int width;
+        int kind = next_unit(src + pos, len - pos, col, &bytes, &width);
+        if (col + width > limit) {
+            if (placed || skip_cols > 0 || col < skip_cols) {
+                break; // 다음 화면 줄에서 이어서
+            }
+            width = limit - col; // 화면보다 넓은 단위 하나 - 보이는 만큼만 채우고 넘어간다
+            kind = UNIT_TAB;
+        }
+        if (col + width <= skip_cols) { // 왼쪽으로 스크롤되어 보이지 않음
+            col += width;
+            pos += bytes;
+            continue;
+        }
+
+        int partial = col < skip_cols; // 왼쪽 경계에 걸친 2칸 문자나 탭
+        size_t need = kind == UNIT_TEXT ? bytes : (size_t)width;
+        if (need > room - used) {
+            break;
+        }
+        if (dst) {
+            if (partial && kind != UNIT_TAB) {
+                memset(dst + used, ' ', col + width - skip_cols);
+                need = col + width - skip_cols;
+            } else if (kind == UNIT_TEXT) {
+                memcpy(dst + used, src + pos, bytes);
+            } else if (kind == UNIT_TAB) {
+                need = partial ? (size_t)(col + width - skip_cols) : (size_t)width;
+                memset(dst + used, ' ', need);
+            } else if (kind == UNIT_CTRL) {
+                dst[used] = '^';
+                dst[used + 1] = src[pos] == 0x7F ? '?' : src[pos] + 0x40;
+            } else {
+                dst[used] = '?';
+            }
+        } else if (partial) {
+            need = col + width - skip_cols;
+        }
+        used += need;
+        placed = 1;
+        col += width;
+        pos += bytes;
+    }
+
+    // 오른쪽 끝에 오는 조합 문자 (폭 0) 는 앞 문자와 함께 둔다
+    while (pos < len && col == limit && src[pos] >= 0x80) {
+        size_t bytes;
+        int width;
+        if (next_unit(src + pos, len - pos, col, &bytes, &width) != UNIT_TEXT || width != 0 || bytes > room - used) {
+            break;
+        }
+        if (dst) {
+            memcpy(dst + used, src + pos, bytes);
+        }
+        used += bytes;
+        pos += bytes;
+    }
+
+    if (dst) {
+        int filled = col > skip_cols ? (col < limit ? col - skip_cols : max_width) : 0;
+        for (int i = filled; pad && i < max_width && used < room; i++) {
+            dst[used++] = ' ';
+        }
+        dst[used] = '\0';
+    }
+    return pos;
+}
+
+void layout_trimmed(char *dst, size_t dst_size, const char *str, int max_width) {
+    layout_line(dst, dst_size, str, strlen(str), 0, max_width, 1);
+}
+
+int layout_width(const char *str, size_t len) {
+    const unsigned char *src = (const unsigned char *)str;
+    int col = 0;
+    size_t pos = 0;
+    while (pos < len) {
+        size_t run = ascii_run(src + pos, len - pos);
+        if (run > 0) {
+            col += (int)run;
+            pos += run;
+            continue;
+        }
+        size_t bytes;
+        int width;
+        next_unit(src + pos, len - pos, col, &bytes, &width);
+        col += width;
+        pos += bytes;
+    }
+    return col;
+}
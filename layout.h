@@ -0,0 +1,26 @@
+#ifndef __LAYOUT__
+#define __LAYOUT__
+
+#include <stddef.h>
+
+#define LAYOUT_TAB_WIDTH 8
+
+// 한 줄을 화면 칸에 배치하는 함수들 (UTF-8)
+// - 출력 가능한 ASCII 는 16바이트씩 한 번에 확인해서 그대로 복사한다 (SSE2)
+// - 그 밖의 문자 폭은 wcwidth 결과를 표로 캐시해 둔다 (한글 등 2칸 문자)
+// - 탭은 다음 탭 위치까지 공백, 제어 문자는 ^X, 잘못된 UTF-8 바이트는 '?'
+// 결과는 한 줄 문자열이라 addstr 한 번 (또는 screen_put) 으로 출력할 수 있다
+
+// src[0, len) 을 화면 열 skip_cols 부터 max_width 칸만큼 dst 에 배치한다
+// pad 가 1 이면 남는 칸을 공백으로 채운다. dst 가 NULL 이면 소비할 바이트 수만 계산
+// 2칸 문자가 잘리는 경계는 공백으로 채운다
+// return 배치한 마지막 문자 다음의 src 위치 (줄바꿈 모드에서 다음 화면 줄의 시작)
+size_t layout_line(char *dst, size_t dst_size, const char *src, size_t len, int skip_cols, int max_width, int pad);
+
+// NUL 로 끝나는 문자열을 max_width 칸에 맞게 자르고 남는 칸은 공백으로 채운다
+void layout_trimmed(char *dst, size_t dst_size, const char *str, int max_width);
+
+// 문자열이 차지하는 칸 수 (탭 포함)
+int layout_width(const char *src, size_t len);
+
+#endif
@@ -8,40 +8,113 @@
 #include <pthread.h> 
 
 #include "project_macro.h"
+#include "uichannel.h"
+#include "screen.h"
+#include "filter.h"
+#include "perf.h"
+#include "treeindex.h"
+#include "jobs.h"
 
 // 함수 선언
 int display_folder(const char *directory, const int startline_idx, const int highlighted_idx, char *selected_filename, size_t filename_size);
 void display_file(const char *file_path);
+int folder_watch_fd(void);
+int folder_refresh(void);
 int execute_command(char *current_dir, const char *selected_filename);
-void execute_command_in_ncurses(const char *command);
+void execute_command_in_ncurses(const char *command, const char *args, const char *cwd);
+int prompt_input(const char *label, char *buf, size_t buf_size);
+int read_key(void);
 
 // 클립보드 관련 함수 선언
 void set_clipboard_copy(const char *file_path);
 void set_clipboard_cut(const char *file_path);
 void paste_clipboard_file(const char *current_dir);
+void toggle_mark(const char *file_path);
+void display_jobs(void);
+void folder_filter_set(const char *query); // display.c에 있는 함수
+void folder_sort_cycle(void);
+void folder_sort_toggle_dirs_first(void);
+void folder_du_toggle(void);
+void display_processes(void);
+void display_sessions(void);
+int display_find(const char *root, char *target, size_t target_size);
+void display_duplicates(const char *root);
+int folder_locate(const char *directory, const char *name);
+void folder_remember(const char *directory, const char *name, int row);
+void folder_restore(const char *directory, const char *from, int rows, int *highlighted, int *start);
+void monitor_set_interval(int ms);
+void sessions_set_source(const char *path);
 
-// ALRM 시그널 핸들러
+volatile sig_atomic_t idle_timeout = 0; // 입력 없이 IDLE_TIMEOUT_SECONDS 가 지남 (이벤트 루프에서 처리, 키를 받으면 해제)
+
+// ALRM 시그널 핸들러 - 여기서 끝내면 복사 중인 파일과 색인이 정리되지 않으므로 표시만 한다
+// (이벤트 루프의 poll 이 시그널로 깨어난다)
 void aram_sig_handle(int sig) {
+    idle_timeout = 1;
+}
+
+// 화면을 닫고 복사 작업을 멈춘 뒤 색인을 저장한다 (종료 직전)
+static void shutdown_program(void) {
     endwin();
-    printf("Program ended because of inactivity.\n");
-    exit(0);
+    jobs_shutdown();
+    tindex_save();
+    perf_shutdown();
 }
 
 char current_dir[MAX_DIR_LENGTH] = "~"; // 초기 디렉토리 설정
 int highlighted_idx = 0;     // 파일 리스트 중 선택된 파일 인덱스, 0 - filecount-1
 int print_start_idx = 0;     // 파일 리스트 중 출력 시작 줄 인덱스 0 - filecount-1
 
-int main() {
+// 사용법: guiShell [-g trace.json] [-i ms] [-u utmp] [-n]
+//   -g  프레임, 디렉토리 읽기, 출력, 복사 구간을 Chrome trace (JSON) 로 기록
+//   -i  프로세스/세션 화면의 갱신 간격 (밀리초, 기본 1000)
+//   -u  세션 화면이 읽을 utmp 파일 (또는 who 출력 형식의 텍스트)
+//   -n  디렉토리 색인 (~/.cache/guiShell/index.bin) 을 쓰지 않음
+int main(int argc, char *argv[]) {
+    int opt;
+    int use_index = 1;
+    while ((opt = getopt(argc, argv, "g:i:u:n")) != -1) {
+        switch (opt) {
+            case 'g':
+                if (perf_init(optarg) < 0) {
+                    perror(optarg);
+                    return 1;
+                }
+                break;
+            case 'i':
+                monitor_set_interval(atoi(optarg));
+                break;
+            case 'u':
+                sessions_set_source(optarg);
+                break;
+            case 'n':
+                use_index = 0;
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-g trace.json] [-i ms] [-u utmp] [-n]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    // 이전 실행에서 본 트리 색인 - mmap 만 하고 필요한 부분은 찾을 때 읽는다
+    char index_file[MAX_DIR_LENGTH];
+    if (use_index && tindex_default_file(index_file, sizeof(index_file)) == 0) {
+        tindex_open(index_file);
+    }
+
     setlocale(LC_ALL, "");
     // ncurses 초기화
     initscr();
     noecho();
     cbreak();
     keypad(stdscr, TRUE);
+    set_escdelay(25); // 필터 모드의 ESC 를 바로 받기 위해
+    screen_init();
+    ui_channel_init();
 
     // 타임아웃 시그널 핸들러 설정
     signal(SIGALRM, aram_sig_handle);
-    alarm(300); // 300초 타임아웃 설정
+    alarm(IDLE_TIMEOUT_SECONDS); // 입력 없음 타임아웃 설정
 
     char *home_dir = getenv("HOME");
     if (home_dir != NULL) {
@@ -53,31 +126,139 @@ int main() {
     // 현재 상태: 99 - 폴더 출력, 1 - 파일 출력
     int return_value = 99;
 
+    int file_count = 0;
+    int need_redraw = 1; // 화면을 다시 그려야 하는지
+
+    // 목록 필터: '/' 로 입력을 시작, Enter 로 입력 종료(필터 유지), ESC 로 해제
+    char filter_query[FILTER_MAX_QUERY] = "";
+    int filter_mode = 0;
+
+    // 키 입력, 백그라운드 작업 메시지, 디렉토리 변경 중 하나가 올 때만 깨어나는 이벤트 루프
     while (1) {
-        clear();
+        if (idle_timeout) {
+            idle_timeout = 0;
+            char summary[UI_STATUS_LENGTH];
+            if (jobs_summary(summary, sizeof(summary)) > 0) {
+                alarm(IDLE_TIMEOUT_SECONDS); // 복사가 끝나기 전에는 끝내지 않는다
+            } else {
+                shutdown_program();
+                printf("Program ended because of inactivity.\n");
+                return 0;
+            }
+        }
 
-        
-        // 폴더 내용을 출력하고 파일 개수 반환
-        int file_count = display_folder(current_dir, print_start_idx, highlighted_idx, selected_filename, sizeof(selected_filename));
+        if (ui_channel_drain()) {
+            need_redraw = 1;
+        }
+
+        if (need_redraw) {
+            uint64_t perf_frame = perf_begin();
+            // 폴더 내용을 출력하고 파일 개수 반환
+            file_count = display_folder(current_dir, print_start_idx, highlighted_idx, selected_filename, sizeof(selected_filename));
+
+            // 디렉토리 변경으로 목록이 줄어든 경우 선택 위치 보정 후 다시 출력
+            if (file_count > 0 && highlighted_idx >= file_count) {
+                highlighted_idx = file_count - 1;
+                if (print_start_idx > highlighted_idx) {
+                    print_start_idx = highlighted_idx;
+                }
+                continue;
+            }
 
-        // 키 입력 처리
-        int ch = getch();
-        if (ch != ERR) {
-            alarm(300); // 키 입력 시 타이머 재설정
+            if (filter_mode) { // 필터 입력줄
+                screen_put(LINES - 1, A_NORMAL, "/%s", filter_query);
+            } else if (ui_status()[0]) { // 백그라운드 작업 등의 상태 메시지
+                screen_put(LINES - 1, A_NORMAL, "%s", ui_status());
+            }
+            uint64_t perf_output = perf_begin();
+            screen_flush(); // 바뀐 줄만 다시 그린다
+            perf_end(PERF_OUTPUT, perf_output);
+            if (perf_active) {
+                screen_stats stats;
+                screen_get_stats(&stats);
+                perf_count(PERF_C_TERM_BYTES, stats.last_bytes > 0 ? stats.last_bytes : 0);
+            }
+            perf_end(PERF_FRAME, perf_frame);
+            need_redraw = 0;
+        }
+
+        // 키 입력 처리 - 입력이 없으면 이벤트를 기다린다
+        nodelay(stdscr, TRUE);
+        int ch = read_key(); // 키를 받으면 타이머 재설정
+        nodelay(stdscr, FALSE);
+        if (ch == ERR) {
+            int watch_fd = folder_watch_fd();
+            // inotify 로 감시할 수 없는 디렉토리만 1초마다 확인
+            int events = ui_wait_events(&watch_fd, 1, watch_fd >= 0 ? -1 : 1000);
+            if ((events & UI_EVENT_EXTRA(0)) || watch_fd < 0) {
+                if (folder_refresh()) {
+                    need_redraw = 1;
+                }
+            }
+            if (events == 0 && watch_fd >= 0) {
+                screen_invalidate(); // 시그널 (화면 크기 변경 등)
+                need_redraw = 1;
+            }
+            continue;
+        }
+        need_redraw = 1;
+
+        if (filter_mode || (ch == 27 && filter_query[0])) {
+            size_t len = strlen(filter_query);
+            int changed = 0;
+            if (ch == 27) { // 필터 해제
+                filter_query[0] = '\0';
+                filter_mode = 0;
+                changed = 1;
+            } else if (ch == '\n' || ch == KEY_ENTER) { // 입력 종료, 필터는 유지
+                filter_mode = 0;
+                continue;
+            } else if (ch == KEY_BACKSPACE || ch == 127 || ch == 8) {
+                // 마지막 글자 (UTF-8 이어지는 바이트 포함) 삭제
+                while (len > 0 && ((unsigned char)filter_query[len - 1] & 0xC0) == 0x80) {
+                    len--;
+                }
+                if (len > 0) {
+                    len--;
+                }
+                filter_query[len] = '\0';
+                changed = 1;
+            } else if (ch >= ' ' && ch < 256 && len + 1 < sizeof(filter_query)) {
+                filter_query[len] = ch;
+                filter_query[len + 1] = '\0';
+                changed = 1;
+            }
+            if (changed) {
+                folder_filter_set(filter_query);
+                highlighted_idx = 0;
+                print_start_idx = 0;
+                continue;
+            }
+            // 방향키 등은 아래에서 그대로 처리
         }
+
         int screen_height, screen_width; // screen_width 유지
         getmaxyx(stdscr, screen_height, screen_width); // 올바른 lvalue 사용
 
 
 
         char full_path[1024];
-        // (1) 예상 길이 확인
+        // (1) 예상 길이 확인 - 너무 길면 경로가 필요한 키만 막는다 (여기서 끝내면 작업과 색인이 정리되지 않는다)
         if (strlen(current_dir) + strlen(selected_filename) + 2 >= sizeof(full_path)) {
-            mvprintw(1, 0, "Path 가 너무 길어 사용 불가능합니다");
-            return 0;
+            if (ch == 'c' || ch == 'x' || ch == 'm') {
+                ui_post_status("Path 가 너무 길어 사용 불가능합니다");
+                continue;
+            }
+            full_path[0] = '\0';
+        } else {
+            // (2) snprintf로 파일 전체 경로 생성
+            snprintf(full_path, sizeof(full_path), "%s%s%s", current_dir, strcmp(current_dir, "/") == 0 ? "" : "/",
+                     selected_filename);
+        }
+
+        if (!selected_filename[0] && (ch == ' ' || ch == 'c' || ch == 'x' || ch == 'm')) {
+            continue; // 필터에 일치하는 항목이 없음
         }
-        // (2) snprintf로 파일 전체 경로 생성
-        snprintf(full_path, sizeof(full_path), "%s/%s", current_dir, selected_filename);
 
         switch (ch) {
             case KEY_UP:
@@ -96,22 +277,72 @@ int main() {
                     }
                 }
                 break;
-            case 'p': // 'p'로 ps 명령 실행
-                execute_command_in_ncurses("ps");
+            case 'p': // 'p'로 프로세스 목록
+                display_processes();
+                screen_invalidate();
+                break;
+            case 'w': // 'w'로 로그인 세션 목록
+                display_sessions();
+                screen_invalidate();
                 break;
-            case 'w': // 'w'로 who 명령 실행
-                execute_command_in_ncurses("who");
+            case '!': { // 임의의 명령 실행 (현재 디렉토리에서)
+                char command_line[512] = "";
+                if (prompt_input("Command: ", command_line, sizeof(command_line)) == 0) {
+                    char *args = command_line + strcspn(command_line, " \t");
+                    if (*args) {
+                        *args++ = '\0';
+                    }
+                    execute_command_in_ncurses(command_line, args, current_dir);
+                }
+                screen_invalidate(); // 입력줄 또는 명령 출력 화면이 덮어씀
                 break;
-            case ' ': 
+            }
+            case ' ': {
+                char previous_dir[MAX_DIR_LENGTH];
+                snprintf(previous_dir, sizeof(previous_dir), "%s", current_dir);
+                folder_remember(current_dir, selected_filename, highlighted_idx - print_start_idx);
                 return_value = execute_command(current_dir, selected_filename);
+                screen_invalidate(); // 파일 보기 등 다른 화면에서 돌아옴
                 if (return_value == 99) {
-                    highlighted_idx = 0;
-                    print_start_idx = 0;
+                    filter_query[0] = '\0'; // 다른 디렉토리로 이동하면 필터 해제
+                    folder_filter_set(filter_query);
+                    // 전에 보던 위치로, 처음이면 올라오기 전의 하위 디렉토리를 선택
+                    size_t len = strlen(current_dir);
+                    if (len > 0 && current_dir[len - 1] == '/') { // "/" 로 올라왔으면 "/usr" 의 "usr"
+                        len--;
+                    }
+                    const char *from = NULL;
+                    if (strncmp(previous_dir, current_dir, len) == 0 && previous_dir[len] == '/' && previous_dir[len + 1]) {
+                        from = previous_dir + len + 1;
+                    }
+                    folder_restore(current_dir, from, screen_height - RESERVED_LINE_NO - 1, &highlighted_idx, &print_start_idx);
                 }
-
-                break; 
+                break;
+            }
+            case '/': // 필터 입력 시작
+                filter_mode = 1;
+                break;
+            case 's': // 정렬 기준 변경 (이름, 크기, 시각, 종류)
+                folder_sort_cycle();
+                highlighted_idx = 0;
+                print_start_idx = 0;
+                break;
+            case 'd': // 디렉토리 먼저 켜고 끄기
+                folder_sort_toggle_dirs_first();
+                highlighted_idx = 0;
+                print_start_idx = 0;
+                break;
+            case 'o': // 성능 오버레이 켜고 끄기
+                perf_overlay_toggle();
+                break;
+            case 'u': // 디렉토리 전체 크기 표시 켜고 끄기
+                folder_du_toggle();
+                break;
+            case KEY_RESIZE:
+                screen_invalidate();
+                break;
             case 'q': // 종료
-                endwin();
+                shutdown_program();
                 return 0;
             case 'c': // 복사
                 set_clipboard_copy(full_path);
@@ -122,6 +353,49 @@ int main() {
             case 'v': // 붙여넣기
                 paste_clipboard_file(current_dir);
                 break;
+            case 'm': // 선택 표시 후 다음 파일로 이동
+                if (strcmp(selected_filename, ".") != 0 && strcmp(selected_filename, "..") != 0) {
+                    toggle_mark(full_path);
+                }
+                if (highlighted_idx < file_count - 1) {
+                    highlighted_idx++;
+                    if (highlighted_idx - print_start_idx == screen_height - RESERVED_LINE_NO - 1) {
+                        print_start_idx++;
+                    }
+                }
+                break;
+            case 'f': { // 현재 디렉토리 아래 재귀 검색
+                char target[4096]; // 검색 결과 경로 (finder 의 경로 길이)
+                if (display_find(current_dir, target, sizeof(target))) {
+                    // 결과가 있는 디렉토리로 이동해서 그 항목을 선택
+                    char *slash = strrchr(target, '/');
+                    size_t dir_len = slash == target ? 1 : (size_t)(slash - target); // 루트 바로 아래면 "/"
+                    if (dir_len >= sizeof(current_dir)) {
+                        ui_post_status("Path too long to open: %.200s...", target);
+                        screen_invalidate();
+                        break;
+                    }
+                    folder_remember(current_dir, selected_filename, highlighted_idx - print_start_idx);
+                    memcpy(current_dir, target, dir_len);
+                    current_dir[dir_len] = '\0';
+                    filter_query[0] = '\0';
+                    folder_filter_set(filter_query);
+                    int idx = folder_locate(current_dir, slash + 1);
+                    int rows = screen_height - RESERVED_LINE_NO - 1;
+                    highlighted_idx = idx > 0 ? idx : 0;
+                    print_start_idx = highlighted_idx > rows / 2 ? highlighted_idx - rows / 2 : 0;
+                }
+                screen_invalidate();
+                break;
+            }
+            case 'D': // 현재 디렉토리 아래 중복 파일 찾기
+                display_duplicates(current_dir);
+                screen_invalidate();
+                break;
+            case 'j': // 백그라운드 작업 목록
+                display_jobs();
+                screen_invalidate();
+                break;
             default:
                 break;
         }
@@ -0,0 +1,208 @@
+#define _GNU_SOURCE // statx
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+
+#include "metafetch.h"
+#include "perf.h"
+
+// 목록 화면에 필요한 필드만 요청
+#define METAFETCH_MASK (STATX_TYPE | STATX_MODE | STATX_NLINK | STATX_SIZE | STATX_MTIME | STATX_INO | STATX_BLOCKS)
+
+struct meta_target {
+    int dirfd;
+    int refs;              // 소유자 1 + 처리 대기 중인 요청 수
+    int closed;
+    void (*on_ready)(void);
+    meta_result *results;
+    int result_count;
+    int result_capacity;
+    int lost;              // 메모리가 부족해 버린 결과가 있음 - 다음 collect 에서 알린다
+};
+
+// 작업 스레드 공용 요청 큐
+typedef struct meta_request {
+    meta_target *target;
+    char name[MAX_FILENAME_LENGTH];
+    struct meta_request *next;
+} meta_request;
+
+static pthread_mutex_t fetch_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t fetch_cond = PTHREAD_COND_INITIALIZER;
+static meta_request *queue_head = NULL;
+static meta_request *queue_tail = NULL;
+static int threads_started = 0;
+static int statx_missing = 0; // 커널이 statx 를 지원하지 않음
+
+// fetch_lock 을 쥔 상태에서 호출
+static void unref_target(meta_target *t) {
+    if (--t->refs == 0) {
+        close(t->dirfd);
+        free(t->results);
+        free(t);
+    }
+}
+
+int metafetch_stat_now(int dirfd, const char *name, struct stat *st) {
+    perf_count(PERF_C_STAT, 1);
+    if (!statx_missing) {
+        struct statx stx;
+        if (statx(dirfd, name, AT_STATX_DONT_SYNC, METAFETCH_MASK, &stx) == 0) {
+            memset(st, 0, sizeof(*st));
+            st->st_mode = stx.stx_mode;
+            st->st_size = stx.stx_size;
+            st->st_ino = stx.stx_ino;
+            st->st_dev = makedev(stx.stx_dev_major, stx.stx_dev_minor);
+            st->st_nlink = stx.stx_nlink;
+            st->st_blocks = stx.stx_blocks;
+            st->st_mtim.tv_sec = stx.stx_mtime.tv_sec;
+            st->st_mtim.tv_nsec = stx.stx_mtime.tv_nsec;
+            return 0;
+        }
+        if (errno != ENOSYS) {
+            return -1;
+        }
+        statx_missing = 1;
+    }
+    return fstatat(dirfd, name, st, 0);
+}
+
+static void push_result(meta_target *t, const meta_result *r) {
+    if (t->result_count == t->result_capacity) {
+        int new_capacity = t->result_capacity ? t->result_capacity * 2 : 64;
+        meta_result *p = realloc(t->results, new_capacity * sizeof(meta_result));
+        if (!p) {
+            t->lost = 1;
+            return;
+        }
+        t->results = p;
+        t->result_capacity = new_capacity;
+    }
+    t->results[t->result_count++] = *r;
+}
+
+// 요청을 METAFETCH_BATCH 개씩 꺼내 처리하는 스레드
+static void *fetch_thread(void *arg) {
+    meta_request *batch[METAFETCH_BATCH];
+
+    while (1) {
+        pthread_mutex_lock(&fetch_lock);
+        while (!queue_head) {
+            pthread_cond_wait(&fetch_cond, &fetch_lock);
+        }
+        int n = 0;
+        while (queue_head && n < METAFETCH_BATCH) {
+            batch[n++] = queue_head;
+            queue_head = queue_head->next;
+        }
+        if (!queue_head) {
+            queue_tail = NULL;
+        }
+        pthread_mutex_unlock(&fetch_lock);
+
+        meta_result results[METAFETCH_BATCH];
+        for (int i = 0; i < n; i++) {
+            meta_target *t = batch[i]->target;
+            strncpy(results[i].name, batch[i]->name, sizeof(results[i].name));
+            results[i].ok = !t->closed && metafetch_stat_now(t->dirfd, batch[i]->name, &results[i].st) == 0;
+        }
+
+        pthread_mutex_lock(&fetch_lock);
+        for (int i = 0; i < n; i++) {
+            meta_target *t = batch[i]->target;
+            if (!t->closed) {
+                int was_empty = t->result_count == 0;
+                push_result(t, &results[i]);
+                if (was_empty && t->on_ready) {
+                    t->on_ready(); // 결과가 쌓이기 시작할 때 한 번만 알림
+                }
+            }
+            unref_target(t);
+            free(batch[i]);
+        }
+        pthread_mutex_unlock(&fetch_lock);
+    }
+    return NULL;
+}
+
+meta_target *metafetch_open(int dirfd, void (*on_ready)(void)) {
+    meta_target *t = calloc(1, sizeof(meta_target));
+    if (!t) {
+        return NULL;
+    }
+    t->dirfd = dirfd;
+    t->refs = 1;
+    t->on_ready = on_ready;
+
+    pthread_mutex_lock(&fetch_lock);
+    if (!threads_started) {
+        for (int i = 0; i < METAFETCH_THREADS; i++) {
+            pthread_t tid;
+            if (pthread_create(&tid, NULL, fetch_thread, NULL) == 0) {
+                pthread_detach(tid);
+                threads_started++;
+            }
+        }
+    }
+    pthread_mutex_unlock(&fetch_lock);
+    return t;
+}
+
+void metafetch_close(meta_target *t) {
+    if (!t) {
+        return;
+    }
+    pthread_mutex_lock(&fetch_lock);
+    t->closed = 1;
+    t->result_count = 0;
+    unref_target(t);
+    pthread_mutex_unlock(&fetch_lock);
+}
+
+int metafetch_dirfd(const meta_target *t) {
+    return t->dirfd;
+}
+
+int metafetch_request(meta_target *t, const char *name) {
+    if (!threads_started) {
+        return -1;
+    }
+    meta_request *req = malloc(sizeof(meta_request));
+    if (!req) {
+        return -1;
+    }
+    req->target = t;
+    strncpy(req->name, name, sizeof(req->name) - 1);
+    req->name[sizeof(req->name) - 1] = '\0';
+    req->next = NULL;
+
+    pthread_mutex_lock(&fetch_lock);
+    t->refs++;
+    if (queue_tail) {
+        queue_tail->next = req;
+    } else {
+        queue_head = req;
+    }
+    queue_tail = req;
+    pthread_cond_signal(&fetch_cond);
+    pthread_mutex_unlock(&fetch_lock);
+    return 0;
+}
+
+int metafetch_collect(meta_target *t, meta_result **out, int *lost) {
+    pthread_mutex_lock(&fetch_lock);
+    int n = t->result_count;
+    *out = t->results;
+    *lost = t->lost;
+    t->results = NULL;
+    t->result_count = t->result_capacity = 0;
+    t->lost = 0;
+    pthread_mutex_unlock(&fetch_lock);
+    return n;
+}
@@ -0,0 +1,40 @@
+#ifndef __METAFETCH__
+#define __METAFETCH__
+
+#include <sys/stat.h>
+
+#include "project_macro.h"
+
+#define METAFETCH_THREADS 4 // stat 요청을 처리하는 스레드 수
+#define METAFETCH_BATCH 16  // 스레드가 한 번에 가져가는 요청 수
+
+// 디렉토리 하나에 대한 메타데이터 요청 대상
+// 디렉토리를 한 번 열어 두고 statx(dirfd, name) 로 필요한 필드만 읽는다
+typedef struct meta_target meta_target;
+
+// 결과 하나
+typedef struct {
+    char name[MAX_FILENAME_LENGTH];
+    struct stat st;
+    int ok;          // 0 이면 stat 실패
+} meta_result;
+
+// dirfd 의 소유권을 넘겨받는다. on_ready 는 결과가 쌓이기 시작할 때 작업 스레드에서 호출 (NULL 가능)
+meta_target *metafetch_open(int dirfd, void (*on_ready)(void));
+
+// 더 이상 결과를 받지 않는다. 처리 중인 요청이 끝나면 dirfd 를 닫는다
+void metafetch_close(meta_target *t);
+
+int metafetch_dirfd(const meta_target *t);
+
+// name 의 메타데이터를 비동기로 요청. return 0 - 성공, -1 - 실패
+int metafetch_request(meta_target *t, const char *name);
+
+// 쌓인 결과를 가져온다. *out 은 호출한 쪽이 free. return 결과 개수
+// *lost 가 1 이면 메모리가 부족해 일부 결과를 버렸다 - 어느 요청인지 모르므로 기다리는 요청을 다시 보내야 한다
+int metafetch_collect(meta_target *t, meta_result **out, int *lost);
+
+// dirfd 기준으로 name 의 메타데이터를 바로 읽는다 (statx 가 없으면 fstatat)
+int metafetch_stat_now(int dirfd, const char *name, struct stat *st);
+
+#endif
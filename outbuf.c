@@ -0,0 +1,155 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "outbuf.h"
+
+void outbuf_init(out_buffer *ob) {
+    memset(ob, 0, sizeof(*ob));
+}
+
+void outbuf_free(out_buffer *ob) {
+    for (int i = 0; i < ob->count; i++) {
+        free(ob->lines[(ob->head + i) % ob->capacity]);
+    }
+    free(ob->lines);
+    free(ob->partial);
+    memset(ob, 0, sizeof(*ob));
+}
+
+static void drop_oldest(out_buffer *ob) {
+    char *line = ob->lines[ob->head];
+    ob->bytes -= strlen(line) + 1;
+    free(line);
+    ob->head = (ob->head + 1) % ob->capacity;
+    ob->count--;
+    ob->dropped++;
+}
+
+// 줄 배열이 가득 차면 OUTBUF_MAX_LINES 까지 늘린다 (원형 순서를 펴서 복사)
+static int grow_lines(out_buffer *ob) {
+    if (ob->capacity >= OUTBUF_MAX_LINES) {
+        return -1;
+    }
+    int new_capacity = ob->capacity ? ob->capacity * 2 : 256;
+    if (new_capacity > OUTBUF_MAX_LINES) {
+        new_capacity = OUTBUF_MAX_LINES;
+    }
+    char **p = malloc(new_capacity * sizeof(char *));
+    if (!p) {
+        return -1;
+    }
+    for (int i = 0; i < ob->count; i++) {
+        p[i] = ob->lines[(ob->head + i) % ob->capacity];
+    }
+    free(ob->lines);
+    ob->lines = p;
+    ob->capacity = new_capacity;
+    ob->head = 0;
+    return 0;
+}
+
+static void push_line(out_buffer *ob, const char *data, size_t len) {
+    char *line = malloc(len + 1);
+    if (!line) {
+        return;
+    }
+    memcpy(line, data, len);
+    line[len] = '\0';
+    if (len > 0 && line[len - 1] == '\r') {
+        line[len - 1] = '\0';
+    }
+
+    if (ob->count == ob->capacity && grow_lines(ob) != 0) {
+        drop_oldest(ob);
+    }
+    ob->lines[(ob->head + ob->count) % ob->capacity] = line;
+    ob->count++;
+    ob->bytes += len + 1;
+
+    while (ob->bytes > OUTBUF_MAX_BYTES && ob->count > 1) {
+        drop_oldest(ob);
+    }
+}
+
+static void partial_add(out_buffer *ob, const char *data, size_t len) {
+    if (ob->partial_len + len > ob->partial_capacity) {
+        size_t new_capacity = ob->partial_capacity ? ob->partial_capacity : 256;
+        while (new_capacity < ob->partial_len + len) {
+            new_capacity *= 2;
+        }
+        char *p = realloc(ob->partial, new_capacity + 1);
+        if (!p) {
+            return;
+        }
+        ob->partial = p;
+        ob->partial_capacity = new_capacity;
+    }
+    memcpy(ob->partial + ob->partial_len, data, len);
+    ob->partial_len += len;
+    ob->partial[ob->partial_len] = '\0';
+}
+
+void outbuf_append(out_buffer *ob, const char *data, size_t len) {
+    while (len > 0) {
+        const char *nl = memchr(data, '\n', len);
+        size_t chunk = nl ? (size_t)(nl - data) : len;
+
+        // 너무 긴 줄은 OUTBUF_MAX_LINE_LENGTH 단위로 나눈다
+        if (ob->partial_len + chunk >= OUTBUF_MAX_LINE_LENGTH) {
+            size_t room = OUTBUF_MAX_LINE_LENGTH - ob->partial_len;
+            partial_add(ob, data, room);
+            push_line(ob, ob->partial, ob->partial_len);
+            ob->partial_len = 0;
+            data += room;
+            len -= room;
+            continue;
+        }
+
+        if (nl) {
+            if (ob->partial_len > 0) {
+                partial_add(ob, data, chunk);
+                push_line(ob, ob->partial, ob->partial_len);
+                ob->partial_len = 0;
+            } else {
+                push_line(ob, data, chunk);
+            }
+            data += chunk + 1;
+            len -= chunk + 1;
+        } else {
+            partial_add(ob, data, chunk);
+            break;
+        }
+    }
+}
+
+void outbuf_flush(out_buffer *ob) {
+    if (ob->partial_len > 0) {
+        push_line(ob, ob->partial, ob->partial_len);
+        ob->partial_len = 0;
+    }
+}
+
+int outbuf_line_count(const out_buffer *ob) {
+    return ob->count + (ob->partial_len > 0 ? 1 : 0);
+}
+
+const char *outbuf_line(out_buffer *ob, int idx) {
+    if (idx < 0 || idx >= outbuf_line_count(ob)) {
+        return NULL;
+    }
+    if (idx == ob->count) {
+        return ob->partial;
+    }
+    return ob->lines[(ob->head + idx) % ob->capacity];
+}
+
+int outbuf_find(out_buffer *ob, int from, const char *needle, int direction) {
+    int total = outbuf_line_count(ob);
+    for (int i = from; i >= 0 && i < total; i += direction) {
+        if (strstr(outbuf_line(ob, i), needle)) {
+            return i;
+        }
+    }
+    return -1;
+}
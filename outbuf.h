@@ -0,0 +1,39 @@
+#ifndef __OUTBUF__
+#define __OUTBUF__
+
+#include <stddef.h>
+
+#define OUTBUF_MAX_BYTES (8 * 1024 * 1024) // 보관할 출력의 최대 크기, 넘으면 오래된 줄부터 버린다
+#define OUTBUF_MAX_LINES 200000
+#define OUTBUF_MAX_LINE_LENGTH (64 * 1024) // 이보다 긴 줄은 나눠서 저장
+
+// 명령 출력을 줄 단위로 보관하는 링 버퍼
+typedef struct {
+    char **lines;          // 원형 배열, head 부터 count 개
+    int capacity;
+    int head;
+    int count;
+    size_t bytes;          // 보관 중인 줄들의 크기 합
+    long long dropped;     // 용량 제한으로 버린 줄 수
+    char *partial;         // 아직 개행이 오지 않은 마지막 줄
+    size_t partial_len;
+    size_t partial_capacity;
+} out_buffer;
+
+void outbuf_init(out_buffer *ob);
+void outbuf_free(out_buffer *ob);
+
+// 읽은 데이터를 줄로 나눠 추가
+void outbuf_append(out_buffer *ob, const char *data, size_t len);
+// 개행 없이 끝난 마지막 줄을 확정 (EOF)
+void outbuf_flush(out_buffer *ob);
+
+// 화면에 보일 줄 수 (완성되지 않은 마지막 줄 포함)
+int outbuf_line_count(const out_buffer *ob);
+// idx 번째 줄 (0 이 보관 중인 가장 오래된 줄)
+const char *outbuf_line(out_buffer *ob, int idx);
+
+// from 부터 direction (1 또는 -1) 방향으로 needle 을 포함한 줄 검색, 없으면 -1
+int outbuf_find(out_buffer *ob, int from, const char *needle, int direction);
+
+#endif
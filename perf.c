@@ -0,0 +1,259 @@
+#define _GNU_SOURCE // syscall
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+
+#include "perf.h"
+
+#define PERF_TRACE_BUFFER (64 * 1024) // 추적 이벤트를 모았다가 파일에 쓰는 단위
+
+volatile int perf_active = 0;
+
+typedef struct {
+    long long count;
+    long long total_ns;
+    long long max_ns;
+    long long hist[PERF_HIST_BUCKETS]; // hist[b] - 2^b us 이상 2^(b+1) us 미만 (b=0 은 2us 미만)
+} perf_phase;
+
+static const char *phase_names[PERF_PHASE_COUNT] = {
+    "frame", "list", "order", "stat", "format", "output", "view", "exec", "copy",
+};
+
+// 구간 통계와 카운터는 여러 스레드에서 원자적으로 더한다
+static perf_phase phases[PERF_PHASE_COUNT];
+static long long counters[PERF_COUNTER_COUNT];
+static int overlay_visible = 0;
+
+// 추적 파일
+static FILE *trace_file = NULL;
+static pthread_mutex_t trace_lock = PTHREAD_MUTEX_INITIALIZER;
+static char trace_buffer[PERF_TRACE_BUFFER];
+static size_t trace_used = 0;
+static int trace_events = 0;
+static uint64_t trace_origin = 0;
+static int trace_pid = 0;
+
+static __thread int thread_id = 0;
+
+uint64_t perf_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void update_active(void) {
+    perf_active = overlay_visible || trace_file != NULL;
+}
+
+static int current_tid(void) {
+    if (!thread_id) {
+        thread_id = (int)syscall(SYS_gettid);
+    }
+    return thread_id;
+}
+
+// 호출 전에 trace_lock
+static void trace_flush_locked(void) {
+    if (trace_used > 0) {
+        fwrite(trace_buffer, 1, trace_used, trace_file);
+        trace_used = 0;
+    }
+}
+
+// 이벤트 하나를 JSON 배열에 추가
+static void trace_emit(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+static void trace_emit(const char *fmt, ...) {
+    char event[512];
+    va_list ap;
+    va_start(ap, fmt);
+    int len = vsnprintf(event, sizeof(event), fmt, ap);
+    va_end(ap);
+    if (len <= 0 || len >= (int)sizeof(event)) {
+        return;
+    }
+
+    pthread_mutex_lock(&trace_lock);
+    if (trace_file) {
+        if (trace_used + len + 2 > sizeof(trace_buffer)) {
+            trace_flush_locked();
+        }
+        if (trace_events++ > 0) {
+            trace_buffer[trace_used++] = ',';
+        }
+        memcpy(trace_buffer + trace_used, event, len);
+        trace_used += len;
+        trace_buffer[trace_used++] = '\n';
+    }
+    pthread_mutex_unlock(&trace_lock);
+}
+
+static int hist_bucket(long long ns) {
+    unsigned long long us = ns / 1000;
+    int b = us > 1 ? 63 - __builtin_clzll(us) : 0;
+    return b < PERF_HIST_BUCKETS ? b : PERF_HIST_BUCKETS - 1;
+}
+
+void perf_record(int phase, uint64_t start) {
+    uint64_t end = perf_now();
+    long long ns = (long long)(end - start);
+    perf_phase *p = &phases[phase];
+    __atomic_add_fetch(&p->count, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&p->total_ns, ns, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&p->hist[hist_bucket(ns)], 1, __ATOMIC_RELAXED);
+    long long max = __atomic_load_n(&p->max_ns, __ATOMIC_RELAXED);
+    while (ns > max && !__atomic_compare_exchange_n(&p->max_ns, &max, ns, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+
+    if (trace_file) {
+        trace_emit("{\"name\":\"%s\",\"cat\":\"guiShell\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%d}",
+                   phase_names[phase], (start - trace_origin) / 1e3, ns / 1e3, trace_pid, current_tid());
+        if (phase == PERF_FRAME) { // 프레임마다 카운터 값도 남긴다
+            trace_emit("{\"name\":\"counters\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":%d,\"args\":{\"stat\":%lld,"
+                       "\"dirent\":%lld,\"read\":%lld,\"copy_calls\":%lld,\"copy_bytes\":%lld,\"term_bytes\":%lld}}",
+                       (end - trace_origin) / 1e3, trace_pid,
+                       __atomic_load_n(&counters[PERF_C_STAT], __ATOMIC_RELAXED),
+                       __atomic_load_n(&counters[PERF_C_DIRENT], __ATOMIC_RELAXED),
+                       __atomic_load_n(&counters[PERF_C_READ], __ATOMIC_RELAXED),
+                       __atomic_load_n(&counters[PERF_C_COPY_CALL], __ATOMIC_RELAXED),
+                       __atomic_load_n(&counters[PERF_C_COPY_BYTES], __ATOMIC_RELAXED),
+                       __atomic_load_n(&counters[PERF_C_TERM_BYTES], __ATOMIC_RELAXED));
+        }
+    }
+}
+
+void perf_add(int counter, long long n) {
+    __atomic_add_fetch(&counters[counter], n, __ATOMIC_RELAXED);
+}
+
+int perf_init(const char *trace_path) {
+    if (!trace_path) {
+        return 0;
+    }
+    FILE *fp = fopen(trace_path, "w");
+    if (!fp) {
+        return -1;
+    }
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", fp);
+    trace_origin = perf_now();
+    trace_pid = getpid();
+    pthread_mutex_lock(&trace_lock);
+    trace_file = fp;
+    pthread_mutex_unlock(&trace_lock);
+    update_active();
+    atexit(perf_shutdown); // shutdown_program 을 거치지 않고 exit 로 끝나는 경우에도 파일을 마무리한다
+    return 0;
+}
+
+void perf_shutdown(void) {
+    pthread_mutex_lock(&trace_lock);
+    if (trace_file) {
+        trace_flush_locked();
+        fputs("]}\n", trace_file);
+        fclose(trace_file);
+        trace_file = NULL;
+    }
+    pthread_mutex_unlock(&trace_lock);
+    update_active();
+}
+
+void perf_overlay_toggle(void) {
+    overlay_visible = !overlay_visible;
+    if (overlay_visible) { // 켤 때부터 다시 센다
+        for (int i = 0; i < PERF_PHASE_COUNT; i++) {
+            long long *p = (long long *)&phases[i];
+            for (size_t k = 0; k < sizeof(perf_phase) / sizeof(long long); k++) {
+                __atomic_store_n(&p[k], 0, __ATOMIC_RELAXED);
+            }
+        }
+        for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+            __atomic_store_n(&counters[i], 0, __ATOMIC_RELAXED);
+        }
+    }
+    update_active();
+}
+
+int perf_overlay_visible(void) {
+    return overlay_visible;
+}
+
+int perf_overlay_rows(void) {
+    return PERF_PHASE_COUNT + 3;
+}
+
+// 히스토그램에서 비율 q 에 해당하는 구간의 상한 (ms)
+// 가장 긴 값보다 크게 보이지 않도록 max_ms 로 자른다
+static double hist_percentile(const long long *hist, long long count, double q, double max_ms) {
+    long long target = (long long)(count * q);
+    long long seen = 0;
+    double bound = (double)(1LL << PERF_HIST_BUCKETS) / 1e3;
+    for (int b = 0; b < PERF_HIST_BUCKETS; b++) {
+        seen += hist[b];
+        if (seen > target) {
+            bound = (double)(1LL << (b + 1)) / 1e3;
+            break;
+        }
+    }
+    return bound < max_ms ? bound : max_ms;
+}
+
+static void format_bytes(char *buf, size_t size, long long bytes) {
+    const char *units = "BKMGT";
+    double v = bytes;
+    int unit = 0;
+    while (v >= 1024 && units[unit + 1]) {
+        v /= 1024;
+        unit++;
+    }
+    snprintf(buf, size, unit ? "%.1f%c" : "%.0f%c", v, units[unit]);
+}
+
+void perf_overlay_line(int row, char *buf, int size) {
+    if (row == 0) {
+        snprintf(buf, size, "-- perf overlay (o: hide) - frame times since shown, histogram 1us .. 8s --");
+    } else if (row == 1) {
+        snprintf(buf, size, "%-7s %8s %8s %8s %8s %8s %8s  %s", "phase", "count", "avg ms", "p50<", "p90<", "p99<",
+                 "max", "histogram");
+    } else if (row - 2 < PERF_PHASE_COUNT) {
+        int phase = row - 2;
+        long long hist[PERF_HIST_BUCKETS];
+        long long peak = 0;
+        for (int b = 0; b < PERF_HIST_BUCKETS; b++) {
+            hist[b] = __atomic_load_n(&phases[phase].hist[b], __ATOMIC_RELAXED);
+            if (hist[b] > peak) {
+                peak = hist[b];
+            }
+        }
+        long long count = __atomic_load_n(&phases[phase].count, __ATOMIC_RELAXED);
+        long long total = __atomic_load_n(&phases[phase].total_ns, __ATOMIC_RELAXED);
+        long long max = __atomic_load_n(&phases[phase].max_ns, __ATOMIC_RELAXED);
+
+        static const char levels[] = " .:-=+*#%@";
+        char bars[PERF_HIST_BUCKETS + 1];
+        for (int b = 0; b < PERF_HIST_BUCKETS; b++) {
+            bars[b] = hist[b] ? levels[1 + (int)((hist[b] * 8 + peak - 1) / peak)] : levels[0];
+        }
+        bars[PERF_HIST_BUCKETS] = '\0';
+        if (count == 0) {
+            snprintf(buf, size, "%-7s %8d", phase_names[phase], 0);
+            return;
+        }
+        snprintf(buf, size, "%-7s %8lld %8.3f %8.3f %8.3f %8.3f %8.3f  |%s|", phase_names[phase], count,
+                 total / 1e6 / count, hist_percentile(hist, count, 0.5, max / 1e6), hist_percentile(hist, count, 0.9, max / 1e6),
+                 hist_percentile(hist, count, 0.99, max / 1e6), max / 1e6, bars);
+    } else {
+        char copied[16], term[16];
+        format_bytes(copied, sizeof(copied), __atomic_load_n(&counters[PERF_C_COPY_BYTES], __ATOMIC_RELAXED));
+        format_bytes(term, sizeof(term), __atomic_load_n(&counters[PERF_C_TERM_BYTES], __ATOMIC_RELAXED));
+        snprintf(buf, size, "stat %lld  dirent %lld  pipe read %lld  copy calls %lld  copied %s  terminal %s",
+                 __atomic_load_n(&counters[PERF_C_STAT], __ATOMIC_RELAXED),
+                 __atomic_load_n(&counters[PERF_C_DIRENT], __ATOMIC_RELAXED),
+                 __atomic_load_n(&counters[PERF_C_READ], __ATOMIC_RELAXED),
+                 __atomic_load_n(&counters[PERF_C_COPY_CALL], __ATOMIC_RELAXED), copied, term);
+    }
+}
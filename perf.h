@@ -0,0 +1,74 @@
+#ifndef __PERF__
+#define __PERF__
+
+#include <stdint.h>
+
+// 구간별 시간 측정과 시스템 호출 카운터
+// 오버레이('o')가 켜져 있거나 -g 로 추적 파일을 쓸 때만 측정하고,
+// 꺼져 있으면 perf_begin/perf_end/perf_count 는 전역 변수 하나만 확인하고 돌아간다
+
+// 측정 구간
+#define PERF_FRAME 0    // 목록 화면 한 프레임 전체
+#define PERF_LIST 1     // 디렉토리 읽기 (scandir, 변경 이벤트 반영)
+#define PERF_ORDER 2    // 필터, 정렬
+#define PERF_STAT 3     // 보이는 줄의 stat 요청과 결과 반영
+#define PERF_FORMAT 4   // 줄 문자열 만들기 (이름 자르기 포함)
+#define PERF_OUTPUT 5   // 터미널 출력 (refresh)
+#define PERF_VIEW 6     // 파일 보기 한 프레임 (display_file)
+#define PERF_EXEC 7     // 명령 출력 한 프레임 (execute_command_in_ncurses)
+#define PERF_COPY 8     // 파일 하나 복사 (작업 스레드)
+#define PERF_PHASE_COUNT 9
+
+// 카운터
+#define PERF_C_STAT 0       // stat/statx 호출
+#define PERF_C_DIRENT 1     // 읽은 디렉토리 항목
+#define PERF_C_READ 2       // 명령 출력 파이프 read 호출
+#define PERF_C_COPY_CALL 3  // 복사 시스템 호출 (copy_file_range, sendfile, pread/pwrite)
+#define PERF_C_COPY_BYTES 4 // 복사한 바이트
+#define PERF_C_TERM_BYTES 5 // 터미널로 보낸 바이트
+#define PERF_COUNTER_COUNT 6
+
+#define PERF_HIST_BUCKETS 24 // 2 의 거듭제곱 마이크로초 단위 (1us - 8s)
+
+extern volatile int perf_active; // 0 이면 측정하지 않음
+
+uint64_t perf_now(void); // 단조 시계 (ns)
+void perf_record(int phase, uint64_t start);
+void perf_add(int counter, long long n);
+
+// 구간 시작. 측정하지 않으면 0
+static inline uint64_t perf_begin(void) {
+    return perf_active ? perf_now() : 0;
+}
+
+// 구간 끝 (start 는 perf_begin 의 반환값)
+static inline void perf_end(int phase, uint64_t start) {
+    if (start) {
+        perf_record(phase, start);
+    }
+}
+
+static inline void perf_count(int counter, long long n) {
+    if (perf_active) {
+        perf_add(counter, n);
+    }
+}
+
+// trace_path 가 있으면 Chrome trace (JSON) 형식으로 모든 구간을 기록한다 (chrome://tracing, Perfetto)
+// return 0 - 성공, -1 - 파일을 만들 수 없음
+int perf_init(const char *trace_path);
+
+// 추적 파일을 마무리한다 (종료 시 자동으로도 호출됨)
+void perf_shutdown(void);
+
+// 오버레이 켜고 끄기
+void perf_overlay_toggle(void);
+int perf_overlay_visible(void);
+
+// 오버레이 줄 수
+int perf_overlay_rows(void);
+
+// 오버레이의 row 번째 줄 (UI 스레드 전용)
+void perf_overlay_line(int row, char *buf, int size);
+
+#endif
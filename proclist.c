@@ -0,0 +1,334 @@
+#define _GNU_SOURCE // syscall, qsort_r
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <pwd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+#include "proclist.h"
+
+#define PROC_DENTS_BUFFER (32 * 1024)
+
+// getdents64 가 돌려주는 항목
+struct linux_dirent64 {
+    ino_t d_ino;
+    off_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+static const char *sort_names[PROC_SORT_COUNT] = {"cpu", "rss", "pid", "user"};
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// 파일 하나를 buf 에 읽는다 (NUL 로 끝남). return 읽은 바이트 수, 실패하면 -1
+static ssize_t read_small(int dirfd, const char *path, char *buf, size_t size) {
+    int fd = openat(dirfd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    ssize_t n = read(fd, buf, size - 1);
+    close(fd);
+    if (n < 0) {
+        return -1;
+    }
+    buf[n] = '\0';
+    return n;
+}
+
+int proctable_init(proc_table *pt) {
+    memset(pt, 0, sizeof(*pt));
+    pt->proc_fd = open("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (pt->proc_fd < 0) {
+        return -1;
+    }
+    pt->hz = sysconf(_SC_CLK_TCK);
+    pt->page_size = sysconf(_SC_PAGESIZE);
+
+    char buf[256];
+    long long kb;
+    if (read_small(pt->proc_fd, "meminfo", buf, sizeof(buf)) > 0 && sscanf(buf, "MemTotal: %lld kB", &kb) == 1) {
+        pt->mem_total = kb * 1024;
+    }
+    return 0;
+}
+
+void proctable_free(proc_table *pt) {
+    if (pt->proc_fd >= 0) {
+        close(pt->proc_fd);
+    }
+    free(pt->procs);
+    free(pt->prev);
+    free(pt->users);
+    memset(pt, 0, sizeof(*pt));
+    pt->proc_fd = -1;
+}
+
+// uid 의 사용자 이름 (처음 보는 uid 만 getpwuid_r - NSS 조회는 느리다)
+static const char *user_name(proc_table *pt, uid_t uid) {
+    for (int i = 0; i < pt->user_count; i++) {
+        if (pt->users[i].uid == (int)uid) {
+            return pt->users[i].name;
+        }
+    }
+    if (pt->user_count == pt->user_capacity) {
+        int new_capacity = pt->user_capacity ? pt->user_capacity * 2 : 32;
+        proc_user *p = realloc(pt->users, new_capacity * sizeof(proc_user));
+        if (!p) {
+            return "?";
+        }
+        pt->users = p;
+        pt->user_capacity = new_capacity;
+    }
+    proc_user *u = &pt->users[pt->user_count++];
+    u->uid = (int)uid;
+    struct passwd pw, *result = NULL;
+    char buf[1024];
+    if (getpwuid_r(uid, &pw, buf, sizeof(buf), &result) == 0 && result) {
+        snprintf(u->name, sizeof(u->name), "%s", result->pw_name);
+    } else {
+        snprintf(u->name, sizeof(u->name), "%d", (int)uid);
+    }
+    return u->name;
+}
+
+// /proc/[pid]/stat 을 파싱한다. return 0 - 성공, -1 - 형식 오류
+static int parse_stat(proc_table *pt, char *buf, proc_info *p) {
+    // 이름에 공백이나 ')' 가 있을 수 있으므로 마지막 ')' 를 찾는다
+    char *lparen = strchr(buf, '(');
+    char *rparen = strrchr(buf, ')');
+    if (!lparen || !rparen || rparen < lparen) {
+        return -1;
+    }
+    size_t comm_len = rparen - lparen - 1;
+    if (comm_len >= sizeof(p->comm)) {
+        comm_len = sizeof(p->comm) - 1;
+    }
+    memcpy(p->comm, lparen + 1, comm_len);
+    p->comm[comm_len] = '\0';
+
+    // 3번째 (state) 부터 24번째 (rss) 필드
+    char state;
+    int ppid;
+    unsigned long long utime, stime, start;
+    long threads, rss;
+    if (sscanf(rparen + 2, "%c %d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu %*d %*d %*d %*d %ld %*d %llu %*u %ld",
+               &state, &ppid, &utime, &stime, &threads, &start, &rss) != 7) {
+        return -1;
+    }
+    p->state = state;
+    p->ppid = ppid;
+    p->ticks = utime + stime;
+    p->start = start;
+    p->threads = (int)threads;
+    p->rss = (long long)rss * pt->page_size;
+    return 0;
+}
+
+// 직전 갱신에서 같은 프로세스의 tick, 없으면 -1
+static long long prev_ticks(const proc_table *pt, int pid, unsigned long long start) {
+    int lo = 0, hi = pt->prev_count - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        if (pt->prev[mid].pid == pid) {
+            return pt->prev[mid].start == start ? (long long)pt->prev[mid].ticks : -1;
+        }
+        if (pt->prev[mid].pid < pid) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return -1;
+}
+
+static int compare_sample(const void *a, const void *b) {
+    const proc_sample *x = a, *y = b;
+    return (x->pid > y->pid) - (x->pid < y->pid);
+}
+
+int proctable_refresh(proc_table *pt) {
+    if (pt->proc_fd < 0 || lseek(pt->proc_fd, 0, SEEK_SET) < 0) {
+        return -1;
+    }
+    uint64_t now = now_ns();
+    double elapsed_ticks = pt->prev_time ? (now - pt->prev_time) / 1e9 * pt->hz : 0;
+
+    char dents[PROC_DENTS_BUFFER];
+    char buf[1024];
+    char path[32];
+    int count = 0;
+    while (1) {
+        long len = syscall(SYS_getdents64, pt->proc_fd, dents, sizeof(dents));
+        if (len <= 0) {
+            break;
+        }
+        for (long pos = 0; pos < len;) {
+            struct linux_dirent64 *d = (struct linux_dirent64 *)(dents + pos);
+            pos += d->d_reclen;
+            if (d->d_name[0] < '1' || d->d_name[0] > '9') {
+                continue; // 숫자 디렉토리만 프로세스
+            }
+
+            if (count == pt->capacity) {
+                int new_capacity = pt->capacity ? pt->capacity * 2 : 256;
+                proc_info *p = realloc(pt->procs, new_capacity * sizeof(proc_info));
+                if (!p) {
+                    break;
+                }
+                pt->procs = p;
+                pt->capacity = new_capacity;
+            }
+            proc_info *p = &pt->procs[count];
+            p->pid = atoi(d->d_name);
+            snprintf(path, sizeof(path), "%s/stat", d->d_name);
+            if (read_small(pt->proc_fd, path, buf, sizeof(buf)) <= 0 || parse_stat(pt, buf, p) != 0) {
+                continue; // 그 사이에 끝난 프로세스
+            }
+            struct stat st;
+            p->uid = fstatat(pt->proc_fd, d->d_name, &st, 0) == 0 ? st.st_uid : 0;
+
+            long long before = prev_ticks(pt, p->pid, p->start);
+            p->cpu = (before >= 0 && elapsed_ticks > 0) ? (p->ticks - before) * 100.0 / elapsed_ticks : 0;
+            count++;
+        }
+    }
+    pt->count = count;
+    // 캐시를 먼저 다 채우고 나서 이름 포인터를 넣는다 (캐시가 커지면서 옮겨질 수 있으므로)
+    for (int i = 0; i < count; i++) {
+        user_name(pt, pt->procs[i].uid);
+    }
+    for (int i = 0; i < count; i++) {
+        pt->procs[i].user = user_name(pt, pt->procs[i].uid);
+    }
+
+    // 다음 갱신을 위해 tick 값을 pid 순으로 저장
+    if (count > pt->prev_capacity) {
+        proc_sample *p = realloc(pt->prev, count * sizeof(proc_sample));
+        if (!p) {
+            pt->prev_count = 0;
+            pt->prev_time = 0;
+            return count;
+        }
+        pt->prev = p;
+        pt->prev_capacity = count;
+    }
+    int sorted = 1;
+    for (int i = 0; i < count; i++) {
+        pt->prev[i].pid = pt->procs[i].pid;
+        pt->prev[i].start = pt->procs[i].start;
+        pt->prev[i].ticks = pt->procs[i].ticks;
+        if (i > 0 && pt->prev[i].pid < pt->prev[i - 1].pid) {
+            sorted = 0;
+        }
+    }
+    if (!sorted) { // /proc 는 보통 pid 순이지만 보장되지는 않는다
+        qsort(pt->prev, count, sizeof(proc_sample), compare_sample);
+    }
+    pt->prev_count = count;
+    pt->prev_time = now;
+    return count;
+}
+
+// 필터 조건
+typedef struct {
+    const char *user;     // 정확히 같은 사용자
+    double min_cpu;
+    long long min_rss;
+    const char *text;     // 이름이나 사용자에 포함
+} proc_filter;
+
+static void parse_filter(const char *filter, proc_filter *f) {
+    memset(f, 0, sizeof(*f));
+    f->min_cpu = -1;
+    f->min_rss = -1;
+    if (!filter || !filter[0]) {
+        return;
+    }
+    if (strncmp(filter, "user:", 5) == 0) {
+        f->user = filter + 5;
+    } else if (strncmp(filter, "cpu>", 4) == 0) {
+        f->min_cpu = atof(filter + 4);
+    } else if (strncmp(filter, "rss>", 4) == 0) {
+        char *end;
+        double v = strtod(filter + 4, &end);
+        switch (*end) {
+            case 'k': case 'K': v *= 1024; break;
+            case 'm': case 'M': v *= 1024 * 1024; break;
+            case 'g': case 'G': v *= 1024.0 * 1024 * 1024; break;
+            default: break;
+        }
+        f->min_rss = (long long)v;
+    } else {
+        f->text = filter;
+    }
+}
+
+static int filter_match(const proc_filter *f, const proc_info *p) {
+    if (f->user && strcmp(p->user, f->user) != 0) {
+        return 0;
+    }
+    if (f->min_cpu >= 0 && p->cpu <= f->min_cpu) {
+        return 0;
+    }
+    if (f->min_rss >= 0 && p->rss <= f->min_rss) {
+        return 0;
+    }
+    if (f->text && !strstr(p->comm, f->text) && !strstr(p->user, f->text)) {
+        return 0;
+    }
+    return 1;
+}
+
+typedef struct {
+    const proc_table *pt;
+    int key;
+} sort_context;
+
+static int compare_proc(const void *a, const void *b, void *arg) {
+    const sort_context *ctx = arg;
+    const proc_info *x = &ctx->pt->procs[*(const int *)a];
+    const proc_info *y = &ctx->pt->procs[*(const int *)b];
+    int c = 0;
+    switch (ctx->key) {
+        case PROC_SORT_CPU:
+            c = (y->cpu > x->cpu) - (y->cpu < x->cpu);
+            break;
+        case PROC_SORT_RSS:
+            c = (y->rss > x->rss) - (y->rss < x->rss);
+            break;
+        case PROC_SORT_USER:
+            c = strcmp(x->user, y->user);
+            break;
+        default:
+            break;
+    }
+    return c ? c : (x->pid > y->pid) - (x->pid < y->pid);
+}
+
+int proctable_view(const proc_table *pt, const char *filter, int sort_key, int *order) {
+    proc_filter f;
+    parse_filter(filter, &f);
+    int n = 0;
+    for (int i = 0; i < pt->count; i++) {
+        if (filter_match(&f, &pt->procs[i])) {
+            order[n++] = i;
+        }
+    }
+    sort_context ctx = {pt, sort_key};
+    qsort_r(order, n, sizeof(int), compare_proc, &ctx);
+    return n;
+}
+
+const char *proctable_sort_name(int sort_key) {
+    return sort_key >= 0 && sort_key < PROC_SORT_COUNT ? sort_names[sort_key] : "?";
+}
@@ -0,0 +1,82 @@
+#ifndef __PROCLIST__
+#define __PROCLIST__
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#define PROC_COMM_LENGTH 64
+#define PROC_USER_LENGTH 32
+
+// 정렬 기준
+#define PROC_SORT_CPU 0
+#define PROC_SORT_RSS 1
+#define PROC_SORT_PID 2
+#define PROC_SORT_USER 3
+#define PROC_SORT_COUNT 4
+
+typedef struct {
+    int pid;
+    int ppid;
+    char state;                 // R, S, D, Z ...
+    uid_t uid;
+    int threads;
+    long long rss;              // 바이트
+    unsigned long long ticks;   // utime + stime (clock tick)
+    unsigned long long start;   // 시작 시각 (부팅 후 clock tick) - pid 재사용 구분
+    double cpu;                 // 직전 갱신 이후 CPU 사용률 (%, 코어 하나가 100)
+    const char *user;           // 사용자 이름 (proc_table 의 캐시, 다음 갱신까지 유효)
+    char comm[PROC_COMM_LENGTH];
+} proc_info;
+
+// 이전 갱신의 tick 값 (pid 순) - CPU 사용률 계산용
+typedef struct {
+    int pid;
+    unsigned long long start;
+    unsigned long long ticks;
+} proc_sample;
+
+typedef struct {
+    int uid;
+    char name[PROC_USER_LENGTH];
+} proc_user;
+
+// /proc 를 직접 읽는 프로세스 목록
+// 프로세스마다 /proc/[pid]/stat 하나만 읽고 (openat 으로 경로 탐색 없이),
+// 사용자는 /proc/[pid] 디렉토리의 소유자로 정한다 (status 를 파싱하지 않음)
+typedef struct {
+    int proc_fd;                // /proc 디렉토리
+    long hz;                    // 초당 clock tick
+    long page_size;
+
+    proc_info *procs;
+    int count;
+    int capacity;
+
+    proc_sample *prev;          // 직전 갱신 (pid 순)
+    int prev_count;
+    int prev_capacity;
+    uint64_t prev_time;         // 직전 갱신 시각 (ns), 0 이면 아직 없음
+
+    proc_user *users;           // uid -> 이름 캐시
+    int user_count;
+    int user_capacity;
+
+    long long mem_total;        // 메모리 전체 (바이트)
+} proc_table;
+
+// return 0 - 성공, -1 - /proc 를 열 수 없음
+int proctable_init(proc_table *pt);
+void proctable_free(proc_table *pt);
+
+// /proc 를 다시 읽는다. CPU 사용률은 직전 갱신과의 차이로 계산한다 (첫 갱신은 0)
+// return 프로세스 수, 실패하면 -1
+int proctable_refresh(proc_table *pt);
+
+// 필터와 정렬을 적용한 순서를 order 에 채운다 (order 는 count 개 이상)
+// filter: 빈 문자열 - 전체, "user:이름", "cpu>N" (%), "rss>N[K|M|G]", 그 밖에는 이름/사용자에 포함된 문자열
+// return order 에 넣은 수
+int proctable_view(const proc_table *pt, const char *filter, int sort_key, int *order);
+
+const char *proctable_sort_name(int sort_key);
+
+#endif
@@ -10,6 +10,8 @@
 
 #define RESERVED_LINE_NO (RESERVED_LINE_UPPER+RESERVED_LINE_LOWER-1) // UI를 위해 남겨 둬야 할 라인 수
 
+#define IDLE_TIMEOUT_SECONDS 300 // 키 입력 없이 이 시간이 지나면 종료
+
 #define CLIPBOARD_EMPTY 0
 #define CLIPBOARD_COPY 1
 #define CLIPBOARD_CUT 2
@@ -0,0 +1,133 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include "screen.h"
+#include "layout.h"
+
+typedef struct {
+    char text[SCREEN_ROW_BYTES];
+    attr_t attr;
+} screen_row;
+
+static screen_row *shown = NULL;   // 지금 터미널에 있는 내용
+static screen_row *next = NULL;    // 만들고 있는 프레임
+static int row_count = 0;
+static int shown_valid = 0;        // 0 이면 shown 을 믿을 수 없음
+static int io_fd = -1;             // UI 스레드의 /proc 입출력 통계
+static screen_stats stats;
+
+// UI 스레드가 지금까지 write 로 보낸 바이트 수, 알 수 없으면 -1
+static long long thread_written_bytes(void) {
+    if (io_fd < 0) {
+        return -1;
+    }
+    char buf[512];
+    ssize_t len = pread(io_fd, buf, sizeof(buf) - 1, 0);
+    if (len <= 0) {
+        return -1;
+    }
+    buf[len] = '\0';
+    char *p = strstr(buf, "wchar:");
+    return p ? atoll(p + 6) : -1;
+}
+
+void screen_init(void) {
+    start_color();
+    init_pair(1, COLOR_YELLOW, COLOR_BLACK); // 노란색 글자, 검은색 배경 (디렉토리)
+
+    // 스레드별 통계라서 작업 스레드의 파일 쓰기는 섞이지 않는다
+    io_fd = open("/proc/thread-self/io", O_RDONLY | O_CLOEXEC);
+    stats.last_bytes = -1;
+}
+
+// 화면 크기가 바뀌면 모델을 다시 만든다
+static int screen_resize(void) {
+    if (row_count == LINES && shown) {
+        return 0;
+    }
+    free(shown);
+    free(next);
+    row_count = LINES;
+    shown = calloc(row_count, sizeof(screen_row));
+    next = calloc(row_count, sizeof(screen_row));
+    shown_valid = 0;
+    if (!shown || !next) {
+        free(shown);
+        free(next);
+        shown = next = NULL;
+        row_count = 0;
+        return -1;
+    }
+    return 0;
+}
+
+void screen_begin(void) {
+    if (screen_resize() < 0) {
+        return;
+    }
+    for (int y = 0; y < row_count; y++) {
+        next[y].text[0] = '\0';
+        next[y].attr = A_NORMAL;
+    }
+}
+
+void screen_put(int y, attr_t attr, const char *fmt, ...) {
+    if (y < 0 || y >= row_count) {
+        return;
+    }
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(next[y].text, sizeof(next[y].text), fmt, ap);
+    va_end(ap);
+    next[y].attr = attr;
+}
+
+void screen_flush(void) {
+    int rows = 0;
+    int redraw_next = 0; // 앞 줄이 화면 폭을 넘었음 - 이 줄이 덮였을 수 있다
+    for (int y = 0; y < row_count; y++) {
+        if (shown_valid && !redraw_next && next[y].attr == shown[y].attr &&
+            strcmp(next[y].text, shown[y].text) == 0) {
+            continue;
+        }
+        // 화면 폭에서 자른다. 자르지 않으면 다음 줄로 넘어가서 (바뀌지 않아 다시 그리지 않는) 다음 줄을 덮는다
+        char line[SCREEN_ROW_BYTES * 2];
+        size_t len = strlen(next[y].text);
+        size_t consumed = layout_line(line, sizeof(line), next[y].text, len, 0, COLS, 0);
+        int width = layout_width(line, strlen(line));
+        move(y, 0);
+        attrset(next[y].attr);
+        addstr(line);
+        attrset(A_NORMAL);
+        if (width < COLS) {
+            clrtoeol(); // 폭을 다 채우면 커서가 다음 줄에 있으므로 지우지 않는다
+        }
+        redraw_next = consumed < len;
+        shown[y] = next[y];
+        rows++;
+    }
+    shown_valid = row_count > 0;
+
+    long long before = thread_written_bytes();
+    refresh();
+    long long after = thread_written_bytes();
+
+    stats.frames++;
+    stats.last_rows = rows;
+    stats.last_bytes = (before >= 0 && after >= 0) ? after - before : -1;
+    if (stats.last_bytes > 0) {
+        stats.bytes_total += stats.last_bytes;
+    }
+}
+
+void screen_invalidate(void) {
+    shown_valid = 0;
+}
+
+void screen_get_stats(screen_stats *out) {
+    *out = stats;
+}
@@ -0,0 +1,37 @@
+#ifndef __SCREEN__
+#define __SCREEN__
+
+#include <ncurses.h>
+
+#define SCREEN_ROW_BYTES 1024 // 한 줄에 저장하는 최대 바이트 수
+
+// 목록 화면용 차등 출력 계층
+// 프레임마다 각 줄의 내용과 속성을 모델에 기록하고, 이전 프레임과 달라진 줄만 다시 그린다
+// 줄 하나는 한 가지 속성으로 출력된다
+
+// 출력 통계 (터미널로 보낸 바이트는 UI 스레드의 write 바이트로 측정)
+typedef struct {
+    long long frames;        // screen_flush 호출 횟수
+    long long bytes_total;   // 지금까지 터미널로 보낸 바이트
+    long long last_bytes;    // 마지막 프레임에서 보낸 바이트, 측정할 수 없으면 -1
+    int last_rows;           // 마지막 프레임에서 다시 그린 줄 수
+} screen_stats;
+
+// initscr 후 UI 스레드에서 한 번 호출 (색상 초기화 포함)
+void screen_init(void);
+
+// 새 프레임 시작 - 모든 줄을 빈 줄로 둔다
+void screen_begin(void);
+
+// y 번째 줄의 내용을 정한다. 같은 줄에 여러 번 쓰면 마지막 것이 남는다
+void screen_put(int y, attr_t attr, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
+
+// 이전 프레임과 달라진 줄만 출력하고 터미널을 갱신한다
+void screen_flush(void);
+
+// 다른 화면이 stdscr 를 덮어쓴 경우 - 다음 프레임은 모든 줄을 다시 그린다
+void screen_invalidate(void);
+
+void screen_get_stats(screen_stats *out);
+
+#endif
@@ -0,0 +1,133 @@
+#define _GNU_SOURCE // strptime
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <utmpx.h>
+#include <paths.h>
+#include <sys/stat.h>
+
+#include "sessions.h"
+
+#define SESSIONS_FILE_LIMIT (4 * 1024 * 1024) // 읽어 들일 utmp 최대 크기
+
+// 터미널의 마지막 입력 후 지난 시간 (장치의 접근 시각)
+static long tty_idle(const char *line, time_t now) {
+    char dev[64];
+    snprintf(dev, sizeof(dev), "/dev/%s", line);
+    struct stat st;
+    if (stat(dev, &st) != 0 || !S_ISCHR(st.st_mode)) {
+        return -1;
+    }
+    return now > st.st_atime ? (long)(now - st.st_atime) : 0;
+}
+
+// 고정 길이 (NUL 로 끝나지 않을 수 있음) utmp 필드를 복사
+static void copy_field(char *dst, size_t dst_size, const char *src, size_t src_size) {
+    size_t n = strnlen(src, src_size);
+    if (n >= dst_size) {
+        n = dst_size - 1;
+    }
+    memcpy(dst, src, n);
+    dst[n] = '\0';
+}
+
+static int parse_utmp(const char *data, size_t size, session_info *out, int max, time_t now) {
+    int count = 0;
+    for (size_t off = 0; off + sizeof(struct utmpx) <= size && count < max; off += sizeof(struct utmpx)) {
+        struct utmpx ut;
+        memcpy(&ut, data + off, sizeof(ut));
+        if (ut.ut_type != USER_PROCESS) {
+            continue;
+        }
+        session_info *s = &out[count++];
+        copy_field(s->user, sizeof(s->user), ut.ut_user, sizeof(ut.ut_user));
+        copy_field(s->line, sizeof(s->line), ut.ut_line, sizeof(ut.ut_line));
+        copy_field(s->host, sizeof(s->host), ut.ut_host, sizeof(ut.ut_host));
+        s->login = ut.ut_tv.tv_sec;
+        s->pid = ut.ut_pid;
+        s->idle = tty_idle(s->line, now);
+    }
+    return count;
+}
+
+// who 출력 형식: 사용자 터미널 YYYY-MM-DD HH:MM (호스트)
+static int parse_text(char *data, session_info *out, int max, time_t now) {
+    int count = 0;
+    char *save = NULL;
+    for (char *line = strtok_r(data, "\n", &save); line && count < max; line = strtok_r(NULL, "\n", &save)) {
+        char user[SESSION_USER_LENGTH], tty[SESSION_LINE_LENGTH], date[32], clock[16];
+        int used = 0;
+        if (sscanf(line, "%31s %31s %31s %15s %n", user, tty, date, clock, &used) < 4) {
+            continue;
+        }
+        session_info *s = &out[count++];
+        memset(s, 0, sizeof(*s));
+        snprintf(s->user, sizeof(s->user), "%s", user);
+        snprintf(s->line, sizeof(s->line), "%s", tty);
+
+        char stamp[64];
+        struct tm tm;
+        memset(&tm, 0, sizeof(tm));
+        snprintf(stamp, sizeof(stamp), "%s %s", date, clock);
+        char *end = strptime(stamp, "%Y-%m-%d %H:%M", &tm);
+        if (end && *end == '\0') {
+            tm.tm_isdst = -1;
+            s->login = mktime(&tm);
+        }
+
+        // 나머지는 "(호스트)"
+        char *rest = line + used;
+        char *lparen = strchr(rest, '(');
+        char *rparen = lparen ? strrchr(lparen, ')') : NULL;
+        if (lparen && rparen) {
+            snprintf(s->host, sizeof(s->host), "%.*s", (int)(rparen - lparen - 1), lparen + 1);
+        }
+        s->idle = tty_idle(s->line, now);
+    }
+    return count;
+}
+
+int sessions_read(const char *path, session_info *out, int max) {
+    if (!path) {
+        path = _PATH_UTMP;
+    }
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size > SESSIONS_FILE_LIMIT) {
+        close(fd);
+        return -1;
+    }
+    size_t size = st.st_size;
+    char *data = malloc(size + 1);
+    if (!data) {
+        close(fd);
+        return -1;
+    }
+    size_t len = 0;
+    ssize_t n;
+    while (len < size && (n = read(fd, data + len, size - len)) > 0) {
+        len += n;
+    }
+    close(fd);
+    data[len] = '\0';
+
+    time_t now = time(NULL);
+    int count;
+    // utmp 레코드 크기로 나누어 떨어지고 첫 레코드의 종류가 올바르면 utmp, 아니면 텍스트
+    short first_type = -1;
+    if (len >= sizeof(short)) {
+        memcpy(&first_type, data, sizeof(short));
+    }
+    if (len > 0 && len % sizeof(struct utmpx) == 0 && first_type >= EMPTY && first_type <= ACCOUNTING) {
+        count = parse_utmp(data, len, out, max, now);
+    } else {
+        count = parse_text(data, out, max, now);
+    }
+    free(data);
+    return count;
+}
@@ -0,0 +1,26 @@
+#ifndef __SESSIONS__
+#define __SESSIONS__
+
+#include <time.h>
+
+#define SESSION_USER_LENGTH 32
+#define SESSION_LINE_LENGTH 32
+#define SESSION_HOST_LENGTH 64
+
+// 로그인 세션 하나 (who 의 한 줄)
+typedef struct {
+    char user[SESSION_USER_LENGTH];
+    char line[SESSION_LINE_LENGTH];  // tty2, pts/0, seat0 ...
+    char host[SESSION_HOST_LENGTH];  // 원격 호스트나 표시 (없으면 빈 문자열)
+    time_t login;                    // 로그인 시각, 모르면 0
+    int pid;                         // 로그인 프로세스, 모르면 0
+    long idle;                       // 터미널 입력 후 지난 초 (who -u), 모르면 -1
+} session_info;
+
+// utmp 를 직접 읽어 로그인 세션 목록을 만든다 (who 를 실행하지 않음)
+// path 가 NULL 이면 시스템 utmp. utmp 레코드가 아닌 파일은 who 출력 형식의 텍스트로 읽는다
+// (저장소의 userlist 처럼 "사용자 터미널 YYYY-MM-DD HH:MM (호스트)" 줄)
+// return 세션 수 (최대 max), 파일을 읽을 수 없으면 -1
+int sessions_read(const char *path, session_info *out, int max);
+
+#endif
@@ -0,0 +1,366 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "sortview.h"
+
+#define NATURAL_DIGITS 20 // 숫자 부분을 맞추는 자리 수 (64비트 정수 최대 자리)
+
+// 이름 순서를 만들 때만 쓰는 정렬 키
+typedef struct {
+    const unsigned char *key;
+    int idx;
+} name_key;
+
+// 64비트 키 정렬용
+typedef struct {
+    uint64_t key;
+    int idx;
+} radix_item;
+
+void sortview_init(sort_view *sv) {
+    memset(sv, 0, sizeof(*sv));
+}
+
+void sortview_free(sort_view *sv) {
+    free(sv->by_name);
+    free(sv->keys);
+    free(sv->order);
+    free(sv->scratch);
+    memset(sv, 0, sizeof(*sv));
+}
+
+const char *sort_mode_name(int mode) {
+    switch (mode) {
+        case SORT_NAME: return "name";
+        case SORT_SIZE: return "size";
+        case SORT_MTIME: return "mtime";
+        case SORT_KIND: return "kind";
+    }
+    return "?";
+}
+
+static int is_dot_entry(const char *name) {
+    return strcmp(name, ".") == 0 || strcmp(name, "..") == 0;
+}
+
+// 숫자 부분을 NATURAL_DIGITS 자리로 맞춘 이름 (file2 → file00...02), 넘치면 잘린다
+static void natural_name(char *dst, size_t size, const char *name) {
+    size_t used = 0;
+    while (*name && used + 1 < size) {
+        if (isdigit((unsigned char)*name)) {
+            const char *start = name;
+            while (isdigit((unsigned char)*name)) {
+                name++;
+            }
+            size_t digits = name - start;
+            size_t pad = digits < NATURAL_DIGITS ? NATURAL_DIGITS - digits : 0;
+            if (used + pad + digits + 1 > size) {
+                break;
+            }
+            memset(dst + used, '0', pad);
+            memcpy(dst + used + pad, start, digits);
+            used += pad + digits;
+        } else {
+            dst[used++] = *name++;
+        }
+    }
+    dst[used] = '\0';
+}
+
+// 같은 키는 원래 번호(strcmp 순서) 로 정한다
+static int key_less(const name_key *a, const name_key *b, int depth) {
+    int cmp = strcmp((const char *)a->key + depth, (const char *)b->key + depth);
+    return cmp < 0 || (cmp == 0 && a->idx < b->idx);
+}
+
+static int compare_idx(const void *a, const void *b) {
+    return ((const name_key *)a)->idx - ((const name_key *)b)->idx;
+}
+
+static void swap_keys(name_key *x, int i, int j) {
+    name_key t = x[i];
+    x[i] = x[j];
+    x[j] = t;
+}
+
+static void swap_range(name_key *x, int i, int j, int n) {
+    while (n-- > 0) {
+        swap_keys(x, i++, j++);
+    }
+}
+
+// 다중 키 퀵정렬 (Bentley-Sedgewick) - 앞부분이 같은 키가 많아도 이미 비교한 바이트는 다시 보지 않는다
+static void sort_name_keys(name_key *x, int n, int depth) {
+    while (n > 1) {
+        if (n < 12) { // 작은 구간은 삽입 정렬
+            for (int i = 1; i < n; i++) {
+                for (int j = i; j > 0 && key_less(&x[j], &x[j - 1], depth); j--) {
+                    swap_keys(x, j, j - 1);
+                }
+            }
+            return;
+        }
+        swap_keys(x, 0, n / 2);
+        int pivot = x[0].key[depth];
+        int a = 1, b = 1, c = n - 1, d = n - 1;
+        while (1) {
+            int r;
+            while (b <= c && (r = x[b].key[depth] - pivot) <= 0) {
+                if (r == 0) {
+                    swap_keys(x, a++, b);
+                }
+                b++;
+            }
+            while (b <= c && (r = x[c].key[depth] - pivot) >= 0) {
+                if (r == 0) {
+                    swap_keys(x, c, d--);
+                }
+                c--;
+            }
+            if (b > c) {
+                break;
+            }
+            swap_keys(x, b++, c--);
+        }
+        int r = a < b - a ? a : b - a;
+        swap_range(x, 0, b - r, r);
+        r = d - c < n - d - 1 ? d - c : n - d - 1;
+        swap_range(x, b, n - r, r);
+
+        int less = b - a;
+        int equal = a + n - d - 1;
+        int greater = d - c;
+        sort_name_keys(x, less, depth);
+        if (pivot != 0) {
+            sort_name_keys(x + less, equal, depth + 1);
+        } else { // 키 전체가 같음
+            qsort(x + less, equal, sizeof(name_key), compare_idx);
+        }
+        // 마지막 구간은 반복으로 처리
+        x += n - greater;
+        n = greater;
+    }
+}
+
+// 자연 순서 + 로케일 순서의 이름 순서를 만든다 (목록이 바뀔 때만)
+static int build_name_order(sort_view *sv, const dir_cache *dc) {
+    int n = 0;
+    name_key *keys = malloc((dc->count > 0 ? dc->count : 1) * sizeof(name_key));
+    size_t arena_capacity = 1024 * 1024;
+    size_t arena_used = 0;
+    unsigned char *arena = malloc(arena_capacity);
+    if (!keys || !arena) {
+        free(keys);
+        free(arena);
+        return -1;
+    }
+
+    // 키는 arena 안의 오프셋으로 모았다가 다 만든 뒤 포인터로 바꾼다 (realloc 대비)
+    for (int i = 0; i < dc->count; i++) {
+        const char *name = dircache_name(dc, i);
+        if (is_dot_entry(name)) {
+            continue;
+        }
+        char natural[MAX_FILENAME_LENGTH * 4];
+        natural_name(natural, sizeof(natural), name);
+        while (1) {
+            size_t room = arena_capacity - arena_used;
+            size_t len = strxfrm((char *)arena + arena_used, natural, room);
+            if (len < room) {
+                keys[n].key = (const unsigned char *)(uintptr_t)arena_used;
+                keys[n].idx = i;
+                n++;
+                arena_used += len + 1;
+                break;
+            }
+            unsigned char *p = realloc(arena, arena_capacity * 2);
+            if (!p) {
+                free(keys);
+                free(arena);
+                return -1;
+            }
+            arena = p;
+            arena_capacity *= 2;
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        keys[i].key = arena + (uintptr_t)keys[i].key;
+    }
+
+    sort_name_keys(keys, n, 0);
+    for (int i = 0; i < n; i++) {
+        sv->by_name[i] = keys[i].idx;
+    }
+    free(keys);
+    free(arena);
+    return n;
+}
+
+// 확장자 앞 7바이트 (소문자, 큰 자리부터) - 확장자가 없으면 0
+static uint64_t extension_key(const char *name) {
+    const char *dot = strrchr(name, '.');
+    uint64_t key = 0;
+    if (!dot || dot == name) {
+        return 0;
+    }
+    for (int i = 1; i <= 7; i++) {
+        unsigned char c = dot[i] ? tolower((unsigned char)dot[i]) : 0;
+        key = (key << 8) | c;
+        if (!c) {
+            key <<= 8 * (7 - i);
+            break;
+        }
+    }
+    return key;
+}
+
+// 항목마다 키를 미리 계산한다 (목록이나 stat 정보가 바뀔 때만)
+// 이름 순서대로 저장해서 기준을 바꿀 때는 키 배열을 앞에서부터 읽기만 한다
+static void build_keys(sort_view *sv, const dir_cache *dc) {
+    const uint64_t low_mask = (1ULL << 63) - 1;
+    for (int rank = 0; rank < sv->named_count; rank++) {
+        int idx = sv->by_name[rank];
+        int state = dc->state[idx];
+        sort_keys *k = &sv->keys[rank];
+        k->is_dir = dircache_is_dir(dc, idx);
+        k->missing = state != STAT_OK && state != STAT_FAILED;
+        if (state == STAT_OK) {
+            uint64_t sec = dc->mtime_sec[idx] > 0 ? dc->mtime_sec[idx] : 0; // 1970년 이전은 0
+            k->size = ~(uint64_t)dc->size[idx] & low_mask;
+            k->mtime = ~((sec << 30) | dc->mtime_nsec[idx]) & low_mask;
+        } else {
+            k->size = low_mask;
+            k->mtime = low_mask;
+        }
+        uint64_t kind = k->is_dir ? 0 : (dc->type[idx] == DT_REG || dc->type[idx] == DT_UNKNOWN ? 1 : 2);
+        k->kind = (kind << 56) | extension_key(dircache_name(dc, idx));
+    }
+    sv->keys_stat_generation = dc->stat_generation;
+    sv->keys_built = 1;
+}
+
+// 현재 기준의 64비트 키
+static uint64_t entry_key(const sort_view *sv, const sort_keys *k) {
+    uint64_t top = (sv->dirs_first && !k->is_dir) ? (1ULL << 63) : 0;
+    switch (sv->mode) {
+        case SORT_SIZE: return top | k->size;
+        case SORT_MTIME: return top | k->mtime;
+        case SORT_KIND: return top | k->kind;
+        default: return top;
+    }
+}
+
+// 안정 LSD 기수 정렬 (바이트 단위, 모든 항목이 같은 자리는 건너뜀)
+// 8자리의 빈도를 한 번에 세고 두 버퍼를 번갈아 쓴다. return 정렬된 쪽 버퍼
+static radix_item *radix_sort(radix_item *items, radix_item *tmp, int n) {
+    static int counts[8][256];
+    memset(counts, 0, sizeof(counts));
+    for (int i = 0; i < n; i++) {
+        uint64_t key = items[i].key;
+        for (int digit = 0; digit < 8; digit++) {
+            counts[digit][(key >> (digit * 8)) & 0xFF]++;
+        }
+    }
+    for (int digit = 0; digit < 8; digit++) {
+        int *count = counts[digit];
+        if (n == 0 || count[(items[0].key >> (digit * 8)) & 0xFF] == n) {
+            continue;
+        }
+        int sum = 0;
+        for (int b = 0; b < 256; b++) {
+            int c = count[b];
+            count[b] = sum;
+            sum += c;
+        }
+        for (int i = 0; i < n; i++) {
+            tmp[count[(items[i].key >> (digit * 8)) & 0xFF]++] = items[i];
+        }
+        radix_item *t = items;
+        items = tmp;
+        tmp = t;
+    }
+    return items;
+}
+
+const int *sortview_update(sort_view *sv, const dir_cache *dc) {
+    int names_changed = !sv->built || sv->generation != dc->generation || sv->count != dc->count;
+    int uses_stats = sv->mode != SORT_NAME || sv->dirs_first; // 디렉토리 여부도 stat 으로 바뀔 수 있다
+    if (!names_changed && sv->built_mode == sv->mode && sv->built_dirs_first == sv->dirs_first &&
+        (!uses_stats || sv->stat_generation == dc->stat_generation)) {
+        return sv->order;
+    }
+
+    if (dc->count > sv->capacity) {
+        int *by_name = realloc(sv->by_name, dc->count * sizeof(int));
+        if (by_name) {
+            sv->by_name = by_name;
+        }
+        int *order = realloc(sv->order, dc->count * sizeof(int));
+        if (order) {
+            sv->order = order;
+        }
+        sort_keys *keys = realloc(sv->keys, dc->count * sizeof(sort_keys));
+        if (keys) {
+            sv->keys = keys;
+        }
+        radix_item *scratch = realloc(sv->scratch, dc->count * 2 * sizeof(radix_item));
+        if (scratch) {
+            sv->scratch = scratch;
+        }
+        if (!by_name || !order || !keys || !scratch) {
+            sv->built = 0;
+            return NULL;
+        }
+        sv->capacity = dc->count;
+    }
+
+    if (names_changed) {
+        sv->keys_built = 0;
+        sv->named_count = build_name_order(sv, dc);
+        if (sv->named_count < 0) {
+            sv->built = 0;
+            return NULL;
+        }
+    }
+    int named = sv->named_count;
+
+    // '.' 과 '..' 은 항상 맨 앞
+    int n = 0;
+    for (int i = 0; i < dc->count && n < 2; i++) {
+        if (is_dot_entry(dircache_name(dc, i))) {
+            sv->order[n++] = i;
+        }
+    }
+
+    if (uses_stats && (names_changed || !sv->keys_built || sv->keys_stat_generation != dc->stat_generation)) {
+        build_keys(sv, dc);
+    }
+
+    sv->missing_stats = 0;
+    if (sv->mode == SORT_NAME && !sv->dirs_first) {
+        memcpy(sv->order + n, sv->by_name, named * sizeof(int));
+    } else {
+        radix_item *items = sv->scratch;
+        int needs_stat = sv->mode == SORT_SIZE || sv->mode == SORT_MTIME;
+        for (int i = 0; i < named; i++) {
+            const sort_keys *k = &sv->keys[i];
+            items[i].idx = sv->by_name[i];
+            items[i].key = entry_key(sv, k);
+            sv->missing_stats += needs_stat && k->missing;
+        }
+        const radix_item *sorted = radix_sort(items, items + named, named);
+        for (int i = 0; i < named; i++) {
+            sv->order[n + i] = sorted[i].idx;
+        }
+    }
+
+    sv->count = dc->count;
+    sv->generation = dc->generation;
+    sv->stat_generation = dc->stat_generation;
+    sv->built_mode = sv->mode;
+    sv->built_dirs_first = sv->dirs_first;
+    sv->built = 1;
+    return sv->order;
+}
@@ -0,0 +1,58 @@
+#ifndef __SORTVIEW__
+#define __SORTVIEW__
+
+#include <stdint.h>
+
+#include "dircache.h"
+
+// 정렬 기준
+#define SORT_NAME 0   // 이름 (숫자는 값 순서, 로케일 순서)
+#define SORT_SIZE 1   // 크기 (큰 것부터)
+#define SORT_MTIME 2  // 수정 시각 (최근 것부터)
+#define SORT_KIND 3   // 종류 (디렉토리, 확장자별 파일, 기타)
+#define SORT_MODE_COUNT 4
+
+// 항목 하나의 정렬 키 (작을수록 앞, 디렉토리 먼저 비트는 정렬할 때 더한다)
+typedef struct {
+    uint64_t size;   // 큰 것부터 - stat 정보가 없으면 맨 뒤
+    uint64_t mtime;  // 최근 것부터
+    uint64_t kind;   // 종류, 확장자
+    int is_dir;
+    int missing;     // stat 정보를 기다리는 중
+} sort_keys;
+
+// 디렉토리 목록의 정렬된 순서
+// 이름 순서는 목록이 바뀔 때 한 번만 만들고, 다른 기준은 항목마다 미리 계산한 64비트 키를
+// 이름 순서 위에서 안정 기수 정렬한다. 기준을 바꿔도 디렉토리를 다시 읽지 않는다
+typedef struct {
+    int mode;
+    int dirs_first;          // 1 - 디렉토리를 먼저
+
+    int *by_name;            // 이름 순서의 항목 번호 ('.', '..' 제외)
+    int named_count;
+    sort_keys *keys;         // 이름 순서의 미리 계산한 키 (keys[i] 는 by_name[i] 의 키)
+    int *order;              // 현재 기준으로 정렬된 항목 번호 ('.', '..' 는 항상 맨 앞)
+    void *scratch;           // 기수 정렬용 버퍼 (매번 새로 할당하지 않도록 유지)
+    int count;
+    int capacity;
+    int missing_stats;       // 정렬에 필요한 stat 정보가 아직 없는 항목 수
+
+    unsigned long generation;      // 이름 순서를 만든 목록의 세대
+    unsigned long stat_generation; // order 를 만든 stat 정보의 세대
+    unsigned long keys_stat_generation; // keys 를 만든 stat 정보의 세대
+    int keys_built;
+    int built_mode;
+    int built_dirs_first;
+    int built;
+} sort_view;
+
+void sortview_init(sort_view *sv);
+void sortview_free(sort_view *sv);
+
+// 목록이나 기준이 바뀐 경우에만 다시 정렬한다
+// return 정렬된 항목 번호 (dc->count 개), 메모리 부족이면 NULL
+const int *sortview_update(sort_view *sv, const dir_cache *dc);
+
+const char *sort_mode_name(int mode);
+
+#endif
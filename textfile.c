@@ -0,0 +1,497 @@
+#define _GNU_SOURCE // memrchr
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+
+#include "textfile.h"
+
+#define TEXTFILE_READ_LIMIT (64 * 1024 * 1024) // mmap 불가능한 파일을 읽어 들일 최대 크기
+#define INDEX_PUBLISH_BYTES (1024 * 1024)      // 이 만큼 스캔할 때마다 진행 상황 공개
+#define TEXTFILE_MAX_MAPS 8                     // SIGBUS 를 처리할 수 있게 등록해 두는 매핑 수
+
+// 매핑한 파일이 다른 프로세스에서 잘리면 새 파일 끝 뒤의 페이지를 읽는 순간 SIGBUS 가 난다
+// 화면, 인덱스 스레드, 검색 스레드 어디서든 읽을 수 있으므로 읽는 쪽에서 막지 않고,
+// 등록한 매핑 안의 SIGBUS 면 그 페이지를 0 으로 채운 익명 페이지로 바꾸고 truncated 를 표시한다
+// (따라가기의 textfile_follow_poll 이 보고 다시 연다)
+static struct {
+    const char *volatile start;
+    volatile size_t length;
+    text_file *volatile tf;
+} mapped_files[TEXTFILE_MAX_MAPS];
+static pthread_once_t sigbus_once = PTHREAD_ONCE_INIT;
+static size_t page_size;
+
+static void textfile_sigbus(int sig, siginfo_t *info, void *context) {
+    const char *addr = info->si_addr;
+    for (int i = 0; i < TEXTFILE_MAX_MAPS; i++) {
+        text_file *tf = mapped_files[i].tf;
+        if (!tf || addr < mapped_files[i].start || addr >= mapped_files[i].start + mapped_files[i].length) {
+            continue;
+        }
+        void *page = (void *)((uintptr_t)addr & ~(uintptr_t)(page_size - 1));
+        if (mmap(page, page_size, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) != MAP_FAILED) {
+            tf->truncated = 1;
+            return; // 같은 명령을 다시 실행하면 0 을 읽는다
+        }
+        break;
+    }
+    // 등록한 매핑이 아니면 원래대로 - 기본 동작으로 되돌리면 같은 명령에서 다시 SIGBUS 가 나서 종료된다
+    signal(SIGBUS, SIG_DFL);
+}
+
+static void textfile_install_sigbus(void) {
+    page_size = (size_t)sysconf(_SC_PAGESIZE);
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_sigaction = textfile_sigbus;
+    sa.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGBUS, &sa, NULL);
+}
+
+// tf 의 매핑을 등록한다 (data, map_size 가 바뀌면 다시 호출). 자리가 없으면 보호 없이 쓴다
+static void textfile_register_map(text_file *tf) {
+    pthread_once(&sigbus_once, textfile_install_sigbus);
+    int slot = -1;
+    for (int i = 0; i < TEXTFILE_MAX_MAPS; i++) {
+        if (mapped_files[i].tf == tf) {
+            slot = i;
+            break;
+        }
+        if (slot < 0 && !mapped_files[i].tf) {
+            slot = i;
+        }
+    }
+    if (slot < 0) {
+        return;
+    }
+    // 시그널 처리기가 반쯤 바뀐 구간을 보지 않게 tf 를 지우고 채운 뒤 다시 넣는다
+    __atomic_store_n(&mapped_files[slot].tf, NULL, __ATOMIC_SEQ_CST);
+    mapped_files[slot].start = tf->data;
+    mapped_files[slot].length = tf->map_size;
+    __atomic_store_n(&mapped_files[slot].tf, tf, __ATOMIC_SEQ_CST);
+}
+
+static void textfile_unregister_map(text_file *tf) {
+    for (int i = 0; i < TEXTFILE_MAX_MAPS; i++) {
+        if (mapped_files[i].tf == tf) {
+            __atomic_store_n(&mapped_files[i].tf, NULL, __ATOMIC_SEQ_CST);
+        }
+    }
+}
+
+// size 바로 앞의 내용을 매핑이 아닌 pread 로 읽어 둔다 (매핑은 다시 채워진 새 내용을 보여 주므로)
+static void textfile_sample_tail(text_file *tf) {
+    size_t len = tf->size < TEXTFILE_TAIL_SAMPLE ? tf->size : TEXTFILE_TAIL_SAMPLE;
+    ssize_t n = pread(tf->fd, tf->tail, len, tf->size - len);
+    tf->tail_len = n == (ssize_t)len ? len : 0;
+}
+
+static int textfile_add_mark(text_file *tf, size_t off) {
+    if (tf->mark_count == tf->mark_capacity) {
+        size_t new_capacity = tf->mark_capacity ? tf->mark_capacity * 2 : 1024;
+        size_t *p = realloc(tf->marks, new_capacity * sizeof(size_t));
+        if (!p) {
+            return -1;
+        }
+        tf->marks = p;
+        tf->mark_capacity = new_capacity;
+    }
+    tf->marks[tf->mark_count++] = off;
+    return 0;
+}
+
+// 라인 인덱스를 만드는 백그라운드 스레드
+// indexed_bytes (줄의 시작) 부터 시작한다 - 처음에는 0, 따라가기에서는 이전에 멈춘 곳
+static void *textfile_index_thread(void *arg) {
+    text_file *tf = arg;
+    size_t off = tf->indexed_bytes;
+    size_t lines = tf->indexed_lines;
+    size_t published = off;
+
+    while (off < tf->size && !tf->stop) {
+        // 줄 시작 위치 off
+        if (lines % LINE_INDEX_STRIDE == 0) {
+            pthread_mutex_lock(&tf->lock);
+            int failed = textfile_add_mark(tf, off);
+            pthread_mutex_unlock(&tf->lock);
+            if (failed) {
+                break;
+            }
+        }
+        lines++;
+
+        const char *nl = memchr(tf->data + off, '\n', tf->size - off);
+        off = nl ? (size_t)(nl - tf->data) + 1 : tf->size;
+
+        if (off - published >= INDEX_PUBLISH_BYTES || off >= tf->size) {
+            pthread_mutex_lock(&tf->lock);
+            tf->indexed_lines = lines;
+            tf->indexed_bytes = off;
+            pthread_mutex_unlock(&tf->lock);
+            published = off;
+            if (tf->on_progress) {
+                tf->on_progress();
+            }
+        }
+    }
+
+    pthread_mutex_lock(&tf->lock);
+    tf->indexed_lines = lines;
+    tf->indexed_bytes = off;
+    tf->index_done = 1;
+    pthread_mutex_unlock(&tf->lock);
+    if (tf->on_progress) {
+        tf->on_progress();
+    }
+    return NULL;
+}
+
+static void textfile_start_index(text_file *tf) {
+    if (pthread_create(&tf->index_thread, NULL, textfile_index_thread, tf) == 0) {
+        tf->thread_started = 1;
+    } else {
+        textfile_index_thread(tf); // 스레드를 못 만들면 직접 인덱싱
+    }
+}
+
+// 인덱스 스레드를 멈춘다. 마지막으로 공개한 위치까지의 인덱스는 그대로 남는다
+static void textfile_pause_index(text_file *tf) {
+    if (tf->thread_started) {
+        tf->stop = 1;
+        pthread_join(tf->index_thread, NULL);
+        tf->thread_started = 0;
+        tf->stop = 0;
+    }
+}
+
+// 멈춘 인덱스를 이어서 만든다
+// 마지막 줄이 개행 없이 끝났었다면 그 줄에 내용이 붙었을 수 있으므로 그 줄부터 다시 센다
+static void textfile_resume_index(text_file *tf) {
+    pthread_mutex_lock(&tf->lock);
+    size_t off = tf->indexed_bytes;
+    size_t lines = tf->indexed_lines;
+    if (off > 0 && lines > 0 && tf->data[off - 1] != '\n') {
+        lines--;
+        off = textfile_prev_line(tf, off);
+    }
+    tf->indexed_bytes = off;
+    tf->indexed_lines = lines;
+    tf->mark_count = (lines + LINE_INDEX_STRIDE - 1) / LINE_INDEX_STRIDE; // lines 보다 뒤에서 기록한 mark 는 버린다
+    tf->index_done = 0;
+    pthread_mutex_unlock(&tf->lock);
+    textfile_start_index(tf);
+}
+
+// size 바이트 파일을 매핑할 길이 - 파일이 커질 자리를 남겨 둔다
+static size_t textfile_map_length(size_t size) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    return (size + page - 1) / page * page + TEXTFILE_GROW_RESERVE;
+}
+
+int textfile_open(text_file *tf, const char *path, void (*on_progress)(void)) {
+    memset(tf, 0, sizeof(*tf));
+    tf->on_progress = on_progress;
+    tf->follow_fd = -1;
+    snprintf(tf->path, sizeof(tf->path), "%s", path);
+    tf->fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (tf->fd < 0) {
+        return -1;
+    }
+
+    struct stat file_stat;
+    if (fstat(tf->fd, &file_stat) != 0) {
+        close(tf->fd);
+        return -1;
+    }
+    tf->dev = file_stat.st_dev;
+    tf->ino = file_stat.st_ino;
+
+    tf->size = file_stat.st_size;
+    if (tf->size > 0) {
+        // 파일 끝 뒤의 빈 자리도 함께 매핑해 두면 파일이 커졌을 때 그대로 보인다 (MAP_SHARED)
+        // 그 자리는 파일이 실제로 커지기 전에는 읽지 않는다 (SIGBUS)
+        size_t map_size = textfile_map_length(tf->size);
+        void *p = mmap(NULL, map_size, PROT_READ, MAP_SHARED, tf->fd, 0);
+        if (p != MAP_FAILED) {
+            madvise(p, map_size, MADV_SEQUENTIAL);
+            tf->data = p;
+            tf->mapped = 1;
+            tf->map_size = map_size;
+            textfile_register_map(tf);
+            textfile_sample_tail(tf);
+        }
+    }
+
+    if (!tf->mapped) {
+        // /proc 파일처럼 크기를 알 수 없거나 mmap 이 안 되는 파일은 읽어 들인다
+        size_t capacity = 64 * 1024;
+        size_t len = 0;
+        char *buf = malloc(capacity);
+        ssize_t n;
+        while (buf && (n = read(tf->fd, buf + len, capacity - len)) > 0) {
+            len += n;
+            if (len == capacity) {
+                if (capacity >= TEXTFILE_READ_LIMIT) {
+                    break;
+                }
+                char *p = realloc(buf, capacity * 2);
+                if (!p) {
+                    break;
+                }
+                buf = p;
+                capacity *= 2;
+            }
+        }
+        if (!buf) {
+            close(tf->fd);
+            return -1;
+        }
+        tf->data = buf;
+        tf->size = len;
+    }
+
+    pthread_mutex_init(&tf->lock, NULL);
+    textfile_start_index(tf);
+    return 0;
+}
+
+void textfile_close(text_file *tf) {
+    tf->stop = 1;
+    if (tf->thread_started) {
+        pthread_join(tf->index_thread, NULL);
+    }
+    if (tf->mapped) {
+        textfile_unregister_map(tf);
+        munmap((void *)tf->data, tf->map_size);
+    } else {
+        free((void *)tf->data);
+    }
+    if (tf->fd >= 0) {
+        close(tf->fd);
+    }
+    if (tf->follow_fd >= 0) {
+        close(tf->follow_fd); // 감시도 함께 해제됨
+    }
+    free(tf->marks);
+    pthread_mutex_destroy(&tf->lock);
+    memset(tf, 0, sizeof(*tf));
+    tf->fd = -1;
+    tf->follow_fd = -1;
+}
+
+size_t textfile_line_end(const text_file *tf, size_t off) {
+    if (off >= tf->size) {
+        return tf->size;
+    }
+    const char *nl = memchr(tf->data + off, '\n', tf->size - off);
+    return nl ? (size_t)(nl - tf->data) : tf->size;
+}
+
+size_t textfile_next_line(const text_file *tf, size_t off) {
+    size_t end = textfile_line_end(tf, off);
+    return end + 1 < tf->size ? end + 1 : off;
+}
+
+size_t textfile_prev_line(const text_file *tf, size_t off) {
+    if (off == 0) {
+        return 0;
+    }
+    if (off > tf->size) {
+        off = tf->size;
+    }
+    // off-1 은 이전 줄의 개행 문자이므로 그 앞에서부터 찾는다
+    if (off < 2) {
+        return 0;
+    }
+    const char *nl = memrchr(tf->data, '\n', off - 1);
+    return nl ? (size_t)(nl - tf->data) + 1 : 0;
+}
+
+size_t textfile_indexed_lines(text_file *tf, int *done) {
+    pthread_mutex_lock(&tf->lock);
+    size_t lines = tf->indexed_lines;
+    if (done) {
+        *done = tf->index_done;
+    }
+    pthread_mutex_unlock(&tf->lock);
+    return lines;
+}
+
+int textfile_line_offset(text_file *tf, size_t line, size_t *off) {
+    if (tf->size == 0) {
+        *off = 0;
+        return 0;
+    }
+    pthread_mutex_lock(&tf->lock);
+    size_t k = line / LINE_INDEX_STRIDE;
+    if (k >= tf->mark_count || (line >= tf->indexed_lines && !tf->index_done)) {
+        pthread_mutex_unlock(&tf->lock);
+        return -1;
+    }
+    if (line >= tf->indexed_lines) { // 인덱싱 완료 후 범위 밖이면 마지막 줄로
+        line = tf->indexed_lines ? tf->indexed_lines - 1 : 0;
+        k = line / LINE_INDEX_STRIDE;
+    }
+    size_t pos = tf->marks[k];
+    pthread_mutex_unlock(&tf->lock);
+
+    for (size_t i = k * LINE_INDEX_STRIDE; i < line; i++) {
+        pos = textfile_next_line(tf, pos);
+    }
+    *off = pos;
+    return 0;
+}
+
+long textfile_line_number(text_file *tf, size_t off) {
+    pthread_mutex_lock(&tf->lock);
+    if (tf->mark_count == 0 || (off >= tf->indexed_bytes && !tf->index_done)) {
+        pthread_mutex_unlock(&tf->lock);
+        return tf->size == 0 ? 0 : -1;
+    }
+    // off 이하인 마지막 mark 를 이진 탐색
+    size_t lo = 0, hi = tf->mark_count - 1;
+    while (lo < hi) {
+        size_t mid = (lo + hi + 1) / 2;
+        if (tf->marks[mid] <= off) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    size_t pos = tf->marks[lo];
+    pthread_mutex_unlock(&tf->lock);
+
+    long line = (long)(lo * LINE_INDEX_STRIDE);
+    while (pos < off) {
+        const char *nl = memchr(tf->data + pos, '\n', off - pos);
+        if (!nl) {
+            break;
+        }
+        pos = (size_t)(nl - tf->data) + 1;
+        line++;
+    }
+    return line;
+}
+
+int textfile_follow(text_file *tf, int enable) {
+    if (!enable) {
+        if (tf->follow_fd >= 0) {
+            close(tf->follow_fd);
+            tf->follow_fd = -1;
+        }
+        return 0;
+    }
+    if (tf->follow_fd >= 0) {
+        return 0;
+    }
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    tf->file_wd = inotify_add_watch(fd, tf->path, IN_MODIFY | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF);
+    if (tf->file_wd < 0) {
+        close(fd);
+        return -1;
+    }
+    // 로그 회전으로 같은 이름의 새 파일이 생기는 것은 디렉토리에서 본다
+    char dir[MAX_DIR_LENGTH];
+    snprintf(dir, sizeof(dir), "%s", tf->path);
+    char *slash = strrchr(dir, '/');
+    if (!slash) {
+        snprintf(dir, sizeof(dir), ".");
+    } else {
+        slash[slash == dir ? 1 : 0] = '\0';
+    }
+    tf->dir_wd = inotify_add_watch(fd, dir, IN_CREATE | IN_MOVED_TO | IN_ONLYDIR);
+    tf->follow_fd = fd;
+    return 0;
+}
+
+int textfile_follow_fd(const text_file *tf) {
+    return tf->follow_fd;
+}
+
+int textfile_follow_poll(text_file *tf) {
+    if (tf->follow_fd >= 0) {
+        // 이벤트 내용은 보지 않는다 - 아래에서 파일 상태를 직접 확인
+        char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+        while (read(tf->follow_fd, buf, sizeof(buf)) > 0) {
+        }
+    }
+
+    if (tf->truncated) {
+        return TEXTFILE_REPLACED; // 잘린 뒤 매핑을 읽다가 0 으로 채운 페이지가 있다
+    }
+    struct stat st;
+    if (stat(tf->path, &st) == 0 && (st.st_dev != tf->dev || st.st_ino != tf->ino)) {
+        return TEXTFILE_REPLACED; // 회전 - 경로가 새 파일을 가리킴 (경로가 아직 없으면 옛 파일을 계속 따라간다)
+    }
+    if (fstat(tf->fd, &st) != 0) {
+        return TEXTFILE_SAME;
+    }
+    if ((size_t)st.st_size < tf->size) {
+        return TEXTFILE_REPLACED; // 잘림 (copytruncate 방식의 회전)
+    }
+    if (tf->tail_len > 0) { // 잘린 뒤 이벤트를 보기 전에 다시 채워져 커졌으면 size 앞의 내용이 다르다
+        char tail[TEXTFILE_TAIL_SAMPLE];
+        if (pread(tf->fd, tail, tf->tail_len, tf->size - tf->tail_len) != (ssize_t)tf->tail_len ||
+            memcmp(tail, tf->tail, tf->tail_len) != 0) {
+            return TEXTFILE_REPLACED;
+        }
+    }
+    return (size_t)st.st_size > tf->size ? TEXTFILE_GROWN : TEXTFILE_SAME;
+}
+
+int textfile_grow(text_file *tf) {
+    struct stat st;
+    if (!tf->mapped || fstat(tf->fd, &st) != 0 || (size_t)st.st_size < tf->size) {
+        return -1;
+    }
+    size_t new_size = st.st_size;
+    if (new_size == tf->size) {
+        return 0;
+    }
+
+    textfile_pause_index(tf);
+    if (new_size > tf->map_size) { // 남겨 둔 자리를 다 쓰면 다시 매핑
+        size_t map_size = textfile_map_length(new_size);
+        void *p = mremap((void *)tf->data, tf->map_size, map_size, MREMAP_MAYMOVE);
+        if (p == MAP_FAILED) {
+            textfile_resume_index(tf);
+            return -1;
+        }
+        tf->data = p;
+        tf->map_size = map_size;
+        textfile_register_map(tf);
+    }
+    pthread_mutex_lock(&tf->lock);
+    tf->size = new_size;
+    pthread_mutex_unlock(&tf->lock);
+    textfile_sample_tail(tf);
+    textfile_resume_index(tf);
+    return 0;
+}
+
+int textfile_reopen(text_file *tf) {
+    char path[MAX_DIR_LENGTH];
+    snprintf(path, sizeof(path), "%s", tf->path);
+    void (*on_progress)(void) = tf->on_progress;
+    int follow = tf->follow_fd >= 0;
+
+    textfile_close(tf);
+    if (textfile_open(tf, path, on_progress) != 0) {
+        return -1;
+    }
+    if (follow) {
+        textfile_follow(tf, 1);
+    }
+    return 0;
+}
@@ -0,0 +1,91 @@
+#ifndef __TEXTFILE__
+#define __TEXTFILE__
+
+#include <stddef.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/types.h>
+
+#include "project_macro.h"
+
+// 희소 라인 인덱스 간격: LINE_INDEX_STRIDE 줄마다 시작 오프셋 하나를 기록
+#define LINE_INDEX_STRIDE 64
+
+// 파일 끝 뒤로 미리 잡아 두는 매핑 크기 - 따라가기에서 파일이 커져도 이 안에서는 다시 매핑하지 않는다
+#define TEXTFILE_GROW_RESERVE (64 * 1024 * 1024)
+// 파일 끝 바로 앞에서 따로 읽어 두는 길이 - 잘린 뒤 다시 채워진 것을 알아본다
+#define TEXTFILE_TAIL_SAMPLE 64
+
+// textfile_follow_poll 의 결과
+#define TEXTFILE_SAME 0      // 변화 없음
+#define TEXTFILE_GROWN 1     // 뒤에 내용이 추가됨 - textfile_grow
+#define TEXTFILE_REPLACED 2  // 잘렸거나 (truncate) 같은 경로에 새 파일이 생김 (로그 회전) - textfile_reopen
+
+// 메모리 맵으로 연 텍스트 파일과 백그라운드에서 만드는 라인 인덱스
+typedef struct {
+    int fd;
+    const char *data;     // 파일 내용 (mmap 또는 읽어 온 버퍼)
+    size_t size;
+    int mapped;           // 1 - data 가 mmap 영역, 0 - malloc 버퍼
+    size_t map_size;      // 매핑한 길이 (size 뒤로 TEXTFILE_GROW_RESERVE 만큼 더)
+    char path[MAX_DIR_LENGTH];
+    dev_t dev;            // 연 파일 - 같은 경로의 파일이 바뀌었는지 확인
+    ino_t ino;
+    volatile sig_atomic_t truncated; // 매핑을 읽다가 SIGBUS (파일이 잘림) - 그 페이지는 0 으로 채워 둠
+    char tail[TEXTFILE_TAIL_SAMPLE]; // size 바로 앞의 내용 (pread 로 읽은 것)
+    size_t tail_len;
+
+    pthread_mutex_t lock; // 아래 인덱스 필드 보호
+    size_t *marks;        // marks[k] = k*LINE_INDEX_STRIDE 번째 줄의 시작 오프셋
+    size_t mark_count;
+    size_t mark_capacity;
+    size_t indexed_lines; // 인덱싱이 끝난 줄 수
+    size_t indexed_bytes; // 인덱싱이 끝난 바이트 위치
+    int index_done;
+
+    pthread_t index_thread;
+    int thread_started;
+    volatile int stop;
+    void (*on_progress)(void); // 인덱싱 진행 알림 (NULL 가능, 인덱스 스레드에서 호출)
+
+    // 따라가기 (tail -f) - 파일과 파일이 있는 디렉토리를 inotify 로 감시
+    int follow_fd;        // 감시하지 않으면 -1
+    int file_wd;
+    int dir_wd;
+} text_file;
+
+// on_progress 는 인덱싱이 진행될 때마다 인덱스 스레드에서 호출된다 (NULL 가능)
+// return 0 - 성공, -1 - 열기 실패
+int textfile_open(text_file *tf, const char *path, void (*on_progress)(void));
+void textfile_close(text_file *tf);
+
+// off 가 속한 줄의 끝 (개행 문자 위치 또는 파일 끝)
+size_t textfile_line_end(const text_file *tf, size_t off);
+// 다음 줄의 시작, 마지막 줄이면 off 그대로
+size_t textfile_next_line(const text_file *tf, size_t off);
+// 이전 줄의 시작, 첫 줄이면 0
+size_t textfile_prev_line(const text_file *tf, size_t off);
+
+// 인덱스 상태 조회
+size_t textfile_indexed_lines(text_file *tf, int *done);
+// line 번째 줄(0부터)의 시작 오프셋. return 0 - 성공, -1 - 아직 인덱싱되지 않음
+int textfile_line_offset(text_file *tf, size_t line, size_t *off);
+// off 위치의 줄 번호(0부터), 아직 인덱싱되지 않았으면 -1
+long textfile_line_number(text_file *tf, size_t off);
+
+// 따라가기 켜고 끄기. return 0 - 성공, -1 - 감시할 수 없음
+int textfile_follow(text_file *tf, int enable);
+// poll 에 넣을 inotify fd, 따라가기 중이 아니면 -1
+int textfile_follow_fd(const text_file *tf);
+// 쌓인 감시 이벤트를 읽고 파일이 어떻게 바뀌었는지 확인한다 (data 는 건드리지 않음)
+// 잘렸다가 다시 커진 파일도 (같은 inode, size 앞의 내용이 다름) TEXTFILE_REPLACED
+// return TEXTFILE_SAME, TEXTFILE_GROWN, TEXTFILE_REPLACED
+int textfile_follow_poll(text_file *tf);
+// 추가된 내용을 반영하고 그 부분부터 라인 인덱스를 이어서 만든다
+// 매핑이 모자라면 다시 매핑하므로 data 가 바뀔 수 있다 (data 를 읽는 다른 스레드는 먼저 멈출 것)
+// return 0 - 성공, -1 - 다시 열어야 함
+int textfile_grow(text_file *tf);
+// 같은 경로를 처음부터 다시 연다 (따라가기 상태는 유지). return 0 - 성공, -1 - 열기 실패 (tf 는 닫힌 상태)
+int textfile_reopen(text_file *tf);
+
+#endif
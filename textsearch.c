@@ -0,0 +1,398 @@
+#define _GNU_SOURCE // memrchr
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "textsearch.h"
+
+#define SEARCH_CHUNK (4 * 1024 * 1024) // 이 만큼 검색할 때마다 인덱스에 반영하고 진행 상황 공개
+#define SEARCH_NONE SIZE_MAX
+// regexec 는 시작 위치마다 줄 끝까지 보므로 긴 줄에서는 줄 길이의 제곱만큼 걸리고 중간에 멈출 수도 없다
+// 한 번에 SEARCH_REGEX_WINDOW 까지만 넘기고, 줄 중간에서 자를 때는 SEARCH_REGEX_OVERLAP 만큼 겹쳐서 다시 본다
+// (그보다 긴 일치는 잘리거나 놓칠 수 있다)
+#define SEARCH_REGEX_WINDOW 4096
+#define SEARCH_REGEX_OVERLAP 256
+
+// [p, end) 에서 pat (n 바이트, n >= 1) 이 처음 나오는 위치
+static const char *find_literal(const char *p, const char *end, const char *pat, size_t n) {
+    if (n == 1) {
+        return memchr(p, pat[0], end - p);
+    }
+#ifdef __SSE2__
+    // 16개 위치에서 첫 바이트와 마지막 바이트가 모두 같은 곳만 후보로 남긴다
+    const __m128i first = _mm_set1_epi8(pat[0]);
+    const __m128i last = _mm_set1_epi8(pat[n - 1]);
+    while ((size_t)(end - p) >= n - 1 + 16) {
+        __m128i a = _mm_loadu_si128((const __m128i *)p);
+        __m128i b = _mm_loadu_si128((const __m128i *)(p + n - 1));
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last)));
+        while (mask) {
+            int bit = __builtin_ctz(mask);
+            if (memcmp(p + bit + 1, pat + 1, n - 2) == 0) {
+                return p + bit;
+            }
+            mask &= mask - 1;
+        }
+        p += 16;
+    }
+#endif
+    // 나머지 - memchr 로 첫 바이트를 찾고 비교
+    while ((size_t)(end - p) >= n) {
+        const char *q = memchr(p, pat[0], end - p - n + 1);
+        if (!q) {
+            return NULL;
+        }
+        if (memcmp(q, pat, n) == 0) {
+            return q;
+        }
+        p = q + 1;
+    }
+    return NULL;
+}
+
+// [pos, end) 에서 처음 일치하는 위치와 길이, 없으면 SEARCH_NONE
+static size_t scan_once(const text_search *ts, regex_t *re, size_t pos, size_t end, size_t *len) {
+    if (!ts->regex) {
+        const char *q = find_literal(ts->data + pos, ts->data + end, ts->pattern, ts->pattern_len);
+        *len = ts->pattern_len;
+        return q ? (size_t)(q - ts->data) : SEARCH_NONE;
+    }
+    // REG_STARTEND - NUL 로 끝나지 않는 mmap 영역을 복사 없이 검색
+    regmatch_t pm[1];
+    pm[0].rm_so = pos;
+    pm[0].rm_eo = end;
+    int flags = REG_STARTEND;
+    if (pos > 0 && ts->data[pos - 1] != '\n') {
+        flags |= REG_NOTBOL;
+    }
+    if (end < ts->size && ts->data[end] != '\n') {
+        flags |= REG_NOTEOL;
+    }
+    if (regexec(re, ts->data, 1, pm, flags) != 0) {
+        return SEARCH_NONE;
+    }
+    *len = pm[0].rm_eo - pm[0].rm_so;
+    return pm[0].rm_so;
+}
+
+// 파일 전체를 앞에서부터 검색하며 일치 위치 인덱스를 만드는 스레드
+static void *textsearch_thread(void *arg) {
+    text_search *ts = arg;
+    size_t *found = NULL;
+    size_t found_capacity = 0;
+    size_t pos = ts->scanned; // 처음에는 0, resume 이면 멈췄던 곳
+
+    while (pos < ts->size && !ts->stop) {
+        size_t chunk_end = ts->size - pos > SEARCH_CHUNK ? pos + SEARCH_CHUNK : ts->size;
+        size_t limit = chunk_end;
+        if (ts->regex) { // 정규식은 줄 단위라서 구간을 줄 끝에 맞춘다
+            size_t line_end = ts->size - chunk_end > SEARCH_CHUNK ? chunk_end + SEARCH_CHUNK : ts->size;
+            const char *nl = memchr(ts->data + chunk_end, '\n', line_end - chunk_end);
+            if (nl) {
+                chunk_end = limit = (size_t)(nl - ts->data) + 1;
+            } else if (line_end == ts->size) {
+                chunk_end = limit = ts->size;
+            } else { // 줄바꿈이 없는 긴 줄은 줄 중간에서 자른다
+                chunk_end = line_end;
+                limit = ts->size - chunk_end > SEARCH_REGEX_OVERLAP ? chunk_end + SEARCH_REGEX_OVERLAP : ts->size;
+            }
+        } else { // 구간 끝에 걸친 일치도 찾도록 검색어 길이만큼 더 본다
+            limit = ts->size - chunk_end > ts->pattern_len - 1 ? chunk_end + ts->pattern_len - 1 : ts->size;
+        }
+
+        size_t found_count = 0;
+        size_t last_end = 0;
+        size_t p = pos;
+        while (p < chunk_end && !ts->stop) {
+            size_t len;
+            size_t end = limit;
+            int cut = 0; // 줄 중간에서 자른 창
+            if (ts->regex && limit - p > SEARCH_REGEX_WINDOW) {
+                const char *nl = memrchr(ts->data + p, '\n', SEARCH_REGEX_WINDOW);
+                if (nl) {
+                    end = (size_t)(nl - ts->data) + 1;
+                } else {
+                    end = p + SEARCH_REGEX_WINDOW;
+                    cut = 1;
+                }
+            }
+            size_t m = scan_once(ts, &ts->re_scan, p, end, &len);
+            if (m == SEARCH_NONE) {
+                if (end == limit) {
+                    break;
+                }
+                p = cut ? end - SEARCH_REGEX_OVERLAP : end;
+                continue;
+            }
+            if (cut && m >= end - SEARCH_REGEX_OVERLAP) { // 창 끝에서 잘렸을 수 있으니 m 부터 다시
+                p = m;
+                continue;
+            }
+            if (m >= chunk_end) {
+                break;
+            }
+            if (found_count == found_capacity) {
+                size_t new_capacity = found_capacity ? found_capacity * 2 : 1024;
+                size_t *q = realloc(found, new_capacity * sizeof(size_t));
+                if (!q) {
+                    break;
+                }
+                found = q;
+                found_capacity = new_capacity;
+            }
+            found[found_count++] = m;
+            last_end = m + len;
+            p = m + (len ? len : 1); // 겹치지 않게 다음 일치를 찾는다
+        }
+
+        if (ts->stop) { // 구간 중간에서 멈췄으면 버린다 (resume 이 pos 부터 다시 검색)
+            break;
+        }
+
+        // 이 구간에서 마지막 줄이 시작하는 곳 (없으면 앞 구간에서 이어지는 줄)
+        size_t line_start = SEARCH_NONE;
+        if (!ts->regex) {
+            line_start = chunk_end; // 문자열 검색은 resume 이 last_end 뒤부터라서 다시 찾는 일치가 없다
+        } else if (chunk_end > pos && ts->data[chunk_end - 1] == '\n') {
+            line_start = chunk_end;
+        } else if (chunk_end > pos) {
+            const char *nl = memrchr(ts->data + pos, '\n', chunk_end - pos);
+            if (nl) {
+                line_start = (size_t)(nl - ts->data) + 1;
+            }
+        }
+
+        pthread_mutex_lock(&ts->lock);
+        size_t keep = ts->dropped ? 0 : found_count; // 한 번 넘치면 인덱스에 빈틈이 생기지 않게 더 기록하지 않는다
+        if (ts->stored + keep > TEXTSEARCH_MAX_MATCHES) {
+            keep = TEXTSEARCH_MAX_MATCHES - ts->stored;
+        }
+        if (keep > 0 && ts->stored + keep > ts->capacity) {
+            size_t new_capacity = ts->capacity ? ts->capacity : 1024;
+            while (new_capacity < ts->stored + keep) {
+                new_capacity *= 2;
+            }
+            size_t *q = realloc(ts->matches, new_capacity * sizeof(size_t));
+            if (q) {
+                ts->matches = q;
+                ts->capacity = new_capacity;
+            } else {
+                keep = ts->capacity - ts->stored;
+            }
+        }
+        memcpy(ts->matches + ts->stored, found, keep * sizeof(size_t));
+        ts->stored += keep;
+        if (line_start != SEARCH_NONE) {
+            ts->dropped_line = ts->dropped;
+            for (size_t i = keep; i < found_count && found[i] < line_start; i++) {
+                ts->dropped_line++;
+            }
+        }
+        ts->dropped += found_count - keep;
+        ts->count += found_count;
+        if (found_count > 0) {
+            ts->last_end = last_end;
+        }
+        ts->scanned = chunk_end;
+        pthread_mutex_unlock(&ts->lock);
+
+        pos = p > chunk_end ? p : chunk_end;
+        if (ts->on_progress) {
+            ts->on_progress();
+        }
+    }
+    free(found);
+
+    if (!ts->stop) {
+        pthread_mutex_lock(&ts->lock);
+        ts->scanned = ts->size;
+        ts->done = 1;
+        pthread_mutex_unlock(&ts->lock);
+        if (ts->on_progress) {
+            ts->on_progress();
+        }
+    }
+    return NULL;
+}
+
+static void textsearch_start_thread(text_search *ts) {
+    if (pthread_create(&ts->thread, NULL, textsearch_thread, ts) == 0) {
+        ts->thread_started = 1;
+    } else {
+        textsearch_thread(ts); // 스레드를 못 만들면 직접 검색
+    }
+}
+
+int textsearch_start(text_search *ts, const char *data, size_t size, const char *pattern, int regex,
+                     void (*on_progress)(void)) {
+    memset(ts, 0, sizeof(*ts));
+    size_t len = strlen(pattern);
+    if (len == 0 || len >= sizeof(ts->pattern)) {
+        snprintf(ts->error, sizeof(ts->error), len ? "pattern too long" : "empty pattern");
+        return -1;
+    }
+    if (regex) {
+        int err = regcomp(&ts->re_scan, pattern, REG_EXTENDED | REG_NEWLINE);
+        if (err == 0) {
+            err = regcomp(&ts->re_view, pattern, REG_EXTENDED | REG_NEWLINE);
+            if (err != 0) {
+                regfree(&ts->re_scan);
+            }
+        }
+        if (err != 0) {
+            regerror(err, NULL, ts->error, sizeof(ts->error));
+            return -1;
+        }
+    }
+
+    memcpy(ts->pattern, pattern, len + 1);
+    ts->pattern_len = len;
+    ts->regex = regex;
+    ts->data = data;
+    ts->size = size;
+    ts->on_progress = on_progress;
+    pthread_mutex_init(&ts->lock, NULL);
+    textsearch_start_thread(ts);
+    return 0;
+}
+
+void textsearch_stop(text_search *ts) {
+    if (ts->pattern_len == 0) {
+        return;
+    }
+    ts->stop = 1;
+    if (ts->thread_started) {
+        pthread_join(ts->thread, NULL);
+    }
+    if (ts->regex) {
+        regfree(&ts->re_scan);
+        regfree(&ts->re_view);
+    }
+    free(ts->matches);
+    pthread_mutex_destroy(&ts->lock);
+    memset(ts, 0, sizeof(*ts));
+}
+
+// off 보다 작은 일치의 개수 (호출 전에 lock)
+static size_t lower_bound(const text_search *ts, size_t off) {
+    size_t lo = 0, hi = ts->stored;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (ts->matches[mid] < off) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+void textsearch_pause(text_search *ts) {
+    if (ts->pattern_len == 0) {
+        return;
+    }
+    if (ts->thread_started) {
+        ts->stop = 1;
+        pthread_join(ts->thread, NULL);
+        ts->thread_started = 0;
+        ts->stop = 0;
+    }
+}
+
+void textsearch_resume(text_search *ts, const char *data, size_t size) {
+    if (ts->pattern_len == 0) {
+        return;
+    }
+    pthread_mutex_lock(&ts->lock);
+    ts->data = data;
+    ts->size = size;
+    // 끝부분에 걸쳐서 아직 찾지 못한 일치가 있을 수 있는 곳부터 다시
+    // 정규식은 마지막 줄의 시작부터, 문자열은 검색어 길이 - 1 만큼 앞에서부터
+    size_t resume = ts->scanned;
+    if (ts->regex) {
+        while (resume > 0 && data[resume - 1] != '\n') {
+            resume--;
+        }
+    } else {
+        resume = resume > ts->pattern_len - 1 ? resume - (ts->pattern_len - 1) : 0;
+    }
+    if (!ts->regex && ts->last_end > resume) {
+        resume = ts->last_end; // 이미 찾은 일치와 겹치지 않게
+    }
+    // resume 뒤의 일치는 다시 찾는다 - 기록하지 못한 일치도 마지막 줄 것은 뺀다
+    size_t idx = lower_bound(ts, resume);
+    ts->stored = idx;
+    ts->dropped = ts->dropped_line;
+    ts->count = ts->stored + ts->dropped;
+    ts->scanned = resume;
+    ts->done = 0;
+    pthread_mutex_unlock(&ts->lock);
+    textsearch_start_thread(ts);
+}
+
+size_t textsearch_progress(text_search *ts, int *done, size_t *scanned) {
+    pthread_mutex_lock(&ts->lock);
+    size_t count = ts->count;
+    if (done) {
+        *done = ts->done;
+    }
+    if (scanned) {
+        *scanned = ts->scanned;
+    }
+    pthread_mutex_unlock(&ts->lock);
+    return count;
+}
+
+int textsearch_find(text_search *ts, size_t from, int backward, size_t *match) {
+    int result;
+    pthread_mutex_lock(&ts->lock);
+    size_t idx = lower_bound(ts, from);
+    int full = ts->dropped > 0; // 인덱스가 가득 차서 뒤쪽 일치는 기록되지 않음
+    if (!backward) {
+        if (idx < ts->stored) {
+            *match = ts->matches[idx];
+            result = 0;
+        } else {
+            result = ts->done || full ? -1 : 1;
+        }
+    } else {
+        if (from > ts->scanned && !ts->done && !full) { // [scanned, from) 에 일치가 더 있을 수 있다
+            result = 1;
+        } else if (idx > 0) {
+            *match = ts->matches[idx - 1];
+            result = 0;
+        } else {
+            result = -1;
+        }
+    }
+    pthread_mutex_unlock(&ts->lock);
+    return result;
+}
+
+size_t textsearch_rank(text_search *ts, size_t off) {
+    pthread_mutex_lock(&ts->lock);
+    size_t rank = lower_bound(ts, off);
+    pthread_mutex_unlock(&ts->lock);
+    return rank;
+}
+
+int textsearch_range(text_search *ts, size_t start, size_t end, size_t *offs, size_t *lens, int max) {
+    int n = 0;
+    size_t p = start;
+    while (n < max && p < end) {
+        size_t len;
+        size_t m = scan_once(ts, &ts->re_view, p, end, &len);
+        if (m == SEARCH_NONE) {
+            break;
+        }
+        offs[n] = m;
+        lens[n] = len;
+        n++;
+        p = m + (len ? len : 1);
+    }
+    return n;
+}
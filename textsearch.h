@@ -0,0 +1,68 @@
+#ifndef __TEXTSEARCH__
+#define __TEXTSEARCH__
+
+#include <stddef.h>
+#include <pthread.h>
+#include <regex.h>
+
+#define TEXTSEARCH_MAX_PATTERN 256
+#define TEXTSEARCH_MAX_MATCHES (4 * 1024 * 1024) // 인덱스에 기록하는 최대 일치 수 (그 뒤로는 개수만 센다)
+
+// 파일 보기 화면의 검색
+// 백그라운드 스레드가 파일 전체를 훑으며 일치 위치 인덱스를 만들고,
+// UI 스레드는 만들어진 만큼의 인덱스로 다음/이전 일치로 이동한다
+// 문자열 검색은 첫 바이트와 마지막 바이트를 16바이트씩 비교해서 후보만 확인한다 (SSE2)
+typedef struct {
+    const char *data;     // 검색할 내용 (text_file 의 mmap 영역)
+    size_t size;
+    char pattern[TEXTSEARCH_MAX_PATTERN];
+    size_t pattern_len;
+    int regex;            // 1 - POSIX 확장 정규식 (줄 단위), 0 - 문자열 그대로
+    regex_t re_scan;      // 검색 스레드용
+    regex_t re_view;      // 화면 강조용 (UI 스레드)
+
+    pthread_mutex_t lock; // 아래 필드 보호
+    size_t *matches;      // 일치 시작 위치 (오름차순)
+    size_t stored;
+    size_t capacity;
+    size_t count;         // 찾은 일치 수 (= stored + dropped)
+    size_t dropped;       // 인덱스가 가득 차서 기록하지 못한 일치 수 (모두 matches 의 마지막 일치 뒤에 있다)
+    size_t dropped_line;  // 그 중 마지막 줄이 시작하기 전의 수 (resume 이 다시 찾지 않는 것)
+    size_t last_end;      // 마지막으로 찾은 일치의 끝 (문자열 검색의 resume 용)
+    size_t scanned;       // 이 위치 앞까지 검색 완료
+    int done;
+
+    pthread_t thread;
+    int thread_started;
+    volatile int stop;
+    void (*on_progress)(void); // 진행 알림 (NULL 가능, 검색 스레드에서 호출)
+    char error[128];           // textsearch_start 가 실패한 이유
+} text_search;
+
+// data[0, size) 에서 pattern 검색을 시작한다
+// return 0 - 성공, -1 - 정규식 오류 또는 빈 검색어 (error 에 이유)
+int textsearch_start(text_search *ts, const char *data, size_t size, const char *pattern, int regex,
+                     void (*on_progress)(void));
+// 검색 스레드를 멈추고 메모리를 정리한다 (시작하지 않은 상태에서도 호출 가능)
+void textsearch_stop(text_search *ts);
+
+// 따라가기에서 내용이 바뀔 때 - pause 로 검색 스레드를 멈추고 (data 를 읽지 않게),
+// resume 으로 바뀐 data, size 에서 멈췄던 곳부터 이어서 검색한다 (뒤에 추가된 내용만 검색)
+void textsearch_pause(text_search *ts);
+void textsearch_resume(text_search *ts, const char *data, size_t size);
+
+// 찾은 일치 수. done, scanned 는 NULL 가능
+size_t textsearch_progress(text_search *ts, int *done, size_t *scanned);
+
+// from 이후 (backward 면 from 앞) 의 가장 가까운 일치
+// return 0 - 찾음 (*match), 1 - 아직 검색하지 않은 구간이라 모름, -1 - 없음
+int textsearch_find(text_search *ts, size_t from, int backward, size_t *match);
+
+// off 앞에 있는 일치 수 (일치 번호 표시용)
+size_t textsearch_rank(text_search *ts, size_t off);
+
+// [start, end) 안의 일치를 인덱스와 상관없이 바로 찾는다 (화면 강조용, UI 스레드)
+// return 찾은 수 (최대 max)
+int textsearch_range(text_search *ts, size_t start, size_t end, size_t *offs, size_t *lens, int max);
+
+#endif
@@ -0,0 +1,490 @@
+#define _GNU_SOURCE // syncfs
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <ftw.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#include "treecopy.h"
+#include "copy.h"
+
+// 복사 작업 하나 (디렉토리 또는 파일)
+typedef struct copy_job {
+    char *src;
+    char *dst;
+    struct stat st;
+    struct copy_job *next;
+} copy_job;
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t dir_cond;    // 디렉토리 작업이 생기거나 탐색이 끝남
+    pthread_cond_t file_cond;   // 파일 작업이 생기거나 탐색이 끝남
+    pthread_cond_t space_cond;  // 파일 큐에 자리가 생김
+
+    copy_job *dirs;             // 읽을 디렉토리 (제한 없음)
+    int dirs_active;            // 지금 읽고 있는 디렉토리 수
+    copy_job *files_head;       // 복사할 파일 (최대 TREECOPY_QUEUE_LIMIT 개)
+    copy_job *files_tail;
+    int file_count;
+    int walkers_running;
+    int inline_copy;            // 복사 스레드가 없음 - 탐색하면서 바로 복사
+    copy_job *made_dirs;        // 만든 디렉토리, 끝난 뒤 권한과 시간 정보 복원
+
+    int sync_fd;                // destination 디렉토리 (syncfs 용), -1 이면 파일마다 fdatasync
+    copy_job *pending;          // 복사는 끝났지만 아직 디스크에 내리지 않은 파일 (src 가 임시 파일)
+    int pending_count;
+    long long pending_bytes;
+
+    tree_copy_stats *stats;
+} tree_copy;
+
+static copy_job *new_job(const char *src, const char *dst, const struct stat *st) {
+    copy_job *job = malloc(sizeof(copy_job));
+    if (!job) {
+        return NULL;
+    }
+    job->src = strdup(src);
+    job->dst = strdup(dst);
+    job->st = *st;
+    job->next = NULL;
+    return job;
+}
+
+static void free_job(copy_job *job) {
+    free(job->src);
+    free(job->dst);
+    free(job);
+}
+
+static void record_error(tree_copy_stats *stats, const char *path, int err) {
+    if (__atomic_fetch_add(&stats->errors, 1, __ATOMIC_RELAXED) == 0) {
+        stats->first_error = err;
+        strncpy(stats->error_path, path, sizeof(stats->error_path) - 1);
+        stats->error_path[sizeof(stats->error_path) - 1] = '\0';
+    }
+}
+
+static void push_dir(tree_copy *tc, copy_job *job) {
+    pthread_mutex_lock(&tc->lock);
+    job->next = tc->dirs;
+    tc->dirs = job;
+    pthread_cond_signal(&tc->dir_cond);
+    pthread_mutex_unlock(&tc->lock);
+}
+
+// 복사 결과 중 해시와 남긴 임시 파일을 센다
+static void count_result(tree_copy_stats *stats, const copy_stats *cs) {
+    if (cs->has_digest) {
+        __atomic_add_fetch(&stats->files_checksummed, 1, __ATOMIC_RELAXED);
+    }
+    if (cs->verified) {
+        __atomic_add_fetch(&stats->files_verified, 1, __ATOMIC_RELAXED);
+    }
+    if (cs->partial_kept) {
+        __atomic_add_fetch(&stats->partials_kept, 1, __ATOMIC_RELAXED);
+    }
+}
+
+// 모아 둔 파일들을 마무리한다 - 임시 파일 내용을 syncfs 한 번으로 내리고 rename 한 뒤
+// 바뀐 디렉토리 항목도 syncfs 한 번으로 내린다 (파일마다 fdatasync 하면 작은 파일이 많을 때 매우 느리다)
+static void commit_batch(tree_copy *tc, copy_job *batch) {
+    int synced = syncfs(tc->sync_fd) == 0;
+    int sync_errno = errno;
+    while (batch) {
+        copy_job *next = batch->next;
+        if (!synced) {
+            record_error(tc->stats, batch->dst, sync_errno);
+            unlink(batch->src);
+        } else if (rename(batch->src, batch->dst) != 0) {
+            record_error(tc->stats, batch->dst, errno);
+            unlink(batch->src);
+        } else {
+            __atomic_add_fetch(&tc->stats->files_done, 1, __ATOMIC_RELAXED);
+        }
+        free_job(batch);
+        batch = next;
+    }
+    if (synced && syncfs(tc->sync_fd) != 0) {
+        record_error(tc->stats, tc->made_dirs->dst, errno);
+    }
+}
+
+// 복사가 끝난 임시 파일을 마무리 목록에 넣고, 충분히 모이면 마무리한다
+static void queue_commit(tree_copy *tc, const char *temp, copy_job *job) {
+    copy_job *entry = new_job(temp, job->dst, &job->st);
+    if (!entry) {
+        record_error(tc->stats, job->src, ENOMEM);
+        unlink(temp);
+        return;
+    }
+    copy_job *batch = NULL;
+    pthread_mutex_lock(&tc->lock);
+    entry->next = tc->pending;
+    tc->pending = entry;
+    tc->pending_bytes += job->st.st_size;
+    if (++tc->pending_count >= TREECOPY_SYNC_FILES || tc->pending_bytes >= TREECOPY_SYNC_BYTES) {
+        batch = tc->pending;
+        tc->pending = NULL;
+        tc->pending_count = 0;
+        tc->pending_bytes = 0;
+    }
+    pthread_mutex_unlock(&tc->lock);
+    if (batch) {
+        commit_batch(tc, batch);
+    }
+}
+
+// 파일 하나 복사
+static void copy_one(tree_copy *tc, copy_job *job) {
+    if (!tc->stats->cancel) {
+        copy_stats cs;
+        memset(&cs, 0, sizeof(cs));
+        cs.shared_done = &tc->stats->bytes_done;
+        cs.shared_cancel = &tc->stats->cancel;
+        cs.defer_commit = tc->sync_fd >= 0;
+        if (copy_file_fast(job->src, job->dst, &cs) == 0) {
+            if (cs.temp_path[0]) {
+                queue_commit(tc, cs.temp_path, job);
+            } else {
+                __atomic_add_fetch(&tc->stats->files_done, 1, __ATOMIC_RELAXED);
+            }
+        } else if (cs.error != ECANCELED) {
+            record_error(tc->stats, job->src, cs.error);
+        }
+        count_result(tc->stats, &cs);
+    }
+    free_job(job);
+}
+
+// 파일 작업 추가, 큐가 가득 차면 복사 스레드가 따라올 때까지 기다린다
+static void push_file(tree_copy *tc, copy_job *job) {
+    if (tc->inline_copy) {
+        copy_one(tc, job);
+        return;
+    }
+    pthread_mutex_lock(&tc->lock);
+    while (tc->file_count >= TREECOPY_QUEUE_LIMIT && !tc->stats->cancel) {
+        pthread_cond_wait(&tc->space_cond, &tc->lock);
+    }
+    if (tc->files_tail) {
+        tc->files_tail->next = job;
+    } else {
+        tc->files_head = job;
+    }
+    tc->files_tail = job;
+    tc->file_count++;
+    pthread_cond_signal(&tc->file_cond);
+    pthread_mutex_unlock(&tc->lock);
+}
+
+// 심볼릭 링크는 따라가지 않고 링크 자체를 만든다
+static void copy_symlink(tree_copy *tc, const char *src, const char *dst) {
+    char target[PATH_MAX];
+    ssize_t len = readlink(src, target, sizeof(target) - 1);
+    if (len < 0) {
+        record_error(tc->stats, src, errno);
+        return;
+    }
+    if (len == sizeof(target) - 1) { // 잘렸을 수 있다 - 다른 곳을 가리키는 링크를 만들지 않는다
+        record_error(tc->stats, src, ENAMETOOLONG);
+        return;
+    }
+    target[len] = '\0';
+    if (symlink(target, dst) != 0) {
+        record_error(tc->stats, dst, errno);
+    }
+}
+
+// 디렉토리 하나를 읽어서 하위 디렉토리와 파일 작업을 만든다
+static void scan_dir(tree_copy *tc, copy_job *dir) {
+    DIR *dp = opendir(dir->src);
+    if (!dp) {
+        record_error(tc->stats, dir->src, errno);
+        return;
+    }
+
+    struct dirent *ent;
+    while ((ent = readdir(dp)) != NULL && !tc->stats->cancel) {
+        if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0) {
+            continue;
+        }
+        char src[MAX_DIR_LENGTH], dst[MAX_DIR_LENGTH];
+        if ((size_t)snprintf(src, sizeof(src), "%s/%s", dir->src, ent->d_name) >= sizeof(src) ||
+            (size_t)snprintf(dst, sizeof(dst), "%s/%s", dir->dst, ent->d_name) >= sizeof(dst)) {
+            record_error(tc->stats, src, ENAMETOOLONG);
+            continue;
+        }
+
+        struct stat st;
+        if (fstatat(dirfd(dp), ent->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+            record_error(tc->stats, src, errno);
+            continue;
+        }
+
+        if (S_ISDIR(st.st_mode)) {
+            if (mkdir(dst, 0700) != 0 && errno != EEXIST) {
+                record_error(tc->stats, dst, errno);
+                continue;
+            }
+            copy_job *made = new_job(src, dst, &st);
+            copy_job *job = new_job(src, dst, &st);
+            if (!made || !job) {
+                record_error(tc->stats, src, ENOMEM);
+                continue;
+            }
+            pthread_mutex_lock(&tc->lock);
+            made->next = tc->made_dirs;
+            tc->made_dirs = made;
+            pthread_mutex_unlock(&tc->lock);
+            push_dir(tc, job);
+        } else if (S_ISREG(st.st_mode)) {
+            copy_job *job = new_job(src, dst, &st);
+            if (!job) {
+                record_error(tc->stats, src, ENOMEM);
+                continue;
+            }
+            __atomic_add_fetch(&tc->stats->files_total, 1, __ATOMIC_RELAXED);
+            __atomic_add_fetch(&tc->stats->bytes_total, st.st_size, __ATOMIC_RELAXED);
+            push_file(tc, job);
+        } else if (S_ISLNK(st.st_mode)) {
+            copy_symlink(tc, src, dst);
+        } else if (S_ISFIFO(st.st_mode)) {
+            if (mkfifo(dst, st.st_mode & 07777) != 0) {
+                record_error(tc->stats, dst, errno);
+            }
+        }
+        // 장치 파일, 소켓은 복사하지 않는다
+    }
+    closedir(dp);
+}
+
+// 디렉토리 탐색 스레드
+static void *walker_thread(void *arg) {
+    tree_copy *tc = arg;
+
+    pthread_mutex_lock(&tc->lock);
+    while (1) {
+        while (!tc->dirs && tc->dirs_active > 0 && !tc->stats->cancel) {
+            pthread_cond_wait(&tc->dir_cond, &tc->lock);
+        }
+        if (!tc->dirs || tc->stats->cancel) {
+            break; // 남은 디렉토리도 없고 읽는 중인 스레드도 없음 - 탐색 끝
+        }
+        copy_job *dir = tc->dirs;
+        tc->dirs = dir->next;
+        tc->dirs_active++;
+        pthread_mutex_unlock(&tc->lock);
+
+        scan_dir(tc, dir);
+        free_job(dir);
+
+        pthread_mutex_lock(&tc->lock);
+        tc->dirs_active--;
+        if (!tc->dirs && tc->dirs_active == 0) {
+            pthread_cond_broadcast(&tc->dir_cond);
+        }
+    }
+
+    if (--tc->walkers_running == 0) {
+        pthread_cond_broadcast(&tc->file_cond); // 복사 스레드에게 더 이상 작업이 없음을 알림
+        pthread_cond_broadcast(&tc->dir_cond);
+    }
+    pthread_mutex_unlock(&tc->lock);
+    return NULL;
+}
+
+// 파일 복사 스레드
+static void *worker_thread(void *arg) {
+    tree_copy *tc = arg;
+
+    while (1) {
+        pthread_mutex_lock(&tc->lock);
+        while (!tc->files_head && tc->walkers_running > 0) {
+            pthread_cond_wait(&tc->file_cond, &tc->lock);
+        }
+        copy_job *job = tc->files_head;
+        if (!job) {
+            pthread_mutex_unlock(&tc->lock);
+            break;
+        }
+        tc->files_head = job->next;
+        if (!tc->files_head) {
+            tc->files_tail = NULL;
+        }
+        tc->file_count--;
+        pthread_cond_signal(&tc->space_cond);
+        pthread_mutex_unlock(&tc->lock);
+
+        copy_one(tc, job);
+    }
+    return NULL;
+}
+
+// 디렉토리 권한과 시간 정보 복원 (하위 디렉토리부터)
+static void restore_dir_attrs(copy_job *made) {
+    while (made) {
+        copy_job *next = made->next;
+        struct timespec times[2] = { made->st.st_atim, made->st.st_mtim };
+        chmod(made->dst, made->st.st_mode & 07777);
+        utimensat(AT_FDCWD, made->dst, times, 0);
+        free_job(made);
+        made = next;
+    }
+}
+
+int copy_tree(const char *source, const char *destination, tree_copy_stats *stats) {
+    struct stat st;
+    if (stat(source, &st) != 0) {
+        record_error(stats, source, errno);
+        return -1;
+    }
+
+    if (!S_ISDIR(st.st_mode)) {
+        copy_stats cs;
+        memset(&cs, 0, sizeof(cs));
+        cs.shared_done = &stats->bytes_done;
+        cs.shared_cancel = &stats->cancel;
+        __atomic_add_fetch(&stats->files_total, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&stats->bytes_total, st.st_size, __ATOMIC_RELAXED);
+        int result = copy_file_fast(source, destination, &cs);
+        count_result(stats, &cs);
+        if (result != 0) {
+            if (cs.error != ECANCELED) {
+                record_error(stats, source, cs.error);
+            }
+            return -1;
+        }
+        __atomic_add_fetch(&stats->files_done, 1, __ATOMIC_RELAXED);
+        return 0;
+    }
+
+    // 자기 자신의 하위 디렉토리로 복사하면 끝나지 않는다
+    size_t src_len = strlen(source);
+    if (strncmp(destination, source, src_len) == 0 && destination[src_len] == '/') {
+        record_error(stats, destination, EINVAL);
+        return -1;
+    }
+
+    if (mkdir(destination, 0700) != 0) {
+        record_error(stats, destination, errno);
+        return -1;
+    }
+
+    tree_copy tc;
+    memset(&tc, 0, sizeof(tc));
+    pthread_mutex_init(&tc.lock, NULL);
+    pthread_cond_init(&tc.dir_cond, NULL);
+    pthread_cond_init(&tc.file_cond, NULL);
+    pthread_cond_init(&tc.space_cond, NULL);
+    tc.stats = stats;
+    tc.dirs = new_job(source, destination, &st);
+    tc.made_dirs = new_job(source, destination, &st);
+    tc.sync_fd = open(destination, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+    pthread_t walkers[TREECOPY_WALKERS];
+    pthread_t workers[TREECOPY_WORKERS];
+    int walker_count = 0, worker_count = 0;
+
+    // 복사 스레드를 먼저 만든다. 탐색 스레드가 생기기 전에 끝나지 않도록 walkers_running 을 1 로 시작
+    tc.walkers_running = 1;
+    for (int i = 0; i < TREECOPY_WORKERS; i++) {
+        if (pthread_create(&workers[worker_count], NULL, worker_thread, &tc) == 0) {
+            worker_count++;
+        }
+    }
+    // 복사 스레드가 없으면 큐를 비울 스레드가 없으므로 탐색 스레드도 만들지 않고 전부 이 스레드에서 처리
+    tc.inline_copy = worker_count == 0;
+
+    // 모든 탐색 스레드가 만들어질 때까지 잠금을 쥐고 있어야 walkers_running 이 정확하다
+    pthread_mutex_lock(&tc.lock);
+    for (int i = 0; i < TREECOPY_WALKERS && !tc.inline_copy; i++) {
+        if (pthread_create(&walkers[walker_count], NULL, walker_thread, &tc) == 0) {
+            walker_count++;
+        }
+    }
+    if (walker_count > 0) {
+        tc.walkers_running = walker_count;
+    }
+    pthread_mutex_unlock(&tc.lock);
+
+    // 탐색 스레드를 만들 수 없으면 직접 처리
+    if (walker_count == 0) {
+        walker_thread(&tc);
+    }
+    for (int i = 0; i < walker_count; i++) {
+        pthread_join(walkers[i], NULL);
+    }
+    for (int i = 0; i < worker_count; i++) {
+        pthread_join(workers[i], NULL);
+    }
+
+    // 취소된 경우 남은 작업 정리
+    while (tc.dirs) {
+        copy_job *next = tc.dirs->next;
+        free_job(tc.dirs);
+        tc.dirs = next;
+    }
+    while (tc.files_head) {
+        copy_job *next = tc.files_head->next;
+        free_job(tc.files_head);
+        tc.files_head = next;
+    }
+    // 다 복사한 파일은 취소된 경우에도 마무리한다 (디렉토리 권한을 되돌리기 전에)
+    if (tc.pending) {
+        commit_batch(&tc, tc.pending);
+    }
+    if (tc.sync_fd >= 0) {
+        close(tc.sync_fd);
+    }
+    restore_dir_attrs(tc.made_dirs);
+
+    pthread_cond_destroy(&tc.space_cond);
+    pthread_cond_destroy(&tc.file_cond);
+    pthread_cond_destroy(&tc.dir_cond);
+    pthread_mutex_destroy(&tc.lock);
+    return (stats->errors || stats->cancel) ? -1 : 0;
+}
+
+static int remove_entry(const char *path, const struct stat *st, int flag, struct FTW *ftw) {
+    return remove(path);
+}
+
+int remove_tree(const char *path) {
+    struct stat st;
+    if (lstat(path, &st) != 0) {
+        return -1;
+    }
+    if (!S_ISDIR(st.st_mode)) {
+        return unlink(path);
+    }
+    return nftw(path, remove_entry, 64, FTW_DEPTH | FTW_PHYS);
+}
+
+int move_tree(const char *source, const char *destination, tree_copy_stats *stats) {
+    if (rename(source, destination) == 0) {
+        __atomic_add_fetch(&stats->files_total, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&stats->files_done, 1, __ATOMIC_RELAXED);
+        return 0;
+    }
+    if (errno != EXDEV) {
+        record_error(stats, source, errno);
+        return -1;
+    }
+
+    // 다른 파일시스템 - 복사가 모두 성공한 경우에만 원본 삭제
+    if (copy_tree(source, destination, stats) != 0) {
+        return -1;
+    }
+    if (remove_tree(source) != 0) {
+        record_error(stats, source, errno);
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,40 @@
+#ifndef __TREECOPY__
+#define __TREECOPY__
+
+#include "project_macro.h"
+
+#define TREECOPY_WALKERS 2               // 디렉토리를 읽으며 작업을 만드는 스레드 수
+#define TREECOPY_WORKERS 4               // 파일을 복사하는 스레드 수
+#define TREECOPY_QUEUE_LIMIT 256         // 대기 중인 파일 복사 작업의 최대 개수
+#define TREECOPY_SYNC_FILES 256          // 이만큼 복사한 작은 파일을 모아서 한 번에 디스크에 내리고 rename
+#define TREECOPY_SYNC_BYTES (64LL << 20) // 모은 파일 크기 합이 이만큼 되어도 내린다
+
+// 디렉토리 트리 복사/이동 진행 상황
+// 카운터는 작업 스레드가 갱신하고 다른 스레드에서 읽을 수 있다
+typedef struct {
+    volatile long long files_total;  // 지금까지 발견한 파일 수
+    volatile long long files_done;
+    volatile long long bytes_total;  // 지금까지 발견한 파일 크기 합
+    volatile long long bytes_done;
+    volatile long long files_checksummed; // 복사하면서 해시를 계산한 (큰) 파일 수
+    volatile long long files_verified;    // 그 중 원본에 남아 있던 해시와 비교해서 같았던 파일 수
+    volatile int partials_kept;      // 이어 복사하도록 남긴 임시 파일 (.이름.gspart) 수
+    volatile int cancel;             // 1 로 설정하면 중단
+    volatile int errors;
+    int first_error;                 // 첫 번째 실패의 errno
+    char error_path[MAX_DIR_LENGTH]; // 첫 번째로 실패한 경로
+} tree_copy_stats;
+
+// source (파일 또는 디렉토리) 를 destination 으로 복사한다
+// 디렉토리의 작은 파일들은 임시 파일에 복사해 두었다가 TREECOPY_SYNC_FILES 개씩 syncfs 한 번으로 내리고 rename 한다
+// 카운터는 더해지므로 같은 stats 로 여러 번 호출하면 전체 합계가 된다
+// return 0 - 모두 성공, -1 - 하나 이상 실패
+int copy_tree(const char *source, const char *destination, tree_copy_stats *stats);
+
+// rename 으로 옮기고, 파일시스템이 다르면 (EXDEV) 복사 후 원본을 지운다
+int move_tree(const char *source, const char *destination, tree_copy_stats *stats);
+
+// 디렉토리 트리 전체 삭제
+int remove_tree(const char *path);
+
+#endif
@@ -0,0 +1,1011 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "treeindex.h"
+
+#define TINDEX_MAGIC "GSINDEX"  // NUL 포함 8바이트
+#define TINDEX_BUCKETS 16384    // 2 의 거듭제곱
+#define TINDEX_STALE_SLOTS 4096 // 확인에 실패한 디렉토리를 기억하는 자리 (2 의 거듭제곱, 넘치면 덮어쓴다)
+
+// 디렉토리 레코드의 flags
+#define TINDEX_HAS_TOTAL 1      // 하위 트리 합계가 있음
+#define TINDEX_HAS_LISTING 2    // 목록이 있음
+#define TINDEX_STAT_COMPLETE 4  // 목록의 모든 항목에 크기와 시각이 있음
+
+// 파일 형식: 머리 + 디렉토리 레코드 (dev, ino 순) + 목록 항목 + 이름 문자열
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t dir_count;
+    uint64_t entry_count;
+    uint64_t names_size;
+    uint64_t dirs_offset;
+    uint64_t entries_offset;
+    uint64_t names_offset;
+} tindex_header;
+
+typedef struct {
+    uint64_t dev;
+    uint64_t ino;
+    int64_t mtime_sec;
+    uint32_t mtime_nsec;
+    uint32_t flags;
+    int64_t bytes;
+    int64_t files;
+    int64_t dirs;
+    uint64_t entry_first;  // 목록 항목 배열 안의 시작 위치
+    uint64_t names_first;  // 이름 문자열 안의 시작 위치
+    uint32_t entry_count;
+    uint32_t names_size;   // 이 디렉토리의 이름 문자열 바이트 수
+    int64_t seen;          // 마지막으로 넣거나 쓴 시각 (초) - 오래된 레코드부터 버린다
+} tindex_dir;
+
+// 실행 중에 읽은 목록 - 넣은 뒤에는 바꾸지 않고, 새 목록으로 바뀌면 잠금 밖에서 보는 쪽이 없을 때까지 retired 에 둔다
+// (다른 스레드가 tindex_scan_tree 중에 보고 있을 수 있으므로)
+typedef struct listing {
+    uint64_t dev;
+    uint64_t ino;
+    struct timespec mtime;
+    int stat_complete;
+    uint32_t count;
+    uint32_t names_size;
+    tindex_entry *entries;
+    char *names;
+    struct listing *next;
+} listing;
+
+typedef struct total_node {
+    uint64_t dev;
+    uint64_t ino;
+    struct timespec mtime;
+    tindex_total total;
+    struct total_node *next;
+} total_node;
+
+// tindex_scan_tree 가 실패한 경로 위의 디렉토리 (이 mtime 에서 하위 트리가 색인과 다름)
+typedef struct {
+    uint64_t dev;
+    uint64_t ino;
+    struct timespec mtime;
+    int used;
+} stale_mark;
+
+// 목록 하나를 읽는 동안 보는 모습 (파일이든 메모리든 같은 형태)
+typedef struct {
+    const tindex_entry *entries;
+    uint32_t count;
+    const char *names;
+    uint32_t names_size;
+    int stat_complete;
+} listing_view;
+
+static pthread_mutex_t index_lock = PTHREAD_MUTEX_INITIALIZER;
+static int enabled = 0;
+static char index_file[4096];
+static int dirty = 0;                     // index_lock - 저장하지 않은 변경이 있음
+
+static void *map = NULL;                  // 파일 전체 (읽기 전용, 닫을 때까지 바꾸지 않음)
+static size_t map_size = 0;
+static const tindex_header *header = NULL;
+static const tindex_dir *disk_dirs = NULL;
+static const tindex_entry *disk_entries = NULL;
+static const char *disk_names = NULL;
+static unsigned char *disk_touched = NULL; // 이번 실행에서 쓴 파일 레코드 (저장할 때 seen 을 갱신)
+
+static listing *listings[TINDEX_BUCKETS]; // index_lock
+static listing *retired = NULL;
+static long long retired_entries = 0;   // retired 목록의 항목 수 (해제할 때까지 TINDEX_MAX_ENTRIES 에 포함)
+static int readers = 0;                 // 목록을 잠금 밖에서 보는 중인 scan, save 수
+static total_node *totals[TINDEX_BUCKETS];
+static long long overlay_entries = 0;
+static stale_mark stale_marks[TINDEX_STALE_SLOTS]; // index_lock
+
+static unsigned int bucket_of(uint64_t dev, uint64_t ino) {
+    unsigned long long h = ino * 0x9E3779B97F4A7C15ULL ^ dev;
+    return (unsigned int)(h >> 32) & (TINDEX_BUCKETS - 1);
+}
+
+static int same_time(const struct timespec *t, int64_t sec, uint32_t nsec) {
+    return t->tv_sec == sec && t->tv_nsec == (long)nsec;
+}
+
+static int compare_time(const struct timespec *a, const struct timespec *b) {
+    if (a->tv_sec != b->tv_sec) {
+        return a->tv_sec < b->tv_sec ? -1 : 1;
+    }
+    return a->tv_nsec < b->tv_nsec ? -1 : a->tv_nsec > b->tv_nsec;
+}
+
+// 파일의 디렉토리 레코드 (이진 탐색)
+static const tindex_dir *disk_find(uint64_t dev, uint64_t ino) {
+    if (!header) {
+        return NULL;
+    }
+    size_t lo = 0, hi = header->dir_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        const tindex_dir *d = &disk_dirs[mid];
+        if (d->dev == dev && d->ino == ino) {
+            return d;
+        }
+        if (d->dev < dev || (d->dev == dev && d->ino < ino)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return NULL;
+}
+
+static void disk_touch(const tindex_dir *d) {
+    if (disk_touched) {
+        __atomic_store_n(&disk_touched[d - disk_dirs], 1, __ATOMIC_RELAXED);
+    }
+}
+
+// 범위를 벗어난 레코드는 없는 것으로 본다. return 0 - 목록 있음
+static int disk_view(const tindex_dir *d, listing_view *v) {
+    if (!(d->flags & TINDEX_HAS_LISTING) || d->entry_first > header->entry_count ||
+        d->entry_count > header->entry_count - d->entry_first || d->names_first > header->names_size ||
+        d->names_size > header->names_size - d->names_first) {
+        return -1;
+    }
+    v->entries = disk_entries + d->entry_first;
+    v->count = d->entry_count;
+    v->names = disk_names + d->names_first;
+    v->names_size = d->names_size;
+    v->stat_complete = (d->flags & TINDEX_STAT_COMPLETE) != 0;
+    return v->names_size == 0 || v->names[v->names_size - 1] == '\0' ? 0 : -1;
+}
+
+// 호출 전에 index_lock
+static listing *overlay_find(uint64_t dev, uint64_t ino) {
+    for (listing *l = listings[bucket_of(dev, ino)]; l; l = l->next) {
+        if (l->dev == dev && l->ino == ino) {
+            return l;
+        }
+    }
+    return NULL;
+}
+
+static total_node *total_find(uint64_t dev, uint64_t ino) {
+    for (total_node *t = totals[bucket_of(dev, ino)]; t; t = t->next) {
+        if (t->dev == dev && t->ino == ino) {
+            return t;
+        }
+    }
+    return NULL;
+}
+
+// mtime 이 같은 목록. return 0 - 있음
+static int find_listing(uint64_t dev, uint64_t ino, const struct timespec *mtime, listing_view *v) {
+    pthread_mutex_lock(&index_lock);
+    listing *l = overlay_find(dev, ino);
+    if (l && same_time(mtime, l->mtime.tv_sec, l->mtime.tv_nsec)) {
+        v->entries = l->entries;
+        v->count = l->count;
+        v->names = l->names;
+        v->names_size = l->names_size;
+        v->stat_complete = l->stat_complete;
+        pthread_mutex_unlock(&index_lock);
+        return 0;
+    }
+    pthread_mutex_unlock(&index_lock);
+    const tindex_dir *d = disk_find(dev, ino);
+    if (d && same_time(mtime, d->mtime_sec, d->mtime_nsec) && disk_view(d, v) == 0) {
+        disk_touch(d);
+        return 0;
+    }
+    return -1;
+}
+
+static void free_listing(listing *l) {
+    if (l) {
+        free(l->entries);
+        free(l->names);
+        free(l);
+    }
+}
+
+// 목록을 잠금 밖에서 보기 시작한다 (호출 전에 index_lock). 보는 동안에는 retired 목록을 해제하지 않는다
+static void reader_begin_locked(void) {
+    readers++;
+}
+
+// 마지막으로 보던 쪽이 끝나면 그 사이 바뀐 목록을 해제한다
+static void reader_end(void) {
+    pthread_mutex_lock(&index_lock);
+    listing *l = NULL;
+    if (--readers == 0) {
+        l = retired;
+        retired = NULL;
+        retired_entries = 0;
+    }
+    pthread_mutex_unlock(&index_lock);
+    while (l) {
+        listing *next = l->next;
+        free_listing(l);
+        l = next;
+    }
+}
+
+// 새 목록을 넣는다 (l 의 주인이 바뀐다). 같은 mtime 의 같거나 나은 목록이 이미 있으면 버린다
+// 바뀐 목록은 보는 쪽이 없으면 바로, 있으면 끝난 뒤에 해제한다
+static void put_listing(listing *l) {
+    pthread_mutex_lock(&index_lock);
+    listing *old = overlay_find(l->dev, l->ino);
+    const tindex_dir *d = old ? NULL : disk_find(l->dev, l->ino);
+    int known = 0;
+    if (old && same_time(&l->mtime, old->mtime.tv_sec, old->mtime.tv_nsec)) {
+        known = old->stat_complete || !l->stat_complete;
+    } else if (d && same_time(&l->mtime, d->mtime_sec, d->mtime_nsec) && (d->flags & TINDEX_HAS_LISTING)) {
+        known = (d->flags & TINDEX_STAT_COMPLETE) || !l->stat_complete;
+        if (known) {
+            disk_touch(d);
+        }
+    }
+    if (known || overlay_entries + retired_entries + l->count > TINDEX_MAX_ENTRIES) {
+        pthread_mutex_unlock(&index_lock);
+        free_listing(l);
+        return;
+    }
+    listing **head = &listings[bucket_of(l->dev, l->ino)];
+    if (old) {
+        for (listing **p = head; *p; p = &(*p)->next) {
+            if (*p == old) {
+                *p = old->next;
+                break;
+            }
+        }
+        overlay_entries -= old->count;
+        if (readers > 0) {
+            old->next = retired;
+            retired = old;
+            retired_entries += old->count;
+            old = NULL;
+        }
+    }
+    l->next = *head;
+    *head = l;
+    overlay_entries += l->count;
+    dirty = 1;
+    pthread_mutex_unlock(&index_lock);
+    free_listing(old);
+}
+
+int tindex_enabled(void) {
+    return __atomic_load_n(&enabled, __ATOMIC_ACQUIRE);
+}
+
+int tindex_default_file(char *buf, size_t size) {
+    const char *cache = getenv("XDG_CACHE_HOME");
+    const char *home = getenv("HOME");
+    char dir[4096];
+    if (cache && cache[0] == '/') {
+        snprintf(dir, sizeof(dir), "%s", cache);
+    } else if (home && home[0]) {
+        snprintf(dir, sizeof(dir), "%s/.cache", home);
+    } else {
+        return -1;
+    }
+    if (mkdir(dir, 0700) != 0 && errno != EEXIST) {
+        return -1;
+    }
+    size_t len = strlen(dir);
+    snprintf(dir + len, sizeof(dir) - len, "/guiShell");
+    if (mkdir(dir, 0700) != 0 && errno != EEXIST) {
+        return -1;
+    }
+    int n = snprintf(buf, size, "%s/index.bin", dir);
+    return n >= 0 && (size_t)n < size ? 0 : -1;
+}
+
+int tindex_open(const char *file) {
+    tindex_close();
+    if (strlen(file) >= sizeof(index_file)) {
+        return -1;
+    }
+    snprintf(index_file, sizeof(index_file), "%s", file);
+
+    int fd = open(file, O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (fd >= 0 && fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(tindex_header)) {
+        void *p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            const tindex_header *h = p;
+            uint64_t size = st.st_size;
+            // 범위가 파일 안에 있는지만 확인하고, 레코드는 찾을 때 하나씩 확인한다
+            int ok = memcmp(h->magic, TINDEX_MAGIC, 8) == 0 && h->version == TINDEX_VERSION &&
+                     h->header_size == sizeof(tindex_header) && h->dirs_offset % 8 == 0 && h->entries_offset % 8 == 0 &&
+                     h->dirs_offset <= size && h->dir_count <= (size - h->dirs_offset) / sizeof(tindex_dir) &&
+                     h->entries_offset <= size && h->entry_count <= (size - h->entries_offset) / sizeof(tindex_entry) &&
+                     h->names_offset <= size && h->names_size <= size - h->names_offset;
+            if (ok) {
+                map = p;
+                map_size = st.st_size;
+                header = h;
+                disk_dirs = (const tindex_dir *)((const char *)p + h->dirs_offset);
+                disk_entries = (const tindex_entry *)((const char *)p + h->entries_offset);
+                disk_names = (const char *)p + h->names_offset;
+                disk_touched = calloc(h->dir_count ? h->dir_count : 1, 1);
+                madvise(p, st.st_size, MADV_RANDOM); // 찾는 레코드 근처만 읽는다
+            } else {
+                munmap(p, st.st_size);
+            }
+        }
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+    __atomic_store_n(&enabled, 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+void tindex_close(void) {
+    __atomic_store_n(&enabled, 0, __ATOMIC_RELEASE);
+    pthread_mutex_lock(&index_lock);
+    if (map) {
+        munmap(map, map_size);
+    }
+    map = NULL;
+    map_size = 0;
+    header = NULL;
+    disk_dirs = NULL;
+    disk_entries = NULL;
+    disk_names = NULL;
+    free(disk_touched);
+    disk_touched = NULL;
+    memset(stale_marks, 0, sizeof(stale_marks));
+    for (int b = 0; b < TINDEX_BUCKETS; b++) {
+        while (listings[b]) {
+            listing *l = listings[b];
+            listings[b] = l->next;
+            free_listing(l);
+        }
+        while (totals[b]) {
+            total_node *t = totals[b];
+            totals[b] = t->next;
+            free(t);
+        }
+    }
+    while (retired) {
+        listing *l = retired;
+        retired = l->next;
+        free_listing(l);
+    }
+    retired_entries = 0;
+    overlay_entries = 0;
+    dirty = 0;
+    pthread_mutex_unlock(&index_lock);
+}
+
+int tindex_get_total(dev_t dev, ino_t ino, const struct timespec *mtime, tindex_total *out) {
+    if (!tindex_enabled()) {
+        return -1;
+    }
+    pthread_mutex_lock(&index_lock);
+    total_node *t = total_find(dev, ino);
+    if (t && same_time(mtime, t->mtime.tv_sec, t->mtime.tv_nsec)) {
+        *out = t->total;
+        pthread_mutex_unlock(&index_lock);
+        return 0;
+    }
+    pthread_mutex_unlock(&index_lock);
+    const tindex_dir *d = disk_find(dev, ino);
+    if (d && (d->flags & TINDEX_HAS_TOTAL) && same_time(mtime, d->mtime_sec, d->mtime_nsec)) {
+        disk_touch(d);
+        out->bytes = d->bytes;
+        out->files = d->files;
+        out->dirs = d->dirs;
+        return 0;
+    }
+    return -1;
+}
+
+void tindex_put_total(dev_t dev, ino_t ino, const struct timespec *mtime, const tindex_total *total) {
+    if (!tindex_enabled()) {
+        return;
+    }
+    const tindex_dir *d = disk_find(dev, ino);
+    if (d && (d->flags & TINDEX_HAS_TOTAL) && same_time(mtime, d->mtime_sec, d->mtime_nsec) &&
+        d->bytes == total->bytes && d->files == total->files && d->dirs == total->dirs) {
+        disk_touch(d);
+        return; // 파일에 있는 그대로
+    }
+    pthread_mutex_lock(&index_lock);
+    total_node *t = total_find(dev, ino);
+    if (!t && (t = malloc(sizeof(total_node)))) {
+        unsigned int b = bucket_of(dev, ino);
+        t->dev = dev;
+        t->ino = ino;
+        t->mtime.tv_sec = -1;
+        t->next = totals[b];
+        totals[b] = t;
+    }
+    if (t && (compare_time(&t->mtime, mtime) != 0 || memcmp(&t->total, total, sizeof(*total)) != 0)) {
+        t->mtime = *mtime;
+        t->total = *total;
+        dirty = 1;
+    }
+    pthread_mutex_unlock(&index_lock);
+}
+
+// ---- 트리 확인 ----
+
+typedef struct {
+    listing_view view;
+    size_t path_off;  // 경로 아레나 안의 위치
+    int parent;       // 이 디렉토리를 찾은 디렉토리 (시작 디렉토리는 -1)
+    uint64_t dev;
+    uint64_t ino;
+    struct timespec mtime;
+} scan_dir;
+
+typedef struct {
+    scan_dir *dirs;
+    int count;
+    int capacity;
+    char *paths;
+    size_t paths_used;
+    size_t paths_capacity;
+} scan_state;
+
+static int scan_add(scan_state *s, const listing_view *v, const char *path, int parent, uint64_t dev, uint64_t ino,
+                    const struct timespec *mtime) {
+    size_t len = strlen(path) + 1;
+    if (s->count == s->capacity) {
+        int new_capacity = s->capacity ? s->capacity * 2 : 64;
+        scan_dir *p = realloc(s->dirs, new_capacity * sizeof(scan_dir));
+        if (!p) {
+            return -1;
+        }
+        s->dirs = p;
+        s->capacity = new_capacity;
+    }
+    if (s->paths_used + len > s->paths_capacity) {
+        size_t new_capacity = s->paths_capacity ? s->paths_capacity * 2 : 16384;
+        while (new_capacity < s->paths_used + len) {
+            new_capacity *= 2;
+        }
+        char *p = realloc(s->paths, new_capacity);
+        if (!p) {
+            return -1;
+        }
+        s->paths = p;
+        s->paths_capacity = new_capacity;
+    }
+    memcpy(s->paths + s->paths_used, path, len);
+    scan_dir *d = &s->dirs[s->count++];
+    d->view = *v;
+    d->path_off = s->paths_used;
+    d->parent = parent;
+    d->dev = dev;
+    d->ino = ino;
+    d->mtime = *mtime;
+    s->paths_used += len;
+    return 0;
+}
+
+static int join_path(char *buf, size_t size, const char *dir, const char *name) {
+    size_t len = strlen(dir);
+    const char *sep = len > 0 && dir[len - 1] == '/' ? "" : "/";
+    int n = snprintf(buf, size, "%s%s%s", dir, sep, name);
+    return n >= 0 && (size_t)n < size ? 0 : -1;
+}
+
+static stale_mark *stale_slot(uint64_t dev, uint64_t ino) {
+    return &stale_marks[bucket_of(dev, ino) & (TINDEX_STALE_SLOTS - 1)];
+}
+
+// s->dirs[i] 부터 시작 디렉토리까지 - 모두 하위 트리가 색인과 다르다
+static void stale_mark_chain(const scan_state *s, int i) {
+    pthread_mutex_lock(&index_lock);
+    for (; i > 0; i = s->dirs[i].parent) { // 시작 디렉토리는 이미 들어가는 중이라 기억할 필요가 없다
+        stale_mark *m = stale_slot(s->dirs[i].dev, s->dirs[i].ino);
+        m->dev = s->dirs[i].dev;
+        m->ino = s->dirs[i].ino;
+        m->mtime = s->dirs[i].mtime;
+        m->used = 1;
+    }
+    pthread_mutex_unlock(&index_lock);
+}
+
+// 기억해 둔 실패가 있으면 지우고 1 - 순회는 디렉토리마다 한 번만 들어가므로 한 번 쓰면 필요 없다
+static int stale_mark_take(uint64_t dev, uint64_t ino, const struct timespec *mtime) {
+    pthread_mutex_lock(&index_lock);
+    stale_mark *m = stale_slot(dev, ino);
+    int hit = m->used && m->dev == dev && m->ino == ino && compare_time(&m->mtime, mtime) == 0;
+    if (hit) {
+        m->used = 0;
+    }
+    pthread_mutex_unlock(&index_lock);
+    return hit;
+}
+
+int tindex_scan_tree(const char *path, dev_t dev, ino_t ino, const struct timespec *mtime,
+                     tindex_visit_fn visit, void *ctx) {
+    if (!tindex_enabled() || stale_mark_take(dev, ino, mtime)) {
+        return -1;
+    }
+    pthread_mutex_lock(&index_lock);
+    reader_begin_locked(); // 찾은 목록을 잠금 밖에서 본다
+    pthread_mutex_unlock(&index_lock);
+    scan_state s;
+    memset(&s, 0, sizeof(s));
+    listing_view v;
+    int rc = -1;
+    int stale_at = -1; // 하위 트리가 색인과 다른 것으로 확인된 디렉토리
+    if (find_listing(dev, ino, mtime, &v) != 0 || scan_add(&s, &v, path, -1, dev, ino, mtime) < 0) {
+        goto done;
+    }
+    // 하위 디렉토리마다 lstat 한 번 - 목록을 읽는 것보다 훨씬 싸다
+    for (int i = 0; i < s.count; i++) {
+        char dir[4096];
+        snprintf(dir, sizeof(dir), "%s", s.paths + s.dirs[i].path_off);
+        listing_view cur = s.dirs[i].view;
+        for (uint32_t k = 0; k < cur.count; k++) {
+            const tindex_entry *e = &cur.entries[k];
+            if (e->name_off >= cur.names_size) {
+                stale_at = i;
+                goto done;
+            }
+            if (!S_ISDIR(e->mode)) {
+                continue;
+            }
+            char child[4096];
+            struct stat st;
+            if (join_path(child, sizeof(child), dir, cur.names + e->name_off) < 0 || lstat(child, &st) != 0 ||
+                !S_ISDIR(st.st_mode)) {
+                stale_at = i;
+                goto done;
+            }
+            if (st.st_dev != dev) { // 다른 파일 시스템은 순회하지 않는다
+                continue;
+            }
+            if (find_listing(st.st_dev, st.st_ino, &st.st_mtim, &v) != 0) {
+                stale_at = i;
+                goto done;
+            }
+            if (scan_add(&s, &v, child, i, st.st_dev, st.st_ino, &st.st_mtim) < 0) {
+                goto done;
+            }
+        }
+    }
+    if (visit) {
+        for (int i = 0; i < s.count; i++) {
+            const listing_view *cur = &s.dirs[i].view;
+            for (uint32_t k = 0; k < cur->count; k++) {
+                visit(ctx, s.paths + s.dirs[i].path_off, cur->names + cur->entries[k].name_off, &cur->entries[k]);
+            }
+        }
+    }
+    rc = 0;
+done:
+    if (stale_at >= 0) {
+        stale_mark_chain(&s, stale_at);
+    }
+    free(s.dirs);
+    free(s.paths);
+    reader_end();
+    return rc;
+}
+
+// ---- walker 에서 목록 모으기 ----
+
+typedef struct {
+    const walk_node *node;  // 모으는 중인 디렉토리
+    int stat_complete;
+    int failed;             // 메모리 부족 - 이 목록은 넣지 않는다
+    tindex_entry *entries;
+    uint32_t count;
+    uint32_t capacity;
+    char *names;
+    size_t names_used;
+    size_t names_capacity;
+} builder;
+
+static pthread_key_t builder_key;
+static pthread_once_t builder_once = PTHREAD_ONCE_INIT;
+
+static void builder_free(void *p) {
+    builder *b = p;
+    free(b->entries);
+    free(b->names);
+    free(b);
+}
+
+static void builder_key_init(void) {
+    pthread_key_create(&builder_key, builder_free); // 작업 스레드가 끝날 때 해제
+}
+
+static builder *get_builder(void) {
+    pthread_once(&builder_once, builder_key_init);
+    builder *b = pthread_getspecific(builder_key);
+    if (!b && (b = calloc(1, sizeof(builder)))) {
+        pthread_setspecific(builder_key, b);
+    }
+    return b;
+}
+
+static void builder_reset(builder *b, const walk_node *node) {
+    b->node = node;
+    b->stat_complete = 1;
+    b->failed = 0;
+    b->count = 0;
+    b->names_used = 0;
+}
+
+void tindex_walk_visit(const walk_node *parent, const char *name, const struct stat *st, int has_stat) {
+    if (!tindex_enabled()) {
+        return;
+    }
+    builder *b = get_builder();
+    if (!b) {
+        return;
+    }
+    if (b->node != parent) {
+        builder_reset(b, parent);
+    }
+    if (b->failed) {
+        return;
+    }
+    size_t len = strlen(name) + 1;
+    if (b->count == b->capacity) {
+        uint32_t new_capacity = b->capacity ? b->capacity * 2 : 256;
+        tindex_entry *p = realloc(b->entries, new_capacity * sizeof(tindex_entry));
+        if (!p) {
+            b->failed = 1;
+            return;
+        }
+        b->entries = p;
+        b->capacity = new_capacity;
+    }
+    if (b->names_used + len > b->names_capacity) {
+        size_t new_capacity = b->names_capacity ? b->names_capacity * 2 : 8192;
+        while (new_capacity < b->names_used + len) {
+            new_capacity *= 2;
+        }
+        char *p = new_capacity <= UINT32_MAX ? realloc(b->names, new_capacity) : NULL;
+        if (!p) {
+            b->failed = 1;
+            return;
+        }
+        b->names = p;
+        b->names_capacity = new_capacity;
+    }
+    tindex_entry *e = &b->entries[b->count++];
+    e->ino = st->st_ino;
+    e->mode = st->st_mode;
+    e->size = has_stat ? (int64_t)st->st_size : -1;
+    e->mtime_sec = has_stat ? (int64_t)st->st_mtime : 0;
+    e->name_off = (uint32_t)b->names_used;
+    memcpy(b->names + b->names_used, name, len);
+    b->names_used += len;
+    if (!has_stat) {
+        b->stat_complete = 0;
+    }
+}
+
+void tindex_walk_listed(const walk_node *node, int complete) {
+    if (!tindex_enabled()) {
+        return;
+    }
+    builder *b = get_builder();
+    if (!b) {
+        return;
+    }
+    if (b->node != node) { // 빈 디렉토리
+        builder_reset(b, node);
+    }
+    if (complete && !b->failed) {
+        listing *l = calloc(1, sizeof(listing));
+        if (l) {
+            l->dev = node->dev;
+            l->ino = node->ino;
+            l->mtime = node->mtime;
+            l->stat_complete = b->stat_complete;
+            l->count = b->count;
+            l->names_size = (uint32_t)b->names_used;
+            l->entries = malloc((b->count ? b->count : 1) * sizeof(tindex_entry));
+            l->names = malloc(b->names_used ? b->names_used : 1);
+            if (l->entries && l->names) {
+                memcpy(l->entries, b->entries, b->count * sizeof(tindex_entry));
+                memcpy(l->names, b->names, b->names_used);
+                put_listing(l);
+            } else {
+                free_listing(l);
+            }
+        }
+    }
+    b->node = NULL;
+}
+
+// ---- 저장 ----
+
+typedef struct {
+    uint64_t dev;
+    uint64_t ino;
+    const tindex_dir *disk;
+    int touched;           // 이번 실행에서 파일 레코드를 씀
+    const listing *list;
+    int has_total;
+    struct timespec total_mtime;
+    tindex_total total;
+} merge_item;
+
+static int compare_item(const void *a, const void *b) {
+    const merge_item *x = a, *y = b;
+    if (x->dev != y->dev) {
+        return x->dev < y->dev ? -1 : 1;
+    }
+    return x->ino < y->ino ? -1 : x->ino > y->ino;
+}
+
+// 새 파일에 쓸 디렉토리 하나
+typedef struct {
+    tindex_dir d;
+    listing_view v;
+} save_dir;
+
+static int compare_save_key(const void *a, const void *b) {
+    const tindex_dir *x = &((const save_dir *)a)->d, *y = &((const save_dir *)b)->d;
+    if (x->dev != y->dev) {
+        return x->dev < y->dev ? -1 : 1;
+    }
+    return x->ino < y->ino ? -1 : x->ino > y->ino;
+}
+
+// 최근에 쓴 것부터
+static int compare_save_seen(const void *a, const void *b) {
+    const tindex_dir *x = &((const save_dir *)a)->d, *y = &((const save_dir *)b)->d;
+    return x->seen > y->seen ? -1 : x->seen < y->seen;
+}
+
+static int write_all(FILE *fp, const void *data, size_t size) {
+    return size == 0 || fwrite(data, 1, size, fp) == size ? 0 : -1;
+}
+
+int tindex_save(void) {
+    if (!tindex_enabled()) {
+        return 0;
+    }
+    // 파일의 레코드와 메모리의 목록/합계를 모은다 (reader_end 까지 목록이 해제되지 않으므로 잠금 밖에서 써도 된다)
+    pthread_mutex_lock(&index_lock);
+    if (!dirty) {
+        pthread_mutex_unlock(&index_lock);
+        return 0;
+    }
+    size_t capacity = header ? header->dir_count : 0;
+    for (int b = 0; b < TINDEX_BUCKETS; b++) {
+        for (listing *l = listings[b]; l; l = l->next) {
+            capacity++;
+        }
+        for (total_node *t = totals[b]; t; t = t->next) {
+            capacity++;
+        }
+    }
+    merge_item *items = malloc((capacity ? capacity : 1) * sizeof(merge_item));
+    if (!items) {
+        pthread_mutex_unlock(&index_lock);
+        return -1;
+    }
+    size_t count = 0;
+    for (size_t i = 0; header && i < header->dir_count; i++) {
+        merge_item *m = &items[count++];
+        memset(m, 0, sizeof(*m));
+        m->dev = disk_dirs[i].dev;
+        m->ino = disk_dirs[i].ino;
+        m->disk = &disk_dirs[i];
+        m->touched = disk_touched && __atomic_load_n(&disk_touched[i], __ATOMIC_RELAXED);
+    }
+    for (int b = 0; b < TINDEX_BUCKETS; b++) {
+        for (listing *l = listings[b]; l; l = l->next) {
+            merge_item *m = &items[count++];
+            memset(m, 0, sizeof(*m));
+            m->dev = l->dev;
+            m->ino = l->ino;
+            m->list = l;
+        }
+        for (total_node *t = totals[b]; t; t = t->next) {
+            merge_item *m = &items[count++];
+            memset(m, 0, sizeof(*m));
+            m->dev = t->dev;
+            m->ino = t->ino;
+            m->has_total = 1;
+            m->total_mtime = t->mtime;
+            m->total = t->total;
+        }
+    }
+    dirty = 0;
+    reader_begin_locked();
+    pthread_mutex_unlock(&index_lock);
+
+    // 같은 디렉토리끼리 합친다
+    qsort(items, count, sizeof(merge_item), compare_item);
+    size_t merged = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (merged > 0 && compare_item(&items[merged - 1], &items[i]) == 0) {
+            merge_item *m = &items[merged - 1];
+            m->disk = m->disk ? m->disk : items[i].disk;
+            m->touched |= items[i].touched;
+            m->list = m->list ? m->list : items[i].list;
+            if (items[i].has_total) {
+                m->has_total = 1;
+                m->total_mtime = items[i].total_mtime;
+                m->total = items[i].total;
+            }
+        } else {
+            items[merged++] = items[i];
+        }
+    }
+
+    // 가장 새로운 mtime 의 목록과 합계만 남긴다. 오래 쓰지 않은 레코드는 버린다
+    int64_t now = (int64_t)time(NULL);
+    int64_t oldest = now - (int64_t)TINDEX_MAX_AGE_DAYS * 24 * 3600;
+    save_dir *out = malloc((merged ? merged : 1) * sizeof(save_dir));
+    if (!out) {
+        free(items);
+        reader_end();
+        return -1;
+    }
+    size_t dir_count = 0;
+    uint64_t entry_count = 0, names_size = 0;
+    for (size_t i = 0; i < merged; i++) {
+        merge_item *m = &items[i];
+        struct timespec newest = { -1, 0 };
+        struct timespec disk_mtime = { 0, 0 };
+        if (m->disk) {
+            disk_mtime.tv_sec = m->disk->mtime_sec;
+            disk_mtime.tv_nsec = m->disk->mtime_nsec;
+            newest = disk_mtime;
+        }
+        if (m->list && compare_time(&m->list->mtime, &newest) > 0) {
+            newest = m->list->mtime;
+        }
+        if (m->has_total && compare_time(&m->total_mtime, &newest) > 0) {
+            newest = m->total_mtime;
+        }
+
+        tindex_dir *d = &out[dir_count].d;
+        memset(d, 0, sizeof(*d));
+        d->dev = m->dev;
+        d->ino = m->ino;
+        d->mtime_sec = newest.tv_sec;
+        d->mtime_nsec = (uint32_t)newest.tv_nsec;
+        d->seen = m->list || m->has_total || m->touched || !m->disk ? now : m->disk->seen;
+        listing_view *v = &out[dir_count].v;
+        int has_view = 0;
+        if (m->list && compare_time(&m->list->mtime, &newest) == 0) {
+            v->entries = m->list->entries;
+            v->count = m->list->count;
+            v->names = m->list->names;
+            v->names_size = m->list->names_size;
+            v->stat_complete = m->list->stat_complete;
+            has_view = 1;
+        } else if (m->disk && compare_time(&disk_mtime, &newest) == 0) {
+            has_view = disk_view(m->disk, v) == 0;
+        }
+        if (has_view) {
+            d->flags |= TINDEX_HAS_LISTING | (v->stat_complete ? TINDEX_STAT_COMPLETE : 0);
+            d->entry_count = v->count;
+            d->names_size = v->names_size;
+        }
+        if (m->has_total && compare_time(&m->total_mtime, &newest) == 0) {
+            d->flags |= TINDEX_HAS_TOTAL;
+            d->bytes = m->total.bytes;
+            d->files = m->total.files;
+            d->dirs = m->total.dirs;
+        } else if (m->disk && (m->disk->flags & TINDEX_HAS_TOTAL) && compare_time(&disk_mtime, &newest) == 0) {
+            d->flags |= TINDEX_HAS_TOTAL;
+            d->bytes = m->disk->bytes;
+            d->files = m->disk->files;
+            d->dirs = m->disk->dirs;
+        }
+        if (d->flags && d->seen >= oldest) {
+            entry_count += d->entry_count;
+            dir_count++;
+        }
+    }
+    free(items);
+
+    // 상한을 넘으면 최근에 쓴 레코드부터 채우고 나머지는 버린다 (목록만 넘치면 합계는 남긴다)
+    if (dir_count > TINDEX_MAX_DIRS || entry_count > TINDEX_MAX_ENTRIES) {
+        qsort(out, dir_count, sizeof(save_dir), compare_save_seen);
+        size_t kept = 0;
+        entry_count = 0;
+        for (size_t i = 0; i < dir_count && kept < TINDEX_MAX_DIRS; i++) {
+            tindex_dir *d = &out[i].d;
+            if ((d->flags & TINDEX_HAS_LISTING) && entry_count + d->entry_count > TINDEX_MAX_ENTRIES) {
+                d->flags &= ~(TINDEX_HAS_LISTING | TINDEX_STAT_COMPLETE);
+            }
+            if (d->flags & TINDEX_HAS_LISTING) {
+                entry_count += d->entry_count;
+            }
+            if (d->flags) {
+                out[kept++] = out[i];
+            }
+        }
+        dir_count = kept;
+        qsort(out, dir_count, sizeof(save_dir), compare_save_key);
+    }
+    entry_count = 0;
+    for (size_t i = 0; i < dir_count; i++) {
+        tindex_dir *d = &out[i].d;
+        if (!(d->flags & TINDEX_HAS_LISTING)) {
+            d->entry_count = 0;
+            d->names_size = 0;
+            continue;
+        }
+        d->entry_first = entry_count;
+        d->names_first = names_size;
+        entry_count += d->entry_count;
+        names_size += d->names_size;
+    }
+
+    tindex_header h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, TINDEX_MAGIC, 8);
+    h.version = TINDEX_VERSION;
+    h.header_size = sizeof(h);
+    h.dir_count = dir_count;
+    h.entry_count = entry_count;
+    h.names_size = names_size;
+    h.dirs_offset = sizeof(h);
+    h.entries_offset = h.dirs_offset + dir_count * sizeof(tindex_dir);
+    h.names_offset = h.entries_offset + entry_count * sizeof(tindex_entry);
+
+    // 임시 파일에 다 쓴 뒤 바꾼다 - 중간에 끝나도 이전 색인은 그대로
+    char tmp[sizeof(index_file) + 32];
+    snprintf(tmp, sizeof(tmp), "%s.%d.tmp", index_file, (int)getpid());
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    FILE *fp = fd >= 0 ? fdopen(fd, "wb") : NULL;
+    int rc = fp ? 0 : -1;
+    if (!fp && fd >= 0) {
+        close(fd);
+    }
+    if (rc == 0) {
+        rc = write_all(fp, &h, sizeof(h));
+    }
+    for (size_t i = 0; rc == 0 && i < dir_count; i++) {
+        rc = write_all(fp, &out[i].d, sizeof(tindex_dir));
+    }
+    for (size_t i = 0; rc == 0 && i < dir_count; i++) {
+        if (out[i].d.flags & TINDEX_HAS_LISTING) {
+            rc = write_all(fp, out[i].v.entries, out[i].v.count * sizeof(tindex_entry));
+        }
+    }
+    for (size_t i = 0; rc == 0 && i < dir_count; i++) {
+        if (out[i].d.flags & TINDEX_HAS_LISTING) {
+            rc = write_all(fp, out[i].v.names, out[i].v.names_size);
+        }
+    }
+    free(out);
+    reader_end();
+    if (fp) {
+        if (fflush(fp) != 0 || fsync(fileno(fp)) != 0) {
+            rc = -1;
+        }
+        if (fclose(fp) != 0) {
+            rc = -1;
+        }
+    }
+    if (rc == 0 && rename(tmp, index_file) != 0) {
+        rc = -1;
+    }
+    if (rc != 0) {
+        unlink(tmp);
+        pthread_mutex_lock(&index_lock);
+        dirty = 1; // 다음에 다시 시도
+        pthread_mutex_unlock(&index_lock);
+    }
+    return rc;
+}
@@ -0,0 +1,75 @@
+#ifndef __TREEINDEX__
+#define __TREEINDEX__
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "walker.h"
+
+#define TINDEX_VERSION 2
+#define TINDEX_MAX_DIRS (1024 * 1024)        // 저장하는 디렉토리 수 상한
+#define TINDEX_MAX_ENTRIES (8 * 1024 * 1024) // 저장하는 목록 항목 수 합계 상한
+#define TINDEX_MAX_AGE_DAYS 90               // 이 기간 동안 쓰지 않은 레코드는 저장할 때 버린다
+
+// 실행 사이에 유지하는 디렉토리 트리 색인 (~/.cache/guiShell/index.bin)
+// 파일은 (dev, ino) 순으로 정렬한 디렉토리 레코드, 목록 항목, 이름 문자열을 이어 붙인 형식이라
+// 시작할 때 mmap 만 하고 찾을 때 이진 탐색으로 필요한 페이지만 읽는다
+// 실행 중에 순회하면서 본 목록과 하위 트리 합계는 메모리에 따로 두고 (한 번 넣은 목록은 바꾸지 않음)
+// 저장할 때 파일의 레코드와 합쳐서 새 파일을 만든 뒤 rename 으로 바꾼다
+// 레코드마다 마지막으로 쓴 시각을 두고, 오래된 것과 상한을 넘는 것은 저장할 때 오래된 순으로 버린다
+// 모든 레코드는 디렉토리의 mtime 이 같을 때만 쓴다 (파일 내용만 바뀐 경우는 알 수 없음)
+
+// 목록 항목 하나 (파일 형식 그대로)
+typedef struct {
+    uint64_t ino;
+    int64_t size;        // -1 - stat 하지 않은 항목 (이름과 종류만)
+    int64_t mtime_sec;
+    uint32_t mode;       // 파일 종류는 항상 있음
+    uint32_t name_off;   // 디렉토리의 이름 문자열 안의 위치
+} tindex_entry;
+
+typedef struct {
+    long long bytes;     // 디렉토리 자신은 제외한 내용의 합계 (du 와 같은 할당 크기)
+    long long files;
+    long long dirs;
+} tindex_total;
+
+// 기본 색인 파일 경로 ($XDG_CACHE_HOME 또는 ~/.cache 아래 guiShell/index.bin), 디렉토리가 없으면 만든다
+// return 0 - 성공, -1 - HOME 이 없거나 디렉토리를 만들 수 없음
+int tindex_default_file(char *buf, size_t size);
+
+// 색인 파일을 연다. 파일이 없거나 형식이 맞지 않으면 빈 색인으로 시작한다
+// 이후의 tindex_* 호출이 색인을 쓰게 된다 (열지 않으면 모두 아무 일도 하지 않음)
+// return 0 - 성공, -1 - 경로가 너무 김
+int tindex_open(const char *file);
+
+// 바뀐 내용이 있으면 파일에 저장한다 (임시 파일에 쓰고 rename)
+// return 0 - 성공 또는 바뀐 것 없음, -1 - 쓰기 실패
+int tindex_save(void);
+
+// 색인을 닫고 메모리를 해제한다. 다른 스레드가 색인을 쓰지 않을 때만 호출
+void tindex_close(void);
+
+int tindex_enabled(void);
+
+// 하위 트리 합계. mtime 이 같을 때만 return 0 (하위 디렉토리는 확인하지 않으므로 tindex_scan_tree 와 함께 쓴다)
+int tindex_get_total(dev_t dev, ino_t ino, const struct timespec *mtime, tindex_total *out);
+void tindex_put_total(dev_t dev, ino_t ino, const struct timespec *mtime, const tindex_total *total);
+
+// path 아래 트리가 색인과 같은지 확인한다 - 모든 하위 디렉토리를 lstat 해서 mtime 을 비교
+// (다른 파일 시스템은 건너뛴다). 파일의 크기와 시각은 바뀌어도 알 수 없으므로 이름과 종류만 믿을 것
+// 모두 같으면 visit 을 색인의 항목마다 부르고 (dir - 항목이 있는 디렉토리의 전체 경로) return 0
+// 하나라도 다르면 visit 을 부르지 않고 return -1
+// 실패하면 path 부터 다른 곳까지의 디렉토리를 기억해 두었다가, 순회가 그 디렉토리에 들어가며 다시 부르면
+// 확인하지 않고 바로 실패한다 (위에서부터 들어갈 때마다 같은 하위 트리를 다시 확인하지 않도록)
+typedef void (*tindex_visit_fn)(void *ctx, const char *dir, const char *name, const tindex_entry *e);
+int tindex_scan_tree(const char *path, dev_t dev, ino_t ino, const struct timespec *mtime,
+                     tindex_visit_fn visit, void *ctx);
+
+// walker 의 visit/listed 에서 부르면 읽은 디렉토리 목록을 색인에 넣는다 (작업 스레드마다 따로 모은다)
+// has_stat - st 의 크기와 시각이 있음 (skip_file_stat 으로 이름만 읽었으면 0)
+void tindex_walk_visit(const walk_node *parent, const char *name, const struct stat *st, int has_stat);
+void tindex_walk_listed(const walk_node *node, int complete);
+
+#endif
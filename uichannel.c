@@ -0,0 +1,128 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+
+#include "uichannel.h"
+
+// 채널에 쌓인 메시지
+typedef struct ui_msg {
+    char text[UI_STATUS_LENGTH];
+    struct ui_msg *next;
+} ui_msg;
+
+static int channel_fd = -1;
+static pthread_mutex_t channel_lock = PTHREAD_MUTEX_INITIALIZER;
+static ui_msg *msg_head = NULL;
+static ui_msg *msg_tail = NULL;
+
+static char status_text[UI_STATUS_LENGTH] = ""; // UI 스레드만 접근
+
+int ui_channel_init(void) {
+    channel_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    return channel_fd >= 0 ? 0 : -1;
+}
+
+int ui_channel_fd(void) {
+    return channel_fd;
+}
+
+static void ui_wake(void) {
+    uint64_t one = 1;
+    if (channel_fd >= 0) {
+        // 카운터가 넘칠 때만 실패하며, 그 경우에도 이미 깨울 상태이다
+        ssize_t n = write(channel_fd, &one, sizeof(one));
+        (void)n;
+    }
+}
+
+void ui_post_status(const char *fmt, ...) {
+    ui_msg *msg = malloc(sizeof(ui_msg));
+    if (!msg) {
+        return;
+    }
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(msg->text, sizeof(msg->text), fmt, ap);
+    va_end(ap);
+    msg->next = NULL;
+
+    pthread_mutex_lock(&channel_lock);
+    if (msg_tail) {
+        msg_tail->next = msg;
+    } else {
+        msg_head = msg;
+    }
+    msg_tail = msg;
+    pthread_mutex_unlock(&channel_lock);
+
+    ui_wake();
+}
+
+void ui_post_redraw(void) {
+    ui_wake();
+}
+
+int ui_channel_drain(void) {
+    uint64_t count = 0;
+    int woken = channel_fd >= 0 && read(channel_fd, &count, sizeof(count)) == sizeof(count);
+
+    pthread_mutex_lock(&channel_lock);
+    ui_msg *msg = msg_head;
+    msg_head = msg_tail = NULL;
+    pthread_mutex_unlock(&channel_lock);
+
+    while (msg) {
+        ui_msg *next = msg->next;
+        memcpy(status_text, msg->text, sizeof(status_text)); // 마지막 메시지만 남는다
+        free(msg);
+        msg = next;
+        woken = 1;
+    }
+    return woken;
+}
+
+int ui_wait_events(const int *extra_fds, int extra_count, int timeout_ms) {
+    struct pollfd fds[2 + UI_MAX_EXTRA_FDS];
+    int nfds = 0;
+
+    fds[nfds].fd = STDIN_FILENO;
+    fds[nfds++].events = POLLIN;
+    fds[nfds].fd = channel_fd;
+    fds[nfds++].events = POLLIN;
+    for (int i = 0; i < extra_count && i < UI_MAX_EXTRA_FDS; i++) {
+        fds[nfds].fd = extra_fds[i]; // 음수 fd 는 poll 이 무시한다
+        fds[nfds++].events = POLLIN;
+    }
+
+    if (poll(fds, nfds, timeout_ms) <= 0) {
+        return 0; // 시간 초과 또는 시그널 (SIGWINCH 등)
+    }
+
+    int ready = 0;
+    if (fds[0].revents) {
+        ready |= UI_EVENT_INPUT;
+    }
+    if (fds[1].revents) {
+        ready |= UI_EVENT_CHANNEL;
+    }
+    for (int i = 2; i < nfds; i++) {
+        if (fds[i].revents) {
+            ready |= UI_EVENT_EXTRA(i - 2);
+        }
+    }
+    return ready;
+}
+
+const char *ui_status(void) {
+    return status_text;
+}
+
+void ui_clear_status(void) {
+    status_text[0] = '\0';
+}
@@ -0,0 +1,38 @@
+#ifndef __UICHANNEL__
+#define __UICHANNEL__
+
+#define UI_STATUS_LENGTH 512
+
+// 백그라운드 스레드가 UI 스레드에게 보내는 메시지 채널
+// 메시지는 큐에 쌓이고 eventfd 로 UI 스레드의 poll 을 깨운다
+// ncurses 는 UI 스레드만 호출하고 다른 스레드는 이 채널만 사용한다
+
+// return 0 - 성공, -1 - eventfd 생성 실패
+int ui_channel_init(void);
+
+// poll 에 넣을 파일 디스크립터
+int ui_channel_fd(void);
+
+// 상태줄 메시지 전송 (모든 스레드에서 호출 가능)
+void ui_post_status(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+// 메시지 없이 화면 갱신만 요청 (모든 스레드에서 호출 가능)
+void ui_post_redraw(void);
+
+// 쌓인 메시지를 처리한다 (UI 스레드 전용, 블록하지 않음)
+// return 1 - 화면 갱신 필요, 0 - 받은 메시지 없음
+int ui_channel_drain(void);
+
+// 키 입력, 채널 메시지, extra_fds 중 하나가 준비될 때까지 기다린다 (UI 스레드 전용)
+// timeout_ms 가 -1 이면 무한 대기. 반환값의 비트: UI_EVENT_INPUT, UI_EVENT_CHANNEL, UI_EVENT_EXTRA(i)
+#define UI_EVENT_INPUT 0x1
+#define UI_EVENT_CHANNEL 0x2
+#define UI_EVENT_EXTRA(i) (0x4 << (i))
+#define UI_MAX_EXTRA_FDS 4
+int ui_wait_events(const int *extra_fds, int extra_count, int timeout_ms);
+
+// 마지막으로 받은 상태줄 메시지 (UI 스레드 전용)
+const char *ui_status(void);
+void ui_clear_status(void);
+
+#endif
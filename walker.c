@@ -0,0 +1,446 @@
+#define _GNU_SOURCE // O_DIRECTORY, O_NOFOLLOW
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+
+#include "walker.h"
+
+#define WALKER_DENTS_BUFFER (32 * 1024)
+
+// 디렉토리 하나를 읽는 작업. fd 가 -1 이면 경로로 연다
+typedef struct {
+    walk_node *node;
+    int fd;
+} walk_task;
+
+// 스레드마다 하나씩 - 주인은 뒤에서 넣고 빼고(LIFO), 다른 스레드는 앞에서 가져간다
+typedef struct {
+    pthread_mutex_t lock;
+    walk_task *items;
+    int head, tail;
+    int capacity;
+} task_deque;
+
+typedef struct kept_node {
+    walk_node *node;
+    struct kept_node *next;
+} kept_node;
+
+struct walker {
+    walk_ops ops;
+    void *ctx;
+    int keep_depth;
+    int one_filesystem;
+    dev_t root_dev;
+    walk_node *root;
+
+    task_deque deques[WALKER_MAX_THREADS];
+    pthread_t threads[WALKER_MAX_THREADS];
+    int deque_count;          // 사용하는 덱 수 (계획한 스레드 수)
+    int thread_count;         // 실제로 만든 스레드 수
+
+    pthread_mutex_t idle_lock;
+    pthread_cond_t idle_cond;
+    int queued;               // 덱에 들어 있는 작업 수 (idle_lock)
+    int outstanding;          // 넣었지만 아직 끝나지 않은 작업 수 (idle_lock)
+
+    int open_fds;             // 작업에 미리 열어 둔 fd 수 (원자적)
+    long long scanned;        // 읽은 디렉토리 수 (원자적)
+    int cancel;               // 취소 요청 (원자적)
+
+    pthread_mutex_t kept_lock;
+    kept_node *kept;          // keep_depth 이하라 walker_free 에서 해제할 노드
+};
+
+// getdents64 가 돌려주는 항목
+struct linux_dirent64 {
+    ino_t d_ino;
+    off_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+typedef struct {
+    walker *w;
+    int index;
+} worker_arg;
+
+void walk_add_totals(walk_node *node, long long bytes, long long files, long long dirs) {
+    for (walk_node *n = node; n; n = n->parent) {
+        __atomic_add_fetch(&n->bytes, bytes, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&n->files, files, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&n->dirs, dirs, __ATOMIC_RELAXED);
+    }
+}
+
+static int cancelled(walker *w) {
+    return __atomic_load_n(&w->cancel, __ATOMIC_RELAXED);
+}
+
+static void free_node(walk_node *node) {
+    free(node->name);
+    free(node);
+}
+
+// 노드의 자기 몫을 끝낸다. 하위 트리가 모두 끝났으면 부모 쪽으로 이어서 끝낸다
+static void finish_node(walker *w, walk_node *node) {
+    while (node && __atomic_sub_fetch(&node->pending, 1, __ATOMIC_ACQ_REL) == 0) {
+        __atomic_store_n(&node->complete, 1, __ATOMIC_RELEASE);
+        if (!cancelled(w) && w->ops.leave) {
+            w->ops.leave(w, node, w->ctx);
+        }
+        walk_node *parent = node->parent;
+        if (node->depth > w->keep_depth) {
+            free_node(node);
+        }
+        node = parent;
+    }
+}
+
+static void push_task(walker *w, int index, walk_node *node, int fd) {
+    task_deque *dq = &w->deques[index];
+    pthread_mutex_lock(&dq->lock);
+    if (dq->tail == dq->capacity) {
+        if (dq->head > 0) { // 앞쪽 빈 자리로 당긴다
+            memmove(dq->items, dq->items + dq->head, (dq->tail - dq->head) * sizeof(walk_task));
+            dq->tail -= dq->head;
+            dq->head = 0;
+        }
+        if (dq->tail == dq->capacity) {
+            int new_capacity = dq->capacity ? dq->capacity * 2 : 64;
+            walk_task *p = realloc(dq->items, new_capacity * sizeof(walk_task));
+            if (!p) { // 메모리 부족 - 이 디렉토리는 건너뛴다
+                pthread_mutex_unlock(&dq->lock);
+                if (fd >= 0) {
+                    close(fd);
+                    __atomic_sub_fetch(&w->open_fds, 1, __ATOMIC_RELAXED);
+                }
+                finish_node(w, node);
+                return;
+            }
+            dq->items = p;
+            dq->capacity = new_capacity;
+        }
+    }
+    dq->items[dq->tail].node = node;
+    dq->items[dq->tail].fd = fd;
+    dq->tail++;
+    pthread_mutex_unlock(&dq->lock);
+
+    pthread_mutex_lock(&w->idle_lock);
+    w->queued++;
+    w->outstanding++;
+    pthread_cond_signal(&w->idle_cond);
+    pthread_mutex_unlock(&w->idle_lock);
+}
+
+// 자기 덱의 뒤에서, 없으면 다른 덱의 앞에서 작업을 가져온다
+static int take_task(walker *w, int index, walk_task *out) {
+    for (int k = 0; k < w->deque_count; k++) {
+        int victim = (index + k) % w->deque_count;
+        task_deque *dq = &w->deques[victim];
+        pthread_mutex_lock(&dq->lock);
+        if (dq->head < dq->tail) {
+            if (victim == index) {
+                *out = dq->items[--dq->tail];
+            } else {
+                *out = dq->items[dq->head++];
+            }
+            if (dq->head == dq->tail) {
+                dq->head = dq->tail = 0;
+            }
+            pthread_mutex_unlock(&dq->lock);
+
+            pthread_mutex_lock(&w->idle_lock);
+            w->queued--;
+            pthread_mutex_unlock(&w->idle_lock);
+            return 1;
+        }
+        pthread_mutex_unlock(&dq->lock);
+    }
+    return 0;
+}
+
+// fd 가 부족해서 미리 열지 못한 디렉토리는 부모 포인터를 따라 경로를 만든다
+int walk_node_path(const walk_node *node, char *buf, size_t size) {
+    if (!node->parent) {
+        return snprintf(buf, size, "%s", node->name) < (int)size ? 0 : -1;
+    }
+    if (walk_node_path(node->parent, buf, size) < 0) {
+        return -1;
+    }
+    size_t len = strlen(buf);
+    return snprintf(buf + len, size - len, "/%s", node->name) < (int)(size - len) ? 0 : -1;
+}
+
+// d_type 에 해당하는 st_mode 의 파일 종류, 모르면 0
+static mode_t dtype_mode(unsigned char type) {
+    switch (type) {
+        case DT_REG: return S_IFREG;
+        case DT_DIR: return S_IFDIR;
+        case DT_LNK: return S_IFLNK;
+        case DT_FIFO: return S_IFIFO;
+        case DT_SOCK: return S_IFSOCK;
+        case DT_CHR: return S_IFCHR;
+        case DT_BLK: return S_IFBLK;
+        default: return 0;
+    }
+}
+
+static void process_task(walker *w, int index, walk_task *task) {
+    walk_node *node = task->node;
+    int fd = task->fd;
+    if (fd >= 0) {
+        __atomic_sub_fetch(&w->open_fds, 1, __ATOMIC_RELAXED);
+    }
+    if (cancelled(w)) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        finish_node(w, node);
+        return;
+    }
+    if (fd < 0) {
+        char path[4096];
+        if (walk_node_path(node, path, sizeof(path)) == 0) {
+            fd = open(path, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        }
+        if (fd < 0) {
+            finish_node(w, node);
+            return;
+        }
+    }
+    __atomic_add_fetch(&w->scanned, 1, __ATOMIC_RELAXED);
+
+    char *buf = malloc(WALKER_DENTS_BUFFER);
+    int complete = 0;
+    while (buf && !cancelled(w)) {
+        long len = syscall(SYS_getdents64, fd, buf, WALKER_DENTS_BUFFER);
+        if (len <= 0) {
+            complete = len == 0 && !cancelled(w);
+            break;
+        }
+        for (long off = 0; off < len; ) {
+            struct linux_dirent64 *d = (struct linux_dirent64 *)(buf + off);
+            off += d->d_reclen;
+            const char *name = d->d_name;
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+                continue;
+            }
+
+            struct stat st;
+            mode_t kind = w->ops.skip_file_stat ? dtype_mode(d->d_type) : 0;
+            if (kind && !S_ISDIR(kind)) { // 이름과 종류만으로 충분
+                memset(&st, 0, sizeof(st));
+                st.st_mode = kind;
+                st.st_ino = d->d_ino;
+            } else if (fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+                continue; // 그 사이 지워진 항목
+            }
+            if (w->ops.visit) {
+                w->ops.visit(w, node, name, &st, w->ctx);
+            }
+            if (!S_ISDIR(st.st_mode) || (w->one_filesystem && st.st_dev != w->root_dev)) {
+                continue;
+            }
+
+            walk_node *child = calloc(1, sizeof(walk_node));
+            if (!child || !(child->name = strdup(name))) {
+                free(child);
+                continue;
+            }
+            child->parent = node;
+            child->depth = node->depth + 1;
+            child->dev = st.st_dev;
+            child->ino = st.st_ino;
+            child->mtime = st.st_mtim;
+            child->pending = 1;
+            __atomic_add_fetch(&node->pending, 1, __ATOMIC_ACQ_REL);
+            if (child->depth <= w->keep_depth) {
+                kept_node *k = malloc(sizeof(kept_node));
+                if (k) {
+                    k->node = child;
+                    pthread_mutex_lock(&w->kept_lock);
+                    k->next = w->kept;
+                    w->kept = k;
+                    pthread_mutex_unlock(&w->kept_lock);
+                }
+            }
+
+            if (w->ops.enter && !w->ops.enter(w, child, w->ctx)) {
+                finish_node(w, child); // 캐시된 결과 사용 등으로 들어가지 않음
+                continue;
+            }
+
+            // fd 여유가 있으면 지금 부모 fd 기준으로 열어 둔다
+            int child_fd = -1;
+            if (__atomic_add_fetch(&w->open_fds, 1, __ATOMIC_RELAXED) <= WALKER_MAX_FDS) {
+                child_fd = openat(fd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+            }
+            if (child_fd < 0) {
+                __atomic_sub_fetch(&w->open_fds, 1, __ATOMIC_RELAXED);
+            }
+            push_task(w, index, child, child_fd);
+        }
+    }
+    free(buf);
+    close(fd);
+    if (w->ops.listed) {
+        w->ops.listed(w, node, complete, w->ctx);
+    }
+    finish_node(w, node);
+}
+
+static void *walker_thread(void *arg) {
+    worker_arg *wa = arg;
+    walker *w = wa->w;
+    int index = wa->index;
+    free(wa);
+
+    while (1) {
+        walk_task task;
+        if (take_task(w, index, &task)) {
+            process_task(w, index, &task);
+            pthread_mutex_lock(&w->idle_lock);
+            if (--w->outstanding == 0) {
+                pthread_cond_broadcast(&w->idle_cond); // 모두 끝남
+            }
+            pthread_mutex_unlock(&w->idle_lock);
+            continue;
+        }
+
+        pthread_mutex_lock(&w->idle_lock);
+        while (w->queued == 0 && w->outstanding > 0) {
+            pthread_cond_wait(&w->idle_cond, &w->idle_lock);
+        }
+        int finished = w->outstanding == 0;
+        pthread_mutex_unlock(&w->idle_lock);
+        if (finished) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+walker *walker_start(const char *root, const walk_ops *ops, void *ctx, int keep_depth, int one_filesystem) {
+    int fd = open(root, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat st;
+    walker *w = calloc(1, sizeof(walker));
+    walk_node *node = calloc(1, sizeof(walk_node));
+    kept_node *k = malloc(sizeof(kept_node));
+    if (!w || !node || !k || fstat(fd, &st) != 0 || !(node->name = strdup(root))) {
+        close(fd);
+        free(w);
+        free(node);
+        free(k);
+        return NULL;
+    }
+    node->dev = st.st_dev;
+    node->ino = st.st_ino;
+    node->mtime = st.st_mtim;
+    node->pending = 1;
+
+    w->ops = *ops;
+    w->ctx = ctx;
+    w->keep_depth = keep_depth;
+    w->one_filesystem = one_filesystem;
+    w->root_dev = st.st_dev;
+    w->root = node;
+    k->node = node;
+    k->next = NULL;
+    w->kept = k;
+    pthread_mutex_init(&w->idle_lock, NULL);
+    pthread_cond_init(&w->idle_cond, NULL);
+    pthread_mutex_init(&w->kept_lock, NULL);
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    w->deque_count = cpus > 0 ? (int)cpus * 2 : WALKER_MIN_THREADS;
+    if (w->deque_count < WALKER_MIN_THREADS) {
+        w->deque_count = WALKER_MIN_THREADS;
+    } else if (w->deque_count > WALKER_MAX_THREADS) {
+        w->deque_count = WALKER_MAX_THREADS;
+    }
+    for (int i = 0; i < w->deque_count; i++) {
+        pthread_mutex_init(&w->deques[i].lock, NULL);
+    }
+
+    w->open_fds = 1;
+    push_task(w, 0, node, fd);
+
+    int created = 0;
+    for (int i = 0; i < w->deque_count; i++) {
+        worker_arg *wa = malloc(sizeof(worker_arg));
+        if (!wa) {
+            break;
+        }
+        wa->w = w;
+        wa->index = i;
+        if (pthread_create(&w->threads[i], NULL, walker_thread, wa) != 0) {
+            free(wa);
+            break;
+        }
+        created++;
+    }
+    w->thread_count = created;
+
+    if (created == 0) { // 스레드를 만들 수 없으면 여기서 끝까지 순회
+        worker_arg *wa = malloc(sizeof(worker_arg));
+        if (wa) {
+            wa->w = w;
+            wa->index = 0;
+            walker_thread(wa);
+        }
+    }
+    return w;
+}
+
+walk_node *walker_root(walker *w) {
+    return w->root;
+}
+
+void walker_cancel(walker *w) {
+    __atomic_store_n(&w->cancel, 1, __ATOMIC_RELAXED);
+}
+
+int walker_done(walker *w) {
+    pthread_mutex_lock(&w->idle_lock);
+    int done = w->outstanding == 0;
+    pthread_mutex_unlock(&w->idle_lock);
+    return done;
+}
+
+long long walker_scanned(walker *w) {
+    return __atomic_load_n(&w->scanned, __ATOMIC_RELAXED);
+}
+
+void walker_free(walker *w) {
+    if (!w) {
+        return;
+    }
+    __atomic_store_n(&w->cancel, 1, __ATOMIC_RELAXED);
+    for (int i = 0; i < w->thread_count; i++) {
+        pthread_join(w->threads[i], NULL);
+    }
+    while (w->kept) {
+        kept_node *k = w->kept;
+        w->kept = k->next;
+        free_node(k->node);
+        free(k);
+    }
+    for (int i = 0; i < w->deque_count; i++) {
+        free(w->deques[i].items);
+        pthread_mutex_destroy(&w->deques[i].lock);
+    }
+    pthread_mutex_destroy(&w->idle_lock);
+    pthread_cond_destroy(&w->idle_cond);
+    pthread_mutex_destroy(&w->kept_lock);
+    free(w);
+}
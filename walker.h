@@ -0,0 +1,78 @@
+#ifndef __WALKER__
+#define __WALKER__
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+// 작업 스레드 수는 코어 수의 두 배를 이 범위로 제한한다 (디스크를 기다리는 동안에도 요청이 쌓이도록)
+#define WALKER_MIN_THREADS 4
+#define WALKER_MAX_THREADS 16
+#define WALKER_MAX_FDS 256    // 미리 열어 두는 하위 디렉토리 fd 의 최대 수
+
+// 병렬 디렉토리 트리 순회기
+// 스레드마다 디렉토리 작업 덱을 두고, 자기 덱이 비면 다른 스레드의 덱에서 가져온다 (work stealing)
+// 디렉토리는 부모 fd 기준 openat + getdents64 로 읽고, 경로 문자열은 만들지 않는다
+// (fd 가 부족할 때만 부모 포인터를 따라 경로를 만든다)
+
+typedef struct walk_node walk_node;
+struct walk_node {
+    walk_node *parent;
+    char *name;               // 루트는 전체 경로
+    int depth;                // 루트 0
+    dev_t dev;
+    ino_t ino;
+    struct timespec mtime;
+    volatile int pending;     // 끝나지 않은 하위 디렉토리 수 + 1 (자기 자신)
+    volatile long long bytes; // 지금까지 센 하위 트리의 합계 (walk_add_totals)
+    volatile long long files;
+    volatile long long dirs;
+    int complete;             // 하위 트리 순회가 끝남
+};
+
+typedef struct walker walker;
+
+typedef struct {
+    // 하위 디렉토리에 들어가기 전 (작업 스레드에서 호출). 0 을 돌려주면 들어가지 않는다
+    // 캐시된 합계가 있으면 여기서 walk_add_totals 로 넣고 0 을 돌려주면 된다 (NULL 가능)
+    int (*enter)(walker *w, walk_node *node, void *ctx);
+    // 디렉토리 안의 항목마다 (디렉토리 포함, 작업 스레드에서 호출)
+    void (*visit)(walker *w, walk_node *parent, const char *name, const struct stat *st, void *ctx);
+    // 디렉토리의 하위 트리 순회가 모두 끝났을 때 (취소된 경우에는 호출하지 않음, NULL 가능)
+    void (*leave)(walker *w, walk_node *node, void *ctx);
+    // 1 - 디렉토리가 아닌 항목은 stat 하지 않는다 (이름과 종류만 필요한 경우)
+    // 이때 visit 의 st 에는 d_type 으로 정한 st_mode 의 파일 종류와 st_ino 만 있다
+    // (d_type 을 알려 주지 않는 파일 시스템이면 stat 한다)
+    int skip_file_stat;
+    // 디렉토리 하나를 다 읽은 뒤 (그 디렉토리의 visit 을 부른 작업 스레드에서 호출, NULL 가능)
+    // complete 가 0 이면 읽기 오류나 취소로 중간에 멈춘 것 - 지금까지 visit 한 항목이 전부가 아니다
+    void (*listed)(walker *w, walk_node *node, int complete, void *ctx);
+} walk_ops;
+
+// root 부터 순회를 시작한다. keep_depth 이하의 노드는 walker_free 까지 유지된다 (그 밑은 끝나면 해제)
+// one_filesystem 이 1 이면 다른 파일 시스템으로 넘어가지 않는다
+// return NULL - root 를 열 수 없음
+walker *walker_start(const char *root, const walk_ops *ops, void *ctx, int keep_depth, int one_filesystem);
+
+// 루트 노드 (walker_free 전까지 유효)
+walk_node *walker_root(walker *w);
+
+// node 와 모든 조상에 합계를 더한다 (작업 스레드에서 호출 가능)
+void walk_add_totals(walk_node *node, long long bytes, long long files, long long dirs);
+
+// node 의 전체 경로 (루트 이름부터). visit 중에는 parent 와 그 조상이 유효하다
+// return 0 - 성공, -1 - size 가 부족함
+int walk_node_path(const walk_node *node, char *buf, size_t size);
+
+// 순회 중단 요청 (블록하지 않음)
+void walker_cancel(walker *w);
+
+// 1 - 모든 작업이 끝남 (취소 포함)
+int walker_done(walker *w);
+
+// 지금까지 읽은 디렉토리 수
+long long walker_scanned(walker *w);
+
+// 취소하고 스레드가 끝나기를 기다린 뒤 모든 노드를 해제한다
+void walker_free(walker *w);
+
+#endif